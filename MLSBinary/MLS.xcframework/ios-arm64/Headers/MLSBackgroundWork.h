@@ -0,0 +1,55 @@
+#import <Foundation/Foundation.h>
+
+@class MLSGroupScheduler;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Runs maintenance work — key rotation, committing pending proposals,
+ * adding members, tree export and key package refill — at utility QoS so it
+ * yields the cores to the interactive encrypt, decrypt and process calls of
+ * other groups.
+ *
+ * Work still runs on its group's lane, after everything scheduled for the
+ * group before it. Until it starts it can be cancelled, and while the power
+ * mode or the system's Low Power Mode asks to save energy it is held back
+ * instead of being queued, for at most `deferralLimit`. Held work joins its
+ * lane when it is released, behind anything scheduled for the group in the
+ * meantime, as if it had been called then.
+ *
+ * Thread-safe.
+ */
+@interface MLSBackgroundWork : NSObject
+
+- (instancetype)initWithDeferralLimit:(NSTimeInterval)deferralLimit;
+
+/**
+ * Queue `work` on the lane for `key`, or hold it while saving energy.
+ * `cancelled` runs instead of `work` if the work is cancelled before it starts.
+ */
+- (void)scheduleOn:(MLSGroupScheduler *)scheduler
+               key:(NSString *)key
+              work:(dispatch_block_t)work
+         cancelled:(dispatch_block_t)cancelled;
+
+/**
+ * Cancel the work for `key`, or all of it, that has not started yet
+ * @return How many were cancelled
+ */
+- (NSUInteger)cancelWorkForKey:(nullable NSString *)key;
+
+/**
+ * Follow the power mode of Utils/BatteryOptimizer.swift: "performance",
+ * "balanced", "powerSaver" or "ultraLowPower". Work is held where
+ * shouldSkipNonEssential holds there, in ultraLowPower and in powerSaver
+ * while the app is in the background, and released once that ends.
+ * @return NO for an unknown mode, which leaves the policy unchanged
+ */
+- (BOOL)setPowerMode:(NSString *)powerMode inBackground:(BOOL)inBackground;
+
+// {powerMode, inBackground, lowPowerMode, deferring, deferred, queued, started, cancelled}
+- (NSDictionary *)statistics;
+
+@end
+
+NS_ASSUME_NONNULL_END
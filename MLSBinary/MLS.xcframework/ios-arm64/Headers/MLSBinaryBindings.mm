@@ -0,0 +1,1049 @@
+#import "MLSBinaryBindings.h"
+#import "MLSModule.h"
+#import "MLSModule+Internal.h"
+#import "MLSCiphertextFilter.h"
+#import "MLSClientTable.h"
+#import "MLSCompactResult.h"
+#import "MLSEpochReorderBuffer.h"
+#import "MLSErrors.h"
+#import "MLSGroupScheduler.h"
+#import "MLSFFI.h"
+#import "MLSGroupHandleCache.h"
+#import "MLSKeyRotationSchedule.h"
+#import "MLSMetrics.h"
+#import "MLSPlatform.h"
+#import "MLSProposalAggregator.h"
+#import "MLSExporterSecretCache.h"
+#import "MLSMeshOutbox.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace facebook;
+
+namespace {
+
+// ArrayBuffer backing store that owns a buffer allocated by Rust and hands it
+// back to mls_free_bytes once the JS ArrayBuffer is garbage collected
+class MLSRustBuffer : public jsi::MutableBuffer {
+public:
+    MLSRustBuffer(uint8_t *bytes, size_t length) : bytes_(bytes), length_(length) {}
+    ~MLSRustBuffer() override
+    {
+        if (bytes_ != NULL) {
+            mls_free_bytes(bytes_);
+        }
+    }
+
+    size_t size() const override { return length_; }
+    uint8_t *data() override { return bytes_; }
+
+private:
+    uint8_t *bytes_;
+    size_t length_;
+};
+
+// ArrayBuffer backing store sharing an NSData, used once a commit has been
+// handed to the mesh outbox and both sides read the same Rust buffer
+class MLSDataBuffer : public jsi::MutableBuffer {
+public:
+    explicit MLSDataBuffer(NSData *data) : data_(data) {}
+
+    size_t size() const override { return data_.length; }
+    uint8_t *data() override { return (uint8_t *)data_.bytes; }
+
+private:
+    NSData *data_;
+};
+
+// ArrayBuffer backing store for secret bytes; wiped when the JS ArrayBuffer
+// is garbage collected
+class MLSSecretBuffer : public jsi::MutableBuffer {
+public:
+    explicit MLSSecretBuffer(std::vector<uint8_t> &&bytes) : bytes_(std::move(bytes)) {}
+    ~MLSSecretBuffer() override { MLSZeroize(bytes_); }
+
+    size_t size() const override { return bytes_.size(); }
+    uint8_t *data() override { return bytes_.data(); }
+
+private:
+    std::vector<uint8_t> bytes_;
+};
+
+// Read-only window into a shared Rust buffer, used to hand out chunks of one
+// export without copying. The last slice to go away frees the whole buffer.
+class MLSRustBufferSlice : public jsi::MutableBuffer {
+public:
+    MLSRustBufferSlice(std::shared_ptr<MLSRustBuffer> owner, size_t offset, size_t length)
+        : owner_(std::move(owner)), offset_(offset), length_(length) {}
+
+    size_t size() const override { return length_; }
+    uint8_t *data() override { return owner_->data() + offset_; }
+
+private:
+    std::shared_ptr<MLSRustBuffer> owner_;
+    size_t offset_;
+    size_t length_;
+};
+
+struct MLSByteView {
+    const uint8_t *bytes;
+    size_t length;
+};
+
+void requireArguments(jsi::Runtime &rt, const char *name, size_t count, size_t expected)
+{
+    if (count < expected) {
+        throw jsi::JSError(rt, std::string(name) + " expects " + std::to_string(expected) + " arguments");
+    }
+}
+
+std::string stringArgument(jsi::Runtime &rt, const jsi::Value &value, const char *name)
+{
+    if (!value.isString()) {
+        throw jsi::JSError(rt, std::string(name) + " must be a string");
+    }
+    return value.asString(rt).utf8(rt);
+}
+
+// Accepts an ArrayBuffer or any typed array view over one. The returned view
+// borrows the JS-owned memory and is only valid for the duration of the call.
+MLSByteView bytesArgument(jsi::Runtime &rt, const jsi::Value &value, const char *name)
+{
+    if (value.isObject()) {
+        jsi::Object object = value.asObject(rt);
+        if (object.isArrayBuffer(rt)) {
+            jsi::ArrayBuffer buffer = object.getArrayBuffer(rt);
+            return {buffer.data(rt), buffer.size(rt)};
+        }
+
+        jsi::Value backing = object.getProperty(rt, "buffer");
+        if (backing.isObject() && backing.getObject(rt).isArrayBuffer(rt)) {
+            jsi::ArrayBuffer buffer = backing.getObject(rt).getArrayBuffer(rt);
+            size_t offset = (size_t)object.getProperty(rt, "byteOffset").asNumber();
+            size_t length = (size_t)object.getProperty(rt, "byteLength").asNumber();
+            if (offset + length <= buffer.size(rt)) {
+                return {buffer.data(rt) + offset, length};
+            }
+        }
+    }
+    throw jsi::JSError(rt, std::string(name) + " must be an ArrayBuffer or typed array");
+}
+
+// Reads an array of byte arguments. `elements` keeps the element values
+// alive so the borrowed views stay valid until the caller returns.
+std::vector<MLSByteView> bytesArrayArgument(jsi::Runtime &rt, const jsi::Value &value, const char *name,
+                                            std::vector<jsi::Value> &elements)
+{
+    if (!value.isObject() || !value.getObject(rt).isArray(rt)) {
+        throw jsi::JSError(rt, std::string(name) + " must be an array");
+    }
+    jsi::Array array = value.getObject(rt).getArray(rt);
+    size_t length = array.size(rt);
+
+    std::vector<MLSByteView> views;
+    elements.reserve(length);
+    views.reserve(length);
+    for (size_t i = 0; i < length; i++) {
+        elements.push_back(array.getValueAtIndex(rt, i));
+        views.push_back(bytesArgument(rt, elements.back(), name));
+    }
+    return views;
+}
+
+// Copy {code, category, retryable, detail?} of an MLSErrorDomain error onto a JS object
+void setErrorFields(jsi::Runtime &rt, jsi::Object &object, NSError *error)
+{
+    NSDictionary<NSString *, id> *fields = MLSErrorFields(error);
+    for (NSString *key in @[ @"code", @"category", @"detail" ]) {
+        NSString *value = fields[key];
+        if (value != nil) {
+            object.setProperty(rt, key.UTF8String, jsi::String::createFromUtf8(rt, value.UTF8String));
+        }
+    }
+    if (fields[@"retryable"] != nil) {
+        object.setProperty(rt, "retryable", (bool)[fields[@"retryable"] boolValue]);
+    }
+}
+
+// Throw an Error with the fields of `error` as its userInfo, the shape React
+// Native gives the rejections of the promise-based methods
+[[noreturn]] void throwMLSError(jsi::Runtime &rt, const char *message, NSError *error)
+{
+    jsi::Object jsError = rt.global().getPropertyAsFunction(rt, "Error")
+                              .callAsConstructor(rt, jsi::String::createFromUtf8(rt, message)).getObject(rt);
+    jsi::Object userInfo(rt);
+    setErrorFields(rt, userInfo, error);
+    jsError.setProperty(rt, "userInfo", std::move(userInfo));
+    throw jsi::JSError(rt, jsi::Value(rt, jsError));
+}
+
+jsi::Value arrayBufferFromRust(jsi::Runtime &rt, uint8_t *bytes, int length)
+{
+    if (bytes == NULL) {
+        return jsi::Value::undefined();
+    }
+    return jsi::ArrayBuffer(rt, std::make_shared<MLSRustBuffer>(bytes, (size_t)length));
+}
+
+// Commit and Welcome produced on a group lane. After handOffCommit the
+// buffers are owned by the NSData objects instead of the raw pointers.
+struct MLSCommitOutput {
+    uint8_t *commitBytes = NULL;
+    int commitLen = 0;
+    uint8_t *welcomeBytes = NULL;
+    int welcomeLen = 0;
+    NSData *commit = nil;
+    NSData *welcome = nil;
+    // Why the FFI produced no commit
+    NSError *error = nil;
+};
+
+NSData *dataFromRust(uint8_t *bytes, int length)
+{
+    return [[NSData alloc] initWithBytesNoCopy:bytes length:(NSUInteger)length deallocator:^(void *buffer, NSUInteger bufferLength) {
+        mls_free_bytes((uint8_t *)buffer);
+    }];
+}
+
+// Give a fresh commit to the mesh outbox while still on the group's lane, so
+// hand-offs stay in epoch order with the promise-based methods, then report
+// the new epoch it merged as they do: rosters, events, pending proposals and
+// parked messages all follow it
+void handOffCommit(MLSModule *module, void *client, const char *groupId, const char *senderId, MLSCommitOutput &output)
+{
+    if (output.commitBytes == NULL) {
+        return;
+    }
+    if (MLSModule.meshOutbox != nil) {
+        output.commit = dataFromRust(output.commitBytes, output.commitLen);
+        output.commitBytes = NULL;
+        if (output.welcomeBytes != NULL) {
+            output.welcome = dataFromRust(output.welcomeBytes, output.welcomeLen);
+            output.welcomeBytes = NULL;
+        }
+        [module handOffCommit:output.commit welcome:output.welcome groupId:@(groupId) senderId:@(senderId)];
+    }
+    [module groupStateDidChange:MLSGroupStateChangeNewEpoch groupId:@(groupId) userId:@(senderId) client:client];
+}
+
+jsi::Value commitBuffer(jsi::Runtime &rt, uint8_t *bytes, int length, NSData *data)
+{
+    if (data != nil) {
+        return jsi::ArrayBuffer(rt, std::make_shared<MLSDataBuffer>(data));
+    }
+    return arrayBufferFromRust(rt, bytes, length);
+}
+
+jsi::Value commitResult(jsi::Runtime &rt, const MLSCommitOutput &output)
+{
+    jsi::Object result(rt);
+    result.setProperty(rt, "commit", commitBuffer(rt, output.commitBytes, output.commitLen, output.commit));
+    if (output.welcomeBytes != NULL || output.welcome != nil) {
+        result.setProperty(rt, "welcome", commitBuffer(rt, output.welcomeBytes, output.welcomeLen, output.welcome));
+    }
+    return std::move(result);
+}
+
+const char *messageTypeName(int messageType)
+{
+    switch (messageType) {
+        case 0: return "application";
+        case 1: return "proposal";
+        case 2: return "commit";
+        case 3: return "welcome";
+        default: return "unknown";
+    }
+}
+
+// Raw outputs of one mls_process_message call, collected on the method
+// queue and converted to JS values afterwards on the JS thread
+struct MLSProcessOutput {
+    int status = 0;
+    int messageType = 0;
+    uint8_t *contentBytes = NULL;
+    int contentLen = 0;
+    uint8_t *senderBytes = NULL;
+    int senderLen = 0;
+    int validated = 0;
+    // Set when a message from a later epoch was parked, see deferMessageBytes:.
+    // The epoch is also set when it was not, and the error is wrong_epoch.
+    uint64_t deferredTicket = 0;
+    uint64_t deferredEpoch = 0;
+    // Set when the filter already saw the ciphertext; nothing else is
+    bool duplicate = false;
+    // Why the FFI rejected the message
+    NSError *error = nil;
+};
+
+// Must run on the group's lane; the use is recorded, and accepted proposals
+// and commits are reported to the module so it can update rosters and emit
+// state change events
+MLSProcessOutput processCiphertext(MLSModule *module, void *client, const char *groupIdStr, const char *userIdStr,
+                                   MLSByteView ciphertext)
+{
+    MLSProcessOutput output;
+    output.status = MLSProcessMessage([module groupHandles], client, groupIdStr, userIdStr,
+                                      ciphertext.bytes, (int)ciphertext.length,
+                                      &output.messageType, &output.contentBytes, &output.contentLen,
+                                      &output.senderBytes, &output.senderLen, &output.validated);
+    if (output.status != MLSFFIStatusOK) {
+        output.error = MLSTakeLastFFIError();
+    }
+    if (output.status == MLSFFIStatusOK) {
+        [module groupWasUsed:@(groupIdStr) userId:@(userIdStr) decrypted:output.messageType == 0];
+    }
+    if (output.status == MLSFFIStatusOK && (output.messageType == 1 || output.messageType == 2)) {
+        MLSGroupStateChange change = output.messageType == 1 ? MLSGroupStateChangeProposal : MLSGroupStateChangeNewEpoch;
+        [module groupStateDidChange:change groupId:@(groupIdStr) userId:@(userIdStr) client:client];
+    }
+    return output;
+}
+
+// processCiphertext behind the module's duplicate filter, parking a
+// rejected message in the reorder buffer if it is from a later epoch. Like
+// processMessageBytes:, only processed and parked ciphertexts are recorded,
+// and the module forgets parked ones it ends up not replaying.
+// Must run on the group's lane.
+MLSProcessOutput processIncomingCiphertext(MLSModule *module, void *client, const char *groupIdStr, const char *userIdStr,
+                                           MLSByteView ciphertext)
+{
+    MLSCiphertextFilter *filter = [module ciphertextFilter];
+    MLSCiphertextDigest digest = MLSDigestCiphertext(groupIdStr, userIdStr, ciphertext.bytes, ciphertext.length);
+    if (filter->contains(digest)) {
+        MLSProcessOutput output;
+        output.status = !MLSFFIStatusOK;
+        output.duplicate = true;
+        return output;
+    }
+
+    MLSProcessOutput output = processCiphertext(module, client, groupIdStr, userIdStr, ciphertext);
+    if (output.status != MLSFFIStatusOK) {
+        output.deferredTicket = [module deferMessageBytes:ciphertext.bytes length:ciphertext.length
+                                                   groupId:groupIdStr userId:userIdStr client:client
+                                                     epoch:&output.deferredEpoch];
+        if (output.deferredTicket == 0 && output.deferredEpoch != 0) {
+            output.error = MLSBridgeError(MLSErrorCodeWrongEpoch);
+        }
+    }
+    if (output.status == MLSFFIStatusOK || output.deferredTicket != 0) {
+        filter->insert(digest);
+    }
+    return output;
+}
+
+jsi::Value duplicateOutputToJS(jsi::Runtime &rt)
+{
+    jsi::Object duplicate(rt);
+    duplicate.setProperty(rt, "type", "duplicate");
+    return std::move(duplicate);
+}
+
+jsi::Value deferredOutputToJS(jsi::Runtime &rt, const MLSProcessOutput &output)
+{
+    jsi::Object deferred(rt);
+    deferred.setProperty(rt, "type", "deferred");
+    deferred.setProperty(rt, "epoch", (double)output.deferredEpoch);
+    deferred.setProperty(rt, "ticket", (double)output.deferredTicket);
+    return std::move(deferred);
+}
+
+// Content stays binary; the caller decides whether it is UTF-8
+jsi::Value processOutputToJS(jsi::Runtime &rt, MLSProcessOutput &output)
+{
+    jsi::Object processed(rt);
+    processed.setProperty(rt, "type", jsi::String::createFromAscii(rt, messageTypeName(output.messageType)));
+    if (output.contentBytes != NULL && output.contentLen > 0) {
+        processed.setProperty(rt, "content", arrayBufferFromRust(rt, output.contentBytes, output.contentLen));
+    } else if (output.contentBytes != NULL) {
+        mls_free_bytes(output.contentBytes);
+    }
+    if (output.senderBytes != NULL) {
+        if (output.senderLen > 0) {
+            processed.setProperty(rt, "sender", jsi::String::createFromUtf8(rt, output.senderBytes, (size_t)output.senderLen));
+        }
+        mls_free_bytes(output.senderBytes);
+    }
+    output.contentBytes = NULL;
+    output.senderBytes = NULL;
+    processed.setProperty(rt, "validated", output.validated == 1);
+    return std::move(processed);
+}
+
+// Append the compact record of one output, see MLSCompactResult.h, and free
+// its Rust buffers
+void appendCompactOutput(NSMutableData *buffer, MLSProcessOutput &output, MLSByteView ciphertext)
+{
+    if (output.duplicate) {
+        MLSAppendCompactResult(buffer, MLSCompactKind::Duplicate, 0, 0, nullptr, 0, nullptr, 0);
+    } else if (output.status != MLSFFIStatusOK && output.deferredTicket != 0) {
+        MLSAppendCompactDeferred(buffer, output.deferredEpoch, output.deferredTicket);
+    } else if (output.status != MLSFFIStatusOK) {
+        NSDictionary *fields = MLSErrorFields(output.error);
+        MLSAppendCompactError(buffer, fields[@"code"], [fields[@"retryable"] boolValue]);
+    } else {
+        MLSMessageHeader header;
+        uint64_t epoch = MLSReadMessageHeader(ciphertext.bytes, ciphertext.length, header) ? header.epoch : 0;
+        MLSAppendCompactResult(buffer, (MLSCompactKind)output.messageType, output.validated == 1 ? MLSCompactFlagValidated : 0,
+                               epoch, output.senderBytes, (size_t)output.senderLen, output.contentBytes, (size_t)output.contentLen);
+    }
+    if (output.contentBytes != NULL) {
+        mls_free_bytes(output.contentBytes);
+    }
+    if (output.senderBytes != NULL) {
+        mls_free_bytes(output.senderBytes);
+    }
+    output.contentBytes = NULL;
+    output.senderBytes = NULL;
+}
+
+// Runs an FFI call on the group's lane of the user's client, ordered with
+// the promise-based methods for that group. The JS thread blocks for the
+// duration, which also keeps any borrowed ArrayBuffer memory alive.
+void runOnGroupLane(jsi::Runtime &rt, MLSModule *module, const char *groupId, const char *userId, void (^work)(void *client))
+{
+    if (module == nil) {
+        throw jsi::JSError(rt, "MLS module has been invalidated");
+    }
+
+    __block BOOL initialized = NO;
+    MLSIdentityClient *owner = [module clientForIdentity:@(userId)];
+    [owner.scheduler dispatchSyncForKey:@(groupId) block:^{
+        void *client = owner.client;
+        if (client) {
+            initialized = YES;
+            work(client);
+        }
+    }];
+
+    if (!initialized) {
+        throwMLSError(rt, "MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
+    }
+}
+
+void installFunction(jsi::Runtime &rt, jsi::Object &target, const char *name, unsigned int paramCount, jsi::HostFunctionType body)
+{
+    target.setProperty(rt, name,
+                       jsi::Function::createFromHostFunction(rt, jsi::PropNameID::forAscii(rt, name), paramCount, std::move(body)));
+}
+
+} // namespace
+
+void MLSInstallBinaryBindings(jsi::Runtime &runtime, MLSModule *module)
+{
+    __weak MLSModule *weakModule = module;
+    jsi::Object bindings(runtime);
+
+    // createApplicationMessage(groupId, userId, plaintext) -> ArrayBuffer
+    installFunction(runtime, bindings, "createApplicationMessage", 3,
+                    [weakModule](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        requireArguments(rt, "createApplicationMessage", count, 3);
+        MLSOperationTrace trace([weakModule metrics], "binary.createApplicationMessage");
+        std::string groupId = stringArgument(rt, args[0], "groupId");
+        std::string userId = stringArgument(rt, args[1], "userId");
+        MLSByteView plaintext = bytesArgument(rt, args[2], "plaintext");
+        trace.addBytesIn(plaintext.length);
+
+        __block uint8_t *encryptedBytes = NULL;
+        __block int encryptedLen = 0;
+        __block NSError *error = nil;
+        const char *groupIdStr = groupId.c_str();
+        const char *userIdStr = userId.c_str();
+        trace.enterPhase(MLSOperationPhase::FFI);
+        runOnGroupLane(rt, weakModule, groupIdStr, userIdStr, ^(void *client) {
+            encryptedBytes = MLSCreateApplicationMessage([weakModule groupHandles], client, groupIdStr, userIdStr,
+                                                         plaintext.bytes, (int)plaintext.length, &encryptedLen);
+            if (encryptedBytes != NULL) {
+                [weakModule groupWasUsed:@(groupIdStr) userId:@(userIdStr) decrypted:NO];
+            } else {
+                error = MLSTakeLastFFIError();
+            }
+        });
+        trace.enterPhase(MLSOperationPhase::Marshal);
+
+        if (encryptedBytes == NULL) {
+            throwMLSError(rt, "Failed to create application message", error);
+        }
+        trace.addBytesOut((uint64_t)encryptedLen);
+        trace.succeed();
+        return arrayBufferFromRust(rt, encryptedBytes, encryptedLen);
+    });
+
+    // createApplicationMessages(groupId, userId, plaintexts[]) -> [ArrayBuffer | undefined]
+    installFunction(runtime, bindings, "createApplicationMessages", 3,
+                    [weakModule](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        requireArguments(rt, "createApplicationMessages", count, 3);
+        MLSOperationTrace trace([weakModule metrics], "binary.createApplicationMessages");
+        std::string groupId = stringArgument(rt, args[0], "groupId");
+        std::string userId = stringArgument(rt, args[1], "userId");
+        std::vector<jsi::Value> elements;
+        std::vector<MLSByteView> plaintexts = bytesArrayArgument(rt, args[2], "plaintexts", elements);
+        for (const MLSByteView &view : plaintexts) {
+            trace.addBytesIn(view.length);
+        }
+        size_t messageCount = plaintexts.size();
+
+        std::vector<uint8_t *> encryptedBytes(messageCount, NULL);
+        std::vector<int> encryptedLens(messageCount, 0);
+        uint8_t **encryptedBytesPtr = encryptedBytes.data();
+        int *encryptedLensPtr = encryptedLens.data();
+        const MLSByteView *plaintextsPtr = plaintexts.data();
+        const char *groupIdStr = groupId.c_str();
+        const char *userIdStr = userId.c_str();
+        trace.enterPhase(MLSOperationPhase::FFI);
+        runOnGroupLane(rt, weakModule, groupIdStr, userIdStr, ^(void *client) {
+            MLSGroupHandleCache *handles = [weakModule groupHandles];
+            BOOL encrypted = NO;
+            for (size_t i = 0; i < messageCount; i++) {
+                encryptedBytesPtr[i] = MLSCreateApplicationMessage(handles, client, groupIdStr, userIdStr,
+                                                                   plaintextsPtr[i].bytes, (int)plaintextsPtr[i].length,
+                                                                   &encryptedLensPtr[i]);
+                encrypted = encrypted || encryptedBytesPtr[i] != NULL;
+            }
+            if (encrypted) {
+                [weakModule groupWasUsed:@(groupIdStr) userId:@(userIdStr) decrypted:NO];
+            }
+        });
+        trace.enterPhase(MLSOperationPhase::Marshal);
+
+        // One zero-copy ArrayBuffer per ciphertext; failed items are undefined
+        jsi::Array results(rt, messageCount);
+        for (size_t i = 0; i < messageCount; i++) {
+            results.setValueAtIndex(rt, i, arrayBufferFromRust(rt, encryptedBytes[i], encryptedLens[i]));
+        }
+        trace.succeed();
+        return std::move(results);
+    });
+
+    // encryptMessage(groupId, creatorId, message) -> ArrayBuffer
+    installFunction(runtime, bindings, "encryptMessage", 3,
+                    [weakModule](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        requireArguments(rt, "encryptMessage", count, 3);
+        MLSOperationTrace trace([weakModule metrics], "binary.encryptMessage");
+        std::string groupId = stringArgument(rt, args[0], "groupId");
+        std::string creatorId = stringArgument(rt, args[1], "creatorId");
+        std::string message = stringArgument(rt, args[2], "message");
+
+        __block uint8_t *encryptedBytes = NULL;
+        __block int encryptedLen = 0;
+        __block NSError *error = nil;
+        const char *groupIdStr = groupId.c_str();
+        const char *creatorIdStr = creatorId.c_str();
+        const char *messageStr = message.c_str();
+        trace.enterPhase(MLSOperationPhase::FFI);
+        runOnGroupLane(rt, weakModule, groupIdStr, creatorIdStr, ^(void *client) {
+            encryptedBytes = mls_encrypt_message(client, groupIdStr, creatorIdStr, messageStr, &encryptedLen);
+            if (encryptedBytes != NULL) {
+                [weakModule groupWasUsed:@(groupIdStr) userId:@(creatorIdStr) decrypted:NO];
+            } else {
+                error = MLSTakeLastFFIError();
+            }
+        });
+        trace.enterPhase(MLSOperationPhase::Marshal);
+
+        if (encryptedBytes == NULL) {
+            throwMLSError(rt, "Failed to encrypt message", error);
+        }
+        trace.addBytesOut((uint64_t)encryptedLen);
+        trace.succeed();
+        return arrayBufferFromRust(rt, encryptedBytes, encryptedLen);
+    });
+
+    // decryptMessage(groupId, creatorId, ciphertext) -> string
+    installFunction(runtime, bindings, "decryptMessage", 3,
+                    [weakModule](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        requireArguments(rt, "decryptMessage", count, 3);
+        MLSOperationTrace trace([weakModule metrics], "binary.decryptMessage");
+        std::string groupId = stringArgument(rt, args[0], "groupId");
+        std::string creatorId = stringArgument(rt, args[1], "creatorId");
+        MLSByteView ciphertext = bytesArgument(rt, args[2], "ciphertext");
+        trace.addBytesIn(ciphertext.length);
+
+        __block char *decryptedStr = NULL;
+        __block NSError *error = nil;
+        const char *groupIdStr = groupId.c_str();
+        const char *creatorIdStr = creatorId.c_str();
+        trace.enterPhase(MLSOperationPhase::FFI);
+        runOnGroupLane(rt, weakModule, groupIdStr, creatorIdStr, ^(void *client) {
+            decryptedStr = mls_decrypt_message(client, groupIdStr, creatorIdStr, ciphertext.bytes, (int)ciphertext.length);
+            if (decryptedStr != NULL) {
+                [weakModule groupWasUsed:@(groupIdStr) userId:@(creatorIdStr) decrypted:YES];
+            } else {
+                error = MLSTakeLastFFIError();
+            }
+        });
+        trace.enterPhase(MLSOperationPhase::Marshal);
+
+        if (decryptedStr == NULL) {
+            throwMLSError(rt, "Failed to decrypt message", error);
+        }
+        jsi::String decrypted = jsi::String::createFromUtf8(rt, decryptedStr);
+        mls_free_string(decryptedStr);
+        trace.succeed();
+        return std::move(decrypted);
+    });
+
+    // encryptBytes(groupId, creatorId, plaintext) -> ArrayBuffer
+    // Length-delimited counterpart of encryptMessage; the plaintext may hold any bytes
+    installFunction(runtime, bindings, "encryptBytes", 3,
+                    [weakModule](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        requireArguments(rt, "encryptBytes", count, 3);
+        MLSOperationTrace trace([weakModule metrics], "binary.encryptBytes");
+        std::string groupId = stringArgument(rt, args[0], "groupId");
+        std::string creatorId = stringArgument(rt, args[1], "creatorId");
+        MLSByteView plaintext = bytesArgument(rt, args[2], "plaintext");
+        trace.addBytesIn(plaintext.length);
+
+        __block uint8_t *encryptedBytes = NULL;
+        __block int encryptedLen = 0;
+        __block NSError *error = nil;
+        const char *groupIdStr = groupId.c_str();
+        const char *creatorIdStr = creatorId.c_str();
+        trace.enterPhase(MLSOperationPhase::FFI);
+        runOnGroupLane(rt, weakModule, groupIdStr, creatorIdStr, ^(void *client) {
+            encryptedBytes = MLSCreateApplicationMessage([weakModule groupHandles], client, groupIdStr, creatorIdStr,
+                                                         plaintext.bytes, (int)plaintext.length, &encryptedLen);
+            if (encryptedBytes != NULL) {
+                [weakModule groupWasUsed:@(groupIdStr) userId:@(creatorIdStr) decrypted:NO];
+            } else {
+                error = MLSTakeLastFFIError();
+            }
+        });
+        trace.enterPhase(MLSOperationPhase::Marshal);
+
+        if (encryptedBytes == NULL) {
+            throwMLSError(rt, "Failed to encrypt message", error);
+        }
+        trace.addBytesOut((uint64_t)encryptedLen);
+        trace.succeed();
+        return arrayBufferFromRust(rt, encryptedBytes, encryptedLen);
+    });
+
+    // decryptBytes(groupId, creatorId, ciphertext) -> ArrayBuffer
+    installFunction(runtime, bindings, "decryptBytes", 3,
+                    [weakModule](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        requireArguments(rt, "decryptBytes", count, 3);
+        MLSOperationTrace trace([weakModule metrics], "binary.decryptBytes");
+        std::string groupId = stringArgument(rt, args[0], "groupId");
+        std::string creatorId = stringArgument(rt, args[1], "creatorId");
+        MLSByteView ciphertext = bytesArgument(rt, args[2], "ciphertext");
+        trace.addBytesIn(ciphertext.length);
+
+        __block MLSProcessOutput output;
+        const char *groupIdStr = groupId.c_str();
+        const char *creatorIdStr = creatorId.c_str();
+        trace.enterPhase(MLSOperationPhase::FFI);
+        runOnGroupLane(rt, weakModule, groupIdStr, creatorIdStr, ^(void *client) {
+            output = processCiphertext(weakModule, client, groupIdStr, creatorIdStr, ciphertext);
+        });
+        trace.enterPhase(MLSOperationPhase::Marshal);
+
+        if (output.senderBytes != NULL) {
+            mls_free_bytes(output.senderBytes);
+        }
+        const char *error = NULL;
+        NSError *cause = output.error;
+        if (output.status != MLSFFIStatusOK) {
+            error = "Failed to decrypt message";
+        } else if (output.messageType != 0) {
+            error = "Not an application message";
+            cause = MLSBridgeError(MLSErrorCodeInvalidInput);
+        }
+        if (error != NULL) {
+            if (output.contentBytes != NULL) {
+                mls_free_bytes(output.contentBytes);
+            }
+            throwMLSError(rt, error, cause);
+        }
+
+        trace.addBytesOut((uint64_t)output.contentLen);
+        trace.succeed();
+        if (output.contentBytes == NULL) {
+            // Empty plaintext
+            return jsi::ArrayBuffer(rt, std::make_shared<MLSRustBuffer>(nullptr, 0));
+        }
+        return arrayBufferFromRust(rt, output.contentBytes, output.contentLen);
+    });
+
+    // exportSecretBytes(groupId, userId, label, context?, length) -> ArrayBuffer
+    // Raw exporter secret, cached per epoch by the module
+    installFunction(runtime, bindings, "exportSecretBytes", 5,
+                    [weakModule](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        requireArguments(rt, "exportSecretBytes", count, 5);
+        MLSOperationTrace trace([weakModule metrics], "binary.exportSecretBytes");
+        std::string groupId = stringArgument(rt, args[0], "groupId");
+        std::string userId = stringArgument(rt, args[1], "userId");
+        std::string label = stringArgument(rt, args[2], "label");
+        MLSByteView context = {NULL, 0};
+        if (!args[3].isUndefined() && !args[3].isNull()) {
+            context = bytesArgument(rt, args[3], "context");
+        }
+        if (!args[4].isNumber() || args[4].asNumber() <= 0 || args[4].asNumber() > UINT16_MAX) {
+            throw jsi::JSError(rt, "length must be a positive number");
+        }
+        uint32_t length = (uint32_t)args[4].asNumber();
+        trace.addBytesIn(context.length);
+
+        __block std::vector<uint8_t> secret;
+        __block BOOL exported = NO;
+        __block NSError *error = nil;
+        NSString *groupIdString = @(groupId.c_str());
+        NSString *userIdString = @(userId.c_str());
+        NSString *labelString = @(label.c_str());
+        NSData *contextData = [[NSData alloc] initWithBytesNoCopy:(void *)context.bytes length:context.length freeWhenDone:NO];
+        trace.enterPhase(MLSOperationPhase::FFI);
+        runOnGroupLane(rt, weakModule, groupId.c_str(), userId.c_str(), ^(void *client) {
+            exported = [weakModule exporterSecretForGroup:groupIdString userId:userIdString label:labelString
+                                                  context:contextData length:length secret:secret client:client];
+            if (!exported) {
+                error = MLSTakeLastFFIError();
+            }
+        });
+        trace.enterPhase(MLSOperationPhase::Marshal);
+
+        if (!exported) {
+            throwMLSError(rt, "Failed to export secret", error);
+        }
+        trace.addBytesOut(secret.size());
+        trace.succeed();
+        return jsi::ArrayBuffer(rt, std::make_shared<MLSSecretBuffer>(std::move(secret)));
+    });
+
+    // processMessage(groupId, userId, ciphertext) -> { type, content, sender, validated } | { type: "deferred", epoch, ticket }
+    //     | { type: "duplicate" }
+    // Messages are only deferred while a listener is subscribed to the module's
+    // events, which deliver the replayed result. Otherwise, or when the reorder
+    // buffer will not take it, a message from a later epoch throws with code
+    // "wrong_epoch" and can be sent again after the commit that gets there.
+    installFunction(runtime, bindings, "processMessage", 3,
+                    [weakModule](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        requireArguments(rt, "processMessage", count, 3);
+        MLSOperationTrace trace([weakModule metrics], "binary.processMessage");
+        std::string groupId = stringArgument(rt, args[0], "groupId");
+        std::string userId = stringArgument(rt, args[1], "userId");
+        MLSByteView ciphertext = bytesArgument(rt, args[2], "ciphertext");
+        trace.addBytesIn(ciphertext.length);
+
+        __block MLSProcessOutput output;
+        const char *groupIdStr = groupId.c_str();
+        const char *userIdStr = userId.c_str();
+        trace.enterPhase(MLSOperationPhase::FFI);
+        runOnGroupLane(rt, weakModule, groupIdStr, userIdStr, ^(void *client) {
+            output = processIncomingCiphertext(weakModule, client, groupIdStr, userIdStr, ciphertext);
+        });
+        trace.enterPhase(MLSOperationPhase::Marshal);
+
+        if (output.duplicate) {
+            trace.succeed();
+            return duplicateOutputToJS(rt);
+        }
+        if (output.status != MLSFFIStatusOK && output.deferredTicket != 0) {
+            trace.succeed();
+            return deferredOutputToJS(rt, output);
+        }
+        if (output.status != MLSFFIStatusOK) {
+            throwMLSError(rt, "Failed to process message", output.error);
+        }
+        trace.succeed();
+        return processOutputToJS(rt, output);
+    });
+
+    // processMessages(groupId, userId, ciphertexts[]) -> [{ type, ... } | { type: "deferred", ... } | { type: "duplicate" }
+    //     | { type: "error", error }]
+    installFunction(runtime, bindings, "processMessages", 3,
+                    [weakModule](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        requireArguments(rt, "processMessages", count, 3);
+        MLSOperationTrace trace([weakModule metrics], "binary.processMessages");
+        std::string groupId = stringArgument(rt, args[0], "groupId");
+        std::string userId = stringArgument(rt, args[1], "userId");
+        std::vector<jsi::Value> elements;
+        std::vector<MLSByteView> inputs = bytesArrayArgument(rt, args[2], "ciphertexts", elements);
+        for (const MLSByteView &view : inputs) {
+            trace.addBytesIn(view.length);
+        }
+        size_t messageCount = inputs.size();
+
+        std::vector<MLSProcessOutput> outputs(messageCount);
+        MLSProcessOutput *outputsPtr = outputs.data();
+        const MLSByteView *inputsPtr = inputs.data();
+        const char *groupIdStr = groupId.c_str();
+        const char *userIdStr = userId.c_str();
+        trace.enterPhase(MLSOperationPhase::FFI);
+        runOnGroupLane(rt, weakModule, groupIdStr, userIdStr, ^(void *client) {
+            for (size_t i = 0; i < messageCount; i++) {
+                outputsPtr[i] = processIncomingCiphertext(weakModule, client, groupIdStr, userIdStr, inputsPtr[i]);
+            }
+        });
+        trace.enterPhase(MLSOperationPhase::Marshal);
+
+        jsi::Array results(rt, messageCount);
+        for (size_t i = 0; i < messageCount; i++) {
+            if (outputs[i].status == MLSFFIStatusOK) {
+                results.setValueAtIndex(rt, i, processOutputToJS(rt, outputs[i]));
+            } else if (outputs[i].duplicate) {
+                results.setValueAtIndex(rt, i, duplicateOutputToJS(rt));
+            } else if (outputs[i].deferredTicket != 0) {
+                results.setValueAtIndex(rt, i, deferredOutputToJS(rt, outputs[i]));
+            } else {
+                jsi::Object failed(rt);
+                setErrorFields(rt, failed, outputs[i].error);
+                failed.setProperty(rt, "type", "error");
+                failed.setProperty(rt, "error", "Failed to process message");
+                results.setValueAtIndex(rt, i, std::move(failed));
+            }
+        }
+        trace.succeed();
+        return std::move(results);
+    });
+
+    // processMessageCompact(groupId, userId, ciphertext) -> ArrayBuffer holding one compact record, see
+    //     MLSCompactResult.h; throws like processMessage
+    installFunction(runtime, bindings, "processMessageCompact", 3,
+                    [weakModule](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        requireArguments(rt, "processMessageCompact", count, 3);
+        MLSOperationTrace trace([weakModule metrics], "binary.processMessageCompact");
+        std::string groupId = stringArgument(rt, args[0], "groupId");
+        std::string userId = stringArgument(rt, args[1], "userId");
+        MLSByteView ciphertext = bytesArgument(rt, args[2], "ciphertext");
+        trace.addBytesIn(ciphertext.length);
+
+        __block MLSProcessOutput output;
+        const char *groupIdStr = groupId.c_str();
+        const char *userIdStr = userId.c_str();
+        trace.enterPhase(MLSOperationPhase::FFI);
+        runOnGroupLane(rt, weakModule, groupIdStr, userIdStr, ^(void *client) {
+            output = processIncomingCiphertext(weakModule, client, groupIdStr, userIdStr, ciphertext);
+        });
+        trace.enterPhase(MLSOperationPhase::Marshal);
+
+        if (output.status != MLSFFIStatusOK && !output.duplicate && output.deferredTicket == 0) {
+            throwMLSError(rt, "Failed to process message", output.error);
+        }
+        NSMutableData *record = [NSMutableData dataWithCapacity:MLSCompactHeaderSize + (size_t)output.senderLen + (size_t)output.contentLen];
+        appendCompactOutput(record, output, ciphertext);
+        trace.addBytesOut(record.length);
+        trace.succeed();
+        return jsi::ArrayBuffer(rt, std::make_shared<MLSDataBuffer>(record));
+    });
+
+    // processMessagesCompact(groupId, userId, ciphertexts[]) -> ArrayBuffer holding one compact record per
+    //     ciphertext, in order; a failing message yields an error record
+    installFunction(runtime, bindings, "processMessagesCompact", 3,
+                    [weakModule](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        requireArguments(rt, "processMessagesCompact", count, 3);
+        MLSOperationTrace trace([weakModule metrics], "binary.processMessagesCompact");
+        std::string groupId = stringArgument(rt, args[0], "groupId");
+        std::string userId = stringArgument(rt, args[1], "userId");
+        std::vector<jsi::Value> elements;
+        std::vector<MLSByteView> inputs = bytesArrayArgument(rt, args[2], "ciphertexts", elements);
+        for (const MLSByteView &view : inputs) {
+            trace.addBytesIn(view.length);
+        }
+        size_t messageCount = inputs.size();
+
+        std::vector<MLSProcessOutput> outputs(messageCount);
+        MLSProcessOutput *outputsPtr = outputs.data();
+        const MLSByteView *inputsPtr = inputs.data();
+        const char *groupIdStr = groupId.c_str();
+        const char *userIdStr = userId.c_str();
+        trace.enterPhase(MLSOperationPhase::FFI);
+        runOnGroupLane(rt, weakModule, groupIdStr, userIdStr, ^(void *client) {
+            for (size_t i = 0; i < messageCount; i++) {
+                outputsPtr[i] = processIncomingCiphertext(weakModule, client, groupIdStr, userIdStr, inputsPtr[i]);
+            }
+        });
+        trace.enterPhase(MLSOperationPhase::Marshal);
+
+        NSMutableData *records = [NSMutableData data];
+        for (size_t i = 0; i < messageCount; i++) {
+            appendCompactOutput(records, outputs[i], inputs[i]);
+        }
+        trace.addBytesOut(records.length);
+        trace.succeed();
+        return jsi::ArrayBuffer(rt, std::make_shared<MLSDataBuffer>(records));
+    });
+
+    // addMember(groupId, creatorId, receiverId, keyPackage) -> { commit, welcome? }
+    installFunction(runtime, bindings, "addMember", 4,
+                    [weakModule](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        requireArguments(rt, "addMember", count, 4);
+        MLSOperationTrace trace([weakModule metrics], "binary.addMember");
+        std::string groupId = stringArgument(rt, args[0], "groupId");
+        std::string creatorId = stringArgument(rt, args[1], "creatorId");
+        std::string receiverId = stringArgument(rt, args[2], "receiverId");
+        std::string keyPackage = stringArgument(rt, args[3], "keyPackage");
+
+        __block MLSCommitOutput output;
+        const char *groupIdStr = groupId.c_str();
+        const char *creatorIdStr = creatorId.c_str();
+        const char *receiverIdStr = receiverId.c_str();
+        const char *keyPackageStr = keyPackage.c_str();
+        trace.enterPhase(MLSOperationPhase::FFI);
+        runOnGroupLane(rt, weakModule, groupIdStr, creatorIdStr, ^(void *client) {
+            output.commitBytes = mls_add_member(client, groupIdStr, creatorIdStr, receiverIdStr, keyPackageStr,
+                                                &output.commitLen, &output.welcomeBytes, &output.welcomeLen);
+            if (output.commitBytes == NULL) {
+                output.error = MLSTakeLastFFIError();
+            }
+            handOffCommit(weakModule, client, groupIdStr, creatorIdStr, output);
+        });
+        trace.enterPhase(MLSOperationPhase::Marshal);
+
+        if (output.commitBytes == NULL && output.commit == nil) {
+            throwMLSError(rt, "Failed to add member to MLS group", output.error);
+        }
+        trace.addBytesOut((uint64_t)output.commitLen + (uint64_t)output.welcomeLen);
+        trace.succeed();
+        return commitResult(rt, output);
+    });
+
+    // selfUpdate(groupId, memberId) -> { commit, welcome? }
+    installFunction(runtime, bindings, "selfUpdate", 2,
+                    [weakModule](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        requireArguments(rt, "selfUpdate", count, 2);
+        MLSOperationTrace trace([weakModule metrics], "binary.selfUpdate");
+        std::string groupId = stringArgument(rt, args[0], "groupId");
+        std::string memberId = stringArgument(rt, args[1], "memberId");
+
+        __block MLSCommitOutput output;
+        const char *groupIdStr = groupId.c_str();
+        const char *memberIdStr = memberId.c_str();
+        trace.enterPhase(MLSOperationPhase::FFI);
+        runOnGroupLane(rt, weakModule, groupIdStr, memberIdStr, ^(void *client) {
+            output.commitBytes = mls_self_update(client, groupIdStr, memberIdStr, &output.commitLen, &output.welcomeBytes, &output.welcomeLen);
+            if (output.commitBytes == NULL) {
+                output.error = MLSTakeLastFFIError();
+            } else {
+                [[weakModule keyRotations] groupDidRotate:@(groupIdStr) userId:@(memberIdStr) merged:NO];
+            }
+            handOffCommit(weakModule, client, groupIdStr, memberIdStr, output);
+        });
+        trace.enterPhase(MLSOperationPhase::Marshal);
+
+        if (output.commitBytes == NULL && output.commit == nil) {
+            throwMLSError(rt, "Failed to update key for member", output.error);
+        }
+        trace.addBytesOut((uint64_t)output.commitLen + (uint64_t)output.welcomeLen);
+        trace.succeed();
+        return commitResult(rt, output);
+    });
+
+    // commitPendingProposals(groupId, creatorId) -> { commit, welcome? }
+    installFunction(runtime, bindings, "commitPendingProposals", 2,
+                    [weakModule](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        requireArguments(rt, "commitPendingProposals", count, 2);
+        MLSOperationTrace trace([weakModule metrics], "binary.commitPendingProposals");
+        std::string groupId = stringArgument(rt, args[0], "groupId");
+        std::string creatorId = stringArgument(rt, args[1], "creatorId");
+
+        __block MLSCommitOutput output;
+        const char *groupIdStr = groupId.c_str();
+        const char *creatorIdStr = creatorId.c_str();
+        trace.enterPhase(MLSOperationPhase::FFI);
+        runOnGroupLane(rt, weakModule, groupIdStr, creatorIdStr, ^(void *client) {
+            // Carries the group's rotation when one is close, as the bridge method does
+            NSString *groupKey = @(groupIdStr);
+            NSString *creatorKey = @(creatorIdStr);
+            BOOL rotate = [[weakModule keyRotations] shouldMergeRotationForGroup:groupKey userId:creatorKey];
+            output.commitBytes = rotate
+                ? mls_self_update(client, groupIdStr, creatorIdStr, &output.commitLen, &output.welcomeBytes, &output.welcomeLen)
+                : mls_commit_pending_proposals(client, groupIdStr, creatorIdStr,
+                                               &output.commitLen, &output.welcomeBytes, &output.welcomeLen);
+            if (output.commitBytes == NULL) {
+                output.error = MLSTakeLastFFIError();
+            } else if (rotate) {
+                [[weakModule keyRotations] groupDidRotate:groupKey userId:creatorKey merged:YES];
+            }
+            handOffCommit(weakModule, client, groupIdStr, creatorIdStr, output);
+        });
+        trace.enterPhase(MLSOperationPhase::Marshal);
+
+        if (output.commitBytes == NULL && output.commit == nil) {
+            throwMLSError(rt, "Failed to commit pending proposals", output.error);
+        }
+        trace.addBytesOut((uint64_t)output.commitLen + (uint64_t)output.welcomeLen);
+        trace.succeed();
+        return commitResult(rt, output);
+    });
+
+    // exportRatchetTree(groupId, userId) -> ArrayBuffer
+    installFunction(runtime, bindings, "exportRatchetTree", 2,
+                    [weakModule](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        requireArguments(rt, "exportRatchetTree", count, 2);
+        MLSOperationTrace trace([weakModule metrics], "binary.exportRatchetTree");
+        std::string groupId = stringArgument(rt, args[0], "groupId");
+        std::string userId = stringArgument(rt, args[1], "userId");
+
+        __block uint8_t *treeBytes = NULL;
+        __block int treeLen = 0;
+        __block NSError *error = nil;
+        const char *groupIdStr = groupId.c_str();
+        const char *userIdStr = userId.c_str();
+        trace.enterPhase(MLSOperationPhase::FFI);
+        runOnGroupLane(rt, weakModule, groupIdStr, userIdStr, ^(void *client) {
+            treeBytes = mls_export_ratchet_tree(client, groupIdStr, userIdStr, &treeLen);
+            if (treeBytes == NULL) {
+                error = MLSTakeLastFFIError();
+            }
+        });
+        trace.enterPhase(MLSOperationPhase::Marshal);
+
+        if (treeBytes == NULL) {
+            throwMLSError(rt, "Failed to export ratchet tree", error);
+        }
+        trace.addBytesOut((uint64_t)treeLen);
+        trace.succeed();
+        return arrayBufferFromRust(rt, treeBytes, treeLen);
+    });
+
+    // exportRatchetTreeChunks(groupId, userId, chunkSize, onChunk(chunk, offset, total)) -> total
+    // Delivers the tree as ArrayBuffer slices of one Rust buffer so callers
+    // can fragment it for transport without building a single JS copy.
+    installFunction(runtime, bindings, "exportRatchetTreeChunks", 4,
+                    [weakModule](jsi::Runtime &rt, const jsi::Value &, const jsi::Value *args, size_t count) -> jsi::Value {
+        requireArguments(rt, "exportRatchetTreeChunks", count, 4);
+        MLSOperationTrace trace([weakModule metrics], "binary.exportRatchetTreeChunks");
+        std::string groupId = stringArgument(rt, args[0], "groupId");
+        std::string userId = stringArgument(rt, args[1], "userId");
+        if (!args[2].isNumber() || args[2].asNumber() < 1) {
+            throw jsi::JSError(rt, "chunkSize must be a positive number");
+        }
+        size_t chunkSize = (size_t)args[2].asNumber();
+        if (!args[3].isObject() || !args[3].getObject(rt).isFunction(rt)) {
+            throw jsi::JSError(rt, "onChunk must be a function");
+        }
+        jsi::Function onChunk = args[3].getObject(rt).getFunction(rt);
+
+        __block uint8_t *treeBytes = NULL;
+        __block int treeLen = 0;
+        __block NSError *error = nil;
+        const char *groupIdStr = groupId.c_str();
+        const char *userIdStr = userId.c_str();
+        trace.enterPhase(MLSOperationPhase::FFI);
+        runOnGroupLane(rt, weakModule, groupIdStr, userIdStr, ^(void *client) {
+            treeBytes = mls_export_ratchet_tree(client, groupIdStr, userIdStr, &treeLen);
+            if (treeBytes == NULL) {
+                error = MLSTakeLastFFIError();
+            }
+        });
+        trace.enterPhase(MLSOperationPhase::Marshal);
+
+        if (treeBytes == NULL) {
+            throwMLSError(rt, "Failed to export ratchet tree", error);
+        }
+
+        auto tree = std::make_shared<MLSRustBuffer>(treeBytes, (size_t)treeLen);
+        size_t total = tree->size();
+        for (size_t offset = 0; offset < total; offset += chunkSize) {
+            size_t length = std::min(chunkSize, total - offset);
+            jsi::ArrayBuffer chunk(rt, std::make_shared<MLSRustBufferSlice>(tree, offset, length));
+            onChunk.call(rt, std::move(chunk), jsi::Value((double)offset), jsi::Value((double)total));
+        }
+        trace.succeed();
+        return jsi::Value((double)total);
+    });
+
+    runtime.global().setProperty(runtime, "__mlsBinary", std::move(bindings));
+}
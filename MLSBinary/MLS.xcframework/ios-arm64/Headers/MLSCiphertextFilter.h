@@ -0,0 +1,249 @@
+#pragma once
+
+#ifdef __cplusplus
+
+#import <Foundation/Foundation.h>
+
+#include <CommonCrypto/CommonDigest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+// First 128 bits of SHA-256 over the group, the local member and the
+// ciphertext, so two local members of one group each process their copy
+struct MLSCiphertextDigest {
+    uint64_t high;
+    uint64_t low;
+};
+
+inline MLSCiphertextDigest MLSDigestCiphertext(const char *groupId, const char *userId, const uint8_t *bytes, size_t length)
+{
+    CC_SHA256_CTX context;
+    CC_SHA256_Init(&context);
+    // The NUL terminators separate the fields
+    CC_SHA256_Update(&context, groupId, (CC_LONG)strlen(groupId) + 1);
+    CC_SHA256_Update(&context, userId, (CC_LONG)strlen(userId) + 1);
+    CC_SHA256_Update(&context, bytes, (CC_LONG)length);
+    uint8_t hash[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256_Final(hash, &context);
+
+    MLSCiphertextDigest digest;
+    memcpy(&digest.high, hash, sizeof(digest.high));
+    memcpy(&digest.low, hash + sizeof(digest.high), sizeof(digest.low));
+    return digest;
+}
+
+/**
+ * Remembers the ciphertexts already processed, so the copies a flooding mesh
+ * delivers through other relays are answered before any crypto or storage
+ * work.
+ *
+ * The ciphertexts of the last one to two `capacity`s of messages are kept
+ * in two generations; when the current one fills up it replaces the
+ * previous one. Each generation has a Bloom filter sized for about 1% false
+ * positives, like Utils/OptimizedBloomFilter.swift, which turns away most
+ * new messages without touching the rest. Its hits are confirmed against
+ * 64-bit fingerprints, so a false positive costs one table probe instead of
+ * a dropped message.
+ *
+ * A ciphertext that will not be processed after all, such as a parked one
+ * the reorder buffer dropped, is removed so its resend goes through. Its
+ * Bloom bits stay set, so checking it again costs a table probe like
+ * a false positive.
+ *
+ * Thread-safe: group lanes on the scheduler check and record concurrently.
+ */
+class MLSCiphertextFilter {
+public:
+    struct Statistics {
+        size_t capacity;
+        size_t remembered;
+        uint64_t checked;
+        uint64_t duplicates;
+        uint64_t falsePositives;
+        size_t memoryBytes;
+    };
+
+    explicit MLSCiphertextFilter(size_t capacity) { resize(capacity); }
+
+    MLSCiphertextFilter(const MLSCiphertextFilter &) = delete;
+    MLSCiphertextFilter &operator=(const MLSCiphertextFilter &) = delete;
+
+    // Whether the ciphertext was recorded before; counts it as a duplicate if so
+    bool contains(const MLSCiphertextDigest &digest)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        checked_++;
+        for (const Generation *generation : {&current_, &previous_}) {
+            if (!mayContain(*generation, digest)) {
+                continue;
+            }
+            if (findSlot(*generation, fingerprint(digest)) != nullptr) {
+                duplicates_++;
+                return true;
+            }
+            falsePositives_++;
+        }
+        return false;
+    }
+
+    // Record a ciphertext once it has been processed
+    void insert(const MLSCiphertextDigest &digest)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t print = fingerprint(digest);
+        if (findSlot(current_, print) != nullptr) {
+            return;
+        }
+        if (current_.count == capacity_) {
+            std::swap(previous_, current_);
+            reset(current_);
+        }
+
+        for (size_t i = 0; i < hashCount_; i++) {
+            size_t bit = bitIndex(digest, i);
+            current_.bits[bit / 64] |= (uint64_t)1 << (bit % 64);
+        }
+        size_t mask = current_.slots.size() - 1;
+        size_t slot = startSlot(print) & mask;
+        while (current_.slots[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        current_.slots[slot] = print;
+        current_.count++;
+    }
+
+    // Forget a recorded ciphertext; nothing happens if it was not recorded
+    void remove(const MLSCiphertextDigest &digest)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t print = fingerprint(digest);
+        for (Generation *generation : {&current_, &previous_}) {
+            erase(*generation, print);
+        }
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reset(current_);
+        reset(previous_);
+    }
+
+    Statistics statistics() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t memoryBytes = 2 * (current_.bits.size() * sizeof(uint64_t) + current_.slots.size() * sizeof(uint64_t));
+        return {capacity_, current_.count + previous_.count, checked_, duplicates_, falsePositives_, memoryBytes};
+    }
+
+private:
+    struct Generation {
+        std::vector<uint64_t> bits;
+        // Open addressing; 0 marks a free slot
+        std::vector<uint64_t> slots;
+        size_t count = 0;
+    };
+
+    void resize(size_t capacity)
+    {
+        capacity_ = capacity > 0 ? capacity : 1;
+        // About 9.6 bits and 7 probes per item give a 1% false positive rate
+        bitCount_ = capacity_ * 10 < 64 ? 64 : capacity_ * 10;
+        hashCount_ = 7;
+        slotCount_ = 1;
+        // At most half full, so probe runs stay short
+        while (slotCount_ < capacity_ * 2) {
+            slotCount_ <<= 1;
+        }
+        reset(current_);
+        reset(previous_);
+    }
+
+    // Caller holds mutex_
+    void reset(Generation &generation) const
+    {
+        generation.bits.assign((bitCount_ + 63) / 64, 0);
+        generation.slots.assign(slotCount_, 0);
+        generation.count = 0;
+    }
+
+    // Double hashing over the two halves of the digest
+    size_t bitIndex(const MLSCiphertextDigest &digest, size_t i) const
+    {
+        return (size_t)((digest.high + i * (digest.low | 1)) % bitCount_);
+    }
+
+    // Caller holds mutex_
+    bool mayContain(const Generation &generation, const MLSCiphertextDigest &digest) const
+    {
+        for (size_t i = 0; i < hashCount_; i++) {
+            size_t bit = bitIndex(digest, i);
+            if ((generation.bits[bit / 64] & ((uint64_t)1 << (bit % 64))) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static uint64_t fingerprint(const MLSCiphertextDigest &digest)
+    {
+        uint64_t print = digest.low ^ (digest.high >> 32);
+        return print != 0 ? print : 1;
+    }
+
+    // Caller holds mutex_
+    const uint64_t *findSlot(const Generation &generation, uint64_t print) const
+    {
+        size_t mask = generation.slots.size() - 1;
+        for (size_t slot = startSlot(print) & mask;; slot = (slot + 1) & mask) {
+            if (generation.slots[slot] == 0) {
+                return nullptr;
+            }
+            if (generation.slots[slot] == print) {
+                return &generation.slots[slot];
+            }
+        }
+    }
+
+    // Caller holds mutex_. Later entries of the probe run move back into
+    // the freed slot, so lookups never stop short of them.
+    void erase(Generation &generation, uint64_t print) const
+    {
+        const uint64_t *found = findSlot(generation, print);
+        if (found == nullptr) {
+            return;
+        }
+        size_t mask = generation.slots.size() - 1;
+        size_t hole = (size_t)(found - generation.slots.data());
+        for (size_t slot = (hole + 1) & mask; generation.slots[slot] != 0; slot = (slot + 1) & mask) {
+            // An entry may fill the hole if the hole is on its probe run
+            size_t home = startSlot(generation.slots[slot]) & mask;
+            if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+                generation.slots[hole] = generation.slots[slot];
+                hole = slot;
+            }
+        }
+        generation.slots[hole] = 0;
+        generation.count--;
+    }
+
+    // Fibonacci hashing spreads the fingerprint over the table
+    static size_t startSlot(uint64_t print) { return (size_t)((print * 0x9E3779B97F4A7C15ull) >> 16); }
+
+    mutable std::mutex mutex_;
+    size_t capacity_ = 0;
+    size_t bitCount_ = 0;
+    size_t hashCount_ = 0;
+    size_t slotCount_ = 0;
+    Generation current_;
+    Generation previous_;
+    uint64_t checked_ = 0;
+    uint64_t duplicates_ = 0;
+    uint64_t falsePositives_ = 0;
+};
+
+#endif
@@ -0,0 +1,63 @@
+#import <Foundation/Foundation.h>
+
+@class MLSGroupScheduler;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * An MLS client handle and the scheduler whose lanes use it.
+ *
+ * Operations pick their client when they are scheduled and run on its
+ * scheduler, so opening or closing a client never changes the handle under
+ * an operation that is already queued. The handle is only set and cleared
+ * by barriers on `scheduler`.
+ */
+@interface MLSIdentityClient : NSObject
+
+// nil for the shared client
+@property (nonatomic, readonly, copy, nullable) NSString *identity;
+
+@property (nonatomic, readonly) MLSGroupScheduler *scheduler;
+
+@property (atomic, assign, nullable) void *client;
+
+- (instancetype)initWithIdentity:(nullable NSString *)identity scheduler:(MLSGroupScheduler *)scheduler;
+
+@end
+
+/**
+ * Table of dedicated clients by identity.
+ *
+ * Each dedicated client has its own scheduler, so a backlog on one identity
+ * does not hold up the lanes or barriers of another. Identities without one
+ * use the shared client created by initialize. The Rust storage provider
+ * keeps a database per identity, so a dedicated client works on the same
+ * "<identity>.sqlite" file the shared client used for that identity.
+ *
+ * Thread-safe.
+ */
+@interface MLSClientTable : NSObject
+
+@property (nonatomic, readonly) MLSIdentityClient *sharedClient;
+
+- (instancetype)initWithSharedClient:(MLSIdentityClient *)sharedClient;
+
+// The identity's dedicated client, or the shared one
+- (MLSIdentityClient *)clientForIdentity:(nullable NSString *)identity;
+
+// Register a dedicated client with no handle yet; nil if one is registered
+- (nullable MLSIdentityClient *)addClientForIdentity:(NSString *)identity;
+
+- (nullable MLSIdentityClient *)removeClientForIdentity:(NSString *)identity;
+
+// Remove `client` if it is still the one registered for its identity
+- (void)removeClient:(MLSIdentityClient *)client;
+
+- (NSArray<MLSIdentityClient *> *)removeAllClients;
+
+// Identities with a dedicated client, sorted
+- (NSArray<NSString *> *)identities;
+
+@end
+
+NS_ASSUME_NONNULL_END
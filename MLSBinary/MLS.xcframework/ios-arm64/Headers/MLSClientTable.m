@@ -0,0 +1,95 @@
+#import "MLSClientTable.h"
+#import "MLSGroupScheduler.h"
+#import <os/lock.h>
+
+@implementation MLSIdentityClient
+
+- (instancetype)initWithIdentity:(NSString *)identity scheduler:(MLSGroupScheduler *)scheduler
+{
+    if (self = [super init]) {
+        _identity = [identity copy];
+        _scheduler = scheduler;
+    }
+    return self;
+}
+
+@end
+
+@implementation MLSClientTable
+{
+    NSMutableDictionary<NSString *, MLSIdentityClient *> *_clients;
+    os_unfair_lock _lock;
+}
+
+- (instancetype)initWithSharedClient:(MLSIdentityClient *)sharedClient
+{
+    if (self = [super init]) {
+        _sharedClient = sharedClient;
+        _clients = [NSMutableDictionary dictionary];
+        _lock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+- (MLSIdentityClient *)clientForIdentity:(NSString *)identity
+{
+    if (identity == nil) {
+        return _sharedClient;
+    }
+
+    os_unfair_lock_lock(&_lock);
+    MLSIdentityClient *client = _clients[identity];
+    os_unfair_lock_unlock(&_lock);
+    return client ?: _sharedClient;
+}
+
+- (MLSIdentityClient *)addClientForIdentity:(NSString *)identity
+{
+    os_unfair_lock_lock(&_lock);
+    MLSIdentityClient *client = nil;
+    if (_clients[identity] == nil) {
+        NSString *label = [@"com.reactnativemls.MLSQueue.identity." stringByAppendingString:identity];
+        client = [[MLSIdentityClient alloc] initWithIdentity:identity
+                                                   scheduler:[[MLSGroupScheduler alloc] initWithLabel:label]];
+        _clients[identity] = client;
+    }
+    os_unfair_lock_unlock(&_lock);
+    return client;
+}
+
+- (MLSIdentityClient *)removeClientForIdentity:(NSString *)identity
+{
+    os_unfair_lock_lock(&_lock);
+    MLSIdentityClient *client = _clients[identity];
+    [_clients removeObjectForKey:identity];
+    os_unfair_lock_unlock(&_lock);
+    return client;
+}
+
+- (void)removeClient:(MLSIdentityClient *)client
+{
+    os_unfair_lock_lock(&_lock);
+    if (client.identity != nil && _clients[client.identity] == client) {
+        [_clients removeObjectForKey:client.identity];
+    }
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (NSArray<MLSIdentityClient *> *)removeAllClients
+{
+    os_unfair_lock_lock(&_lock);
+    NSArray<MLSIdentityClient *> *clients = _clients.allValues;
+    [_clients removeAllObjects];
+    os_unfair_lock_unlock(&_lock);
+    return clients;
+}
+
+- (NSArray<NSString *> *)identities
+{
+    os_unfair_lock_lock(&_lock);
+    NSArray<NSString *> *identities = _clients.allKeys;
+    os_unfair_lock_unlock(&_lock);
+    return [identities sortedArrayUsingSelector:@selector(compare:)];
+}
+
+@end
@@ -0,0 +1,88 @@
+#pragma once
+
+#ifdef __cplusplus
+
+#import <Foundation/Foundation.h>
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Compact encoding of processMessage results: one buffer per result, or the
+ * results of a batch back to back, instead of a dictionary of strings.
+ *
+ * Each record is a 20-byte header followed by the sender and the content;
+ * integers are little-endian:
+ *
+ *   0   u8   kind, see MLSCompactKind
+ *   1   u8   flags, see MLSCompactFlag
+ *   2   u8   format version, MLSCompactVersion
+ *   3   u8   reserved, 0
+ *   4   u64  epoch: the epoch the message was sent in, or for a deferred
+ *            message the one it waits for; 0 where unknown
+ *   12  u32  sender length
+ *   16  u32  content length
+ *   20       sender bytes, then content bytes
+ *
+ * Sender and content are the FFI's bytes as they are; decoding them as
+ * UTF-8 or keeping them binary is up to the reader. A deferred record's
+ * content is its 8-byte ticket and an error record's is the error code name
+ * of MLSErrors.h, e.g. "wrong_epoch".
+ */
+enum class MLSCompactKind : uint8_t {
+    Application = 0,
+    Proposal = 1,
+    Commit = 2,
+    Welcome = 3,
+    Deferred = 16,
+    Duplicate = 17,
+    Error = 18,
+};
+
+enum MLSCompactFlag : uint8_t {
+    MLSCompactFlagValidated = 1 << 0,
+    // Error records: retrying can help
+    MLSCompactFlagRetryable = 1 << 1,
+};
+
+constexpr uint8_t MLSCompactVersion = 1;
+constexpr size_t MLSCompactHeaderSize = 20;
+
+inline void MLSAppendCompactResult(NSMutableData *buffer, MLSCompactKind kind, uint8_t flags, uint64_t epoch,
+                                   const void *sender, size_t senderLength, const void *content, size_t contentLength)
+{
+    uint8_t header[MLSCompactHeaderSize] = {(uint8_t)kind, flags, MLSCompactVersion, 0};
+    for (size_t i = 0; i < 8; i++) {
+        header[4 + i] = (uint8_t)(epoch >> (8 * i));
+    }
+    for (size_t i = 0; i < 4; i++) {
+        header[12 + i] = (uint8_t)((uint32_t)senderLength >> (8 * i));
+        header[16 + i] = (uint8_t)((uint32_t)contentLength >> (8 * i));
+    }
+    [buffer appendBytes:header length:sizeof(header)];
+    if (senderLength > 0) {
+        [buffer appendBytes:sender length:senderLength];
+    }
+    if (contentLength > 0) {
+        [buffer appendBytes:content length:contentLength];
+    }
+}
+
+inline void MLSAppendCompactDeferred(NSMutableData *buffer, uint64_t epoch, uint64_t ticket)
+{
+    uint8_t content[8];
+    for (size_t i = 0; i < 8; i++) {
+        content[i] = (uint8_t)(ticket >> (8 * i));
+    }
+    MLSAppendCompactResult(buffer, MLSCompactKind::Deferred, 0, epoch, nullptr, 0, content, sizeof(content));
+}
+
+// `code` and `retryable` are those of the error's MLSErrorFields
+inline void MLSAppendCompactError(NSMutableData *buffer, NSString *code, BOOL retryable)
+{
+    const char *name = (code ?: @"unknown").UTF8String;
+    MLSAppendCompactResult(buffer, MLSCompactKind::Error, retryable ? MLSCompactFlagRetryable : 0, 0,
+                           nullptr, 0, name, strlen(name));
+}
+
+#endif
@@ -0,0 +1,362 @@
+#pragma once
+
+#ifdef __cplusplus
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Content types of RFC 9420, plus 0 when the header does not say
+enum class MLSContentType : uint8_t {
+    Unknown = 0,
+    Application = 1,
+    Proposal = 2,
+    Commit = 3,
+};
+
+// What the unencrypted header of an MLS message says about it
+struct MLSMessageHeader {
+    uint64_t epoch = 0;
+    MLSContentType contentType = MLSContentType::Unknown;
+};
+
+namespace mls_reorder {
+
+class Reader {
+public:
+    Reader(const uint8_t *bytes, size_t length) : bytes_(bytes), length_(length) {}
+
+    bool readUInt(size_t width, uint64_t &value)
+    {
+        if (length_ - offset_ < width) {
+            return false;
+        }
+        value = 0;
+        for (size_t i = 0; i < width; i++) {
+            value = (value << 8) | bytes_[offset_++];
+        }
+        return true;
+    }
+
+    // opaque<V>: a QUIC-style variable-length size, then that many bytes
+    bool skipVector()
+    {
+        if (offset_ >= length_) {
+            return false;
+        }
+        size_t width = (size_t)1 << (bytes_[offset_] >> 6);
+        uint64_t size = 0;
+        if (width > 4 || !readUInt(width, size)) {
+            return false;
+        }
+        size &= (width == 1 ? 0x3f : width == 2 ? 0x3fff : 0x3fffffff);
+        if (length_ - offset_ < size) {
+            return false;
+        }
+        offset_ += (size_t)size;
+        return true;
+    }
+
+private:
+    const uint8_t *bytes_;
+    size_t length_;
+    size_t offset_ = 0;
+};
+
+} // namespace mls_reorder
+
+/**
+ * Read the epoch, and the content type where it is in the clear, of an
+ * MLSMessage holding a PublicMessage or PrivateMessage (RFC 9420, section 6).
+ * Returns false for other wire formats and for anything that does not parse.
+ */
+inline bool MLSReadMessageHeader(const uint8_t *bytes, size_t length, MLSMessageHeader &header)
+{
+    mls_reorder::Reader reader(bytes, length);
+    uint64_t version = 0;
+    uint64_t wireFormat = 0;
+    if (!reader.readUInt(2, version) || version != 1 || !reader.readUInt(2, wireFormat)) {
+        return false;
+    }
+    if (wireFormat != 1 && wireFormat != 2) {
+        return false;
+    }
+
+    // Both start with group_id<V> and the epoch
+    if (!reader.skipVector() || !reader.readUInt(8, header.epoch)) {
+        return false;
+    }
+
+    uint64_t contentType = 0;
+    if (wireFormat == 2) {
+        // PrivateMessage: content_type follows the epoch
+        if (!reader.readUInt(1, contentType)) {
+            return true;
+        }
+    } else {
+        // PublicMessage: the sender and authenticated_data come first
+        uint64_t senderType = 0;
+        uint64_t senderIndex = 0;
+        if (!reader.readUInt(1, senderType)) {
+            return true;
+        }
+        if ((senderType == 1 || senderType == 2) && !reader.readUInt(4, senderIndex)) {
+            return true;
+        }
+        if (senderType < 1 || senderType > 4 || !reader.skipVector() || !reader.readUInt(1, contentType)) {
+            return true;
+        }
+    }
+    if (contentType >= 1 && contentType <= 3) {
+        header.contentType = (MLSContentType)contentType;
+    }
+    return true;
+}
+
+// One ciphertext parked until its group reaches `epoch`
+struct MLSDeferredMessage {
+    uint64_t ticket = 0;
+    std::string groupId;
+    std::string userId;
+    MLSMessageHeader header;
+    std::vector<uint8_t> bytes;
+    std::chrono::steady_clock::time_point parkedAt;
+    // Set on messages dropped because they outlived the time limit
+    bool expired = false;
+};
+
+/**
+ * Bounded buffer for ciphertexts that arrive before the commit that moves
+ * their group to the epoch they were sent in, as happens when the mesh
+ * reorders packets.
+ *
+ * Messages are kept per group and local member. Once the group's epoch
+ * advances, takeReady hands back every message the group can now read,
+ * epoch by epoch, with a commit after the other messages of its epoch so
+ * they are read before it moves the group on. Messages beyond the per-group
+ * or byte limits push out the oldest ones, and a message is dropped once it
+ * has waited longer than the time limit; dropped messages are handed back
+ * so the caller can report them.
+ *
+ * Thread-safe: group lanes on the scheduler park and take concurrently.
+ */
+class MLSEpochReorderBuffer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Limits {
+        // Zero turns buffering off
+        size_t messagesPerGroup;
+        size_t bytes;
+        // How far past the group's epoch a message may be and still wait
+        uint64_t epochsAhead;
+        Clock::duration timeToLive;
+    };
+
+    struct Statistics {
+        size_t messages;
+        size_t bytes;
+        uint64_t parked;
+        uint64_t replayed;
+        uint64_t expired;
+        uint64_t evicted;
+    };
+
+    explicit MLSEpochReorderBuffer(const Limits &limits) : limits_(limits) {}
+
+    MLSEpochReorderBuffer(const MLSEpochReorderBuffer &) = delete;
+    MLSEpochReorderBuffer &operator=(const MLSEpochReorderBuffer &) = delete;
+
+    /**
+     * Park a message its group cannot read yet. Returns the message's
+     * ticket, or 0 if it is not for a later epoch within the limits.
+     * Messages dropped to make room, or for being too old, are appended to
+     * `dropped`.
+     */
+    uint64_t park(const std::string &groupId, const std::string &userId, const MLSMessageHeader &header,
+                  uint64_t currentEpoch, const uint8_t *bytes, size_t length,
+                  std::vector<MLSDeferredMessage> &dropped)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Clock::time_point now = Clock::now();
+        expire(now, dropped);
+
+        if (limits_.messagesPerGroup == 0 || header.epoch <= currentEpoch ||
+            header.epoch - currentEpoch > limits_.epochsAhead || length > limits_.bytes) {
+            return 0;
+        }
+
+        std::string key = scopeKey(groupId, userId);
+        while (groupCount(key) >= limits_.messagesPerGroup) {
+            auto oldest = std::find_if(messages_.begin(), messages_.end(),
+                                       [&](const MLSDeferredMessage &message) { return inScope(message, groupId, userId); });
+            drop(oldest, false, dropped);
+        }
+        while (bytes_ + length > limits_.bytes) {
+            drop(messages_.begin(), false, dropped);
+        }
+
+        MLSDeferredMessage message;
+        message.ticket = ++lastTicket_;
+        message.groupId = groupId;
+        message.userId = userId;
+        message.header = header;
+        message.bytes.assign(bytes, bytes + length);
+        message.parkedAt = now;
+        messages_.push_back(std::move(message));
+        groupCounts_[key]++;
+        bytes_ += length;
+        parked_++;
+        return lastTicket_;
+    }
+
+    /**
+     * Take the group's messages for `currentEpoch` and earlier, in the order
+     * to process them. Messages that have waited too long are appended to
+     * `dropped` instead.
+     */
+    std::vector<MLSDeferredMessage> takeReady(const std::string &groupId, const std::string &userId,
+                                              uint64_t currentEpoch, std::vector<MLSDeferredMessage> &dropped)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        expire(Clock::now(), dropped);
+
+        std::vector<MLSDeferredMessage> ready;
+        for (auto message = messages_.begin(); message != messages_.end();) {
+            auto next = std::next(message);
+            if (inScope(*message, groupId, userId) && message->header.epoch <= currentEpoch) {
+                ready.push_back(take(message));
+            }
+            message = next;
+        }
+
+        // Arrival order breaks ties, so the sort must be stable
+        std::stable_sort(ready.begin(), ready.end(), [](const MLSDeferredMessage &a, const MLSDeferredMessage &b) {
+            bool aCommits = a.header.contentType == MLSContentType::Commit;
+            bool bCommits = b.header.contentType == MLSContentType::Commit;
+            return a.header.epoch != b.header.epoch ? a.header.epoch < b.header.epoch : (!aCommits && bCommits);
+        });
+        replayed_ += ready.size();
+        return ready;
+    }
+
+    bool empty() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return messages_.empty();
+    }
+
+    // Discard every message of a local member, e.g. when its client goes
+    // away, appending them to `removed`
+    void removeUser(const std::string &userId, std::vector<MLSDeferredMessage> &removed)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto message = messages_.begin(); message != messages_.end();) {
+            auto next = std::next(message);
+            if (message->userId == userId) {
+                removed.push_back(take(message));
+            }
+            message = next;
+        }
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        messages_.clear();
+        groupCounts_.clear();
+        bytes_ = 0;
+    }
+
+    Limits limits() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return limits_;
+    }
+
+    // Takes effect for messages parked from now on
+    void setLimits(const Limits &limits)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        limits_ = limits;
+    }
+
+    Statistics statistics() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return {messages_.size(), bytes_, parked_, replayed_, expired_, evicted_};
+    }
+
+private:
+    using Iterator = std::list<MLSDeferredMessage>::iterator;
+
+    static std::string scopeKey(const std::string &groupId, const std::string &userId)
+    {
+        std::string key(groupId);
+        key.push_back('\0');
+        key.append(userId);
+        return key;
+    }
+
+    // Caller holds mutex_
+    size_t groupCount(const std::string &key) const
+    {
+        auto count = groupCounts_.find(key);
+        return count != groupCounts_.end() ? count->second : 0;
+    }
+
+    static bool inScope(const MLSDeferredMessage &message, const std::string &groupId, const std::string &userId)
+    {
+        return message.groupId == groupId && message.userId == userId;
+    }
+
+    // Caller holds mutex_. messages_ is in arrival order, so the expired
+    // ones are at the front.
+    void expire(Clock::time_point now, std::vector<MLSDeferredMessage> &dropped)
+    {
+        while (!messages_.empty() && now - messages_.front().parkedAt >= limits_.timeToLive) {
+            drop(messages_.begin(), true, dropped);
+        }
+    }
+
+    // Caller holds mutex_
+    void drop(Iterator message, bool expired, std::vector<MLSDeferredMessage> &dropped)
+    {
+        (expired ? expired_ : evicted_)++;
+        message->expired = expired;
+        dropped.push_back(take(message));
+    }
+
+    // Caller holds mutex_. Removes the message and returns it.
+    MLSDeferredMessage take(Iterator message)
+    {
+        auto count = groupCounts_.find(scopeKey(message->groupId, message->userId));
+        if (count != groupCounts_.end() && --count->second == 0) {
+            groupCounts_.erase(count);
+        }
+        bytes_ -= message->bytes.size();
+        MLSDeferredMessage taken = std::move(*message);
+        messages_.erase(message);
+        return taken;
+    }
+
+    mutable std::mutex mutex_;
+    Limits limits_;
+    std::list<MLSDeferredMessage> messages_;
+    std::unordered_map<std::string, size_t> groupCounts_;
+    size_t bytes_ = 0;
+    uint64_t lastTicket_ = 0;
+    uint64_t parked_ = 0;
+    uint64_t replayed_ = 0;
+    uint64_t expired_ = 0;
+    uint64_t evicted_ = 0;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Why an operation failed, in a form retry logic can act on. Promises the
+ * module rejects carry one as their NSError, which React Native hands to JS
+ * as `error.userInfo`:
+ *
+ *   {code, category, retryable, detail?}
+ *
+ * `code` and `category` are the names below in snake case, e.g.
+ * "wrong_epoch" and "state"; `detail` is the Rust library's own message.
+ */
+extern NSErrorDomain const MLSErrorDomain;
+
+// Values below 1000 are the Rust library's, see mls_last_error_fn
+typedef NS_ENUM(NSInteger, MLSErrorCategory) {
+    // The library did not say
+    MLSErrorCategoryUnknown = 0,
+    // Malformed or unacceptable input; the same call fails again
+    MLSErrorCategoryInput = 1,
+    // The group is not in a state the call needs, e.g. an older epoch
+    MLSErrorCategoryState = 2,
+    // The storage layer failed or is busy
+    MLSErrorCategoryStorage = 3,
+    // Decryption or signature verification failed
+    MLSErrorCategoryCrypto = 4,
+    MLSErrorCategoryInternal = 5,
+};
+
+typedef NS_ENUM(NSInteger, MLSErrorCode) {
+    MLSErrorCodeUnknown = 0,
+    MLSErrorCodeInvalidInput = 1,
+    MLSErrorCodeGroupNotFound = 2,
+    // Retryable once the commit for the message's epoch has been processed
+    MLSErrorCodeWrongEpoch = 3,
+    MLSErrorCodeNotMember = 4,
+    // Another connection holds the database lock
+    MLSErrorCodeStorageBusy = 5,
+    MLSErrorCodeStorageFailed = 6,
+    MLSErrorCodeDecryptionFailed = 7,
+    MLSErrorCodeInvalidSignature = 8,
+    MLSErrorCodeInvalidKeyPackage = 9,
+    MLSErrorCodeInternal = 10,
+
+    // Detected by the bridge: the call came before initialize or openClient
+    MLSErrorCodeClientNotInitialized = 1000,
+    // Maintenance work cancelled by cancelBackgroundWork before it started
+    MLSErrorCodeCancelled = 1001,
+};
+
+/**
+ * Why the calling thread's last mls_* call failed. Call it on that thread
+ * straight after the failing call, before any other FFI call. Rust builds
+ * without mls_last_error, or a failure the library did not describe, give
+ * MLSErrorCodeUnknown and no retry.
+ */
+NSError *MLSTakeLastFFIError(void);
+
+// An error the bridge detects itself, with the code's usual category and retry flag
+NSError *MLSBridgeError(MLSErrorCode code);
+
+// The userInfo of `error` for batch results that report errors inline, or
+// an empty dictionary if it is not in MLSErrorDomain
+NSDictionary<NSString *, id> *MLSErrorFields(NSError *_Nullable error);
+
+NS_ASSUME_NONNULL_END
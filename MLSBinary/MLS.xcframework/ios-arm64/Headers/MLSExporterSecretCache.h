@@ -0,0 +1,222 @@
+#pragma once
+
+#ifdef __cplusplus
+
+#import <Foundation/Foundation.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Overwrite secret bytes in a way the compiler cannot optimise away
+inline void MLSZeroize(std::vector<uint8_t> &bytes)
+{
+    volatile uint8_t *data = bytes.data();
+    for (size_t i = 0; i < bytes.size(); i++) {
+        data[i] = 0;
+    }
+}
+
+// Everything an exported secret is derived from. The context is keyed by
+// digest so large contexts are not kept around.
+struct MLSExporterSecretKey {
+    std::string groupId;
+    std::string userId;
+    uint64_t epoch;
+    std::string label;
+    std::string contextDigest;
+    uint32_t length;
+};
+
+/**
+ * LRU cache of exporter secrets keyed by (group, user, epoch, label,
+ * context digest, length).
+ *
+ * mls_export_secret is deterministic for that tuple, so repeated derivations
+ * within an epoch are served from memory. Callers key every lookup with the
+ * group's current epoch as Rust reports it, so a secret of an earlier epoch
+ * is never served, even if no invalidate() followed the epoch change;
+ * invalidate() only frees those entries early. Evicted and invalidated
+ * secrets are zeroized.
+ *
+ * Thread-safe: group lanes on the scheduler touch the cache concurrently.
+ */
+class MLSExporterSecretCache {
+public:
+    explicit MLSExporterSecretCache(size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {}
+
+    ~MLSExporterSecretCache() { clear(); }
+
+    MLSExporterSecretCache(const MLSExporterSecretCache &) = delete;
+    MLSExporterSecretCache &operator=(const MLSExporterSecretCache &) = delete;
+
+    // Copy a cached secret into `secret` and mark it most recently used
+    bool get(const MLSExporterSecretKey &key, std::vector<uint8_t> &secret)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto existing = index_.find(entryKey(key));
+        if (existing == index_.end()) {
+            misses_++;
+            return false;
+        }
+        hits_++;
+        entries_.splice(entries_.begin(), entries_, existing->second);
+        secret = existing->second->secret;
+        return true;
+    }
+
+    // Store a secret. Secrets of the same group and user from another epoch
+    // are dropped first, so a missed invalidation does not keep them around.
+    void put(const MLSExporterSecretKey &key, const std::vector<uint8_t> &secret)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        std::string scope = scopeKey(key.groupId, key.userId);
+        auto epoch = epochs_.find(scope);
+        if (epoch != epochs_.end() && epoch->second != key.epoch) {
+            eraseScope(scope);
+        }
+        epochs_[scope] = key.epoch;
+
+        std::string id = entryKey(key);
+        auto existing = index_.find(id);
+        if (existing != index_.end()) {
+            entries_.splice(entries_.begin(), entries_, existing->second);
+            return;
+        }
+
+        entries_.push_front({id, scope, secret});
+        index_[id] = entries_.begin();
+        while (entries_.size() > capacity_) {
+            eraseEntry(std::prev(entries_.end()));
+        }
+    }
+
+    // The group moved to a new epoch for this user; drop its secrets
+    void invalidate(const std::string &groupId, const std::string &userId)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        eraseScope(scopeKey(groupId, userId));
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &entry : entries_) {
+            MLSZeroize(entry.secret);
+        }
+        entries_.clear();
+        index_.clear();
+        epochs_.clear();
+    }
+
+    void setCapacity(size_t capacity)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = capacity > 0 ? capacity : 1;
+        while (entries_.size() > capacity_) {
+            eraseEntry(std::prev(entries_.end()));
+        }
+    }
+
+    size_t capacity() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return capacity_;
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+
+    // Secret bytes held, not counting keys and bookkeeping
+    size_t bytes() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t bytes = 0;
+        for (const auto &entry : entries_) {
+            bytes += entry.secret.size();
+        }
+        return bytes;
+    }
+
+    uint64_t hits() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return hits_;
+    }
+
+    uint64_t misses() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return misses_;
+    }
+
+private:
+    struct Entry {
+        std::string id;
+        std::string scope;
+        std::vector<uint8_t> secret;
+    };
+
+    static std::string scopeKey(const std::string &groupId, const std::string &userId)
+    {
+        std::string scope;
+        scope.reserve(groupId.size() + userId.size() + 1);
+        scope.append(groupId).push_back('\0');
+        scope.append(userId);
+        return scope;
+    }
+
+    // Fields are NUL-separated and fixed-width numbers are appended raw, so
+    // distinct tuples never serialise to the same key
+    static std::string entryKey(const MLSExporterSecretKey &key)
+    {
+        std::string id = scopeKey(key.groupId, key.userId);
+        id.push_back('\0');
+        id.append(reinterpret_cast<const char *>(&key.epoch), sizeof(key.epoch));
+        id.append(reinterpret_cast<const char *>(&key.length), sizeof(key.length));
+        id.append(key.contextDigest).push_back('\0');
+        id.append(key.label);
+        return id;
+    }
+
+    // Caller holds mutex_
+    void eraseEntry(std::list<Entry>::iterator entry)
+    {
+        MLSZeroize(entry->secret);
+        index_.erase(entry->id);
+        entries_.erase(entry);
+    }
+
+    // Caller holds mutex_
+    void eraseScope(const std::string &scope)
+    {
+        for (auto entry = entries_.begin(); entry != entries_.end();) {
+            auto next = std::next(entry);
+            if (entry->scope == scope) {
+                eraseEntry(entry);
+            }
+            entry = next;
+        }
+        epochs_.erase(scope);
+    }
+
+    mutable std::mutex mutex_;
+    size_t capacity_;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    std::list<Entry> entries_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    std::unordered_map<std::string, uint64_t> epochs_;
+};
+
+#endif
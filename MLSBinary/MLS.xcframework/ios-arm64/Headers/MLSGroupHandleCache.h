@@ -0,0 +1,267 @@
+#pragma once
+
+#ifdef __cplusplus
+
+#import <Foundation/Foundation.h>
+#import "MLSFFI.h"
+
+#include <dlfcn.h>
+
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * LRU cache of live group handles. Keys are opaque to the cache; MLSModule
+ * keys a handle by group ID and the member whose client created it.
+ *
+ * Handles returned by mls_create_group / mls_join_group* are kept alive here
+ * instead of being freed immediately. The number of live handles is capped;
+ * when the cap is exceeded the least recently used handle is released through
+ * the deleter (mls_free_group). Eviction can also be requested explicitly.
+ *
+ * get hands out a reference, so a handle evicted while a lane still calls
+ * into it is released once that call is done.
+ *
+ * Thread-safe: group lanes on the scheduler touch the cache concurrently.
+ */
+class MLSGroupHandleCache {
+public:
+    using Deleter = void (*)(void *handle);
+    using Handle = std::shared_ptr<void>;
+
+    MLSGroupHandleCache(size_t capacity, Deleter deleter)
+        : capacity_(capacity > 0 ? capacity : 1), deleter_(deleter) {}
+
+    ~MLSGroupHandleCache() { clear(); }
+
+    MLSGroupHandleCache(const MLSGroupHandleCache &) = delete;
+    MLSGroupHandleCache &operator=(const MLSGroupHandleCache &) = delete;
+
+    // Store a handle under a key, releasing any handle it replaces
+    void put(const std::string &key, void *handle)
+    {
+        if (handle == nullptr) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto existing = index_.find(key);
+        if (existing != index_.end()) {
+            if (existing->second->second.get() != handle) {
+                existing->second->second = Handle(handle, deleter_);
+            }
+            entries_.splice(entries_.begin(), entries_, existing->second);
+            return;
+        }
+
+        entries_.emplace_front(key, Handle(handle, deleter_));
+        index_[key] = entries_.begin();
+        trimToCapacity();
+    }
+
+    // Look up a handle and mark it as most recently used; null if none is cached
+    Handle get(const std::string &key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto existing = index_.find(key);
+        if (existing == index_.end()) {
+            return Handle();
+        }
+        entries_.splice(entries_.begin(), entries_, existing->second);
+        return existing->second->second;
+    }
+
+    bool contains(const std::string &key) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return index_.find(key) != index_.end();
+    }
+
+    // Release the handle under one key; returns whether one was cached
+    bool evict(const std::string &key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto existing = index_.find(key);
+        if (existing == index_.end()) {
+            return false;
+        }
+        entries_.erase(existing->second);
+        index_.erase(existing);
+        return true;
+    }
+
+    // Release every handle whose key matches; returns how many were cached
+    template <typename Predicate>
+    size_t evictIf(Predicate matches)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t evicted = 0;
+        for (auto entry = entries_.begin(); entry != entries_.end();) {
+            auto next = std::next(entry);
+            if (matches(entry->first)) {
+                index_.erase(entry->first);
+                entries_.erase(entry);
+                evicted++;
+            }
+            entry = next;
+        }
+        return evicted;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+        index_.clear();
+    }
+
+    // Takes effect on the next put; trimIf releases what is over it now
+    void setCapacity(size_t capacity)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = capacity > 0 ? capacity : 1;
+    }
+
+    // Release least recently used handles until at most `keep` remain,
+    // leaving the capacity as it is; returns how many were released
+    size_t trim(size_t keep)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t released = 0;
+        while (entries_.size() > keep) {
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+            released++;
+        }
+        return released;
+    }
+
+    // trim, but releasing only handles whose key matches; the others count
+    // towards `keep` all the same
+    template <typename Predicate>
+    size_t trimIf(size_t keep, Predicate matches)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t released = 0;
+        for (auto entry = entries_.end(); entries_.size() > keep && entry != entries_.begin();) {
+            --entry;
+            if (matches(entry->first)) {
+                index_.erase(entry->first);
+                entry = entries_.erase(entry);
+                released++;
+            }
+        }
+        return released;
+    }
+
+    size_t capacity() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return capacity_;
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+
+    // Cached keys, most recently used first
+    std::vector<std::string> keys() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<std::string> keys;
+        keys.reserve(entries_.size());
+        for (const auto &entry : entries_) {
+            keys.push_back(entry.first);
+        }
+        return keys;
+    }
+
+private:
+    // Caller holds mutex_
+    void trimToCapacity()
+    {
+        while (entries_.size() > capacity_) {
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+    }
+
+    using Entry = std::pair<std::string, Handle>;
+
+    mutable std::mutex mutex_;
+    size_t capacity_;
+    Deleter deleter_;
+    std::list<Entry> entries_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+};
+
+// Group handles belong to the client of the member that created them, so two
+// local identities in one group keep separate handles. Group IDs come from
+// UTF8String and cannot contain NUL, so splitting at the first one is exact.
+inline std::string MLSGroupHandleKey(const char *groupId, const char *userId)
+{
+    std::string key(groupId);
+    key.push_back('\0');
+    key.append(userId);
+    return key;
+}
+
+inline bool MLSGroupHandleKeyHasUser(const std::string &key, const char *userId)
+{
+    size_t separator = key.find('\0');
+    return separator != std::string::npos && key.compare(separator + 1, std::string::npos, userId) == 0;
+}
+
+inline bool MLSGroupHandleKeyHasGroup(const std::string &key, const char *groupId)
+{
+    size_t separator = key.find('\0');
+    return separator != std::string::npos && key.compare(0, separator, groupId) == 0;
+}
+
+// mls_process_message, on the cached handle through mls_group_process_message
+// when the library has it and one is cached; `handles` may be null. Must run
+// on the group's lane.
+inline int MLSProcessMessage(MLSGroupHandleCache *handles, const void *client, const char *groupId, const char *userId,
+                             const uint8_t *message, int messageLength, int *type, uint8_t **content, int *contentLength,
+                             uint8_t **sender, int *senderLength, int *validated)
+{
+    static const auto processWithGroup = (mls_group_process_message_fn)dlsym(RTLD_DEFAULT, "mls_group_process_message");
+    if (processWithGroup != nullptr && handles != nullptr) {
+        MLSGroupHandleCache::Handle group = handles->get(MLSGroupHandleKey(groupId, userId));
+        if (group) {
+            return processWithGroup(client, group.get(), message, messageLength, type, content, contentLength,
+                                    sender, senderLength, validated);
+        }
+    }
+    return mls_process_message(client, groupId, userId, message, messageLength, type, content, contentLength,
+                               sender, senderLength, validated);
+}
+
+// mls_create_application_message, on the cached handle through
+// mls_group_create_application_message when the library has it and one is
+// cached. Must run on the group's lane.
+inline uint8_t *MLSCreateApplicationMessage(MLSGroupHandleCache *handles, const void *client, const char *groupId,
+                                            const char *userId, const uint8_t *plaintext, int plaintextLength, int *outLength)
+{
+    static const auto createWithGroup =
+        (mls_group_create_application_message_fn)dlsym(RTLD_DEFAULT, "mls_group_create_application_message");
+    if (createWithGroup != nullptr && handles != nullptr) {
+        MLSGroupHandleCache::Handle group = handles->get(MLSGroupHandleKey(groupId, userId));
+        if (group) {
+            return createWithGroup(client, group.get(), plaintext, plaintextLength, outLength);
+        }
+    }
+    return mls_create_application_message(client, groupId, userId, plaintext, plaintextLength, outLength);
+}
+
+#endif
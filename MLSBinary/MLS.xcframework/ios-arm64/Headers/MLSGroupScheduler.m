@@ -0,0 +1,52 @@
+#import "MLSGroupScheduler.h"
+#import <os/lock.h>
+
+@implementation MLSGroupScheduler
+{
+    NSString *_label;
+    dispatch_queue_t _rootQueue;
+    NSMutableDictionary<NSString *, dispatch_queue_t> *_lanes;
+    os_unfair_lock _lanesLock;
+}
+
+- (instancetype)initWithLabel:(NSString *)label
+{
+    if (self = [super init]) {
+        _label = [label copy];
+        dispatch_queue_attr_t attr = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_CONCURRENT, QOS_CLASS_USER_INITIATED, 0);
+        _rootQueue = dispatch_queue_create([label UTF8String], attr);
+        _lanes = [NSMutableDictionary dictionary];
+        _lanesLock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+- (dispatch_queue_t)queueForKey:(NSString *)key
+{
+    os_unfair_lock_lock(&_lanesLock);
+    dispatch_queue_t lane = _lanes[key];
+    if (!lane) {
+        NSString *laneLabel = [NSString stringWithFormat:@"%@.%@", _label, key];
+        lane = dispatch_queue_create_with_target([laneLabel UTF8String], DISPATCH_QUEUE_SERIAL, _rootQueue);
+        _lanes[key] = lane;
+    }
+    os_unfair_lock_unlock(&_lanesLock);
+    return lane;
+}
+
+- (void)dispatchAsyncForKey:(NSString *)key block:(dispatch_block_t)block
+{
+    dispatch_async([self queueForKey:key], block);
+}
+
+- (void)dispatchSyncForKey:(NSString *)key block:(dispatch_block_t)block
+{
+    dispatch_sync([self queueForKey:key], block);
+}
+
+- (void)dispatchBarrierAsync:(dispatch_block_t)block
+{
+    dispatch_barrier_async(_rootQueue, block);
+}
+
+@end
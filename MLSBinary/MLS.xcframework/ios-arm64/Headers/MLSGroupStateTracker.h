@@ -0,0 +1,35 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Last known epoch and pending-proposal count per group and local user, so
+ * MLSModule can tell which state change events an operation produced.
+ *
+ * Pending proposals are counted as the bridge sees them: each created or
+ * received proposal adds one, and moving to a new epoch clears them.
+ *
+ * Thread-safe; group lanes on the scheduler update it concurrently.
+ */
+@interface MLSGroupStateTracker : NSObject
+
+/**
+ * Record the group's current epoch. Returns YES if it differs from the last
+ * recorded one, setting `previousEpoch` to that epoch or nil if none was known.
+ */
+- (BOOL)updateEpoch:(uint64_t)epoch
+           forGroup:(NSString *)groupId
+             userId:(NSString *)userId
+      previousEpoch:(NSNumber * _Nullable * _Nonnull)previousEpoch;
+
+// Count one more pending proposal; returns the new count
+- (NSUInteger)addPendingProposalForGroup:(NSString *)groupId userId:(NSString *)userId;
+
+// Clear pending proposals after a commit; returns NO if there were none
+- (BOOL)clearPendingProposalsForGroup:(NSString *)groupId userId:(NSString *)userId;
+
+- (void)removeAllStates;
+
+@end
+
+NS_ASSUME_NONNULL_END
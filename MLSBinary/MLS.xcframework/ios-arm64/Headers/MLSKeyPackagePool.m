@@ -0,0 +1,140 @@
+#import "MLSKeyPackagePool.h"
+#import <os/lock.h>
+
+@implementation MLSKeyPackagePool
+{
+    NSMutableDictionary<NSString *, NSMutableArray<NSString *> *> *_packages;
+    NSMutableSet<NSString *> *_refilling;
+    uint64_t _hits;
+    uint64_t _misses;
+    uint64_t _generated;
+    os_unfair_lock _lock;
+}
+
+- (instancetype)initWithLowWaterMark:(NSUInteger)lowWaterMark targetSize:(NSUInteger)targetSize
+{
+    if (self = [super init]) {
+        _lowWaterMark = lowWaterMark;
+        _targetSize = targetSize;
+        _packages = [NSMutableDictionary dictionary];
+        _refilling = [NSMutableSet set];
+        _lock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+- (NSArray<NSString *> *)takeKeyPackages:(NSUInteger)count forIdentity:(NSString *)identity
+{
+    os_unfair_lock_lock(&_lock);
+    NSMutableArray<NSString *> *available = _packages[identity];
+    NSUInteger taken = MIN(count, available.count);
+    NSArray<NSString *> *result = @[];
+    if (taken > 0) {
+        NSRange oldest = NSMakeRange(0, taken);
+        result = [available subarrayWithRange:oldest];
+        [available removeObjectsInRange:oldest];
+    }
+    _hits += taken;
+    _misses += count - taken;
+    os_unfair_lock_unlock(&_lock);
+    return result;
+}
+
+- (void)addKeyPackages:(NSArray<NSString *> *)keyPackages forIdentity:(NSString *)identity
+{
+    os_unfair_lock_lock(&_lock);
+    NSMutableArray<NSString *> *available = _packages[identity];
+    if (!available) {
+        available = [NSMutableArray array];
+        _packages[identity] = available;
+    }
+    [available addObjectsFromArray:keyPackages];
+    _generated += keyPackages.count;
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (BOOL)beginRefillForIdentity:(NSString *)identity
+{
+    NSUInteger lowWaterMark = self.lowWaterMark;
+    BOOL enabled = self.targetSize > 0;
+
+    os_unfair_lock_lock(&_lock);
+    BOOL due = enabled && _packages[identity].count < lowWaterMark && ![_refilling containsObject:identity];
+    if (due) {
+        [_refilling addObject:identity];
+    }
+    os_unfair_lock_unlock(&_lock);
+    return due;
+}
+
+- (NSUInteger)shortfallForIdentity:(NSString *)identity
+{
+    NSUInteger targetSize = self.targetSize;
+
+    os_unfair_lock_lock(&_lock);
+    NSUInteger count = _packages[identity].count;
+    os_unfair_lock_unlock(&_lock);
+    return count < targetSize ? targetSize - count : 0;
+}
+
+- (void)endRefillForIdentity:(NSString *)identity
+{
+    os_unfair_lock_lock(&_lock);
+    [_refilling removeObject:identity];
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)removeAllKeyPackages
+{
+    os_unfair_lock_lock(&_lock);
+    [_packages removeAllObjects];
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (NSUInteger)trimToCount:(NSUInteger)count
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger dropped = 0;
+    for (NSMutableArray<NSString *> *packages in _packages.objectEnumerator) {
+        if (packages.count > count) {
+            NSRange newest = NSMakeRange(count, packages.count - count);
+            dropped += newest.length;
+            [packages removeObjectsInRange:newest];
+        }
+    }
+    os_unfair_lock_unlock(&_lock);
+    return dropped;
+}
+
+- (NSUInteger)byteCount
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger bytes = 0;
+    for (NSMutableArray<NSString *> *packages in _packages.objectEnumerator) {
+        for (NSString *package in packages) {
+            // Base64, so one byte per character
+            bytes += package.length;
+        }
+    }
+    os_unfair_lock_unlock(&_lock);
+    return bytes;
+}
+
+- (NSDictionary *)statistics
+{
+    os_unfair_lock_lock(&_lock);
+    NSMutableDictionary<NSString *, NSNumber *> *available = [NSMutableDictionary dictionaryWithCapacity:_packages.count];
+    [_packages enumerateKeysAndObjectsUsingBlock:^(NSString *identity, NSMutableArray<NSString *> *packages, BOOL *stop) {
+        available[identity] = @(packages.count);
+    }];
+    NSDictionary *statistics = @{
+        @"hits": @(_hits),
+        @"misses": @(_misses),
+        @"generated": @(_generated),
+        @"available": available,
+    };
+    os_unfair_lock_unlock(&_lock);
+    return statistics;
+}
+
+@end
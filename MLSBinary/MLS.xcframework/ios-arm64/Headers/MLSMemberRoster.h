@@ -0,0 +1,56 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Cached member list per group and local user, kept current from the
+ * commits the bridge creates and processes.
+ *
+ * A roster is tracked from the first time it is loaded. Every later update
+ * records the identities added and removed as a versioned delta, so callers
+ * get the member list, O(1) membership checks and diffs since a version
+ * they already have without going back to the FFI. The last
+ * `changeLogLimit` deltas are kept; older versions get a full reset.
+ *
+ * Updates themselves are not incremental: the FFI does not expose the
+ * proposals a commit applied, so each commit of a tracked group fetches the
+ * full member list once and diffs it here. With JS listeners attached every
+ * group is tracked, which costs one mls_group_members call per commit.
+ *
+ * Thread-safe; group lanes on the scheduler update rosters concurrently.
+ */
+@interface MLSMemberRoster : NSObject
+
+- (instancetype)initWithChangeLogLimit:(NSUInteger)changeLogLimit;
+
+- (BOOL)isTrackingGroup:(NSString *)groupId userId:(NSString *)userId;
+
+// Cached members in FFI order, or nil if the roster is not tracked
+- (nullable NSArray<NSString *> *)membersOfGroup:(NSString *)groupId userId:(NSString *)userId;
+
+// Must only be called for a tracked roster
+- (BOOL)group:(NSString *)groupId userId:(NSString *)userId containsMember:(NSString *)identity;
+
+/**
+ * Replace the roster with a fresh member list, starting to track it if needed.
+ * Returns the delta {version, added, removed}, or nil when membership did not
+ * change or the roster was not tracked before.
+ */
+- (nullable NSDictionary *)updateMembers:(NSArray<NSString *> *)members
+                                 ofGroup:(NSString *)groupId
+                                  userId:(NSString *)userId;
+
+/**
+ * Changes after `version` folded into one {version, added, removed}. If that
+ * version is older than the change log, returns {version, reset: true, members}
+ * instead. Returns nil if the roster is not tracked.
+ */
+- (nullable NSDictionary *)changesForGroup:(NSString *)groupId
+                                    userId:(NSString *)userId
+                              sinceVersion:(NSUInteger)version;
+
+- (void)removeAllRosters;
+
+@end
+
+NS_ASSUME_NONNULL_END
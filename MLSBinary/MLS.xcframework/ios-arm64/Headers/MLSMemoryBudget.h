@@ -0,0 +1,56 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// How much cached state a trim releases, each level including the ones before
+typedef NS_ENUM(NSInteger, MLSMemoryTrimLevel) {
+    // The least recently used half of the group handles and every exporter secret
+    MLSMemoryTrimLevelLow,
+    // Every group handle, and key package pools down to their low-water mark
+    MLSMemoryTrimLevelModerate,
+    // Every pooled key package as well
+    MLSMemoryTrimLevelCritical,
+};
+
+// "low", "moderate" or "critical"
+NSString *MLSMemoryTrimLevelName(MLSMemoryTrimLevel level);
+
+// NO for a name that is not a level
+BOOL MLSMemoryTrimLevelFromName(NSString *name, MLSMemoryTrimLevel *level);
+
+/**
+ * Decides when the bridge has to give memory back, from the system's
+ * memory warnings and pressure events and from a budget on the process
+ * footprint.
+ *
+ * The footprint is the system's own count, so it includes the Rust side.
+ * checkFootprint samples it at most every couple of seconds; over the budget
+ * a moderate trim is asked for, and a critical one if the last trim did not
+ * bring it back under. A memory warning asks for a critical trim, a pressure
+ * warning for a moderate one. Trims are handed to `trimHandler` on a private
+ * queue, which reports each back with trimDidFinish.
+ *
+ * Thread-safe; group lanes call checkFootprint concurrently.
+ */
+@interface MLSMemoryBudget : NSObject
+
+// `budget` is in bytes; 0 leaves the footprint unbounded
+- (instancetype)initWithBudget:(uint64_t)budget;
+
+@property (atomic, copy, nullable) void (^trimHandler)(MLSMemoryTrimLevel level, NSString *reason);
+
+@property (atomic, assign) uint64_t budget;
+
+// Cheap enough for every message
+- (void)checkFootprint;
+
+// A trim finished, by request or by the handler; `released` is what it gave back
+- (void)trimDidFinish:(MLSMemoryTrimLevel)level released:(NSUInteger)released;
+
+// {budgetBytes, footprintBytes, availableBytes, warnings, pressureEvents, budgetTrims, trims: {low, moderate, critical},
+//  released, lastTrimLevel}
+- (NSDictionary *)statistics;
+
+@end
+
+NS_ASSUME_NONNULL_END
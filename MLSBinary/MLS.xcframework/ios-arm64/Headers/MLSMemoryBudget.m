@@ -0,0 +1,187 @@
+#import "MLSMemoryBudget.h"
+#import "MLSPlatform.h"
+#import <os/lock.h>
+
+// Sampling the footprint is a syscall; once every couple of seconds is plenty
+static const NSTimeInterval MLSMemoryCheckInterval = 2;
+
+NSString *MLSMemoryTrimLevelName(MLSMemoryTrimLevel level)
+{
+    switch (level) {
+        case MLSMemoryTrimLevelLow: return @"low";
+        case MLSMemoryTrimLevelModerate: return @"moderate";
+        case MLSMemoryTrimLevelCritical: return @"critical";
+    }
+    return @"unknown";
+}
+
+BOOL MLSMemoryTrimLevelFromName(NSString *name, MLSMemoryTrimLevel *level)
+{
+    for (MLSMemoryTrimLevel candidate = MLSMemoryTrimLevelLow; candidate <= MLSMemoryTrimLevelCritical; candidate++) {
+        if ([MLSMemoryTrimLevelName(candidate) isEqualToString:name]) {
+            *level = candidate;
+            return YES;
+        }
+    }
+    return NO;
+}
+
+@implementation MLSMemoryBudget
+{
+    NSTimeInterval _lastCheckAt;
+    // The last check was over the budget, so a trim has been asked for since
+    BOOL _overBudget;
+    uint64_t _warnings;
+    uint64_t _pressureEvents;
+    uint64_t _budgetTrims;
+    uint64_t _trims[MLSMemoryTrimLevelCritical + 1];
+    uint64_t _released;
+    // -1 before the first trim
+    NSInteger _lastTrimLevel;
+    // Runs the trim handler and the pressure source
+    dispatch_queue_t _queue;
+    dispatch_source_t _pressureSource;
+    id _warningObserver;
+    os_unfair_lock _lock;
+}
+
+- (instancetype)initWithBudget:(uint64_t)budget
+{
+    if (self = [super init]) {
+        _budget = budget;
+        _lastTrimLevel = -1;
+        _queue = dispatch_queue_create("com.reactnativemls.MLSQueue.memory",
+                                       dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+        _lock = OS_UNFAIR_LOCK_INIT;
+
+        __weak MLSMemoryBudget *weakSelf = self;
+        _pressureSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_MEMORYPRESSURE, 0,
+                                                 DISPATCH_MEMORYPRESSURE_WARN | DISPATCH_MEMORYPRESSURE_CRITICAL, _queue);
+        dispatch_source_set_event_handler(_pressureSource, ^{
+            MLSMemoryBudget *strongSelf = weakSelf;
+            if (strongSelf != nil) {
+                [strongSelf memoryPressureDidChange:dispatch_source_get_data(strongSelf->_pressureSource)];
+            }
+        });
+        dispatch_resume(_pressureSource);
+
+        NSNotificationName warning = MLSMemoryWarningNotification();
+        if (warning != nil) {
+            _warningObserver = [NSNotificationCenter.defaultCenter addObserverForName:warning
+                                                                               object:nil
+                                                                                queue:nil
+                                                                           usingBlock:^(NSNotification *notification) {
+                [weakSelf memoryWarningReceived];
+            }];
+        }
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    dispatch_source_cancel(_pressureSource);
+    if (_warningObserver != nil) {
+        [NSNotificationCenter.defaultCenter removeObserver:_warningObserver];
+    }
+}
+
+- (void)checkFootprint
+{
+    uint64_t budget = self.budget;
+    if (budget == 0) {
+        return;
+    }
+
+    os_unfair_lock_lock(&_lock);
+    NSTimeInterval now = NSProcessInfo.processInfo.systemUptime;
+    BOOL due = now - _lastCheckAt >= MLSMemoryCheckInterval;
+    if (due) {
+        _lastCheckAt = now;
+    }
+    os_unfair_lock_unlock(&_lock);
+    if (!due) {
+        return;
+    }
+
+    uint64_t footprint = MLSProcessFootprint();
+    os_unfair_lock_lock(&_lock);
+    BOOL over = footprint > budget;
+    // Still over one check after a trim: what is left has to go too
+    BOOL escalate = over && _overBudget;
+    _overBudget = over;
+    _budgetTrims += over ? 1 : 0;
+    os_unfair_lock_unlock(&_lock);
+
+    if (over) {
+        [self requestTrim:escalate ? MLSMemoryTrimLevelCritical : MLSMemoryTrimLevelModerate reason:@"budget"];
+    }
+}
+
+- (void)trimDidFinish:(MLSMemoryTrimLevel)level released:(NSUInteger)released
+{
+    os_unfair_lock_lock(&_lock);
+    _trims[level]++;
+    _released += released;
+    _lastTrimLevel = level;
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (NSDictionary *)statistics
+{
+    uint64_t footprint = MLSProcessFootprint();
+    uint64_t available = MLSAvailableMemory();
+
+    os_unfair_lock_lock(&_lock);
+    NSDictionary *statistics = @{
+        @"budgetBytes": @(self.budget),
+        @"footprintBytes": @(footprint),
+        @"availableBytes": available > 0 ? @(available) : [NSNull null],
+        @"warnings": @(_warnings),
+        @"pressureEvents": @(_pressureEvents),
+        @"budgetTrims": @(_budgetTrims),
+        @"trims": @{
+            @"low": @(_trims[MLSMemoryTrimLevelLow]),
+            @"moderate": @(_trims[MLSMemoryTrimLevelModerate]),
+            @"critical": @(_trims[MLSMemoryTrimLevelCritical]),
+        },
+        @"released": @(_released),
+        @"lastTrimLevel": _lastTrimLevel >= 0 ? MLSMemoryTrimLevelName((MLSMemoryTrimLevel)_lastTrimLevel) : [NSNull null],
+    };
+    os_unfair_lock_unlock(&_lock);
+    return statistics;
+}
+
+- (void)memoryWarningReceived
+{
+    os_unfair_lock_lock(&_lock);
+    _warnings++;
+    os_unfair_lock_unlock(&_lock);
+    [self requestTrim:MLSMemoryTrimLevelCritical reason:@"memoryWarning"];
+}
+
+// Runs on _queue
+- (void)memoryPressureDidChange:(unsigned long)pressure
+{
+    if ((pressure & (DISPATCH_MEMORYPRESSURE_WARN | DISPATCH_MEMORYPRESSURE_CRITICAL)) == 0) {
+        return;
+    }
+    os_unfair_lock_lock(&_lock);
+    _pressureEvents++;
+    os_unfair_lock_unlock(&_lock);
+    BOOL critical = (pressure & DISPATCH_MEMORYPRESSURE_CRITICAL) != 0;
+    [self requestTrim:critical ? MLSMemoryTrimLevelCritical : MLSMemoryTrimLevelModerate reason:@"memoryPressure"];
+}
+
+- (void)requestTrim:(MLSMemoryTrimLevel)level reason:(NSString *)reason
+{
+    void (^handler)(MLSMemoryTrimLevel, NSString *) = self.trimHandler;
+    if (handler == nil) {
+        return;
+    }
+    dispatch_async(_queue, ^{
+        handler(level, reason);
+    });
+}
+
+@end
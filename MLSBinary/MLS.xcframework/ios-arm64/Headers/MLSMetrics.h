@@ -0,0 +1,136 @@
+#pragma once
+
+#ifdef __cplusplus
+
+#import <Foundation/Foundation.h>
+#import "MLSModule.h"
+
+#include <os/log.h>
+#include <os/signpost.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Phases of one MLS operation: argument decoding, the Rust FFI call, and
+// conversion of the result back to JS values
+enum class MLSOperationPhase : int {
+    Decode = 0,
+    FFI,
+    Marshal,
+};
+
+static const size_t MLSOperationPhaseCount = 3;
+
+/**
+ * Latency histogram with power-of-two microsecond buckets. Bucket i holds
+ * samples in [2^i, 2^(i+1)) µs; the last bucket also takes everything slower.
+ */
+struct MLSLatencyHistogram {
+    static const size_t BucketCount = 24;
+
+    std::array<uint64_t, BucketCount> buckets{};
+    uint64_t count = 0;
+    uint64_t totalMicros = 0;
+    uint64_t maxMicros = 0;
+
+    void record(uint64_t micros);
+
+    // Upper bound of the bucket holding the given quantile (0..1)
+    uint64_t percentile(double quantile) const;
+};
+
+struct MLSOperationStats {
+    uint64_t calls = 0;
+    uint64_t errors = 0;
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+    MLSLatencyHistogram total;
+    std::array<MLSLatencyHistogram, MLSOperationPhaseCount> phases;
+};
+
+/**
+ * Per-operation counters, byte sizes and latency histograms for MLSModule,
+ * plus the os_log handle its signpost intervals are emitted on.
+ *
+ * Thread-safe; operations on different group lanes record concurrently.
+ */
+class MLSMetrics {
+public:
+    MLSMetrics();
+
+    MLSMetrics(const MLSMetrics &) = delete;
+    MLSMetrics &operator=(const MLSMetrics &) = delete;
+
+    void record(const char *operation, bool succeeded, uint64_t bytesIn, uint64_t bytesOut, uint64_t totalMicros,
+                const std::array<uint64_t, MLSOperationPhaseCount> &phaseMicros);
+
+    // {operationName: {calls, errors, bytesIn, bytesOut, latency: {total, decode, ffi, marshal}}}
+    NSDictionary *snapshot() const;
+
+    void reset();
+
+    os_log_t log() const { return log_; }
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, MLSOperationStats> operations_;
+    os_log_t log_;
+};
+
+/**
+ * Times one MLS operation. Starts in the Decode phase; enterPhase closes the
+ * current phase and opens the next. The destructor records the sample and
+ * ends the signpost interval, counting the operation as failed unless
+ * succeed() was called. A null metrics pointer makes every call a no-op.
+ */
+class MLSOperationTrace {
+public:
+    MLSOperationTrace(MLSMetrics *metrics, const char *operation, uint64_t bytesIn = 0);
+    ~MLSOperationTrace();
+
+    MLSOperationTrace(const MLSOperationTrace &) = delete;
+    MLSOperationTrace &operator=(const MLSOperationTrace &) = delete;
+
+    void enterPhase(MLSOperationPhase phase);
+
+    void addBytesIn(uint64_t bytes) { bytesIn_ += bytes; }
+    void addBytesOut(uint64_t bytes) { bytesOut_ += bytes; }
+
+    // Mark success and count the size of the value resolved to JS
+    id succeed(id result);
+
+    void succeed() { succeeded_ = true; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void closePhase(Clock::time_point now);
+
+    MLSMetrics *metrics_;
+    const char *operation_;
+    os_signpost_id_t signpostId_;
+    Clock::time_point start_;
+    Clock::time_point phaseStart_;
+    MLSOperationPhase phase_ = MLSOperationPhase::Decode;
+    std::array<uint64_t, MLSOperationPhaseCount> phaseMicros_{};
+    uint64_t bytesIn_;
+    uint64_t bytesOut_ = 0;
+    bool succeeded_ = false;
+};
+
+// Approximate payload size of a bridge value: string and data lengths,
+// summed through arrays and dictionaries
+uint64_t MLSPayloadSize(id value);
+
+@interface MLSModule (Metrics)
+
+// Metrics shared by the bridge methods and the binary transport
+- (MLSMetrics *)metrics;
+
+@end
+
+#endif
@@ -1,10 +1,117 @@
 #import <React/RCTBridgeModule.h>
+#import <React/RCTEventEmitter.h>
 
-@interface MLSModule : NSObject <RCTBridgeModule>
+@class MLSGroupScheduler;
+@class MLSIdentityClient;
 
-// Store the MLS client pointer
+/**
+ * Events sent to JS whenever an operation changes group state:
+ *
+ * - MLSEpochChanged: {groupId, userId, epoch, previousEpoch}
+ * - MLSMembershipChanged: {groupId, userId, version, added, removed}
+ * - MLSPendingProposalsChanged: {groupId, userId, pendingProposals}
+ * - MLSMembershipProgress: {operationId, groupId, phase, completed, total}
+ *   while bulkUpdateMembers runs; phase is "staging", "committing" or "done"
+ * - MLSStartup: {state, error?, warmedGroups?} after initializeAsync; state is
+ *   "ready" once the client exists, "failed" if it could not be created, and
+ *   "warm" when the recently used groups have been loaded
+ * - MLSDeferredMessage: {ticket, groupId, userId, epoch, result | error} for a
+ *   message processMessage resolved as {type: "deferred", ticket}: the result
+ *   once a commit reached its epoch, or why it was dropped unprocessed; a
+ *   failed replay also has the {code, category, retryable} of MLSErrors.h
+ * - MLSKeyRotated: {groupId, userId, commit, welcome} when a scheduled key
+ *   rotation made a commit, to broadcast unless a mesh outbox sends it
+ * - MLSProposalsCommitted: {groupId, userId, reason, commit, welcome} when
+ *   proposal aggregation committed a group's proposals; reason is "count",
+ *   "time", "idle" or "flush"
+ * - MLSMemoryTrimmed: {level, reason, groupHandles, exporterSecrets,
+ *   keyPackages, footprintBytes} when a memory warning, memory pressure or
+ *   the memory budget made the bridge release cached state; reason is
+ *   "memoryWarning", "memoryPressure" or "budget"
+ *
+ * Nothing is tracked or sent while no JS listener is attached.
+ */
+extern NSString *const MLSEpochChangedEvent;
+extern NSString *const MLSMembershipChangedEvent;
+extern NSString *const MLSPendingProposalsChangedEvent;
+extern NSString *const MLSMembershipProgressEvent;
+extern NSString *const MLSStartupEvent;
+extern NSString *const MLSDeferredMessageEvent;
+extern NSString *const MLSKeyRotatedEvent;
+extern NSString *const MLSProposalsCommittedEvent;
+extern NSString *const MLSMemoryTrimmedEvent;
+
+typedef NS_ENUM(NSInteger, MLSGroupStateChange) {
+    // The group moved to a new epoch: a commit was created or applied, or the group was joined
+    MLSGroupStateChangeNewEpoch,
+    // A proposal was created or received and is pending until the next commit
+    MLSGroupStateChangeProposal,
+};
+
+/**
+ * Rejections carry an NSError in MLSErrorDomain that says whether retrying
+ * can help, except where a file operation's own error says more; see
+ * MLSErrors.h. Batch results that report failures inline give the same
+ * fields on the failed entry.
+ *
+ * Maintenance operations — selfUpdate, commitPendingProposals, addMembers,
+ * bulkUpdateMembers, exportRatchetTree, exportRatchetTreeToFile and key
+ * package refill — run as background work at utility QoS, see
+ * MLSBackgroundWork.h. Until they start they can be cancelled with
+ * cancelBackgroundWork, which rejects them with code "cancelled", and
+ * setPowerMode holds them while the device saves energy.
+ */
+@interface MLSModule : RCTEventEmitter <RCTBridgeModule>
+
+// The shared MLS client, used by every identity without a client of its own
 @property (nonatomic, assign) void* mlsClient;
 
+// Per-group execution lanes of the shared client
+@property (nonatomic, readonly) MLSGroupScheduler *scheduler;
+
+/**
+ * Client and lanes an operation for `identity` uses: its own if openClient
+ * gave it one, the shared ones otherwise. Resolve it when scheduling work and
+ * keep using the result, so the work stays on one client.
+ */
+- (MLSIdentityClient *)clientForIdentity:(NSString *)identity;
+
+/**
+ * Record that an operation changed a group's state and emit the matching
+ * events to JS listeners. Called by the promise methods and the binary
+ * transport; must run on the group's lane.
+ * @param client The client of the lane, see clientForIdentity:
+ * @return The membership delta {version, added, removed} of a new epoch, or nil
+ */
+- (NSDictionary *)groupStateDidChange:(MLSGroupStateChange)change
+                              groupId:(NSString *)groupId
+                               userId:(NSString *)userId
+                               client:(void *)client;
+
+/**
+ * Record that an operation used a group, keeping its handle cached and
+ * moving it up the recency list initializeAsync warms from. Must run on the
+ * group's lane.
+ * @param decrypted Whether the operation decrypted an application message
+ */
+- (void)groupWasUsed:(NSString *)groupId userId:(NSString *)userId decrypted:(BOOL)decrypted;
+
+/**
+ * Park a message the FFI rejected if its header says it is from a later
+ * epoch than the group's. It is processed again once a commit gets the
+ * group there, and the outcome sent as an MLSDeferredMessage event; nothing
+ * is parked while no JS listener is attached. Must run on the group's lane.
+ * @param epoch Set to the message's epoch when it is from a later epoch,
+ *              parked or not, so callers can report MLSErrorCodeWrongEpoch
+ * @return The ticket of the parked message, or 0 if it was not parked
+ */
+- (uint64_t)deferMessageBytes:(const uint8_t *)bytes
+                       length:(size_t)length
+                      groupId:(const char *)groupId
+                       userId:(const char *)userId
+                       client:(void *)client
+                        epoch:(uint64_t *)epoch;
+
 /**
  * Initialize the MLS module
  * @param groupID The app group ID for shared storage (iOS only)
@@ -15,6 +122,23 @@
           resolver:(RCTPromiseResolveBlock)resolver
           rejecter:(RCTPromiseRejectBlock)rejecter;
 
+/**
+ * Initialize the MLS module in the background. Resolves at once; operations
+ * called afterwards run once the client exists. The groups used most
+ * recently in earlier runs are then preloaded, a few at a time: their FFI
+ * state, epoch and member list, and a handle when the Rust library exports
+ * mls_load_group. Progress and failures are reported as MLSStartup events.
+ * @param groupID The app group ID for shared storage (iOS only)
+ * @param options {warmGroups?: number} groups to preload, 8 by default, at
+ *        most the group handle limit
+ * @param resolver Promise resolver, called with YES
+ * @param rejecter Promise rejecter
+ */
+- (void)initializeAsync:(NSString *)groupID
+                options:(NSDictionary *)options
+               resolver:(RCTPromiseResolveBlock)resolver
+               rejecter:(RCTPromiseRejectBlock)rejecter;
+
 /**
  * Set storage encryption key for a user
  * @param userId The user ID
@@ -41,6 +165,69 @@
                resolver:(RCTPromiseResolveBlock)resolver
                rejecter:(RCTPromiseRejectBlock)rejecter;
 
+/**
+ * Give an identity its own client and execution lanes, so its work runs
+ * independently of other identities. Operations for the identity called
+ * after this wait for its queued work on the shared client, then run on the
+ * new one. Requires initialize.
+ * @param identity The identity
+ * @param resolver Promise resolver, called with NO if the identity already has a client
+ * @param rejecter Promise rejecter
+ */
+- (void)openClient:(NSString *)identity
+          resolver:(RCTPromiseResolveBlock)resolver
+          rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Release an identity's own client after its queued work has run. Later
+ * operations for the identity use the shared client again; the shared
+ * client waits for that queued work, so close idle identities.
+ * @param identity The identity
+ * @param resolver Promise resolver, called with NO if the identity had no client of its own
+ * @param rejecter Promise rejecter
+ */
+- (void)closeClient:(NSString *)identity
+           resolver:(RCTPromiseResolveBlock)resolver
+           rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Tune the SQLite connections of the Rust storage provider. Settings are kept
+ * across initialize; without storage support in the Rust library they are
+ * only recorded.
+ * @param options {wal?: bool, synchronous?: "off"|"normal"|"full",
+ *        cacheSizeKiB?: number, groupCommitIntervalMs?: number}
+ * @param resolver Promise resolver, called with the storage statistics
+ *        {supported, journalMode, synchronous, cacheSizeKiB, groupCommitIntervalMs,
+ *        openBatches, committedBatches, expiredBatches}
+ * @param rejecter Promise rejecter
+ */
+- (void)configureStorage:(NSDictionary *)options
+                resolver:(RCTPromiseResolveBlock)resolver
+                rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Start a batch for a user: the state changes of the operations scheduled
+ * until the matching endBatch share one storage transaction. Batches nest,
+ * and one left open for 10 seconds is committed by the bridge.
+ * @param userId The ID of the user whose storage the batch covers
+ * @param resolver Promise resolver, called with {depth, transactional}
+ * @param rejecter Promise rejecter
+ */
+- (void)beginBatch:(NSString *)userId
+          resolver:(RCTPromiseResolveBlock)resolver
+          rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * End the innermost batch for a user once the operations scheduled before
+ * it have run; the transaction commits when the outermost batch ends
+ * @param userId The ID of the user
+ * @param resolver Promise resolver, called with {depth, committed}
+ * @param rejecter Promise rejecter
+ */
+- (void)endBatch:(NSString *)userId
+        resolver:(RCTPromiseResolveBlock)resolver
+        rejecter:(RCTPromiseRejectBlock)rejecter;
+
 /**
  * Create a new MLS group
  * @param groupId The ID of the group
@@ -83,6 +270,136 @@
                         resolver:(RCTPromiseResolveBlock)resolver
                         rejecter:(RCTPromiseRejectBlock)rejecter;
 
+/**
+ * Join many groups in one call, e.g. when a provisioned device receives its
+ * Welcomes at once. Groups are joined in parallel on their own lanes, and
+ * the group states they store share one storage transaction (see
+ * beginBatch) that has committed when the promise resolves.
+ * @param receiverId The ID of the receiver
+ * @param welcomes Array of {groupId, welcome, ratchetTree?}
+ * @param resolver Promise resolver, called with one {groupId, joined, error?}
+ *                 per entry in input order; failed joins do not fail the batch
+ * @param rejecter Promise rejecter
+ */
+- (void)joinGroups:(NSString *)receiverId
+          welcomes:(NSArray *)welcomes
+          resolver:(RCTPromiseResolveBlock)resolver
+          rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Limit how many live group handles are cached. Handles from createGroup,
+ * joinGroup and joinGroupWithRatchetTree are kept until evicted; beyond
+ * the limit the least recently used handle is released.
+ * @param limit Maximum number of live group handles (must be positive)
+ * @param resolver Promise resolver
+ * @param rejecter Promise rejecter
+ */
+- (void)setGroupHandleLimit:(NSInteger)limit
+                   resolver:(RCTPromiseResolveBlock)resolver
+                   rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Release the cached handle for a group
+ * @param groupId The ID of the group
+ * @param resolver Promise resolver, called with whether a handle was released
+ * @param rejecter Promise rejecter
+ */
+- (void)evictGroupHandle:(NSString *)groupId
+                resolver:(RCTPromiseResolveBlock)resolver
+                rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Snapshot of bridge instrumentation. Every MLS operation records call and
+ * error counts, input/output byte sizes, and latency histograms for the
+ * whole call and for its decode, FFI and marshalling phases. The same
+ * phases are emitted as os_signpost intervals for Instruments.
+ * @param resolver Promise resolver, called with {operations, keyPackagePool, groupHandles,
+ *        exporterSecrets, storage, clients, startup, reorderBuffer, duplicateFilter, backgroundWork, keyRotation, proposalAggregation,
+ *        memory}; clients lists the
+ *        identities with a client of their own, and startup times the last initialize
+ *        in ms: {mode, clientReadyMs, warmedGroups, warmMs, firstDecryptMs, recentGroups}
+ * @param rejecter Promise rejecter
+ */
+- (void)getMetrics:(RCTPromiseResolveBlock)resolver
+          rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Bound the process footprint, which includes the Rust side. Over the
+ * budget the bridge trims as trimMemory does, moderately first and
+ * critically if that was not enough, and sends MLSMemoryTrimmed.
+ * @param budget Bytes; 0 removes the budget
+ * @param resolver Promise resolver, called with the memory metrics: {budgetBytes, footprintBytes,
+ *        availableBytes, warnings, pressureEvents, budgetTrims, trims: {low, moderate, critical},
+ *        released, lastTrimLevel, caches: {groupHandles, exporterSecretBytes, keyPackageBytes,
+ *        reorderBufferBytes, duplicateFilterBytes}}
+ * @param rejecter Promise rejecter
+ */
+- (void)setMemoryBudget:(double)budget
+               resolver:(RCTPromiseResolveBlock)resolver
+               rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Release cached state, least costly to get back first. Memory warnings
+ * trim at "critical" and memory pressure at "moderate" or "critical" by
+ * themselves. Group handles are released once the group work queued
+ * before the call has run.
+ * @param level "low": the least recently used half of the group handles and
+ *        every exporter secret; "moderate": every group handle too, and key
+ *        package pools down to their low-water mark; "critical": every pooled
+ *        key package too
+ * @param resolver Promise resolver, called with {level, groupHandles, exporterSecrets,
+ *        keyPackages, footprintBytes}: what was released and the footprint after
+ * @param rejecter Promise rejecter
+ */
+- (void)trimMemory:(NSString *)level
+          resolver:(RCTPromiseResolveBlock)resolver
+          rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Apply the app's battery policy to maintenance work
+ * @param powerMode "performance", "balanced", "powerSaver" or "ultraLowPower", as in
+ *        Utils/BatteryOptimizer.swift; work is held in ultraLowPower, in powerSaver while
+ *        in the background and in the system's Low Power Mode, for at most a minute
+ * @param inBackground Whether the app is in the background
+ * @param resolver Promise resolver, called with {powerMode, inBackground, lowPowerMode,
+ *        deferring, deferred, queued, started, cancelled}
+ * @param rejecter Promise rejecter
+ */
+- (void)setPowerMode:(NSString *)powerMode
+        inBackground:(BOOL)inBackground
+            resolver:(RCTPromiseResolveBlock)resolver
+            rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Cancel maintenance work that has not started yet; running work finishes
+ * @param groupId The group whose work to cancel, or empty for all work
+ * @param resolver Promise resolver, called with the number of operations cancelled
+ * @param rejecter Promise rejecter
+ */
+- (void)cancelBackgroundWork:(NSString *)groupId
+                    resolver:(RCTPromiseResolveBlock)resolver
+                    rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Clear the per-operation metrics
+ * @param resolver Promise resolver
+ * @param rejecter Promise rejecter
+ */
+- (void)resetMetrics:(RCTPromiseResolveBlock)resolver
+            rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Bound the buffer of messages that arrived before the commit of their epoch
+ * @param options {messagesPerGroup?: number, maxBytes?: number, epochsAhead?: number,
+ *        timeToLiveMs?: number}; messagesPerGroup 0 turns buffering off
+ * @param resolver Promise resolver, called with the limits and {messages, bytes,
+ *        parked, replayed, expired, evicted}
+ * @param rejecter Promise rejecter
+ */
+- (void)configureReorderBuffer:(NSDictionary *)options
+                      resolver:(RCTPromiseResolveBlock)resolver
+                      rejecter:(RCTPromiseRejectBlock)rejecter;
+
 /**
  * Export ratchet tree from a group
  * @param groupId The ID of the group
@@ -95,6 +412,37 @@
                  resolver:(RCTPromiseResolveBlock)resolver
                  rejecter:(RCTPromiseRejectBlock)rejecter;
 
+/**
+ * Export the ratchet tree of a group as raw bytes to a file, without
+ * building a base64 string
+ * @param groupId The ID of the group
+ * @param userId The ID of the user
+ * @param path Destination file path; written atomically
+ * @param resolver Promise resolver, called with the number of bytes written
+ * @param rejecter Promise rejecter
+ */
+- (void)exportRatchetTreeToFile:(NSString *)groupId
+                         userId:(NSString *)userId
+                           path:(NSString *)path
+                       resolver:(RCTPromiseResolveBlock)resolver
+                       rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Join an existing MLS group with a ratchet tree stored in a file
+ * @param groupId The ID of the group
+ * @param receiverId The ID of the receiver
+ * @param welcomeMessage The welcome message
+ * @param ratchetTreePath Path to a file of raw ratchet tree bytes, as written by exportRatchetTreeToFile
+ * @param resolver Promise resolver
+ * @param rejecter Promise rejecter
+ */
+- (void)joinGroupWithRatchetTreeFile:(NSString *)groupId
+                          receiverId:(NSString *)receiverId
+                      welcomeMessage:(NSString *)welcomeMessage
+                     ratchetTreePath:(NSString *)ratchetTreePath
+                            resolver:(RCTPromiseResolveBlock)resolver
+                            rejecter:(RCTPromiseRejectBlock)rejecter;
+
 /**
  * Add a member to an MLS group
  * @param groupId The ID of the group
@@ -116,7 +464,8 @@
  * @param groupId The ID of the group
  * @param creatorId The ID of the creator
  * @param receiverKeyPackages Array of key packages
- * @param resolver Promise resolver
+ * @param resolver Promise resolver, called with {commit, welcome?}; the macOS Rust
+ *        build returns no welcome, see MLSPlatform.h
  * @param rejecter Promise rejecter
  */
 - (void)addMembers:(NSString *)groupId
@@ -151,6 +500,93 @@ receiverKeyPackages:(NSArray *)receiverKeyPackages
                       resolver:(RCTPromiseResolveBlock)resolver
                       rejecter:(RCTPromiseRejectBlock)rejecter;
 
+/**
+ * Commit the group's proposals together instead of one commit per proposal.
+ * Proposals created, accepted or received for the group are committed once
+ * maxProposals are pending, maxDelay after the first, or when no proposal or
+ * message went through the bridge for idleMs. Enable it only for the member
+ * expected to commit, so members do not race to commit the same proposals.
+ * @param groupId The ID of the group
+ * @param userId The local member that commits
+ * @param resolver Promise resolver
+ * @param rejecter Promise rejecter
+ */
+- (void)enableProposalAggregation:(NSString *)groupId
+                           userId:(NSString *)userId
+                         resolver:(RCTPromiseResolveBlock)resolver
+                         rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Stop aggregating a group's proposals; those pending stay for an explicit commit
+ * @param groupId The ID of the group
+ * @param userId The local member
+ * @param resolver Promise resolver
+ * @param rejecter Promise rejecter
+ */
+- (void)disableProposalAggregation:(NSString *)groupId
+                            userId:(NSString *)userId
+                          resolver:(RCTPromiseResolveBlock)resolver
+                          rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Tune proposal aggregation; by default 8 proposals, 5 s or 0.5 s of quiet
+ * @param options {maxProposals?: number, maxDelayMs?: number, idleMs?: number}
+ * @param resolver Promise resolver, called with {maxProposals, maxDelayMs, idleMs, groups,
+ *        pendingProposals, commits, proposalsCommitted, failed}
+ * @param rejecter Promise rejecter
+ */
+- (void)configureProposalAggregation:(NSDictionary *)options
+                            resolver:(RCTPromiseResolveBlock)resolver
+                            rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Tell the bridge the network is idle: aggregating groups commit their pending proposals now
+ * @param resolver Promise resolver
+ * @param rejecter Promise rejecter
+ */
+- (void)flushProposals:(RCTPromiseResolveBlock)resolver
+              rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Self-update the group on a schedule instead of when JS asks. Rotations of
+ * enrolled groups are spread with jitter and capped in number; a
+ * commitPendingProposals close to a group's rotation is made as a
+ * self-update, so the rotation costs no commit of its own. Rotations wait
+ * while neither a mesh outbox nor a JS listener would send the commit.
+ * @param groupId The ID of the group
+ * @param userId The local member that rotates
+ * @param resolver Promise resolver
+ * @param rejecter Promise rejecter
+ */
+- (void)enableKeyRotation:(NSString *)groupId
+                   userId:(NSString *)userId
+                 resolver:(RCTPromiseResolveBlock)resolver
+                 rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Stop scheduled key rotation for a group
+ * @param groupId The ID of the group
+ * @param userId The local member
+ * @param resolver Promise resolver
+ * @param rejecter Promise rejecter
+ */
+- (void)disableKeyRotation:(NSString *)groupId
+                    userId:(NSString *)userId
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Tune scheduled key rotation; by default rotations are a day apart with 25% jitter, two at a time
+ * @param options {intervalMs?: number, jitter?: number, maxConcurrent?: number}; jitter is the
+ *        part of the interval over which rotations spread, from 0 to 1
+ * @param resolver Promise resolver, called with {intervalMs, jitter, maxConcurrent, groups,
+ *        inFlight, rotations, merged, failed, nextDueMs}
+ * @param rejecter Promise rejecter
+ */
+- (void)configureKeyRotation:(NSDictionary *)options
+                    resolver:(RCTPromiseResolveBlock)resolver
+                    rejecter:(RCTPromiseRejectBlock)rejecter;
+
 /**
  * Generate a key package
  * @param identity The identity
@@ -173,6 +609,39 @@ receiverKeyPackages:(NSArray *)receiverKeyPackages
                    resolver:(RCTPromiseResolveBlock)resolver
                    rejecter:(RCTPromiseRejectBlock)rejecter;
 
+/**
+ * Size the per-identity pool of pre-generated key packages. generateKeyPackage
+ * and generateKeyPackages are served from the pool first; once fewer than
+ * lowWaterMark packages remain the pool is refilled to targetSize in the
+ * background at utility QoS.
+ * @param lowWaterMark Pool size that triggers a refill
+ * @param targetSize Pool size a refill tops up to; 0 disables pooling
+ * @param resolver Promise resolver
+ * @param rejecter Promise rejecter
+ */
+- (void)configureKeyPackagePool:(NSInteger)lowWaterMark
+                     targetSize:(NSInteger)targetSize
+                       resolver:(RCTPromiseResolveBlock)resolver
+                       rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Start filling the key package pool for an identity ahead of demand
+ * @param identity The identity
+ * @param resolver Promise resolver, called once the refill is scheduled
+ * @param rejecter Promise rejecter
+ */
+- (void)warmKeyPackagePool:(NSString *)identity
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Key package pool counters
+ * @param resolver Promise resolver, called with {hits, misses, generated, available}
+ * @param rejecter Promise rejecter
+ */
+- (void)getKeyPackagePoolStats:(RCTPromiseResolveBlock)resolver
+                      rejecter:(RCTPromiseRejectBlock)rejecter;
+
 /**
  * Import a key package
  * @param identity The identity
@@ -203,6 +672,25 @@ receiverKeyPackages:(NSArray *)receiverKeyPackages
             resolver:(RCTPromiseResolveBlock)resolver
             rejecter:(RCTPromiseRejectBlock)rejecter;
 
+/**
+ * Export a secret from an MLS group as raw bytes. Secrets are cached for the
+ * group's current epoch, so repeated derivations skip the FFI.
+ * @param groupId The ID of the group
+ * @param creatorId The ID of the creator
+ * @param label The label for the secret
+ * @param context The context data
+ * @param length The length of the secret in bytes
+ * @param resolver Promise resolver, receives the secret as base64
+ * @param rejecter Promise rejecter
+ */
+- (void)exportSecretBytes:(NSString *)groupId
+                creatorId:(NSString *)creatorId
+                    label:(NSString *)label
+                  context:(NSData *)context
+                   length:(NSInteger)length
+                 resolver:(RCTPromiseResolveBlock)resolver
+                 rejecter:(RCTPromiseRejectBlock)rejecter;
+
 /**
  * Encrypt a message
  * @param groupId The ID of the group
@@ -231,6 +719,35 @@ receiverKeyPackages:(NSArray *)receiverKeyPackages
               resolver:(RCTPromiseResolveBlock)resolver
               rejecter:(RCTPromiseRejectBlock)rejecter;
 
+/**
+ * Encrypt a binary payload as an application message. Unlike encryptMessage
+ * the plaintext is length-delimited, so it may contain NUL bytes.
+ * @param groupId The ID of the group
+ * @param creatorId The ID of the sender
+ * @param data Base64-encoded plaintext bytes
+ * @param resolver Promise resolver, called with the base64 ciphertext
+ * @param rejecter Promise rejecter
+ */
+- (void)encryptBytes:(NSString *)groupId
+           creatorId:(NSString *)creatorId
+                data:(NSString *)data
+            resolver:(RCTPromiseResolveBlock)resolver
+            rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Decrypt an application message back to its exact plaintext bytes
+ * @param groupId The ID of the group
+ * @param creatorId The ID of the receiving member
+ * @param encryptedMessage Base64-encoded ciphertext
+ * @param resolver Promise resolver, called with the base64 plaintext
+ * @param rejecter Promise rejecter
+ */
+- (void)decryptBytes:(NSString *)groupId
+           creatorId:(NSString *)creatorId
+    encryptedMessage:(NSString *)encryptedMessage
+            resolver:(RCTPromiseResolveBlock)resolver
+            rejecter:(RCTPromiseRejectBlock)rejecter;
+
 /**
  * Create a commit
  * @param groupId The ID of the group
@@ -247,6 +764,40 @@ receiverKeyPackages:(NSArray *)receiverKeyPackages
             resolver:(RCTPromiseResolveBlock)resolver
             rejecter:(RCTPromiseRejectBlock)rejecter;
 
+/**
+ * Add and remove many members of a group in a single commit.
+ *
+ * Progress is reported through MLSMembershipProgress events tagged with
+ * `operationId` (a UUID is generated when it is empty).
+ *
+ * Resolves to:
+ * {
+ *   operationId: string,
+ *   commit: string,          // base64 commit, to be sent to the existing members
+ *   welcome?: string,        // base64 Welcome, present when members were added
+ *   recipients: [{ identity, keyPackageIndex }],  // who to send the Welcome to, one per add
+ *   removed: number[],       // member indices removed, sorted and deduplicated
+ *   memberChanges?: { version, added, removed }   // when the group's roster is tracked
+ * }
+ *
+ * If staging fails part-way, remove proposals created for earlier indices
+ * stay pending in the group until the next commit.
+ * @param groupId The ID of the group
+ * @param creatorId The ID of the committer
+ * @param adds Base64 key packages, or {identity, keyPackage} objects
+ * @param removes Member indices to remove
+ * @param operationId Identifier reported in progress events
+ * @param resolver Promise resolver
+ * @param rejecter Promise rejecter
+ */
+- (void)bulkUpdateMembers:(NSString *)groupId
+                creatorId:(NSString *)creatorId
+                     adds:(NSArray *)adds
+                  removes:(NSArray *)removes
+              operationId:(NSString *)operationId
+                 resolver:(RCTPromiseResolveBlock)resolver
+                 rejecter:(RCTPromiseRejectBlock)rejecter;
+
 /**
  * Get current epoch
  * @param groupId The ID of the group
@@ -264,7 +815,13 @@ receiverKeyPackages:(NSArray *)receiverKeyPackages
  * @param groupId The ID of the group
  * @param userId The ID of the user processing the message
  * @param encryptedMessage The encrypted message to process (base64 encoded)
- * @param resolver Promise resolver
+ * @param resolver Promise resolver, called with {type: "deferred", epoch, ticket} for a
+ *                 message from a later epoch, see MLSDeferredMessage, and with
+ *                 {type: "duplicate"} for a copy of a message already processed or deferred.
+ *                 Messages are only deferred while JS listens to the module's events;
+ *                 otherwise, or when the reorder buffer will not take it, a message from
+ *                 a later epoch is rejected with code "wrong_epoch" and can be sent again
+ *                 after the commit that gets there
  * @param rejecter Promise rejecter
  */
 - (void)processMessage:(NSString *)groupId
@@ -273,6 +830,56 @@ receiverKeyPackages:(NSArray *)receiverKeyPackages
               resolver:(RCTPromiseResolveBlock)resolver
               rejecter:(RCTPromiseRejectBlock)rejecter;
 
+/**
+ * Process a batch of MLS messages for one group in a single bridge call,
+ * sharing one storage transaction (see beginBatch). Where the library
+ * supports storage batches the batch runs exclusively, waiting for the
+ * user's work on other groups, and unless a beginBatch is open the
+ * transaction has committed when it resolves. Otherwise it runs on the
+ * group's lane like processMessage.
+ * @param groupId The ID of the group
+ * @param userId The ID of the user processing the messages
+ * @param encryptedMessages Array of encrypted messages (base64 encoded), applied in order
+ * @param resolver Promise resolver, called with one result per message; messages that
+ *                 fail yield {type: "error", error, code, category, retryable} without
+ *                 failing the batch, ones from a later epoch {type: "deferred", epoch,
+ *                 ticket}, and copies of messages already processed or deferred
+ *                 {type: "duplicate"}. As with processMessage, deferring needs an
+ *                 event listener; without one those are errors with code "wrong_epoch"
+ * @param rejecter Promise rejecter
+ */
+- (void)processMessages:(NSString *)groupId
+                 userId:(NSString *)userId
+      encryptedMessages:(NSArray *)encryptedMessages
+               resolver:(RCTPromiseResolveBlock)resolver
+               rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * processMessage with the result as one compact record instead of a
+ * dictionary: a fixed header with the type, validated flag and epoch, then
+ * the sender and content bytes. See MLSCompactResult.h for the layout.
+ * Content is left to the caller to read as UTF-8 or bytes; a commit's
+ * memberChanges are not included, see MLSMembershipChanged.
+ * @param resolver Promise resolver, called with the record (base64 encoded)
+ */
+- (void)processMessageCompact:(NSString *)groupId
+                       userId:(NSString *)userId
+             encryptedMessage:(NSString *)encryptedMessage
+                     resolver:(RCTPromiseResolveBlock)resolver
+                     rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * processMessages with compact records, one per message in order and back
+ * to back in one buffer. A failing message yields an error record carrying
+ * its error code.
+ * @param resolver Promise resolver, called with the records (base64 encoded)
+ */
+- (void)processMessagesCompact:(NSString *)groupId
+                        userId:(NSString *)userId
+             encryptedMessages:(NSArray *)encryptedMessages
+                      resolver:(RCTPromiseResolveBlock)resolver
+                      rejecter:(RCTPromiseRejectBlock)rejecter;
+
 /**
  * Accept a proposal
  * @param groupId The ID of the group
@@ -354,7 +961,22 @@ receiverKeyPackages:(NSArray *)receiverKeyPackages
                        rejecter:(RCTPromiseRejectBlock)rejecter;
 
 /**
- * Get group members
+ * Create application messages for a batch of plaintexts in one bridge call
+ * @param groupId The ID of the group
+ * @param userId The ID of the user
+ * @param messages Array of plaintext messages, encrypted in order
+ * @param resolver Promise resolver, called with one base64 ciphertext per message
+ *                 (null where encryption failed or the item is not a string)
+ * @param rejecter Promise rejecter
+ */
+- (void)createApplicationMessages:(NSString *)groupId
+                           userId:(NSString *)userId
+                         messages:(NSArray *)messages
+                         resolver:(RCTPromiseResolveBlock)resolver
+                         rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Get group members, served from the cached roster after the first call
  * @param groupId The ID of the group
  * @param userId The ID of the user
  * @param resolver Promise resolver
@@ -365,4 +987,42 @@ receiverKeyPackages:(NSArray *)receiverKeyPackages
             resolver:(RCTPromiseResolveBlock)resolver
             rejecter:(RCTPromiseRejectBlock)rejecter;
 
+/**
+ * Check whether an identity is a member of a group
+ * @param groupId The ID of the group
+ * @param userId The ID of the user whose view of the group is used
+ * @param identity The identity to look up
+ * @param resolver Promise resolver, called with a boolean
+ * @param rejecter Promise rejecter
+ */
+- (void)isGroupMember:(NSString *)groupId
+               userId:(NSString *)userId
+             identity:(NSString *)identity
+             resolver:(RCTPromiseResolveBlock)resolver
+             rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Get membership changes since a roster version. processMessage results for
+ * commits carry the same delta as `memberChanges`.
+ * @param groupId The ID of the group
+ * @param userId The ID of the user whose view of the group is used
+ * @param sinceVersion Last roster version the caller has seen, or 0
+ * @param resolver Promise resolver, called with {version, added, removed}, or
+ *                 {version, reset: true, members} when sinceVersion is too old
+ * @param rejecter Promise rejecter
+ */
+- (void)groupMemberChanges:(NSString *)groupId
+                    userId:(NSString *)userId
+              sinceVersion:(NSInteger)sinceVersion
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter;
+
+/**
+ * Install the binary transport on the JS runtime as `global.__mlsBinary`.
+ * Its functions take and return ArrayBuffers instead of base64 strings and
+ * return Rust-owned buffers without copying. See MLSBinaryBindings.h.
+ * @return YES if the bindings were installed, NO if no JSI runtime is available
+ */
+- (id)installBinaryTransport;
+
 @end
\ No newline at end of file
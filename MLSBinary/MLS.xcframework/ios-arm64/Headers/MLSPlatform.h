@@ -0,0 +1,73 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * The platform-specific parts of the bridge. Everything else in the module
+ * is the same source on iOS and macOS.
+ *
+ * The iOS and macOS Rust builds differ in a few results, and every such
+ * difference is decoded here. The other entry points, mls_remove_members
+ * among them, have one ABI: it returns the commit with its length in
+ * out_count on both builds.
+ */
+
+/**
+ * Status the int-returning FFI calls (mls_process_message,
+ * mls_accept_proposal, mls_add_keypackage) report on success. The iOS and
+ * macOS Rust builds disagree on it.
+ */
+extern const int MLSFFIStatusOK;
+
+// Commit and welcome of an mls_add_members result, each a Rust buffer for
+// mls_free_bytes. The macOS build returns no welcome.
+typedef struct {
+    uint8_t *_Nullable commit;
+    int commitLength;
+    uint8_t *_Nullable welcome;
+    int welcomeLength;
+} MLSAddMembersOutput;
+
+/**
+ * Unpack what mls_add_members returned, releasing the containers:
+ * - iOS: `result` is a malloc'd array of the commit and welcome buffers,
+ *   with their lengths in the malloc'd `lengths`
+ * - macOS: `result` is the commit buffer itself, its length in lengths[0]
+ * Returns NO, with nothing left to free, when the call failed.
+ */
+BOOL MLSUnpackAddMembersResult(uint8_t *_Nullable result, int *_Nullable lengths, int count, MLSAddMembersOutput *output);
+
+/**
+ * Release what mls_generate_keypackages returned once the strings are copied:
+ * - iOS: each string, then the array, then the malloc'd `lengths`
+ * - macOS: the array with mls_free_string_array, which frees the strings
+ */
+void MLSFreeKeyPackageStrings(char *_Nullable *_Nullable strings, int count, int *_Nullable lengths);
+
+/**
+ * Create and return the directory the Rust storage provider keeps its
+ * per-identity databases in:
+ * - iOS: "MLSStorage" in the app group container for `groupID`, falling
+ *   back to the home directory when the container is unavailable
+ * - macOS: "MLSStorage" in Application Support; `groupID` is ignored
+ */
+NSString *_Nullable MLSResolveStorageDirectory(NSString *_Nullable groupID, NSError *_Nullable *_Nullable error);
+
+/**
+ * Posted when the system is about to kill the app for its memory use:
+ * - iOS: UIApplicationDidReceiveMemoryWarningNotification
+ * - macOS: nil; the memory pressure dispatch source is the only signal
+ */
+NSNotificationName _Nullable MLSMemoryWarningNotification(void);
+
+// Memory the system charges the process with, including Rust allocations
+uint64_t MLSProcessFootprint(void);
+
+/**
+ * Memory the process can still allocate before it is killed:
+ * - iOS 13 and later: os_proc_available_memory
+ * - otherwise 0, for unknown
+ */
+uint64_t MLSAvailableMemory(void);
+
+NS_ASSUME_NONNULL_END
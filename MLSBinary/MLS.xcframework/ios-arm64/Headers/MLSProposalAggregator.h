@@ -0,0 +1,71 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Why the aggregator asked for a commit
+typedef NS_ENUM(NSInteger, MLSProposalCommitReason) {
+    // maxProposals were pending
+    MLSProposalCommitReasonCount,
+    // The oldest pending proposal waited maxDelay
+    MLSProposalCommitReasonTime,
+    // No proposal or message for idleDelay
+    MLSProposalCommitReasonIdle,
+    // The app said the network is idle
+    MLSProposalCommitReasonFlush,
+};
+
+/**
+ * Collects the proposals of enrolled groups so a burst of adds and removes
+ * goes out as one commit instead of one per proposal.
+ *
+ * A group's pending proposals are handed to `commitHandler` once
+ * `maxProposals` are pending, once the oldest has waited `maxDelay`, or once
+ * neither a proposal for the group nor a message for any group went through
+ * the bridge for `idleDelay`, whichever comes first. The handler reports the
+ * outcome with groupDidCommit or commitDidFail. Any new epoch of the group,
+ * including one from another member's commit, consumes what was pending.
+ *
+ * Thread-safe; group lanes on the scheduler report proposals concurrently.
+ */
+@interface MLSProposalAggregator : NSObject
+
+- (instancetype)initWithMaxProposals:(NSUInteger)maxProposals
+                            maxDelay:(NSTimeInterval)maxDelay
+                           idleDelay:(NSTimeInterval)idleDelay;
+
+// Called on a private queue; at most one commit per group is outstanding
+@property (atomic, copy, nullable) void (^commitHandler)(NSString *groupId, NSString *userId, MLSProposalCommitReason reason);
+
+- (void)setMaxProposals:(NSUInteger)maxProposals maxDelay:(NSTimeInterval)maxDelay idleDelay:(NSTimeInterval)idleDelay;
+
+- (void)addGroup:(NSString *)groupId userId:(NSString *)userId;
+
+- (void)removeGroup:(NSString *)groupId userId:(NSString *)userId;
+
+// Drop every group of a local member, e.g. when its client closes
+- (void)removeUser:(NSString *)userId;
+
+- (void)removeAllGroups;
+
+// A proposal of an enrolled group is now pending
+- (void)proposalAddedToGroup:(NSString *)groupId userId:(NSString *)userId;
+
+// A message went through the bridge, so the network is not idle. Cheap
+// enough for every message.
+- (void)noteTraffic;
+
+// Commit every enrolled group with pending proposals now
+- (void)flush;
+
+// The group moved to a new epoch, which consumed its pending proposals
+- (void)groupDidCommit:(NSString *)groupId userId:(NSString *)userId;
+
+// A commit the handler was asked for failed; the proposals wait another maxDelay
+- (void)commitDidFail:(NSString *)groupId userId:(NSString *)userId;
+
+// {maxProposals, maxDelayMs, idleMs, groups, pendingProposals, commits, proposalsCommitted, failed}
+- (NSDictionary *)statistics;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,294 @@
+#import "MLSProposalAggregator.h"
+#import <os/lock.h>
+
+// Commits only need to be roughly on time, so let the system batch the wakeup
+static const uint64_t MLSProposalTimerLeeway = 100 * NSEC_PER_MSEC;
+
+static NSString *MLSProposalGroupKey(NSString *groupId, NSString *userId)
+{
+    return [NSString stringWithFormat:@"%@\n%@", groupId, userId];
+}
+
+static NSTimeInterval MLSUptime(void)
+{
+    return NSProcessInfo.processInfo.systemUptime;
+}
+
+@interface MLSProposalGroup : NSObject
+
+@property (nonatomic, copy) NSString *groupId;
+@property (nonatomic, copy) NSString *userId;
+@property (nonatomic, assign) NSUInteger pending;
+@property (nonatomic, assign) NSTimeInterval firstAt;
+@property (nonatomic, assign) NSTimeInterval lastAt;
+// Handed to the commit handler and not reported back yet
+@property (nonatomic, assign) BOOL committing;
+
+@end
+
+@implementation MLSProposalGroup
+@end
+
+@implementation MLSProposalAggregator
+{
+    NSUInteger _maxProposals;
+    NSTimeInterval _maxDelay;
+    NSTimeInterval _idleDelay;
+    // "groupId\nuserId" -> group
+    NSMutableDictionary<NSString *, MLSProposalGroup *> *_groups;
+    NSTimeInterval _lastTrafficAt;
+    uint64_t _commits;
+    uint64_t _proposalsCommitted;
+    uint64_t _failed;
+    // Runs the timer and the commit handler
+    dispatch_queue_t _queue;
+    dispatch_source_t _timer;
+    os_unfair_lock _lock;
+}
+
+- (instancetype)initWithMaxProposals:(NSUInteger)maxProposals maxDelay:(NSTimeInterval)maxDelay idleDelay:(NSTimeInterval)idleDelay
+{
+    if (self = [super init]) {
+        _groups = [NSMutableDictionary dictionary];
+        _queue = dispatch_queue_create("com.reactnativemls.MLSQueue.proposals",
+                                       dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+        _lock = OS_UNFAIR_LOCK_INIT;
+
+        _timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _queue);
+        __weak MLSProposalAggregator *weakSelf = self;
+        dispatch_source_set_event_handler(_timer, ^{
+            [weakSelf commitExpiredGroups];
+        });
+        dispatch_source_set_timer(_timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, MLSProposalTimerLeeway);
+        dispatch_resume(_timer);
+        [self setMaxProposals:maxProposals maxDelay:maxDelay idleDelay:idleDelay];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    dispatch_source_cancel(_timer);
+}
+
+- (void)setMaxProposals:(NSUInteger)maxProposals maxDelay:(NSTimeInterval)maxDelay idleDelay:(NSTimeInterval)idleDelay
+{
+    os_unfair_lock_lock(&_lock);
+    _maxProposals = MAX(maxProposals, (NSUInteger)1);
+    _maxDelay = MAX(maxDelay, 0);
+    _idleDelay = MAX(idleDelay, 0);
+    os_unfair_lock_unlock(&_lock);
+    [self updateTimer];
+}
+
+- (void)addGroup:(NSString *)groupId userId:(NSString *)userId
+{
+    NSString *key = MLSProposalGroupKey(groupId, userId);
+
+    os_unfair_lock_lock(&_lock);
+    if (_groups[key] == nil) {
+        MLSProposalGroup *group = [[MLSProposalGroup alloc] init];
+        group.groupId = groupId;
+        group.userId = userId;
+        _groups[key] = group;
+    }
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)removeGroup:(NSString *)groupId userId:(NSString *)userId
+{
+    os_unfair_lock_lock(&_lock);
+    [_groups removeObjectForKey:MLSProposalGroupKey(groupId, userId)];
+    os_unfair_lock_unlock(&_lock);
+    [self updateTimer];
+}
+
+- (void)removeUser:(NSString *)userId
+{
+    os_unfair_lock_lock(&_lock);
+    NSMutableArray<NSString *> *keys = [NSMutableArray array];
+    [_groups enumerateKeysAndObjectsUsingBlock:^(NSString *key, MLSProposalGroup *group, BOOL *stop) {
+        if ([group.userId isEqualToString:userId]) {
+            [keys addObject:key];
+        }
+    }];
+    [_groups removeObjectsForKeys:keys];
+    os_unfair_lock_unlock(&_lock);
+    [self updateTimer];
+}
+
+- (void)removeAllGroups
+{
+    os_unfair_lock_lock(&_lock);
+    [_groups removeAllObjects];
+    os_unfair_lock_unlock(&_lock);
+    [self updateTimer];
+}
+
+- (void)proposalAddedToGroup:(NSString *)groupId userId:(NSString *)userId
+{
+    void (^handler)(NSString *, NSString *, MLSProposalCommitReason) = self.commitHandler;
+
+    os_unfair_lock_lock(&_lock);
+    MLSProposalGroup *group = _groups[MLSProposalGroupKey(groupId, userId)];
+    if (group == nil) {
+        os_unfair_lock_unlock(&_lock);
+        return;
+    }
+    NSTimeInterval now = MLSUptime();
+    if (group.pending == 0) {
+        group.firstAt = now;
+    }
+    group.pending++;
+    group.lastAt = now;
+    BOOL commitNow = handler != nil && !group.committing && group.pending >= _maxProposals;
+    group.committing = group.committing || commitNow;
+    os_unfair_lock_unlock(&_lock);
+
+    if (commitNow) {
+        dispatch_async(_queue, ^{
+            handler(groupId, userId, MLSProposalCommitReasonCount);
+        });
+    } else {
+        [self updateTimer];
+    }
+}
+
+- (void)noteTraffic
+{
+    // Only moves idle deadlines later, so the timer can fire early and recheck
+    os_unfair_lock_lock(&_lock);
+    _lastTrafficAt = MLSUptime();
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)flush
+{
+    dispatch_async(_queue, ^{
+        [self commitGroupsWithReason:MLSProposalCommitReasonFlush];
+    });
+}
+
+- (void)groupDidCommit:(NSString *)groupId userId:(NSString *)userId
+{
+    os_unfair_lock_lock(&_lock);
+    MLSProposalGroup *group = _groups[MLSProposalGroupKey(groupId, userId)];
+    if (group.committing) {
+        _commits++;
+        _proposalsCommitted += group.pending;
+    }
+    group.pending = 0;
+    group.committing = NO;
+    os_unfair_lock_unlock(&_lock);
+    [self updateTimer];
+}
+
+- (void)commitDidFail:(NSString *)groupId userId:(NSString *)userId
+{
+    os_unfair_lock_lock(&_lock);
+    MLSProposalGroup *group = _groups[MLSProposalGroupKey(groupId, userId)];
+    if (group != nil) {
+        _failed++;
+        group.committing = NO;
+        group.firstAt = MLSUptime();
+    }
+    os_unfair_lock_unlock(&_lock);
+    [self updateTimer];
+}
+
+- (NSDictionary *)statistics
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger pending = 0;
+    for (MLSProposalGroup *group in _groups.objectEnumerator) {
+        pending += group.pending;
+    }
+    NSDictionary *statistics = @{
+        @"maxProposals": @(_maxProposals),
+        @"maxDelayMs": @(_maxDelay * 1000.0),
+        @"idleMs": @(_idleDelay * 1000.0),
+        @"groups": @(_groups.count),
+        @"pendingProposals": @(pending),
+        @"commits": @(_commits),
+        @"proposalsCommitted": @(_proposalsCommitted),
+        @"failed": @(_failed),
+    };
+    os_unfair_lock_unlock(&_lock);
+    return statistics;
+}
+
+// Caller holds _lock. When the group's proposals are to be committed, or 0
+// if it has none waiting.
+- (NSTimeInterval)deadlineOfGroup:(MLSProposalGroup *)group
+{
+    if (group.pending == 0 || group.committing) {
+        return 0;
+    }
+    return MIN(group.firstAt + _maxDelay, MAX(group.lastAt, _lastTrafficAt) + _idleDelay);
+}
+
+- (void)updateTimer
+{
+    dispatch_async(_queue, ^{
+        // Without a handler nothing can be committed, and the timer would fire at once forever
+        BOOL canCommit = self.commitHandler != nil;
+        NSTimeInterval next = 0;
+        os_unfair_lock_lock(&self->_lock);
+        for (MLSProposalGroup *group in self->_groups.objectEnumerator) {
+            if (!canCommit) {
+                break;
+            }
+            NSTimeInterval deadline = [self deadlineOfGroup:group];
+            if (deadline > 0 && (next == 0 || deadline < next)) {
+                next = deadline;
+            }
+        }
+        os_unfair_lock_unlock(&self->_lock);
+
+        dispatch_time_t start = DISPATCH_TIME_FOREVER;
+        if (next > 0) {
+            start = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(MAX(next - MLSUptime(), 0) * NSEC_PER_SEC));
+        }
+        dispatch_source_set_timer(self->_timer, start, DISPATCH_TIME_FOREVER, MLSProposalTimerLeeway);
+    });
+}
+
+// Runs on _queue
+- (void)commitExpiredGroups
+{
+    [self commitGroupsWithReason:MLSProposalCommitReasonIdle];
+}
+
+// Runs on _queue. Flush commits every group with proposals; otherwise only
+// those past their deadline, for the reason that was reached first.
+- (void)commitGroupsWithReason:(MLSProposalCommitReason)flushOrIdle
+{
+    void (^handler)(NSString *, NSString *, MLSProposalCommitReason) = self.commitHandler;
+    if (handler == nil) {
+        return;
+    }
+    NSMutableArray<NSArray *> *commits = [NSMutableArray array];
+
+    os_unfair_lock_lock(&_lock);
+    NSTimeInterval now = MLSUptime();
+    for (MLSProposalGroup *group in _groups.objectEnumerator) {
+        NSTimeInterval deadline = [self deadlineOfGroup:group];
+        if (deadline == 0 || (flushOrIdle != MLSProposalCommitReasonFlush && deadline > now)) {
+            continue;
+        }
+        MLSProposalCommitReason reason = flushOrIdle;
+        if (reason != MLSProposalCommitReasonFlush && group.firstAt + _maxDelay <= now) {
+            reason = MLSProposalCommitReasonTime;
+        }
+        group.committing = YES;
+        [commits addObject:@[group.groupId, group.userId, @(reason)]];
+    }
+    os_unfair_lock_unlock(&_lock);
+
+    for (NSArray *commit in commits) {
+        handler(commit[0], commit[1], (MLSProposalCommitReason)[commit[2] integerValue]);
+    }
+    [self updateTimer];
+}
+
+@end
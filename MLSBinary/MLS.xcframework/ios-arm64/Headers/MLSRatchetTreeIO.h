@@ -0,0 +1,34 @@
+#pragma once
+
+#import <Foundation/Foundation.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Base64-encode a byte range into a NUL-terminated C string, the form the
+ * Rust FFI takes ratchet trees in. Encoding goes straight into one buffer
+ * with no intermediate NSString.
+ * @param bytes The bytes to encode
+ * @param length Number of bytes
+ * @return A malloc'd string the caller must free(), or NULL on allocation failure
+ */
+char *MLSCopyBase64CString(const uint8_t *bytes, size_t length);
+
+/**
+ * Base64-encode the contents of a file into a NUL-terminated C string. The
+ * file is read in fixed-size chunks so only the encoded output is resident,
+ * never a second full copy of the raw tree.
+ * @param path Path to a file holding raw ratchet tree bytes
+ * @param error Set when the file cannot be read
+ * @return A malloc'd string the caller must free(), or NULL on failure
+ */
+char *MLSCopyBase64CStringFromFile(NSString *path, NSError **error);
+
+#ifdef __cplusplus
+}
+#endif
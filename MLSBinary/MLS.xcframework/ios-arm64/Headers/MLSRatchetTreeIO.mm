@@ -0,0 +1,102 @@
+#import "MLSRatchetTreeIO.h"
+
+#include <stdlib.h>
+
+// Raw bytes read per step when encoding a file; a multiple of 3 so chunk
+// boundaries never need padding
+static const NSUInteger MLSRatchetTreeReadChunk = 48 * 1024;
+
+static const char MLSBase64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static size_t MLSBase64EncodedLength(size_t length)
+{
+    return ((length + 2) / 3) * 4;
+}
+
+// Encode into `out`, returning the number of characters written
+static size_t MLSBase64Encode(const uint8_t *bytes, size_t length, char *out)
+{
+    char *cursor = out;
+    size_t i = 0;
+    for (; i + 3 <= length; i += 3) {
+        uint32_t triple = ((uint32_t)bytes[i] << 16) | ((uint32_t)bytes[i + 1] << 8) | bytes[i + 2];
+        *cursor++ = MLSBase64Alphabet[(triple >> 18) & 0x3F];
+        *cursor++ = MLSBase64Alphabet[(triple >> 12) & 0x3F];
+        *cursor++ = MLSBase64Alphabet[(triple >> 6) & 0x3F];
+        *cursor++ = MLSBase64Alphabet[triple & 0x3F];
+    }
+
+    size_t remaining = length - i;
+    if (remaining > 0) {
+        uint32_t triple = (uint32_t)bytes[i] << 16;
+        if (remaining == 2) {
+            triple |= (uint32_t)bytes[i + 1] << 8;
+        }
+        *cursor++ = MLSBase64Alphabet[(triple >> 18) & 0x3F];
+        *cursor++ = MLSBase64Alphabet[(triple >> 12) & 0x3F];
+        *cursor++ = remaining == 2 ? MLSBase64Alphabet[(triple >> 6) & 0x3F] : '=';
+        *cursor++ = '=';
+    }
+    return (size_t)(cursor - out);
+}
+
+char *MLSCopyBase64CString(const uint8_t *bytes, size_t length)
+{
+    char *encoded = (char *)malloc(MLSBase64EncodedLength(length) + 1);
+    if (encoded == NULL) {
+        return NULL;
+    }
+    size_t written = MLSBase64Encode(bytes, length, encoded);
+    encoded[written] = '\0';
+    return encoded;
+}
+
+char *MLSCopyBase64CStringFromFile(NSString *path, NSError **error)
+{
+    NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:path error:error];
+    if (!attributes) {
+        return NULL;
+    }
+
+    NSFileHandle *handle = [NSFileHandle fileHandleForReadingAtPath:path];
+    if (!handle) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadNoPermissionError userInfo:@{NSFilePathErrorKey: path}];
+        }
+        return NULL;
+    }
+
+    size_t fileLength = (size_t)[attributes fileSize];
+    char *encoded = (char *)malloc(MLSBase64EncodedLength(fileLength) + 1);
+    if (encoded == NULL) {
+        [handle closeFile];
+        return NULL;
+    }
+
+    size_t written = 0;
+    size_t consumed = 0;
+    while (consumed < fileLength) {
+        @autoreleasepool {
+            NSData *chunk = [handle readDataOfLength:MLSRatchetTreeReadChunk];
+            if (chunk.length == 0) {
+                break;
+            }
+            // Never write past the size reported up front, even if the file grew
+            size_t usable = MIN((size_t)chunk.length, fileLength - consumed);
+            written += MLSBase64Encode((const uint8_t *)chunk.bytes, usable, encoded + written);
+            consumed += usable;
+        }
+    }
+    [handle closeFile];
+
+    if (consumed != fileLength) {
+        free(encoded);
+        if (error) {
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileReadCorruptFileError userInfo:@{NSFilePathErrorKey: path}];
+        }
+        return NULL;
+    }
+
+    encoded[written] = '\0';
+    return encoded;
+}
@@ -0,0 +1,179 @@
+#import "MLSStorageTuning.h"
+#import "MLSFFI.h"
+#import "MLSPlatform.h"
+#import <dlfcn.h>
+#import <os/lock.h>
+
+// About SQLite's own default page cache
+static const NSUInteger MLSDefaultStorageCacheSizeKiB = 2048;
+
+static NSString *MLSSynchronousName(MLSStorageSynchronous synchronous)
+{
+    switch (synchronous) {
+        case MLSStorageSynchronousOff:
+            return @"off";
+        case MLSStorageSynchronousFull:
+            return @"full";
+        case MLSStorageSynchronousNormal:
+        default:
+            return @"normal";
+    }
+}
+
+@implementation MLSStorageTuning
+{
+    mls_storage_configure_fn _configure;
+    mls_storage_batch_fn _beginBatch;
+    mls_storage_batch_fn _endBatch;
+
+    NSMutableDictionary<NSString *, NSNumber *> *_depths;
+    NSMutableDictionary<NSString *, NSNumber *> *_generations;
+    uint64_t _nextGeneration;
+    uint64_t _committedBatches;
+    uint64_t _expiredBatches;
+
+    // Held across the begin and end calls into Rust, so they reach the
+    // storage layer in the order the depths changed
+    os_unfair_lock _lock;
+}
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _configure = (mls_storage_configure_fn)dlsym(RTLD_DEFAULT, "mls_storage_configure");
+        _beginBatch = (mls_storage_batch_fn)dlsym(RTLD_DEFAULT, "mls_storage_begin_batch");
+        _endBatch = (mls_storage_batch_fn)dlsym(RTLD_DEFAULT, "mls_storage_end_batch");
+
+        _journalModeWAL = YES;
+        _synchronous = MLSStorageSynchronousNormal;
+        _cacheSizeKiB = MLSDefaultStorageCacheSizeKiB;
+        _groupCommitIntervalMs = 0;
+
+        _depths = [NSMutableDictionary dictionary];
+        _generations = [NSMutableDictionary dictionary];
+        _lock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+- (BOOL)supported
+{
+    return _configure != NULL && _beginBatch != NULL && _endBatch != NULL;
+}
+
+- (BOOL)apply
+{
+    if (!self.supported) {
+        return NO;
+    }
+    int status = _configure(self.journalModeWAL ? 1 : 0,
+                            (int)self.synchronous,
+                            (int)MIN(self.cacheSizeKiB, (NSUInteger)INT_MAX),
+                            (unsigned int)MIN(self.groupCommitIntervalMs, (NSUInteger)UINT_MAX));
+    return status == MLSFFIStatusOK;
+}
+
+- (NSUInteger)beginBatchForIdentity:(NSString *)identity generation:(uint64_t *)generation
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger depth = _depths[identity].unsignedIntegerValue + 1;
+    if (depth == 1) {
+        _generations[identity] = @(++_nextGeneration);
+        if (self.supported) {
+            _beginBatch(identity.UTF8String);
+        }
+    }
+    _depths[identity] = @(depth);
+    *generation = _generations[identity].unsignedLongLongValue;
+    os_unfair_lock_unlock(&_lock);
+    return depth;
+}
+
+- (NSInteger)endBatchForIdentity:(NSString *)identity
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger depth = _depths[identity].unsignedIntegerValue;
+    if (depth == 0) {
+        os_unfair_lock_unlock(&_lock);
+        return -1;
+    }
+    if (depth == 1) {
+        [self commitBatchForIdentity:identity];
+    } else {
+        _depths[identity] = @(depth - 1);
+    }
+    os_unfair_lock_unlock(&_lock);
+    return (NSInteger)depth - 1;
+}
+
+- (NSInteger)endBatchForIdentity:(NSString *)identity generation:(uint64_t)generation
+{
+    os_unfair_lock_lock(&_lock);
+    BOOL open = _depths[identity] != nil && _generations[identity].unsignedLongLongValue == generation;
+    os_unfair_lock_unlock(&_lock);
+    // Only barriers open and close batches, so the check still holds
+    return open ? [self endBatchForIdentity:identity] : -1;
+}
+
+- (BOOL)expireBatchForIdentity:(NSString *)identity generation:(uint64_t)generation
+{
+    os_unfair_lock_lock(&_lock);
+    BOOL open = _depths[identity] != nil && _generations[identity].unsignedLongLongValue == generation;
+    if (open) {
+        [self commitBatchForIdentity:identity];
+        _expiredBatches++;
+    }
+    os_unfair_lock_unlock(&_lock);
+    return open;
+}
+
+- (void)endBatchesForIdentity:(NSString *)identity
+{
+    os_unfair_lock_lock(&_lock);
+    if (_depths[identity] != nil) {
+        [self commitBatchForIdentity:identity];
+    }
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)endAllBatches
+{
+    os_unfair_lock_lock(&_lock);
+    for (NSString *identity in _depths.allKeys) {
+        [self commitBatchForIdentity:identity];
+    }
+    os_unfair_lock_unlock(&_lock);
+}
+
+// Caller holds _lock
+- (void)commitBatchForIdentity:(NSString *)identity
+{
+    if (self.supported) {
+        _endBatch(identity.UTF8String);
+    }
+    [_depths removeObjectForKey:identity];
+    [_generations removeObjectForKey:identity];
+    _committedBatches++;
+}
+
+- (NSDictionary *)statistics
+{
+    os_unfair_lock_lock(&_lock);
+    NSDictionary *openBatches = [_depths copy];
+    uint64_t committedBatches = _committedBatches;
+    uint64_t expiredBatches = _expiredBatches;
+    os_unfair_lock_unlock(&_lock);
+
+    return @{
+        @"supported": @(self.supported),
+        @"journalMode": self.journalModeWAL ? @"wal" : @"delete",
+        @"synchronous": MLSSynchronousName(self.synchronous),
+        @"cacheSizeKiB": @(self.cacheSizeKiB),
+        @"groupCommitIntervalMs": @(self.groupCommitIntervalMs),
+        @"openBatches": openBatches,
+        @"committedBatches": @(committedBatches),
+        @"expiredBatches": @(expiredBatches),
+    };
+}
+
+@end
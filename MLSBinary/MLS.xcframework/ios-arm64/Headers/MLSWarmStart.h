@@ -0,0 +1,48 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Recency list of groups, persisted next to the MLS storage so the next
+ * launch can load its busiest groups before JS asks for them, and the
+ * timings of the current startup.
+ *
+ * The list holds one entry per group and local member, most recently used
+ * first, capped at `limit`. Changes are written back a few seconds after
+ * they happen; flush writes them out at once.
+ *
+ * Thread-safe; group lanes on the scheduler record uses concurrently.
+ */
+@interface MLSWarmStart : NSObject
+
+- (instancetype)initWithLimit:(NSUInteger)limit;
+
+// Switch to the list stored in `directory`, writing out the current one first
+- (void)loadFromDirectory:(NSString *)directory;
+
+- (void)groupWasUsed:(NSString *)groupId userId:(NSString *)userId;
+
+// Drop a group that is no longer in storage
+- (void)forgetGroup:(NSString *)groupId userId:(NSString *)userId;
+
+// Entries {groupId, userId}, most recently used first
+- (NSArray<NSDictionary<NSString *, NSString *> *> *)recentGroups;
+
+- (void)flush;
+
+// Start timing a startup; `async` tells initializeAsync from initialize
+- (void)beginStartup:(BOOL)async;
+
+- (void)clientDidStart;
+
+- (void)warmingDidFinish:(NSUInteger)warmedGroups;
+
+// Records the time to the first decrypt after beginStartup:
+- (void)messageWasDecrypted;
+
+// {mode, clientReadyMs, warmedGroups, warmMs, firstDecryptMs, recentGroups}; times are null until reached
+- (NSDictionary *)statistics;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,226 @@
+#import "MLSBackgroundWork.h"
+#import "MLSGroupScheduler.h"
+#import <os/lock.h>
+
+typedef NS_ENUM(NSInteger, MLSBackgroundItemState) {
+    // Held back while saving energy
+    MLSBackgroundItemStateDeferred,
+    // On its lane, waiting for the work ahead of it
+    MLSBackgroundItemStateQueued,
+    MLSBackgroundItemStateStarted,
+    MLSBackgroundItemStateCancelled,
+};
+
+@interface MLSBackgroundItem : NSObject
+
+@property (nonatomic, strong) MLSGroupScheduler *scheduler;
+@property (nonatomic, copy) NSString *key;
+@property (nonatomic, copy) dispatch_block_t work;
+@property (nonatomic, copy) dispatch_block_t cancelled;
+@property (nonatomic, assign) MLSBackgroundItemState state;
+
+@end
+
+@implementation MLSBackgroundItem
+@end
+
+@implementation MLSBackgroundWork
+{
+    NSTimeInterval _deferralLimit;
+    NSString *_powerMode;
+    BOOL _inBackground;
+    BOOL _lowPowerMode;
+    // Work that has not started, held or queued, in scheduling order
+    NSMutableArray<MLSBackgroundItem *> *_pending;
+    uint64_t _started;
+    uint64_t _cancelled;
+    id _powerStateObserver;
+    os_unfair_lock _lock;
+}
+
+- (instancetype)initWithDeferralLimit:(NSTimeInterval)deferralLimit
+{
+    if (self = [super init]) {
+        _deferralLimit = deferralLimit;
+        // BatteryOptimizer's default
+        _powerMode = @"balanced";
+        _pending = [NSMutableArray array];
+        _lock = OS_UNFAIR_LOCK_INIT;
+
+        if (@available(iOS 9.0, macOS 12.0, *)) {
+            _lowPowerMode = NSProcessInfo.processInfo.isLowPowerModeEnabled;
+            __weak MLSBackgroundWork *weakSelf = self;
+            _powerStateObserver = [NSNotificationCenter.defaultCenter addObserverForName:NSProcessInfoPowerStateDidChangeNotification
+                                                                                   object:nil
+                                                                                    queue:nil
+                                                                               usingBlock:^(NSNotification *notification) {
+                [weakSelf lowPowerModeDidChange:NSProcessInfo.processInfo.isLowPowerModeEnabled];
+            }];
+        }
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    if (_powerStateObserver != nil) {
+        [NSNotificationCenter.defaultCenter removeObserver:_powerStateObserver];
+    }
+}
+
+- (void)scheduleOn:(MLSGroupScheduler *)scheduler
+               key:(NSString *)key
+              work:(dispatch_block_t)work
+         cancelled:(dispatch_block_t)cancelled
+{
+    MLSBackgroundItem *item = [[MLSBackgroundItem alloc] init];
+    item.scheduler = scheduler;
+    item.key = key;
+    item.work = work;
+    item.cancelled = cancelled;
+
+    os_unfair_lock_lock(&_lock);
+    BOOL deferring = [self isDeferring];
+    item.state = deferring ? MLSBackgroundItemStateDeferred : MLSBackgroundItemStateQueued;
+    [_pending addObject:item];
+    os_unfair_lock_unlock(&_lock);
+
+    if (!deferring) {
+        [self enqueue:item];
+        return;
+    }
+    // Held work runs after the limit even if the mode never changes, so a
+    // device that stays in Low Power Mode still rotates its keys
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(_deferralLimit * NSEC_PER_SEC)),
+                   dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        [self releaseItems:@[item]];
+    });
+}
+
+- (NSUInteger)cancelWorkForKey:(NSString *)key
+{
+    NSMutableArray<MLSBackgroundItem *> *cancelled = [NSMutableArray array];
+    os_unfair_lock_lock(&_lock);
+    for (MLSBackgroundItem *item in _pending) {
+        if (key == nil || [item.key isEqualToString:key]) {
+            item.state = MLSBackgroundItemStateCancelled;
+            [cancelled addObject:item];
+        }
+    }
+    [_pending removeObjectsInArray:cancelled];
+    _cancelled += cancelled.count;
+    os_unfair_lock_unlock(&_lock);
+
+    // A queued item stays on its lane and does nothing when its turn comes
+    for (MLSBackgroundItem *item in cancelled) {
+        dispatch_block_t handler = item.cancelled;
+        item.work = nil;
+        item.cancelled = nil;
+        handler();
+    }
+    return cancelled.count;
+}
+
+- (BOOL)setPowerMode:(NSString *)powerMode inBackground:(BOOL)inBackground
+{
+    static NSSet<NSString *> *modes;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        modes = [NSSet setWithArray:@[@"performance", @"balanced", @"powerSaver", @"ultraLowPower"]];
+    });
+    if (![modes containsObject:powerMode]) {
+        return NO;
+    }
+
+    os_unfair_lock_lock(&_lock);
+    _powerMode = [powerMode copy];
+    _inBackground = inBackground;
+    NSArray<MLSBackgroundItem *> *released = [self isDeferring] ? @[] : [_pending copy];
+    os_unfair_lock_unlock(&_lock);
+
+    [self releaseItems:released];
+    return YES;
+}
+
+- (void)lowPowerModeDidChange:(BOOL)lowPowerMode
+{
+    os_unfair_lock_lock(&_lock);
+    _lowPowerMode = lowPowerMode;
+    NSArray<MLSBackgroundItem *> *released = [self isDeferring] ? @[] : [_pending copy];
+    os_unfair_lock_unlock(&_lock);
+
+    [self releaseItems:released];
+}
+
+- (NSDictionary *)statistics
+{
+    os_unfair_lock_lock(&_lock);
+    NSUInteger deferred = 0;
+    for (MLSBackgroundItem *item in _pending) {
+        deferred += item.state == MLSBackgroundItemStateDeferred ? 1 : 0;
+    }
+    NSDictionary *statistics = @{
+        @"powerMode": _powerMode,
+        @"inBackground": @(_inBackground),
+        @"lowPowerMode": @(_lowPowerMode),
+        @"deferring": @([self isDeferring]),
+        @"deferred": @(deferred),
+        @"queued": @(_pending.count - deferred),
+        @"started": @(_started),
+        @"cancelled": @(_cancelled),
+    };
+    os_unfair_lock_unlock(&_lock);
+    return statistics;
+}
+
+// Caller holds _lock. The same rule as BatteryOptimizer.shouldSkipNonEssential.
+- (BOOL)isDeferring
+{
+    return _lowPowerMode || [_powerMode isEqualToString:@"ultraLowPower"] ||
+           ([_powerMode isEqualToString:@"powerSaver"] && _inBackground);
+}
+
+// Queue the items that are still held
+- (void)releaseItems:(NSArray<MLSBackgroundItem *> *)items
+{
+    NSMutableArray<MLSBackgroundItem *> *released = [NSMutableArray array];
+    os_unfair_lock_lock(&_lock);
+    for (MLSBackgroundItem *item in items) {
+        if (item.state == MLSBackgroundItemStateDeferred) {
+            item.state = MLSBackgroundItemStateQueued;
+            [released addObject:item];
+        }
+    }
+    os_unfair_lock_unlock(&_lock);
+
+    for (MLSBackgroundItem *item in released) {
+        [self enqueue:item];
+    }
+}
+
+- (void)enqueue:(MLSBackgroundItem *)item
+{
+    // Interactive work queued behind this block raises its QoS until it
+    // finishes, so a group's lane is never held up at utility priority
+    dispatch_block_t block = dispatch_block_create_with_qos_class(DISPATCH_BLOCK_ENFORCE_QOS_CLASS, QOS_CLASS_UTILITY, 0, ^{
+        os_unfair_lock_lock(&self->_lock);
+        BOOL cancelled = item.state == MLSBackgroundItemStateCancelled;
+        if (!cancelled) {
+            item.state = MLSBackgroundItemStateStarted;
+            [self->_pending removeObjectIdenticalTo:item];
+            self->_started++;
+        }
+        os_unfair_lock_unlock(&self->_lock);
+        if (cancelled) {
+            return;
+        }
+
+        dispatch_block_t work = item.work;
+        item.work = nil;
+        item.cancelled = nil;
+        work();
+    });
+    [item.scheduler dispatchAsyncForKey:item.key block:block];
+}
+
+@end
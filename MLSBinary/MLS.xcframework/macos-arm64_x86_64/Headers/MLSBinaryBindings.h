@@ -0,0 +1,27 @@
+#pragma once
+
+#ifdef __cplusplus
+
+#include <jsi/jsi.h>
+
+@class MLSModule;
+
+/**
+ * Install the binary (ArrayBuffer) transport on the JS runtime as
+ * `global.__mlsBinary`.
+ *
+ * The installed functions mirror the ciphertext paths of MLSModule but take
+ * and return raw bytes instead of base64 strings. Results returned as
+ * ArrayBuffers wrap the Rust-owned buffer directly and release it through
+ * mls_free_bytes when the JS object is collected, so no copy is made.
+ *
+ * Every call runs synchronously on the scheduler lane of its group, keeping
+ * it ordered with the promise-based methods for that group. Failures throw
+ * an Error whose userInfo is that of the matching rejection, see MLSErrors.h.
+ *
+ * @param runtime The JS runtime to install into (must be called on the JS thread)
+ * @param module The MLS module owning the client and method queue
+ */
+void MLSInstallBinaryBindings(facebook::jsi::Runtime &runtime, MLSModule *module);
+
+#endif
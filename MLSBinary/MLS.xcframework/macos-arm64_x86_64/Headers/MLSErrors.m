@@ -0,0 +1,103 @@
+#import "MLSErrors.h"
+#import "MLSFFI.h"
+#import "MLSPlatform.h"
+#import <dlfcn.h>
+
+NSErrorDomain const MLSErrorDomain = @"MLSErrorDomain";
+
+static NSString *MLSErrorCodeName(NSInteger code)
+{
+    switch (code) {
+        case MLSErrorCodeInvalidInput: return @"invalid_input";
+        case MLSErrorCodeGroupNotFound: return @"group_not_found";
+        case MLSErrorCodeWrongEpoch: return @"wrong_epoch";
+        case MLSErrorCodeNotMember: return @"not_member";
+        case MLSErrorCodeStorageBusy: return @"storage_busy";
+        case MLSErrorCodeStorageFailed: return @"storage_failed";
+        case MLSErrorCodeDecryptionFailed: return @"decryption_failed";
+        case MLSErrorCodeInvalidSignature: return @"invalid_signature";
+        case MLSErrorCodeInvalidKeyPackage: return @"invalid_key_package";
+        case MLSErrorCodeInternal: return @"internal";
+        case MLSErrorCodeClientNotInitialized: return @"client_not_initialized";
+        case MLSErrorCodeCancelled: return @"cancelled";
+        default: return @"unknown";
+    }
+}
+
+static NSString *MLSErrorCategoryName(NSInteger category)
+{
+    switch (category) {
+        case MLSErrorCategoryInput: return @"input";
+        case MLSErrorCategoryState: return @"state";
+        case MLSErrorCategoryStorage: return @"storage";
+        case MLSErrorCategoryCrypto: return @"crypto";
+        case MLSErrorCategoryInternal: return @"internal";
+        default: return @"unknown";
+    }
+}
+
+static NSError *MLSMakeError(NSInteger code, NSInteger category, BOOL retryable, NSString *detail)
+{
+    NSMutableDictionary<NSString *, id> *userInfo = [@{
+        @"code": MLSErrorCodeName(code),
+        @"category": MLSErrorCategoryName(category),
+        @"retryable": @(retryable),
+    } mutableCopy];
+    userInfo[@"detail"] = detail;
+    return [NSError errorWithDomain:MLSErrorDomain code:code userInfo:userInfo];
+}
+
+NSError *MLSTakeLastFFIError(void)
+{
+    static mls_last_error_fn lastError;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        lastError = (mls_last_error_fn)dlsym(RTLD_DEFAULT, "mls_last_error");
+    });
+
+    int code = 0;
+    int category = 0;
+    int retryable = 0;
+    uint8_t *message = NULL;
+    int messageLen = 0;
+    if (lastError == NULL || lastError(&code, &category, &retryable, &message, &messageLen) != MLSFFIStatusOK) {
+        return MLSMakeError(MLSErrorCodeUnknown, MLSErrorCategoryUnknown, NO, nil);
+    }
+
+    NSString *detail = nil;
+    if (message != NULL) {
+        detail = [[NSString alloc] initWithBytes:message length:(NSUInteger)MAX(messageLen, 0) encoding:NSUTF8StringEncoding];
+        mls_free_bytes(message);
+    }
+    return MLSMakeError(code, category, retryable != 0, detail);
+}
+
+NSError *MLSBridgeError(MLSErrorCode code)
+{
+    switch (code) {
+        case MLSErrorCodeClientNotInitialized:
+            // Succeeds once initialize has finished
+            return MLSMakeError(code, MLSErrorCategoryState, YES, nil);
+        case MLSErrorCodeCancelled:
+            // Nothing ran, so the call can simply be made again
+            return MLSMakeError(code, MLSErrorCategoryState, YES, nil);
+        case MLSErrorCodeWrongEpoch:
+            // A message from a later epoch the bridge could not park
+            return MLSMakeError(code, MLSErrorCategoryState, YES, nil);
+        case MLSErrorCodeInvalidInput:
+            return MLSMakeError(code, MLSErrorCategoryInput, NO, nil);
+        case MLSErrorCodeStorageBusy:
+            return MLSMakeError(code, MLSErrorCategoryStorage, YES, nil);
+        case MLSErrorCodeStorageFailed:
+            return MLSMakeError(code, MLSErrorCategoryStorage, NO, nil);
+        case MLSErrorCodeInternal:
+            return MLSMakeError(code, MLSErrorCategoryInternal, NO, nil);
+        default:
+            return MLSMakeError(code, MLSErrorCategoryUnknown, NO, nil);
+    }
+}
+
+NSDictionary<NSString *, id> *MLSErrorFields(NSError *error)
+{
+    return [error.domain isEqualToString:MLSErrorDomain] ? error.userInfo : @{};
+}
@@ -0,0 +1,90 @@
+// Rust FFI surface of libreact_native_mls_rust, shared by the bridge sources
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Rust FFI functions
+void* mls_client_create(void);
+void mls_set_storage_path(const char *path_ptr);
+void* mls_create_group(const void* client, const char* group_id, const char* creator_id);
+void* mls_join_group(const void* client, const char* group_id, const char* receiver_id, const char* welcome_message);
+void* mls_join_group_with_ratchet_tree(const void* client, const char* group_id, const char* receiver_id, const char* welcome_message, const char* ratchet_tree_b64);
+uint8_t* mls_export_ratchet_tree(const void* client, const char* group_id, const char* user_id, int* out_len);
+uint8_t* mls_add_member(const void* client, const char* group_id, const char* creator_id, const char* receiver_id, const char* key_package, int* out_len, uint8_t** out_welcome, int* out_welcome_len);
+uint8_t* mls_encrypt_message(const void* client, const char* group_id, const char* creator_id, const char* message, int* out_len);
+char* mls_decrypt_message(const void* client, const char* group_id, const char* creator_id, const uint8_t* encrypted_message, int encrypted_len);
+char* mls_generate_key_package(const void* client, const char* identity);
+uint8_t* mls_create_commit(const void* client, const char* group_id, const char* creator_id, const uint8_t** key_packages, const int* key_package_lens,
+                          int key_package_count, const uint8_t** proposals, const int* proposal_lens,
+                          int proposal_count, int* out_commit_len, uint8_t** out_welcome, int* out_welcome_len);
+unsigned long mls_get_current_epoch(const void* client, const char* group_id, const char* user_id);
+char** mls_generate_keypackages(const void* client, const char* identity, int count, int* out_count, int** out_lens);
+int mls_add_keypackage(const void* client, const char* identity, const char* key_package);
+// New storage FFI functions
+void mls_set_storage_key(const char *user_id_ptr, const char *key_ptr);
+void mls_set_storage_rekey(const char *user_id_ptr, const char *old_key_ptr, const char *new_key_ptr);
+uint8_t* mls_add_members(const void* client, const char* group_id, const char* creator_id, const char** receiver_keypackages, int receiver_count, int** out_lens, int* out_count);
+char* mls_export_secret(const void* client, const char* group_id, const char* creator_id, const char* label, const uint8_t* context, int context_len, unsigned int length);
+char** mls_group_members(const void* client, const char* group_id, const char* user_id, int* out_len);
+
+// New FFI functions
+int mls_process_message(const void* client, const char* group_id, const char* user_id, const uint8_t* message_bytes, int message_len, int* out_type, uint8_t** out_content, int* out_content_len, uint8_t** out_sender, int* out_sender_len, int* out_validated);
+int mls_accept_proposal(const void* client, const char* group_id, const char* user_id, const uint8_t* message_bytes, int message_len);
+uint8_t* mls_create_add_proposal(const void* client, const char* group_id, const char* sender_id, const uint8_t* key_package_bytes, int key_package_len, int* out_len);
+uint8_t* mls_create_remove_proposal(const void* client, const char* group_id, const char* creator_id, unsigned int member_index, int* out_len);
+uint8_t* mls_remove_members(const void* client, const char* group_id, const char* creator_id, const int** member_indices, int member_count, int* out_count);
+uint8_t* mls_self_update(const void* client, const char* group_id, const char* member_id, int* out_len, uint8_t** out_welcome, int* out_welcome_len);
+uint8_t* mls_self_remove(const void* client, const char* group_id, const char* member_id, int* out_len);
+uint8_t* mls_create_application_message(const void* client, const char* group_id, const char* user_id, const uint8_t* plaintext, int plaintext_len, int* out_len);
+uint8_t* mls_commit_pending_proposals(const void* client, const char* group_id, const char* creator_id, int* out_len, uint8_t** out_welcome, int* out_welcome_len);
+
+// Optional storage functions: mls_storage_configure, mls_storage_begin_batch
+// and mls_storage_end_batch. Builds of the Rust library without them must
+// still link, so they are not declared as imports; MLSStorageTuning looks
+// them up with dlsym. Each returns MLSFFIStatusOK on success.
+typedef int (*mls_storage_configure_fn)(int journal_mode_wal, int synchronous, int cache_size_kib, unsigned int group_commit_ms);
+typedef int (*mls_storage_batch_fn)(const char *user_id);
+
+// Optional mls_load_group, also found with dlsym: opens a handle on a group
+// already in storage, as mls_create_group does for a new one. NULL if the
+// group is unknown. Handles are released with mls_free_group.
+typedef void* (*mls_load_group_fn)(const void* client, const char* group_id, const char* user_id);
+
+// Optional mls_group_process_message and mls_group_create_application_message,
+// also found with dlsym: mls_process_message and
+// mls_create_application_message on a live group handle, which saves Rust
+// finding the group by ID and reading it from storage on every call.
+typedef int (*mls_group_process_message_fn)(const void* client, void* group_handle, const uint8_t* message_bytes, int message_len, int* out_type, uint8_t** out_content, int* out_content_len, uint8_t** out_sender, int* out_sender_len, int* out_validated);
+typedef uint8_t* (*mls_group_create_application_message_fn)(const void* client, void* group_handle, const uint8_t* plaintext, int plaintext_len, int* out_len);
+
+// Optional mls_last_error, also found with dlsym: why the calling thread's
+// last mls_* call failed. Every mls_* call but the mls_free_* ones clears it
+// on entry, so it must be read on the same thread before the next one. Returns MLSFFIStatusOK and
+// fills the outputs if an error is recorded; code and category take the
+// values of MLSErrorCode and MLSErrorCategory. The message is UTF-8, may be
+// NULL, and is freed with mls_free_bytes.
+typedef int (*mls_last_error_fn)(int* out_code, int* out_category, int* out_retryable, uint8_t** out_message, int* out_message_len);
+
+// Memory management functions
+void mls_free_client(void* client);
+void mls_free_string(char* ptr);
+void mls_free_bytes(uint8_t* ptr);
+void mls_free_group(void* group_handle);
+void mls_free_string_array(char** ptr, int count);
+
+// MLSProcessResult struct
+typedef struct {
+    uint32_t message_type;
+    char* content;
+    void* proposal;
+    void* commit;
+    uint64_t epoch;
+} MLSProcessResult;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,48 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Schedules MLS work so that operations on the same group run in order
+ * while different groups run in parallel.
+ *
+ * Each ordering key (normally a group ID) gets its own serial queue. All of
+ * them target one private concurrent queue, so independent groups spread
+ * across cores. Client-wide operations such as initialize run as barriers
+ * on that concurrent queue and therefore exclude every group lane.
+ */
+@interface MLSGroupScheduler : NSObject
+
+- (instancetype)initWithLabel:(NSString *)label NS_DESIGNATED_INITIALIZER;
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ * Serial queue for an ordering key, created on first use
+ * @param key A group ID or other ordering key
+ */
+- (dispatch_queue_t)queueForKey:(NSString *)key;
+
+/**
+ * Run a block after all previously scheduled work for the same key
+ * @param key A group ID or other ordering key
+ * @param block The work to run
+ */
+- (void)dispatchAsyncForKey:(NSString *)key block:(dispatch_block_t)block;
+
+/**
+ * Run a block in the lane for a key and wait for it to finish
+ * @param key A group ID or other ordering key
+ * @param block The work to run
+ */
+- (void)dispatchSyncForKey:(NSString *)key block:(dispatch_block_t)block;
+
+/**
+ * Run a block exclusively, after all scheduled work for every key and
+ * before any work scheduled later
+ * @param block The work to run
+ */
+- (void)dispatchBarrierAsync:(dispatch_block_t)block;
+
+@end
+
+NS_ASSUME_NONNULL_END
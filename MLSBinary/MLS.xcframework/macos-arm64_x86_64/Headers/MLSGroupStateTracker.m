@@ -0,0 +1,76 @@
+#import "MLSGroupStateTracker.h"
+#import <os/lock.h>
+
+static NSString *MLSGroupStateKey(NSString *groupId, NSString *userId)
+{
+    return [NSString stringWithFormat:@"%@\n%@", groupId, userId];
+}
+
+@implementation MLSGroupStateTracker
+{
+    // "groupId\nuserId" -> value
+    NSMutableDictionary<NSString *, NSNumber *> *_epochs;
+    NSMutableDictionary<NSString *, NSNumber *> *_pendingProposals;
+    os_unfair_lock _lock;
+}
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _epochs = [NSMutableDictionary dictionary];
+        _pendingProposals = [NSMutableDictionary dictionary];
+        _lock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+- (BOOL)updateEpoch:(uint64_t)epoch
+           forGroup:(NSString *)groupId
+             userId:(NSString *)userId
+      previousEpoch:(NSNumber **)previousEpoch
+{
+    NSString *key = MLSGroupStateKey(groupId, userId);
+
+    os_unfair_lock_lock(&_lock);
+    NSNumber *known = _epochs[key];
+    BOOL changed = known == nil || known.unsignedLongLongValue != epoch;
+    if (changed) {
+        _epochs[key] = @(epoch);
+    }
+    os_unfair_lock_unlock(&_lock);
+
+    *previousEpoch = known;
+    return changed;
+}
+
+- (NSUInteger)addPendingProposalForGroup:(NSString *)groupId userId:(NSString *)userId
+{
+    NSString *key = MLSGroupStateKey(groupId, userId);
+
+    os_unfair_lock_lock(&_lock);
+    NSUInteger count = _pendingProposals[key].unsignedIntegerValue + 1;
+    _pendingProposals[key] = @(count);
+    os_unfair_lock_unlock(&_lock);
+    return count;
+}
+
+- (BOOL)clearPendingProposalsForGroup:(NSString *)groupId userId:(NSString *)userId
+{
+    NSString *key = MLSGroupStateKey(groupId, userId);
+
+    os_unfair_lock_lock(&_lock);
+    BOOL hadPending = _pendingProposals[key].unsignedIntegerValue > 0;
+    [_pendingProposals removeObjectForKey:key];
+    os_unfair_lock_unlock(&_lock);
+    return hadPending;
+}
+
+- (void)removeAllStates
+{
+    os_unfair_lock_lock(&_lock);
+    [_epochs removeAllObjects];
+    [_pendingProposals removeAllObjects];
+    os_unfair_lock_unlock(&_lock);
+}
+
+@end
@@ -0,0 +1,58 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Pool of pre-generated key packages per identity.
+ *
+ * Packages are handed out oldest first in O(1). When an identity's pool
+ * falls below the low-water mark a refill is due; the owner generates
+ * packages in the background until the pool is back at its target size.
+ * Hits and misses are counted for every package requested.
+ *
+ * Thread-safe; identity lanes on the scheduler use it concurrently.
+ */
+@interface MLSKeyPackagePool : NSObject
+
+// Refill is due once fewer packages than this remain
+@property (atomic, assign) NSUInteger lowWaterMark;
+
+// Packages a refill tops the pool up to. Zero disables pooling.
+@property (atomic, assign) NSUInteger targetSize;
+
+- (instancetype)initWithLowWaterMark:(NSUInteger)lowWaterMark targetSize:(NSUInteger)targetSize;
+
+/**
+ * Take up to `count` pooled packages, recording a hit for each one returned
+ * and a miss for each one the caller still has to generate
+ */
+- (NSArray<NSString *> *)takeKeyPackages:(NSUInteger)count forIdentity:(NSString *)identity;
+
+- (void)addKeyPackages:(NSArray<NSString *> *)keyPackages forIdentity:(NSString *)identity;
+
+/**
+ * Claim the refill for an identity. Returns NO when pooling is disabled,
+ * the pool is at or above the low-water mark, or a refill is in flight.
+ */
+- (BOOL)beginRefillForIdentity:(NSString *)identity;
+
+// Packages still needed to reach the target size
+- (NSUInteger)shortfallForIdentity:(NSString *)identity;
+
+- (void)endRefillForIdentity:(NSString *)identity;
+
+- (void)removeAllKeyPackages;
+
+// Keep at most `count` packages per identity, the oldest ones; returns how
+// many were dropped. Pools refill on their next use.
+- (NSUInteger)trimToCount:(NSUInteger)count;
+
+// Bytes of the pooled packages
+- (NSUInteger)byteCount;
+
+// {hits, misses, generated, available: {identity: count}}
+- (NSDictionary *)statistics;
+
+@end
+
+NS_ASSUME_NONNULL_END
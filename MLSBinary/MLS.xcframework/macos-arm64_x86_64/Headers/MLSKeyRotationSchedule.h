@@ -0,0 +1,72 @@
+#import <Foundation/Foundation.h>
+#import "MLSModule.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * When each enrolled group's local member should next refresh its leaf
+ * with a self-update, so rotations spread out instead of sending one commit
+ * per group at the same moment.
+ *
+ * A rotation is due `interval` after the member's last self-update, brought
+ * forward by a random part of `jitter * interval`; the jitter window before
+ * that is when a commit the app makes anyway can carry the rotation
+ * instead. Groups enrolled without a known last update come due at a random
+ * point within the first interval. No more than `maxConcurrent` rotations
+ * are handed out at once; a failed one is retried a few minutes later.
+ *
+ * Due rotations are handed to `rotationHandler` on a private queue; the
+ * handler reports each back with rotationDidFinish. Times are wall clock,
+ * so time asleep counts.
+ *
+ * Thread-safe.
+ */
+@interface MLSKeyRotationSchedule : NSObject
+
+- (instancetype)initWithInterval:(NSTimeInterval)interval
+                          jitter:(double)jitter
+                   maxConcurrent:(NSUInteger)maxConcurrent;
+
+@property (atomic, copy, nullable) void (^rotationHandler)(NSString *groupId, NSString *userId);
+
+// Due times already set keep their value until the group next rotates
+- (void)setInterval:(NSTimeInterval)interval jitter:(double)jitter maxConcurrent:(NSUInteger)maxConcurrent;
+
+- (void)addGroup:(NSString *)groupId userId:(NSString *)userId;
+
+- (void)removeGroup:(NSString *)groupId userId:(NSString *)userId;
+
+// Drop every group of a local member, e.g. when its client closes
+- (void)removeUser:(NSString *)userId;
+
+- (void)removeAllGroups;
+
+- (BOOL)isRotationDueForGroup:(NSString *)groupId userId:(NSString *)userId;
+
+// Whether a commit made now should be a self-update: the group is enrolled
+// and within the jitter window of its next rotation
+- (BOOL)shouldMergeRotationForGroup:(NSString *)groupId userId:(NSString *)userId;
+
+/**
+ * The member refreshed its leaf, by a scheduled rotation or any other
+ * self-update, which restarts the group's interval
+ * @param merged Whether the self-update replaced a commit the app asked for
+ */
+- (void)groupDidRotate:(NSString *)groupId userId:(NSString *)userId merged:(BOOL)merged;
+
+// Free a rotation's slot; an unsuccessful one is tried again later
+- (void)rotationDidFinish:(NSString *)groupId userId:(NSString *)userId succeeded:(BOOL)succeeded;
+
+// {intervalMs, jitter, maxConcurrent, groups, inFlight, rotations, merged, failed, nextDueMs}
+- (NSDictionary *)statistics;
+
+@end
+
+@interface MLSModule (KeyRotation)
+
+// Shared by the bridge methods and the binary transport
+- (MLSKeyRotationSchedule *)keyRotations;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,276 @@
+#import "MLSKeyRotationSchedule.h"
+#import <os/lock.h>
+#import <stdlib.h>
+
+// Wait before trying a failed rotation again, at most one interval
+static const NSTimeInterval MLSKeyRotationRetryDelay = 5 * 60;
+
+// Rotations need no precision, so let the system batch the wakeup with others
+static const uint64_t MLSKeyRotationTimerLeeway = 30 * NSEC_PER_SEC;
+
+static NSString *MLSKeyRotationKey(NSString *groupId, NSString *userId)
+{
+    return [NSString stringWithFormat:@"%@\n%@", groupId, userId];
+}
+
+// Uniform in [0, 1)
+static double MLSRandomFraction(void)
+{
+    return (double)arc4random() / ((double)UINT32_MAX + 1.0);
+}
+
+static NSTimeInterval MLSNow(void)
+{
+    return [NSDate date].timeIntervalSince1970;
+}
+
+@interface MLSKeyRotationEntry : NSObject
+
+@property (nonatomic, copy) NSString *groupId;
+@property (nonatomic, copy) NSString *userId;
+@property (nonatomic, assign) NSTimeInterval dueAt;
+// Start of the jitter window, from which commits carry the rotation
+@property (nonatomic, assign) NSTimeInterval mergeFrom;
+@property (nonatomic, assign) BOOL inFlight;
+
+@end
+
+@implementation MLSKeyRotationEntry
+@end
+
+@implementation MLSKeyRotationSchedule
+{
+    NSTimeInterval _interval;
+    double _jitter;
+    NSUInteger _maxConcurrent;
+    // "groupId\nuserId" -> entry
+    NSMutableDictionary<NSString *, MLSKeyRotationEntry *> *_entries;
+    NSUInteger _inFlight;
+    uint64_t _rotations;
+    uint64_t _merged;
+    uint64_t _failed;
+    // Serializes the timer's handler and its rescheduling
+    dispatch_queue_t _queue;
+    dispatch_source_t _timer;
+    os_unfair_lock _lock;
+}
+
+- (instancetype)initWithInterval:(NSTimeInterval)interval jitter:(double)jitter maxConcurrent:(NSUInteger)maxConcurrent
+{
+    if (self = [super init]) {
+        _entries = [NSMutableDictionary dictionary];
+        _queue = dispatch_queue_create("com.reactnativemls.MLSQueue.keyRotation",
+                                       dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+        _lock = OS_UNFAIR_LOCK_INIT;
+
+        _timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _queue);
+        __weak MLSKeyRotationSchedule *weakSelf = self;
+        dispatch_source_set_event_handler(_timer, ^{
+            [weakSelf startDueRotations];
+        });
+        dispatch_source_set_timer(_timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, MLSKeyRotationTimerLeeway);
+        dispatch_resume(_timer);
+        [self setInterval:interval jitter:jitter maxConcurrent:maxConcurrent];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    dispatch_source_cancel(_timer);
+}
+
+- (void)setInterval:(NSTimeInterval)interval jitter:(double)jitter maxConcurrent:(NSUInteger)maxConcurrent
+{
+    os_unfair_lock_lock(&_lock);
+    _interval = MAX(interval, 1);
+    _jitter = MIN(MAX(jitter, 0), 1);
+    _maxConcurrent = MAX(maxConcurrent, (NSUInteger)1);
+    os_unfair_lock_unlock(&_lock);
+    [self updateTimer];
+}
+
+- (void)addGroup:(NSString *)groupId userId:(NSString *)userId
+{
+    NSString *key = MLSKeyRotationKey(groupId, userId);
+
+    os_unfair_lock_lock(&_lock);
+    BOOL added = _entries[key] == nil;
+    if (added) {
+        MLSKeyRotationEntry *entry = [[MLSKeyRotationEntry alloc] init];
+        entry.groupId = groupId;
+        entry.userId = userId;
+        // The last update is unknown, so spread newly enrolled groups over an interval
+        entry.dueAt = MLSNow() + _interval * MLSRandomFraction();
+        entry.mergeFrom = entry.dueAt - _interval * _jitter;
+        _entries[key] = entry;
+    }
+    os_unfair_lock_unlock(&_lock);
+
+    if (added) {
+        [self updateTimer];
+    }
+}
+
+- (void)removeGroup:(NSString *)groupId userId:(NSString *)userId
+{
+    os_unfair_lock_lock(&_lock);
+    [_entries removeObjectForKey:MLSKeyRotationKey(groupId, userId)];
+    os_unfair_lock_unlock(&_lock);
+    [self updateTimer];
+}
+
+- (void)removeUser:(NSString *)userId
+{
+    os_unfair_lock_lock(&_lock);
+    NSMutableArray<NSString *> *keys = [NSMutableArray array];
+    [_entries enumerateKeysAndObjectsUsingBlock:^(NSString *key, MLSKeyRotationEntry *entry, BOOL *stop) {
+        if ([entry.userId isEqualToString:userId]) {
+            [keys addObject:key];
+        }
+    }];
+    [_entries removeObjectsForKeys:keys];
+    os_unfair_lock_unlock(&_lock);
+    [self updateTimer];
+}
+
+- (void)removeAllGroups
+{
+    os_unfair_lock_lock(&_lock);
+    [_entries removeAllObjects];
+    os_unfair_lock_unlock(&_lock);
+    [self updateTimer];
+}
+
+- (BOOL)isRotationDueForGroup:(NSString *)groupId userId:(NSString *)userId
+{
+    os_unfair_lock_lock(&_lock);
+    MLSKeyRotationEntry *entry = _entries[MLSKeyRotationKey(groupId, userId)];
+    BOOL due = entry != nil && entry.dueAt <= MLSNow();
+    os_unfair_lock_unlock(&_lock);
+    return due;
+}
+
+- (BOOL)shouldMergeRotationForGroup:(NSString *)groupId userId:(NSString *)userId
+{
+    os_unfair_lock_lock(&_lock);
+    MLSKeyRotationEntry *entry = _entries[MLSKeyRotationKey(groupId, userId)];
+    BOOL merge = entry != nil && entry.mergeFrom <= MLSNow();
+    os_unfair_lock_unlock(&_lock);
+    return merge;
+}
+
+- (void)groupDidRotate:(NSString *)groupId userId:(NSString *)userId merged:(BOOL)merged
+{
+    os_unfair_lock_lock(&_lock);
+    MLSKeyRotationEntry *entry = _entries[MLSKeyRotationKey(groupId, userId)];
+    if (entry != nil) {
+        NSTimeInterval now = MLSNow();
+        entry.dueAt = now + _interval * (1 - _jitter * MLSRandomFraction());
+        entry.mergeFrom = now + _interval * (1 - _jitter);
+        _rotations++;
+        _merged += merged ? 1 : 0;
+    }
+    os_unfair_lock_unlock(&_lock);
+    [self updateTimer];
+}
+
+- (void)rotationDidFinish:(NSString *)groupId userId:(NSString *)userId succeeded:(BOOL)succeeded
+{
+    os_unfair_lock_lock(&_lock);
+    _inFlight -= _inFlight > 0 ? 1 : 0;
+    MLSKeyRotationEntry *entry = _entries[MLSKeyRotationKey(groupId, userId)];
+    entry.inFlight = NO;
+    if (!succeeded) {
+        _failed++;
+        entry.dueAt = MLSNow() + MIN(MLSKeyRotationRetryDelay, _interval) * (1 + _jitter * MLSRandomFraction());
+    }
+    os_unfair_lock_unlock(&_lock);
+    [self updateTimer];
+}
+
+- (NSDictionary *)statistics
+{
+    os_unfair_lock_lock(&_lock);
+    NSTimeInterval nextDueAt = [self nextDueAt];
+    NSDictionary *statistics = @{
+        @"intervalMs": @(_interval * 1000.0),
+        @"jitter": @(_jitter),
+        @"maxConcurrent": @(_maxConcurrent),
+        @"groups": @(_entries.count),
+        @"inFlight": @(_inFlight),
+        @"rotations": @(_rotations),
+        @"merged": @(_merged),
+        @"failed": @(_failed),
+        @"nextDueMs": nextDueAt > 0 ? @(MAX(nextDueAt - MLSNow(), 0) * 1000.0) : [NSNull null],
+    };
+    os_unfair_lock_unlock(&_lock);
+    return statistics;
+}
+
+// Caller holds _lock. The earliest due time of a group not rotating yet, or 0.
+- (NSTimeInterval)nextDueAt
+{
+    NSTimeInterval next = 0;
+    for (MLSKeyRotationEntry *entry in _entries.objectEnumerator) {
+        if (!entry.inFlight && (next == 0 || entry.dueAt < next)) {
+            next = entry.dueAt;
+        }
+    }
+    return next;
+}
+
+// Point the timer at the next rotation that can start
+- (void)updateTimer
+{
+    dispatch_async(_queue, ^{
+        // Without a handler nothing can start, and the timer would fire at once forever
+        BOOL canStart = self.rotationHandler != nil;
+        os_unfair_lock_lock(&self->_lock);
+        NSTimeInterval next = canStart && self->_inFlight < self->_maxConcurrent ? [self nextDueAt] : 0;
+        os_unfair_lock_unlock(&self->_lock);
+
+        dispatch_time_t start = DISPATCH_TIME_FOREVER;
+        if (next > 0) {
+            start = dispatch_walltime(NULL, (int64_t)(MAX(next - MLSNow(), 0) * NSEC_PER_SEC));
+        }
+        dispatch_source_set_timer(self->_timer, start, DISPATCH_TIME_FOREVER, MLSKeyRotationTimerLeeway);
+    });
+}
+
+// Runs on _queue. Hand out due rotations, earliest first, up to the cap.
+- (void)startDueRotations
+{
+    void (^handler)(NSString *, NSString *) = self.rotationHandler;
+    NSMutableArray<MLSKeyRotationEntry *> *started = [NSMutableArray array];
+
+    os_unfair_lock_lock(&_lock);
+    if (handler != nil) {
+        NSTimeInterval now = MLSNow();
+        NSMutableArray<MLSKeyRotationEntry *> *due = [NSMutableArray array];
+        for (MLSKeyRotationEntry *entry in _entries.objectEnumerator) {
+            if (!entry.inFlight && entry.dueAt <= now) {
+                [due addObject:entry];
+            }
+        }
+        [due sortUsingComparator:^NSComparisonResult(MLSKeyRotationEntry *a, MLSKeyRotationEntry *b) {
+            return a.dueAt < b.dueAt ? NSOrderedAscending : (a.dueAt > b.dueAt ? NSOrderedDescending : NSOrderedSame);
+        }];
+        for (MLSKeyRotationEntry *entry in due) {
+            if (_inFlight >= _maxConcurrent) {
+                break;
+            }
+            entry.inFlight = YES;
+            _inFlight++;
+            [started addObject:entry];
+        }
+    }
+    os_unfair_lock_unlock(&_lock);
+
+    for (MLSKeyRotationEntry *entry in started) {
+        handler(entry.groupId, entry.userId);
+    }
+    [self updateTimer];
+}
+
+@end
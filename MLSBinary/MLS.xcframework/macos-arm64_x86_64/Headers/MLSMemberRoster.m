@@ -0,0 +1,187 @@
+#import "MLSMemberRoster.h"
+#import <os/lock.h>
+
+@interface MLSRosterEntry : NSObject
+
+@property (nonatomic, copy) NSArray<NSString *> *members;
+@property (nonatomic, copy) NSSet<NSString *> *memberSet;
+@property (nonatomic, assign) NSUInteger version;
+// Oldest version a delta can still be computed from
+@property (nonatomic, assign) NSUInteger baseVersion;
+// {version, added, removed} per update, oldest first
+@property (nonatomic, strong) NSMutableArray<NSDictionary *> *changes;
+
+@end
+
+@implementation MLSRosterEntry
+@end
+
+@implementation MLSMemberRoster
+{
+    NSUInteger _changeLogLimit;
+    // groupId -> userId -> roster
+    NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, MLSRosterEntry *> *> *_rosters;
+    os_unfair_lock _lock;
+}
+
+- (instancetype)initWithChangeLogLimit:(NSUInteger)changeLogLimit
+{
+    if (self = [super init]) {
+        _changeLogLimit = MAX(changeLogLimit, (NSUInteger)1);
+        _rosters = [NSMutableDictionary dictionary];
+        _lock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+// Caller holds the lock
+- (MLSRosterEntry *)entryForGroup:(NSString *)groupId userId:(NSString *)userId
+{
+    return _rosters[groupId][userId];
+}
+
+- (BOOL)isTrackingGroup:(NSString *)groupId userId:(NSString *)userId
+{
+    os_unfair_lock_lock(&_lock);
+    BOOL tracking = [self entryForGroup:groupId userId:userId] != nil;
+    os_unfair_lock_unlock(&_lock);
+    return tracking;
+}
+
+- (NSArray<NSString *> *)membersOfGroup:(NSString *)groupId userId:(NSString *)userId
+{
+    os_unfair_lock_lock(&_lock);
+    NSArray<NSString *> *members = [self entryForGroup:groupId userId:userId].members;
+    os_unfair_lock_unlock(&_lock);
+    return members;
+}
+
+- (BOOL)group:(NSString *)groupId userId:(NSString *)userId containsMember:(NSString *)identity
+{
+    os_unfair_lock_lock(&_lock);
+    BOOL contains = [[self entryForGroup:groupId userId:userId].memberSet containsObject:identity];
+    os_unfair_lock_unlock(&_lock);
+    return contains;
+}
+
+- (NSDictionary *)updateMembers:(NSArray<NSString *> *)members
+                        ofGroup:(NSString *)groupId
+                         userId:(NSString *)userId
+{
+    NSSet<NSString *> *memberSet = [NSSet setWithArray:members];
+
+    os_unfair_lock_lock(&_lock);
+    MLSRosterEntry *entry = [self entryForGroup:groupId userId:userId];
+    if (!entry) {
+        entry = [[MLSRosterEntry alloc] init];
+        entry.members = members;
+        entry.memberSet = memberSet;
+        entry.version = 1;
+        entry.baseVersion = 1;
+        entry.changes = [NSMutableArray array];
+
+        NSMutableDictionary<NSString *, MLSRosterEntry *> *groupRosters = _rosters[groupId];
+        if (!groupRosters) {
+            groupRosters = [NSMutableDictionary dictionary];
+            _rosters[groupId] = groupRosters;
+        }
+        groupRosters[userId] = entry;
+        os_unfair_lock_unlock(&_lock);
+        return nil;
+    }
+
+    NSMutableArray<NSString *> *added = [NSMutableArray array];
+    for (NSString *member in members) {
+        if (![entry.memberSet containsObject:member]) {
+            [added addObject:member];
+        }
+    }
+    NSMutableArray<NSString *> *removed = [NSMutableArray array];
+    for (NSString *member in entry.members) {
+        if (![memberSet containsObject:member]) {
+            [removed addObject:member];
+        }
+    }
+
+    // Order can change without membership changing; keep the latest order
+    entry.members = members;
+    entry.memberSet = memberSet;
+
+    NSDictionary *change = nil;
+    if (added.count > 0 || removed.count > 0) {
+        entry.version++;
+        change = @{
+            @"version": @(entry.version),
+            @"added": added,
+            @"removed": removed,
+        };
+        [entry.changes addObject:change];
+        if (entry.changes.count > _changeLogLimit) {
+            entry.baseVersion = [entry.changes.firstObject[@"version"] unsignedIntegerValue];
+            [entry.changes removeObjectAtIndex:0];
+        }
+    }
+    os_unfair_lock_unlock(&_lock);
+    return change;
+}
+
+- (NSDictionary *)changesForGroup:(NSString *)groupId
+                           userId:(NSString *)userId
+                     sinceVersion:(NSUInteger)version
+{
+    os_unfair_lock_lock(&_lock);
+    MLSRosterEntry *entry = [self entryForGroup:groupId userId:userId];
+    if (!entry) {
+        os_unfair_lock_unlock(&_lock);
+        return nil;
+    }
+
+    if (version < entry.baseVersion || version > entry.version) {
+        NSDictionary *reset = @{
+            @"version": @(entry.version),
+            @"reset": @YES,
+            @"members": entry.members,
+        };
+        os_unfair_lock_unlock(&_lock);
+        return reset;
+    }
+
+    // A member added and removed again within the window cancels out
+    NSMutableOrderedSet<NSString *> *added = [NSMutableOrderedSet orderedSet];
+    NSMutableOrderedSet<NSString *> *removed = [NSMutableOrderedSet orderedSet];
+    for (NSDictionary *change in entry.changes) {
+        if ([change[@"version"] unsignedIntegerValue] <= version) {
+            continue;
+        }
+        for (NSString *member in change[@"added"]) {
+            if ([removed containsObject:member]) {
+                [removed removeObject:member];
+            } else {
+                [added addObject:member];
+            }
+        }
+        for (NSString *member in change[@"removed"]) {
+            if ([added containsObject:member]) {
+                [added removeObject:member];
+            } else {
+                [removed addObject:member];
+            }
+        }
+    }
+    NSDictionary *changes = @{
+        @"version": @(entry.version),
+        @"added": added.array,
+        @"removed": removed.array,
+    };
+    os_unfair_lock_unlock(&_lock);
+    return changes;
+}
+
+- (void)removeAllRosters
+{
+    os_unfair_lock_lock(&_lock);
+    [_rosters removeAllObjects];
+    os_unfair_lock_unlock(&_lock);
+}
+
+@end
@@ -0,0 +1,44 @@
+#import <Foundation/Foundation.h>
+#import "MLSModule.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Native sink for the commits and Welcomes MLSModule creates.
+ *
+ * The mesh layer can register one to start fragmenting and transmitting a
+ * commit as soon as the FFI returns it, instead of waiting for the base64
+ * result to travel through JS and back. Results are still returned to JS
+ * as before.
+ */
+NS_SWIFT_NAME(MeshOutbox)
+@protocol MLSMeshOutbox <NSObject>
+
+/**
+ * A local operation created a commit for `groupId`, plus a Welcome if it
+ * added members. Called on the group's lane in epoch order, before the
+ * result is returned to JS. The buffers are the FFI output itself, not a
+ * copy; retain them as long as needed, but hand the work off quickly since
+ * the lane waits for this call.
+ */
+- (void)mlsGroup:(NSString *)groupId
+ didCreateCommit:(NSData *)commit
+         welcome:(nullable NSData *)welcome
+        senderId:(NSString *)senderId;
+
+@end
+
+@interface MLSModule (MeshOutbox)
+
+// Weakly held and shared by every module instance
+@property (class, nonatomic, weak, nullable) id<MLSMeshOutbox> meshOutbox;
+
+// Give a commit to the registered outbox, if any. Must run on the group's lane.
+- (void)handOffCommit:(NSData *)commit
+              welcome:(nullable NSData *)welcome
+              groupId:(NSString *)groupId
+             senderId:(NSString *)senderId;
+
+@end
+
+NS_ASSUME_NONNULL_END
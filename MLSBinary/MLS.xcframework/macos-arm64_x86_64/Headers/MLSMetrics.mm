@@ -0,0 +1,209 @@
+#import "MLSMetrics.h"
+
+#include <algorithm>
+
+static const char *MLSPhaseNames[MLSOperationPhaseCount] = {"decode", "ffi", "marshal"};
+
+void MLSLatencyHistogram::record(uint64_t micros)
+{
+    size_t bucket = 0;
+    for (uint64_t bound = 2; bound <= micros && bucket + 1 < BucketCount; bound <<= 1) {
+        bucket++;
+    }
+    buckets[bucket]++;
+    count++;
+    totalMicros += micros;
+    maxMicros = std::max(maxMicros, micros);
+}
+
+uint64_t MLSLatencyHistogram::percentile(double quantile) const
+{
+    if (count == 0) {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t)(quantile * (double)count);
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BucketCount; bucket++) {
+        seen += buckets[bucket];
+        if (seen > rank) {
+            return std::min((uint64_t)2 << bucket, maxMicros);
+        }
+    }
+    return maxMicros;
+}
+
+static NSDictionary *MLSHistogramDictionary(const MLSLatencyHistogram &histogram)
+{
+    NSMutableArray<NSNumber *> *buckets = [NSMutableArray arrayWithCapacity:MLSLatencyHistogram::BucketCount];
+    for (uint64_t bucketCount : histogram.buckets) {
+        [buckets addObject:@(bucketCount)];
+    }
+    return @{
+        @"count": @(histogram.count),
+        @"totalMicros": @(histogram.totalMicros),
+        @"maxMicros": @(histogram.maxMicros),
+        @"p50Micros": @(histogram.percentile(0.50)),
+        @"p95Micros": @(histogram.percentile(0.95)),
+        @"p99Micros": @(histogram.percentile(0.99)),
+        @"buckets": buckets,
+    };
+}
+
+MLSMetrics::MLSMetrics() : log_(os_log_create("com.reactnativemls", "MLSOperations")) {}
+
+void MLSMetrics::record(const char *operation, bool succeeded, uint64_t bytesIn, uint64_t bytesOut, uint64_t totalMicros,
+                        const std::array<uint64_t, MLSOperationPhaseCount> &phaseMicros)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    MLSOperationStats &stats = operations_[operation];
+    stats.calls++;
+    if (!succeeded) {
+        stats.errors++;
+    }
+    stats.bytesIn += bytesIn;
+    stats.bytesOut += bytesOut;
+    stats.total.record(totalMicros);
+    for (size_t phase = 0; phase < MLSOperationPhaseCount; phase++) {
+        stats.phases[phase].record(phaseMicros[phase]);
+    }
+}
+
+NSDictionary *MLSMetrics::snapshot() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    NSMutableDictionary *operations = [NSMutableDictionary dictionaryWithCapacity:operations_.size()];
+    for (const auto &entry : operations_) {
+        const MLSOperationStats &stats = entry.second;
+        NSMutableDictionary *latency = [NSMutableDictionary dictionaryWithCapacity:MLSOperationPhaseCount + 1];
+        latency[@"total"] = MLSHistogramDictionary(stats.total);
+        for (size_t phase = 0; phase < MLSOperationPhaseCount; phase++) {
+            latency[@(MLSPhaseNames[phase])] = MLSHistogramDictionary(stats.phases[phase]);
+        }
+        operations[@(entry.first.c_str())] = @{
+            @"calls": @(stats.calls),
+            @"errors": @(stats.errors),
+            @"bytesIn": @(stats.bytesIn),
+            @"bytesOut": @(stats.bytesOut),
+            @"latency": latency,
+        };
+    }
+    return operations;
+}
+
+void MLSMetrics::reset()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    operations_.clear();
+}
+
+MLSOperationTrace::MLSOperationTrace(MLSMetrics *metrics, const char *operation, uint64_t bytesIn)
+    : metrics_(metrics), operation_(operation), signpostId_(OS_SIGNPOST_ID_NULL), bytesIn_(bytesIn)
+{
+    start_ = phaseStart_ = Clock::now();
+    if (metrics_ == nullptr) {
+        return;
+    }
+
+    os_log_t log = metrics_->log();
+    signpostId_ = os_signpost_id_generate(log);
+    os_signpost_interval_begin(log, signpostId_, "MLSOperation", "%{public}s", operation_);
+    os_signpost_interval_begin(log, signpostId_, "MLSDecode");
+}
+
+MLSOperationTrace::~MLSOperationTrace()
+{
+    if (metrics_ == nullptr) {
+        return;
+    }
+
+    Clock::time_point now = Clock::now();
+    closePhase(now);
+
+    os_log_t log = metrics_->log();
+    os_signpost_interval_end(log, signpostId_, "MLSOperation", "%{public}s %{public}s", operation_,
+                             succeeded_ ? "ok" : "error");
+
+    uint64_t totalMicros = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(now - start_).count();
+    metrics_->record(operation_, succeeded_, bytesIn_, bytesOut_, totalMicros, phaseMicros_);
+}
+
+void MLSOperationTrace::closePhase(Clock::time_point now)
+{
+    phaseMicros_[(size_t)phase_] += (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(now - phaseStart_).count();
+    phaseStart_ = now;
+
+    // Signpost names must be string literals
+    os_log_t log = metrics_->log();
+    switch (phase_) {
+        case MLSOperationPhase::Decode:
+            os_signpost_interval_end(log, signpostId_, "MLSDecode");
+            break;
+        case MLSOperationPhase::FFI:
+            os_signpost_interval_end(log, signpostId_, "MLSFFI");
+            break;
+        case MLSOperationPhase::Marshal:
+            os_signpost_interval_end(log, signpostId_, "MLSMarshal");
+            break;
+    }
+}
+
+void MLSOperationTrace::enterPhase(MLSOperationPhase phase)
+{
+    if (metrics_ == nullptr || phase == phase_) {
+        return;
+    }
+
+    closePhase(Clock::now());
+    phase_ = phase;
+
+    os_log_t log = metrics_->log();
+    switch (phase_) {
+        case MLSOperationPhase::Decode:
+            os_signpost_interval_begin(log, signpostId_, "MLSDecode");
+            break;
+        case MLSOperationPhase::FFI:
+            os_signpost_interval_begin(log, signpostId_, "MLSFFI");
+            break;
+        case MLSOperationPhase::Marshal:
+            os_signpost_interval_begin(log, signpostId_, "MLSMarshal");
+            break;
+    }
+}
+
+id MLSOperationTrace::succeed(id result)
+{
+    succeeded_ = true;
+    if (metrics_ != nullptr) {
+        bytesOut_ += MLSPayloadSize(result);
+    }
+    return result;
+}
+
+uint64_t MLSPayloadSize(id value)
+{
+    if ([value isKindOfClass:[NSString class]]) {
+        return [(NSString *)value length];
+    }
+    if ([value isKindOfClass:[NSData class]]) {
+        return [(NSData *)value length];
+    }
+    if ([value isKindOfClass:[NSArray class]]) {
+        uint64_t size = 0;
+        for (id element in (NSArray *)value) {
+            size += MLSPayloadSize(element);
+        }
+        return size;
+    }
+    if ([value isKindOfClass:[NSDictionary class]]) {
+        __block uint64_t size = 0;
+        [(NSDictionary *)value enumerateKeysAndObjectsUsingBlock:^(id key, id object, BOOL *stop) {
+            size += MLSPayloadSize(object);
+        }];
+        return size;
+    }
+    if ([value isKindOfClass:[NSNumber class]]) {
+        return sizeof(double);
+    }
+    return 0;
+}
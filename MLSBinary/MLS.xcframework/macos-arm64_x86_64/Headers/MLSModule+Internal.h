@@ -0,0 +1,59 @@
+#pragma once
+
+#ifdef __cplusplus
+
+#import "MLSModule.h"
+#import "MLSCiphertextFilter.h"
+#import "MLSExporterSecretCache.h"
+#import "MLSGroupHandleCache.h"
+#import "MLSProposalAggregator.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Module state the bridge methods share with the binary transport.
+ *
+ * Kept apart from the helpers' own headers, so those build without React,
+ * as bitchatMLSTests needs.
+ */
+
+@interface MLSModule (CiphertextFilter)
+
+// Shared by processMessage and the binary transport
+- (MLSCiphertextFilter *)ciphertextFilter;
+
+@end
+
+@interface MLSModule (ExporterSecrets)
+
+/**
+ * Exporter secret for the group's current epoch as raw bytes, served from
+ * the cache when possible. Must run on the group's lane, with that lane's
+ * client.
+ */
+- (BOOL)exporterSecretForGroup:(NSString *)groupId
+                        userId:(NSString *)userId
+                         label:(NSString *)label
+                       context:(NSData *)context
+                        length:(uint32_t)length
+                        secret:(std::vector<uint8_t> &)secret
+                        client:(void *)client;
+
+@end
+
+@interface MLSModule (GroupHandles)
+
+// Shared by the bridge methods and the binary transport
+- (MLSGroupHandleCache *)groupHandles;
+
+@end
+
+@interface MLSModule (ProposalAggregation)
+
+// Shared by the bridge methods and the binary transport
+- (MLSProposalAggregator *)proposalAggregator;
+
+@end
+
+#endif
@@ -1,916 +1,3334 @@
 #import "MLSModule.h"
+#import "MLSModule+Internal.h"
 #import <React/RCTLog.h>
 #import <React/RCTUtils.h>
 #import <React/RCTConvert.h>
+#import <React/RCTBridge+Private.h>
+#import <dlfcn.h>
+#import <os/lock.h>
+#import "MLSFFI.h"
+#import "MLSBackgroundWork.h"
+#import "MLSBinaryBindings.h"
+#import "MLSCiphertextFilter.h"
+#import "MLSClientTable.h"
+#import "MLSCompactResult.h"
+#import "MLSEpochReorderBuffer.h"
+#import "MLSErrors.h"
+#import "MLSExporterSecretCache.h"
+#import "MLSScratchArena.h"
+#import "MLSGroupHandleCache.h"
+#import "MLSGroupScheduler.h"
+#import "MLSGroupStateTracker.h"
+#import "MLSKeyPackagePool.h"
+#import "MLSKeyRotationSchedule.h"
+#import "MLSMemoryBudget.h"
+#import "MLSMeshOutbox.h"
+#import "MLSMemberRoster.h"
+#import "MLSMetrics.h"
+#import "MLSPlatform.h"
+#import "MLSProposalAggregator.h"
+#import "MLSRatchetTreeIO.h"
+#import "MLSStorageTuning.h"
+#import "MLSWarmStart.h"
 
-// Import the Rust FFI header
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-// Rust FFI functions
-void* mls_client_create(void);
-void mls_set_storage_path(const char *path_ptr);
-void* mls_create_group(const void* client, const char* group_id, const char* creator_id);
-void* mls_join_group(const void* client, const char* group_id, const char* receiver_id, const char* welcome_message);
-void* mls_join_group_with_ratchet_tree(const void* client, const char* group_id, const char* receiver_id, const char* welcome_message, const char* ratchet_tree_b64);
-uint8_t* mls_export_ratchet_tree(const void* client, const char* group_id, const char* user_id, int* out_len);
-uint8_t* mls_add_member(const void* client, const char* group_id, const char* creator_id, const char* receiver_id, const char* key_package, int* out_len, uint8_t** out_welcome, int* out_welcome_len);
-uint8_t* mls_encrypt_message(const void* client, const char* group_id, const char* creator_id, const char* message, int* out_len);
-char* mls_decrypt_message(const void* client, const char* group_id, const char* creator_id, const uint8_t* encrypted_message, int encrypted_len);
-char* mls_generate_key_package(const void* client, const char* identity);
-uint8_t* mls_create_commit(const void* client, const char* group_id, const char* creator_id, const uint8_t** key_packages, const int* key_package_lens,
-                          int key_package_count, const uint8_t** proposals, const int* proposal_lens,
-                          int proposal_count, int* out_commit_len, uint8_t** out_welcome, int* out_welcome_len);
-unsigned long mls_get_current_epoch(const void* client, const char* group_id, const char* user_id);
-char** mls_generate_keypackages(const void* client, const char* identity, int count, int* out_count, int** out_lens);
-int mls_add_keypackage(const void* client, const char* identity, const char* key_package);
-// New storage FFI functions
-void mls_set_storage_key(const char *user_id_ptr, const char *key_ptr);
-void mls_set_storage_rekey(const char *user_id_ptr, const char *old_key_ptr, const char *new_key_ptr);
-uint8_t* mls_add_members(const void* client, const char* group_id, const char* creator_id, const char** receiver_keypackages, int receiver_count, int** out_lens, int* out_count);
-char* mls_export_secret(const void* client, const char* group_id, const char* creator_id, const char* label, const uint8_t* context, int context_len, unsigned int length);
-char** mls_group_members(const void* client, const char* group_id, const char* user_id, int* out_len);
-
-// New FFI functions
-int mls_process_message(const void* client, const char* group_id, const char* user_id, const uint8_t* message_bytes, int message_len, int* out_type, uint8_t** out_content, int* out_content_len, uint8_t** out_sender, int* out_sender_len, int* out_validated);
-int mls_accept_proposal(const void* client, const char* group_id, const char* user_id, const uint8_t* message_bytes, int message_len);
-uint8_t* mls_create_add_proposal(const void* client, const char* group_id, const char* sender_id, const uint8_t* key_package_bytes, int key_package_len, int* out_len);
-uint8_t* mls_create_remove_proposal(const void* client, const char* group_id, const char* creator_id, unsigned int member_index, int* out_len);
-uint8_t* mls_remove_members(const void* client, const char* group_id, const char* creator_id, const int** member_indices, int member_count, int* out_count);
-uint8_t* mls_self_update(const void* client, const char* group_id, const char* member_id, int* out_len, uint8_t** out_welcome, int* out_welcome_len);
-uint8_t* mls_self_remove(const void* client, const char* group_id, const char* member_id, int* out_len);
-uint8_t* mls_create_application_message(const void* client, const char* group_id, const char* user_id, const uint8_t* plaintext, int plaintext_len, int* out_len);
-uint8_t* mls_commit_pending_proposals(const void* client, const char* group_id, const char* creator_id, int* out_len, uint8_t** out_welcome, int* out_welcome_len);
-
-// Memory management functions
-void mls_free_client(void* client);
-void mls_free_string(char* ptr);
-void mls_free_bytes(uint8_t* ptr);
-void mls_free_group(void* group_handle);
-void mls_free_string_array(char** ptr, int count);
-
-// MLSProcessResult struct
-typedef struct {
-    uint32_t message_type;
-    char* content;
-    void* proposal;
-    void* commit;
-    uint64_t epoch;
-} MLSProcessResult;
-
-#ifdef __cplusplus
-}
-#endif
+#include <CommonCrypto/CommonDigest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Live group handles kept by default before LRU eviction
+static const size_t MLSDefaultGroupHandleLimit = 64;
+
+// Default key package pool sizing per identity
+static const NSUInteger MLSDefaultKeyPackageLowWaterMark = 4;
+static const NSUInteger MLSDefaultKeyPackagePoolSize = 16;
+
+// Key packages generated per background refill step
+static const NSInteger MLSKeyPackageRefillBatch = 4;
+
+// Exporter secrets kept across all groups
+static const size_t MLSDefaultExporterSecretCacheSize = 128;
+
+// Membership deltas kept per roster for groupMemberChanges
+static const NSUInteger MLSMemberRosterChangeLogLimit = 32;
+
+// Members staged between bulkUpdateMembers progress events
+static const NSUInteger MLSMembershipProgressStride = 32;
+
+// Group joins in flight at once in joinGroups; each blocks a worker in the FFI
+static const long MLSJoinGroupsConcurrency = 4;
+
+// Longest a storage batch stays open before the bridge commits it itself
+static const int64_t MLSStorageBatchTimeout = 10 * NSEC_PER_SEC;
+
+// Groups remembered across launches for warm start
+static const NSUInteger MLSRecentGroupLimit = 128;
+
+// Groups initializeAsync loads by default, and how many load at once
+static const NSUInteger MLSDefaultWarmStartGroups = 8;
+static const long MLSWarmStartConcurrency = 2;
+
+// Future-epoch messages parked per group and in total, how many epochs
+// ahead of their group they may be, and how long they wait for its commit
+static const size_t MLSDefaultReorderMessagesPerGroup = 32;
+static const size_t MLSDefaultReorderBytes = 1024 * 1024;
+static const uint64_t MLSDefaultReorderEpochsAhead = 2;
+static const int64_t MLSDefaultReorderTimeToLiveMs = 30 * 1000;
+
+// Ciphertexts per generation of the duplicate filter; it remembers between
+// one and two generations, about 70 KB
+static const size_t MLSCiphertextFilterCapacity = 2048;
+
+// Longest that maintenance work waits while the device saves energy
+static const NSTimeInterval MLSBackgroundDeferralLimit = 60;
+
+// Self-update each enrolled group about once a day, spread over the last
+// quarter of the interval, with at most two rotations at a time
+static const NSTimeInterval MLSDefaultKeyRotationInterval = 24 * 60 * 60;
+static const double MLSDefaultKeyRotationJitter = 0.25;
+static const NSUInteger MLSDefaultKeyRotationConcurrency = 2;
+
+// Proposals of an aggregating group are committed once eight are pending,
+// five seconds after the first, or after half a second without traffic
+static const NSUInteger MLSDefaultProposalBatchSize = 8;
+static const NSTimeInterval MLSDefaultProposalMaxDelay = 5;
+static const NSTimeInterval MLSDefaultProposalIdleDelay = 0.5;
+
+NSString *const MLSEpochChangedEvent = @"MLSEpochChanged";
+NSString *const MLSMembershipChangedEvent = @"MLSMembershipChanged";
+NSString *const MLSPendingProposalsChangedEvent = @"MLSPendingProposalsChanged";
+NSString *const MLSMembershipProgressEvent = @"MLSMembershipProgress";
+NSString *const MLSStartupEvent = @"MLSStartup";
+NSString *const MLSDeferredMessageEvent = @"MLSDeferredMessage";
+NSString *const MLSKeyRotatedEvent = @"MLSKeyRotated";
+NSString *const MLSProposalsCommittedEvent = @"MLSProposalsCommitted";
+NSString *const MLSMemoryTrimmedEvent = @"MLSMemoryTrimmed";
+
+// Registered through MLSModule.meshOutbox
+static __weak id<MLSMeshOutbox> MLSRegisteredMeshOutbox = nil;
+static os_unfair_lock MLSMeshOutboxLock = OS_UNFAIR_LOCK_INIT;
+
+// Rejection for maintenance work cancelled before it started
+static dispatch_block_t MLSCancelledRejection(RCTPromiseRejectBlock rejecter)
+{
+    return ^{
+        rejecter(@"cancelled", @"Cancelled before it started", MLSBridgeError(MLSErrorCodeCancelled));
+    };
+}
+
+static NSString *MLSProposalCommitReasonName(MLSProposalCommitReason reason)
+{
+    switch (reason) {
+        case MLSProposalCommitReasonCount: return @"count";
+        case MLSProposalCommitReasonTime: return @"time";
+        case MLSProposalCommitReasonIdle: return @"idle";
+        case MLSProposalCommitReasonFlush: return @"flush";
+    }
+    return @"unknown";
+}
+
+// Key package work is ordered per identity on its own scheduler lane
+static NSString *MLSIdentityLaneKey(NSString *identity)
+{
+    return [@"identity:" stringByAppendingString:identity];
+}
+
+// NULL when the Rust library cannot open a stored group by itself
+static mls_load_group_fn MLSLoadGroupFunction(void)
+{
+    static mls_load_group_fn loadGroup;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        loadGroup = (mls_load_group_fn)dlsym(RTLD_DEFAULT, "mls_load_group");
+    });
+    return loadGroup;
+}
+
+static NSError *MLSStartupError(NSString *description, NSError *underlying)
+{
+    NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithObject:description forKey:NSLocalizedDescriptionKey];
+    userInfo[NSUnderlyingErrorKey] = underlying;
+    return [NSError errorWithDomain:@"MLSModule" code:0 userInfo:userInfo];
+}
+
+// A failed entry of a batch result, with the {code, category, retryable}
+// a rejection would carry
+static NSDictionary *MLSBatchFailure(NSDictionary *entry, NSError *cause)
+{
+    NSMutableDictionary *failure = [MLSErrorFields(cause) mutableCopy];
+    [failure addEntriesFromDictionary:entry];
+    return failure;
+}
+
+// What processing one ciphertext came to, before it is turned into a
+// dictionary or a compact record
+struct MLSProcessedMessage {
+    enum class Outcome { Processed, Deferred, Duplicate };
+    Outcome outcome = Outcome::Processed;
+    int messageType = 0;
+    NSData *content = nil;
+    NSData *sender = nil;
+    BOOL validated = NO;
+    // The message's epoch, or for a deferred one the epoch it waits for
+    uint64_t epoch = 0;
+    uint64_t ticket = 0;
+    NSDictionary *memberChanges = nil;
+};
+
+static void MLSAppendCompactMessage(NSMutableData *buffer, const MLSProcessedMessage &message)
+{
+    switch (message.outcome) {
+        case MLSProcessedMessage::Outcome::Duplicate:
+            MLSAppendCompactResult(buffer, MLSCompactKind::Duplicate, 0, 0, nullptr, 0, nullptr, 0);
+            return;
+        case MLSProcessedMessage::Outcome::Deferred:
+            MLSAppendCompactDeferred(buffer, message.epoch, message.ticket);
+            return;
+        case MLSProcessedMessage::Outcome::Processed:
+            break;
+    }
+    MLSAppendCompactResult(buffer, (MLSCompactKind)message.messageType, message.validated ? MLSCompactFlagValidated : 0,
+                           message.epoch, message.sender.bytes, message.sender.length,
+                           message.content.bytes, message.content.length);
+}
+
+static void MLSAppendCompactFailure(NSMutableData *buffer, NSError *cause)
+{
+    NSDictionary *fields = MLSErrorFields(cause);
+    MLSAppendCompactError(buffer, fields[@"code"], [fields[@"retryable"] boolValue]);
+}
+
+// Wrap a Rust-owned buffer without copying it. The bytes are handed back to
+// mls_free_bytes when the NSData is released, so callers must not free them.
+static NSData *MLSDataFromRustBytes(uint8_t *bytes, int length)
+{
+    if (bytes == NULL) {
+        return [NSData data];
+    }
+    return [[NSData alloc] initWithBytesNoCopy:bytes
+                                        length:(NSUInteger)length
+                                   deallocator:^(void *rustBytes, NSUInteger rustLength) {
+        mls_free_bytes((uint8_t *)rustBytes);
+    }];
+}
+
+static int MLSHexValue(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// mls_export_secret hands the secret back as text. Accept hex or base64 and
+// require the decoded size to match the requested length.
+static bool MLSDecodeExportedSecret(const char *text, uint32_t length, std::vector<uint8_t> &secret)
+{
+    size_t textLength = strlen(text);
+    secret.assign(length, 0);
+
+    if (textLength == (size_t)length * 2) {
+        bool hex = true;
+        for (size_t i = 0; i < length && hex; i++) {
+            int high = MLSHexValue(text[2 * i]);
+            int low = MLSHexValue(text[2 * i + 1]);
+            hex = high >= 0 && low >= 0;
+            secret[i] = (uint8_t)((high << 4) | low);
+        }
+        if (hex) {
+            return true;
+        }
+    }
+
+    NSData *encoded = [[NSData alloc] initWithBytesNoCopy:(void *)text length:textLength freeWhenDone:NO];
+    NSMutableData *decoded = [[NSMutableData alloc] initWithBase64EncodedData:encoded options:0];
+    bool matches = decoded != nil && decoded.length == length;
+    if (matches) {
+        memcpy(secret.data(), decoded.bytes, length);
+    } else {
+        MLSZeroize(secret);
+        secret.clear();
+    }
+    if (decoded != nil) {
+        memset(decoded.mutableBytes, 0, decoded.length);
+    }
+    return matches;
+}
 
 @implementation MLSModule
+{
+    dispatch_queue_t _methodQueue;
+    MLSGroupScheduler *_scheduler;
+    MLSClientTable *_clients;
+    MLSKeyPackagePool *_keyPackagePool;
+    MLSMemberRoster *_memberRoster;
+    MLSGroupStateTracker *_groupStates;
+    MLSStorageTuning *_storageTuning;
+    MLSWarmStart *_warmStart;
+    MLSBackgroundWork *_backgroundWork;
+    MLSKeyRotationSchedule *_keyRotations;
+    MLSProposalAggregator *_proposalAggregator;
+    MLSMemoryBudget *_memoryBudget;
+    std::atomic<bool> _hasListeners;
+    std::unique_ptr<MLSGroupHandleCache> _groupHandles;
+    std::unique_ptr<MLSMetrics> _metrics;
+    std::unique_ptr<MLSExporterSecretCache> _exporterSecrets;
+    std::unique_ptr<MLSEpochReorderBuffer> _reorderBuffer;
+    std::unique_ptr<MLSCiphertextFilter> _ciphertextFilter;
+}
+
+@synthesize scheduler = _scheduler;
+
+RCT_EXPORT_MODULE()
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        _methodQueue = dispatch_queue_create("com.reactnativemls.MLSQueue", DISPATCH_QUEUE_SERIAL);
+        _scheduler = [[MLSGroupScheduler alloc] initWithLabel:@"com.reactnativemls.MLSQueue.groups"];
+        _clients = [[MLSClientTable alloc] initWithSharedClient:[[MLSIdentityClient alloc] initWithIdentity:nil scheduler:_scheduler]];
+        _keyPackagePool = [[MLSKeyPackagePool alloc] initWithLowWaterMark:MLSDefaultKeyPackageLowWaterMark
+                                                               targetSize:MLSDefaultKeyPackagePoolSize];
+        _memberRoster = [[MLSMemberRoster alloc] initWithChangeLogLimit:MLSMemberRosterChangeLogLimit];
+        _groupStates = [[MLSGroupStateTracker alloc] init];
+        _storageTuning = [[MLSStorageTuning alloc] init];
+        _warmStart = [[MLSWarmStart alloc] initWithLimit:MLSRecentGroupLimit];
+        _backgroundWork = [[MLSBackgroundWork alloc] initWithDeferralLimit:MLSBackgroundDeferralLimit];
+        _keyRotations = [[MLSKeyRotationSchedule alloc] initWithInterval:MLSDefaultKeyRotationInterval
+                                                                  jitter:MLSDefaultKeyRotationJitter
+                                                           maxConcurrent:MLSDefaultKeyRotationConcurrency];
+        __weak MLSModule *weakSelf = self;
+        _keyRotations.rotationHandler = ^(NSString *groupId, NSString *userId) {
+            [weakSelf rotateKeysOfGroup:groupId userId:userId];
+        };
+        _proposalAggregator = [[MLSProposalAggregator alloc] initWithMaxProposals:MLSDefaultProposalBatchSize
+                                                                         maxDelay:MLSDefaultProposalMaxDelay
+                                                                        idleDelay:MLSDefaultProposalIdleDelay];
+        _proposalAggregator.commitHandler = ^(NSString *groupId, NSString *userId, MLSProposalCommitReason reason) {
+            [weakSelf commitAggregatedProposals:groupId userId:userId reason:reason];
+        };
+        _groupHandles.reset(new MLSGroupHandleCache(MLSDefaultGroupHandleLimit, mls_free_group));
+        _metrics.reset(new MLSMetrics());
+        _exporterSecrets.reset(new MLSExporterSecretCache(MLSDefaultExporterSecretCacheSize));
+        _reorderBuffer.reset(new MLSEpochReorderBuffer({
+            MLSDefaultReorderMessagesPerGroup,
+            MLSDefaultReorderBytes,
+            MLSDefaultReorderEpochsAhead,
+            std::chrono::milliseconds(MLSDefaultReorderTimeToLiveMs),
+        }));
+        _ciphertextFilter.reset(new MLSCiphertextFilter(MLSCiphertextFilterCapacity));
+        // No budget until the app sets one; system warnings trim regardless
+        _memoryBudget = [[MLSMemoryBudget alloc] initWithBudget:0];
+        _memoryBudget.trimHandler = ^(MLSMemoryTrimLevel level, NSString *reason) {
+            [weakSelf memoryTrimRequested:level reason:reason];
+        };
+    }
+    return self;
+}
+
+// Return a background queue for receiving calls. It only hands work off to
+// the scheduler: operations on the same group run in call order on that
+// group's lane, while different groups run in parallel.
+- (dispatch_queue_t)methodQueue
+{
+    return _methodQueue;
+}
+
+- (MLSMetrics *)metrics
+{
+    return _metrics.get();
+}
+
+- (MLSCiphertextFilter *)ciphertextFilter
+{
+    return _ciphertextFilter.get();
+}
+
+- (MLSGroupHandleCache *)groupHandles
+{
+    return _groupHandles.get();
+}
+
+- (MLSKeyRotationSchedule *)keyRotations
+{
+    return _keyRotations;
+}
+
+- (MLSProposalAggregator *)proposalAggregator
+{
+    return _proposalAggregator;
+}
+
+- (void *)mlsClient
+{
+    return _clients.sharedClient.client;
+}
+
+- (void)setMlsClient:(void *)mlsClient
+{
+    _clients.sharedClient.client = mlsClient;
+}
+
+- (MLSIdentityClient *)clientForIdentity:(NSString *)identity
+{
+    return [_clients clientForIdentity:identity];
+}
+
++ (id<MLSMeshOutbox>)meshOutbox
+{
+    os_unfair_lock_lock(&MLSMeshOutboxLock);
+    id<MLSMeshOutbox> outbox = MLSRegisteredMeshOutbox;
+    os_unfair_lock_unlock(&MLSMeshOutboxLock);
+    return outbox;
+}
+
++ (void)setMeshOutbox:(id<MLSMeshOutbox>)meshOutbox
+{
+    os_unfair_lock_lock(&MLSMeshOutboxLock);
+    MLSRegisteredMeshOutbox = meshOutbox;
+    os_unfair_lock_unlock(&MLSMeshOutboxLock);
+}
+
+- (void)handOffCommit:(NSData *)commit
+              welcome:(NSData *)welcome
+              groupId:(NSString *)groupId
+             senderId:(NSString *)senderId
+{
+    id<MLSMeshOutbox> outbox = MLSModule.meshOutbox;
+    if (outbox != nil) {
+        [outbox mlsGroup:groupId didCreateCommit:commit welcome:welcome senderId:senderId];
+    }
+}
+
+- (NSArray<NSString *> *)supportedEvents
+{
+    return @[MLSEpochChangedEvent, MLSMembershipChangedEvent, MLSPendingProposalsChangedEvent, MLSMembershipProgressEvent, MLSStartupEvent,
+             MLSDeferredMessageEvent, MLSKeyRotatedEvent, MLSProposalsCommittedEvent, MLSMemoryTrimmedEvent];
+}
+
+- (void)startObserving
+{
+    // Epochs and proposal counts were not tracked while nobody listened
+    [_groupStates removeAllStates];
+    _hasListeners = true;
+}
+
+- (void)stopObserving
+{
+    _hasListeners = false;
+}
+
+// Install the ArrayBuffer-based binary transport as global.__mlsBinary
+RCT_EXPORT_BLOCKING_SYNCHRONOUS_METHOD(installBinaryTransport)
+{
+    RCTCxxBridge *cxxBridge = (RCTCxxBridge *)self.bridge;
+    if (!cxxBridge.runtime) {
+        return @NO;
+    }
+
+    MLSInstallBinaryBindings(*(facebook::jsi::Runtime *)cxxBridge.runtime, self);
+    return @YES;
+}
+
+// Export methods to JavaScript
+
+// Point storage at the app group and create the shared client. Must run as
+// a barrier on the shared scheduler. Returns nil, or why startup failed with
+// the underlying error as NSUnderlyingErrorKey.
+- (NSError *)startSharedClient:(NSString *)groupID trace:(MLSOperationTrace &)trace
+{
+    // The storage location is the one platform-specific part of the module
+    NSError *fsError = nil;
+    NSString *storageDir = MLSResolveStorageDirectory(groupID, &fsError);
+    if (!storageDir) {
+        return MLSStartupError(@"Failed to create storage directory", fsError);
+    }
+
+    // Rust's storage provider opens "<storageDir>/<identity>.sqlite",
+    // with the tuning from configureStorage when the library supports it.
+    // Batches still open belong to the previous client's connections.
+    trace.enterPhase(MLSOperationPhase::FFI);
+    [_storageTuning endAllBatches];
+    mls_set_storage_path(storageDir.UTF8String);
+    [_storageTuning apply];
+    trace.enterPhase(MLSOperationPhase::Marshal);
+    [_warmStart loadFromDirectory:storageDir];
+
+    // Now create the MLS client
+    trace.enterPhase(MLSOperationPhase::FFI);
+    void *client = mls_client_create();
+    trace.enterPhase(MLSOperationPhase::Marshal);
+    if (!client) {
+        return MLSStartupError(@"mls_client_create() failed", MLSTakeLastFFIError());
+    }
+    // Pooled packages, cached rosters and group handles belong to the previous client
+    _groupHandles->clear();
+    [_keyPackagePool removeAllKeyPackages];
+    [_memberRoster removeAllRosters];
+    [_groupStates removeAllStates];
+    _exporterSecrets->clear();
+    _reorderBuffer->clear();
+    _ciphertextFilter->clear();
+    [_keyRotations removeAllGroups];
+    [_proposalAggregator removeAllGroups];
+    self.mlsClient = client;
+    [_warmStart clientDidStart];
+    return nil;
+}
+
+// Initialize the MLS module
+RCT_EXPORT_METHOD(initialize:(NSString *)groupID      
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    [_warmStart beginStartup:NO];
+
+    // Client-wide: waits for in-flight group work and holds off new work
+    [_scheduler dispatchBarrierAsync:^{
+        MLSOperationTrace trace(_metrics.get(), "initialize", MLSPayloadSize(groupID));
+        NSError *error = [self startSharedClient:groupID trace:trace];
+        if (error != nil) {
+            reject(@"init_error", error.localizedDescription, error.userInfo[NSUnderlyingErrorKey]);
+            return;
+        }
+        resolve(trace.succeed(nil));
+    }];
+}
+
+// Initialize without waiting for storage or the client. Operations called
+// after this resolves queue behind the startup barrier, so they run once
+// the client exists. The most recently used groups are then loaded in the
+// background, in the order of the recency list kept from earlier runs.
+RCT_EXPORT_METHOD(initializeAsync:(NSString *)groupID
+                  options:(NSDictionary *)options
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    NSUInteger warmGroups = MLSDefaultWarmStartGroups;
+    id value = [options isKindOfClass:[NSDictionary class]] ? options[@"warmGroups"] : nil;
+    if (value != nil) {
+        if (![value isKindOfClass:[NSNumber class]] || [value integerValue] < 0) {
+            rejecter(@"E_MLS", @"warmGroups must be a non-negative number", MLSBridgeError(MLSErrorCodeInvalidInput));
+            return;
+        }
+        warmGroups = [value unsignedIntegerValue];
+    }
+
+    [_warmStart beginStartup:YES];
+    [_scheduler dispatchBarrierAsync:^{
+        MLSOperationTrace trace(_metrics.get(), "initializeAsync", MLSPayloadSize(groupID));
+        NSError *error = [self startSharedClient:groupID trace:trace];
+        if (error != nil) {
+            // Operations queued meanwhile fail with client_error
+            RCTLogWarn(@"MLS startup failed: %@", error.localizedDescription);
+            [self sendStartupEvent:@{ @"state": @"failed", @"error": error.localizedDescription }];
+            return;
+        }
+        trace.succeed();
+        [self sendStartupEvent:@{ @"state": @"ready" }];
+        [self warmRecentGroups:warmGroups owner:_clients.sharedClient];
+    }];
+    resolver(@YES);
+}
+
+- (void)sendStartupEvent:(NSDictionary *)body
+{
+    if (_hasListeners) {
+        [self sendEventWithName:MLSStartupEvent body:body];
+    }
+}
+
+// Load up to `count` of the owner's recently used groups ahead of use. Each
+// load runs on its group's lane, a few at a time, so an operation JS sends
+// meanwhile waits for the load it would otherwise do itself.
+- (void)warmRecentGroups:(NSUInteger)count owner:(MLSIdentityClient *)owner
+{
+    // Loading more than the cache holds would evict the first ones again
+    count = MIN(count, _groupHandles->capacity());
+    NSMutableArray<NSDictionary<NSString *, NSString *> *> *groups = [NSMutableArray arrayWithCapacity:count];
+    for (NSDictionary<NSString *, NSString *> *entry in [_warmStart recentGroups]) {
+        if (groups.count == count) {
+            break;
+        }
+        if ([_clients clientForIdentity:entry[@"userId"]] == owner) {
+            [groups addObject:entry];
+        }
+    }
+
+    void *client = owner.client;
+    auto warmed = std::make_shared<std::atomic<NSUInteger>>(0);
+
+    // The coordinator blocks while the window is full; keep it off the lanes
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        dispatch_group_t loads = dispatch_group_create();
+        dispatch_semaphore_t window = dispatch_semaphore_create(MLSWarmStartConcurrency);
+
+        for (NSDictionary<NSString *, NSString *> *entry in groups) {
+            NSString *groupId = entry[@"groupId"];
+            NSString *userId = entry[@"userId"];
+            dispatch_semaphore_wait(window, DISPATCH_TIME_FOREVER);
+            dispatch_group_enter(loads);
+            [owner.scheduler dispatchAsyncForKey:groupId block:^{
+                // Skipped if initialize replaced the client meanwhile
+                if (owner.client == client && [self warmGroup:groupId userId:userId client:client]) {
+                    warmed->fetch_add(1);
+                }
+                dispatch_semaphore_signal(window);
+                dispatch_group_leave(loads);
+            }];
+        }
+
+        dispatch_group_notify(loads, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+            NSUInteger warmedGroups = warmed->load();
+            [_warmStart warmingDidFinish:warmedGroups];
+            [self sendStartupEvent:@{ @"state": @"warm", @"warmedGroups": @(warmedGroups) }];
+        });
+    });
+}
+
+// Bring one stored group into memory: the FFI's group state, its epoch and
+// roster, and a cached handle when the library can open one. Returns NO and
+// forgets the group if it is no longer in storage. Must run on the group's lane.
+- (BOOL)warmGroup:(NSString *)groupId userId:(NSString *)userId client:(void *)client
+{
+    const char *groupIdStr = [groupId UTF8String];
+    const char *userIdStr = [userId UTF8String];
+
+    // Reading the member list makes Rust load the group from storage
+    if (![self trackMemberRoster:groupId userId:userId client:client]) {
+        [_warmStart forgetGroup:groupId userId:userId];
+        [_keyRotations removeGroup:groupId userId:userId];
+        [_proposalAggregator removeGroup:groupId userId:userId];
+        return NO;
+    }
+
+    NSNumber *previousEpoch = nil;
+    uint64_t epoch = mls_get_current_epoch(client, groupIdStr, userIdStr);
+    [_groupStates updateEpoch:epoch forGroup:groupId userId:userId previousEpoch:&previousEpoch];
+
+    mls_load_group_fn loadGroup = MLSLoadGroupFunction();
+    std::string key = MLSGroupHandleKey(groupIdStr, userIdStr);
+    if (loadGroup != NULL && !_groupHandles->contains(key)) {
+        _groupHandles->put(key, loadGroup(client, groupIdStr, userIdStr));
+    }
+    return YES;
+}
+
+// Note a group use for the handle LRU and the warm start recency list.
+// Must run on the group's lane.
+- (void)groupWasUsed:(NSString *)groupId userId:(NSString *)userId decrypted:(BOOL)decrypted
+{
+    // Mark the handle as recently used so busy groups keep it
+    _groupHandles->get(MLSGroupHandleKey([groupId UTF8String], [userId UTF8String]));
+    [_warmStart groupWasUsed:groupId userId:userId];
+    [_proposalAggregator noteTraffic];
+    [_memoryBudget checkFootprint];
+    if (decrypted) {
+        [_warmStart messageWasDecrypted];
+    }
+}
+
+// Set storage key for a user
+RCT_EXPORT_METHOD(setStorageKey:(NSString *)userId
+                  key:(NSString *)key
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    // Waits for in-flight work of the user's client and holds off new work
+    MLSIdentityClient *owner = [_clients clientForIdentity:userId];
+    [owner.scheduler dispatchBarrierAsync:^{
+        MLSOperationTrace trace(_metrics.get(), "setStorageKey", MLSPayloadSize(userId) + MLSPayloadSize(key));
+
+        @try {
+            const char *user_id_cstr = [userId UTF8String];
+            const char *key_cstr = [key UTF8String];
+            trace.enterPhase(MLSOperationPhase::FFI);
+            mls_set_storage_key(user_id_cstr, key_cstr);
+            trace.enterPhase(MLSOperationPhase::Marshal);
+            resolve(trace.succeed(nil));
+        } @catch (NSException *exception) {
+            reject(@"set_storage_key_error", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
+        }
+    }];
+}
+
+// Rekey storage for a user
+RCT_EXPORT_METHOD(setStorageRekey:(NSString *)userId
+                  oldKey:(NSString *)oldKey
+                  newKey:(NSString *)newKey
+                  resolver:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    // Waits for in-flight work of the user's client and holds off new work
+    MLSIdentityClient *owner = [_clients clientForIdentity:userId];
+    [owner.scheduler dispatchBarrierAsync:^{
+        MLSOperationTrace trace(_metrics.get(), "setStorageRekey", MLSPayloadSize(userId) + MLSPayloadSize(oldKey) + MLSPayloadSize(newKey));
+
+        @try {
+            const char *user_id_cstr = [userId UTF8String];
+            const char *old_key_cstr = [oldKey UTF8String];
+            const char *new_key_cstr = [newKey UTF8String];
+            trace.enterPhase(MLSOperationPhase::FFI);
+            mls_set_storage_rekey(user_id_cstr, old_key_cstr, new_key_cstr);
+            trace.enterPhase(MLSOperationPhase::Marshal);
+            resolve(trace.succeed(nil));
+        } @catch (NSException *exception) {
+            reject(@"set_storage_rekey_error", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
+        }
+    }];
+}
+
+// Tune the storage provider's SQLite connections. Options, all optional:
+// wal (bool), synchronous ("off", "normal", "full"), cacheSizeKiB and
+// groupCommitIntervalMs. Resolves the resulting storage statistics.
+RCT_EXPORT_METHOD(configureStorage:(NSDictionary *)options
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    // Client-wide: waits for in-flight group work and holds off new work
+    [_scheduler dispatchBarrierAsync:^{
+        MLSOperationTrace trace(_metrics.get(), "configureStorage", MLSPayloadSize(options));
+
+        @try {
+            id wal = options[@"wal"];
+            id synchronous = options[@"synchronous"];
+            id cacheSize = options[@"cacheSizeKiB"];
+            id groupCommitInterval = options[@"groupCommitIntervalMs"];
+
+            NSDictionary<NSString *, NSNumber *> *synchronousLevels = @{
+                @"off": @(MLSStorageSynchronousOff),
+                @"normal": @(MLSStorageSynchronousNormal),
+                @"full": @(MLSStorageSynchronousFull),
+            };
+            if ((wal && ![wal isKindOfClass:[NSNumber class]]) ||
+                (synchronous && !([synchronous isKindOfClass:[NSString class]] && synchronousLevels[synchronous])) ||
+                (cacheSize && !([cacheSize isKindOfClass:[NSNumber class]] && [cacheSize integerValue] > 0)) ||
+                (groupCommitInterval && !([groupCommitInterval isKindOfClass:[NSNumber class]] && [groupCommitInterval integerValue] >= 0))) {
+                rejecter(@"E_MLS", @"Storage options need wal: bool, synchronous: off|normal|full, cacheSizeKiB > 0, groupCommitIntervalMs >= 0", MLSBridgeError(MLSErrorCodeInvalidInput));
+                return;
+            }
+
+            if (wal) {
+                _storageTuning.journalModeWAL = [wal boolValue];
+            }
+            if (synchronous) {
+                _storageTuning.synchronous = (MLSStorageSynchronous)synchronousLevels[synchronous].integerValue;
+            }
+            if (cacheSize) {
+                _storageTuning.cacheSizeKiB = [cacheSize unsignedIntegerValue];
+            }
+            if (groupCommitInterval) {
+                _storageTuning.groupCommitIntervalMs = [groupCommitInterval unsignedIntegerValue];
+            }
+
+            trace.enterPhase(MLSOperationPhase::FFI);
+            BOOL applied = [_storageTuning apply];
+            trace.enterPhase(MLSOperationPhase::Marshal);
+            if (!applied && _storageTuning.supported) {
+                rejecter(@"E_MLS", @"Storage layer rejected the options", MLSTakeLastFFIError());
+                return;
+            }
+            resolver(trace.succeed([_storageTuning statistics]));
+        } @catch (NSException *exception) {
+            rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
+        }
+    }];
+}
+
+// Open a batch for an identity: state changes until the matching endBatch
+// share one storage transaction. Batches nest; a batch left open for longer
+// than MLSStorageBatchTimeout is committed by the bridge.
+RCT_EXPORT_METHOD(beginBatch:(NSString *)userId
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    // A barrier, so the batch covers exactly the work scheduled after it
+    MLSIdentityClient *owner = [_clients clientForIdentity:userId];
+    [owner.scheduler dispatchBarrierAsync:^{
+        MLSOperationTrace trace(_metrics.get(), "beginBatch", MLSPayloadSize(userId));
+
+        @try {
+            uint64_t generation = 0;
+            trace.enterPhase(MLSOperationPhase::FFI);
+            NSUInteger depth = [_storageTuning beginBatchForIdentity:userId generation:&generation];
+            trace.enterPhase(MLSOperationPhase::Marshal);
+
+            if (depth == 1) {
+                __weak MLSModule *weakSelf = self;
+                dispatch_after(dispatch_time(DISPATCH_TIME_NOW, MLSStorageBatchTimeout), _methodQueue, ^{
+                    MLSModule *strongSelf = weakSelf;
+                    if (strongSelf == nil) {
+                        return;
+                    }
+                    [owner.scheduler dispatchBarrierAsync:^{
+                        if ([strongSelf->_storageTuning expireBatchForIdentity:userId generation:generation]) {
+                            RCTLogWarn(@"MLS storage batch for %@ was not ended within %llds; committed it", userId, (long long)(MLSStorageBatchTimeout / NSEC_PER_SEC));
+                        }
+                    }];
+                });
+            }
+            resolver(trace.succeed(@{
+                @"depth": @(depth),
+                @"transactional": @(_storageTuning.supported),
+            }));
+        } @catch (NSException *exception) {
+            rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
+        }
+    }];
+}
+
+// Close the innermost batch for an identity, committing its transaction
+// once the outermost batch closes
+RCT_EXPORT_METHOD(endBatch:(NSString *)userId
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    // A barrier, so every message dispatched inside the batch has been applied
+    MLSIdentityClient *owner = [_clients clientForIdentity:userId];
+    [owner.scheduler dispatchBarrierAsync:^{
+        MLSOperationTrace trace(_metrics.get(), "endBatch", MLSPayloadSize(userId));
+
+        @try {
+            trace.enterPhase(MLSOperationPhase::FFI);
+            NSInteger depth = [_storageTuning endBatchForIdentity:userId];
+            trace.enterPhase(MLSOperationPhase::Marshal);
+            if (depth < 0) {
+                rejecter(@"E_MLS", @"No storage batch open for this user", MLSBridgeError(MLSErrorCodeInvalidInput));
+                return;
+            }
+            resolver(trace.succeed(@{
+                @"depth": @(depth),
+                @"committed": @(depth == 0),
+            }));
+        } @catch (NSException *exception) {
+            rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
+        }
+    }];
+}
+
+// Give an identity its own client and lanes, so its work no longer waits
+// behind other identities on the shared client. Resolves NO if it already
+// has one. The storage path comes from initialize, which must run first.
+RCT_EXPORT_METHOD(openClient:(NSString *)identity
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    // Registered now, so every operation scheduled from here on picks the new client
+    MLSIdentityClient *owner = [_clients addClientForIdentity:identity];
+    if (owner == nil) {
+        resolver(@NO);
+        return;
+    }
+
+    // The identity's work already queued on the shared client finishes first
+    dispatch_semaphore_t drained = dispatch_semaphore_create(0);
+    __block BOOL storageReady = NO;
+    [_scheduler dispatchBarrierAsync:^{
+        storageReady = self.mlsClient != NULL;
+        [_storageTuning endBatchesForIdentity:identity];
+        const char *identityStr = [identity UTF8String];
+        _groupHandles->evictIf([identityStr](const std::string &key) { return MLSGroupHandleKeyHasUser(key, identityStr); });
+        dispatch_semaphore_signal(drained);
+    }];
+
+    [owner.scheduler dispatchBarrierAsync:^{
+        MLSOperationTrace trace(_metrics.get(), "openClient", MLSPayloadSize(identity));
+        dispatch_semaphore_wait(drained, DISPATCH_TIME_FOREVER);
+
+        if (!storageReady) {
+            [_clients removeClient:owner];
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
+            return;
+        }
+
+        trace.enterPhase(MLSOperationPhase::FFI);
+        void *client = mls_client_create();
+        trace.enterPhase(MLSOperationPhase::Marshal);
+        if (!client) {
+            // Operations scheduled meanwhile fail with client_error
+            [_clients removeClient:owner];
+            rejecter(@"init_error", @"mls_client_create() failed", MLSTakeLastFFIError());
+            return;
+        }
+        owner.client = client;
+        resolver(trace.succeed(@YES));
+    }];
+}
+
+// Release an identity's own client once its queued work has run; later
+// operations for the identity use the shared client again. Resolves NO if
+// the identity had no client of its own.
+RCT_EXPORT_METHOD(closeClient:(NSString *)identity
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    MLSIdentityClient *owner = [_clients removeClientForIdentity:identity];
+    if (owner == nil) {
+        resolver(@NO);
+        return;
+    }
+
+    // The shared client waits until the identity's work on its own client is done
+    dispatch_semaphore_t closed = dispatch_semaphore_create(0);
+    [_scheduler dispatchBarrierAsync:^{
+        dispatch_semaphore_wait(closed, DISPATCH_TIME_FOREVER);
+    }];
+
+    [owner.scheduler dispatchBarrierAsync:^{
+        MLSOperationTrace trace(_metrics.get(), "closeClient", MLSPayloadSize(identity));
+        trace.enterPhase(MLSOperationPhase::FFI);
+        [self releaseClient:owner];
+        trace.enterPhase(MLSOperationPhase::Marshal);
+        dispatch_semaphore_signal(closed);
+        resolver(trace.succeed(@YES));
+    }];
+}
+
+// Commit the identity's batches and free its group handles, then the client
+// they belong to. Must run as a barrier on the client's scheduler.
+- (void)releaseClient:(MLSIdentityClient *)owner
+{
+    [_storageTuning endBatchesForIdentity:owner.identity];
+    std::vector<MLSDeferredMessage> removed;
+    _reorderBuffer->removeUser([owner.identity UTF8String], removed);
+    [self forgetDeferredMessages:removed];
+    [_keyRotations removeUser:owner.identity];
+    [_proposalAggregator removeUser:owner.identity];
+    const char *identityStr = [owner.identity UTF8String];
+    _groupHandles->evictIf([identityStr](const std::string &key) { return MLSGroupHandleKeyHasUser(key, identityStr); });
+    if (owner.client) {
+        mls_free_client(owner.client);
+        owner.client = NULL;
+    }
+}
+
+- (void)dealloc
+{
+    // Commit open batches, write out the recency list, and release cached
+    // group handles before the clients that own them
+    [_storageTuning endAllBatches];
+    [_warmStart flush];
+    _groupHandles->clear();
+    
+    // Free the clients when the module is deallocated
+    for (MLSIdentityClient *owner in [_clients removeAllClients]) {
+        if (owner.client) {
+            mls_free_client(owner.client);
+            owner.client = NULL;
+        }
+    }
+    if (self.mlsClient) {
+        mls_free_client(self.mlsClient);
+        self.mlsClient = NULL;
+    }
+}
+
+// Create a new MLS group
+RCT_EXPORT_METHOD(createGroup:(NSString *)groupId
+                  creatorId:(NSString *)creatorId
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    MLSIdentityClient *owner = [_clients clientForIdentity:creatorId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "createGroup", MLSPayloadSize(groupId) + MLSPayloadSize(creatorId));
+
+        @try {
+            if (!owner.client) {
+                rejecter(@"E_MLS", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
+                return;
+            }
+        
+            const char* groupIdStr = [groupId UTF8String];
+            const char* creatorIdStr = [creatorId UTF8String];
+            trace.enterPhase(MLSOperationPhase::FFI);
+            void* groupHandle = mls_create_group(owner.client, groupIdStr, creatorIdStr);
+            trace.enterPhase(MLSOperationPhase::Marshal);
+        
+            if (groupHandle != NULL) {
+                // Keep the handle alive for later operations on this group
+                _groupHandles->put(MLSGroupHandleKey(groupIdStr, [creatorId UTF8String]), groupHandle);
+                [_warmStart groupWasUsed:groupId userId:creatorId];
+            
+                // Return the group ID as a string
+                resolver(trace.succeed(groupId));
+            } else {
+                rejecter(@"E_MLS", @"Failed to create group", MLSTakeLastFFIError());
+            }
+        } @catch (NSException *exception) {
+            rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
+        }
+    }];
+}
+
+// Join an existing MLS group
+RCT_EXPORT_METHOD(joinGroup:(NSString *)groupId
+                  receiverId:(NSString *)receiverId
+                  welcomeMessage:(NSString *)welcomeMessage
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    MLSIdentityClient *owner = [_clients clientForIdentity:receiverId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "joinGroup", MLSPayloadSize(groupId) + MLSPayloadSize(receiverId) + MLSPayloadSize(welcomeMessage));
+
+        @try {
+            if (!owner.client) {
+                rejecter(@"E_MLS", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
+                return;
+            }
+        
+            // Note: The Rust FFI function expects base64 encoded strings and will decode them,
+            // so we pass the strings directly without additional encoding/decoding
+            const char* groupIdStr = [groupId UTF8String];
+            const char* receiverIdStr = [receiverId UTF8String];
+            const char* welcomeMessageStr = [welcomeMessage UTF8String];
+        
+            trace.enterPhase(MLSOperationPhase::FFI);
+            void* groupHandle = mls_join_group(owner.client, groupIdStr, receiverIdStr, welcomeMessageStr);
+            trace.enterPhase(MLSOperationPhase::Marshal);
+        
+            if (groupHandle != NULL) {
+                // Keep the handle alive for later operations on this group
+                _groupHandles->put(MLSGroupHandleKey(groupIdStr, [receiverId UTF8String]), groupHandle);
+                [_warmStart groupWasUsed:groupId userId:receiverId];
+            
+                trace.enterPhase(MLSOperationPhase::FFI);
+                [self groupStateDidChange:MLSGroupStateChangeNewEpoch groupId:groupId userId:receiverId client:owner.client];
+                trace.enterPhase(MLSOperationPhase::Marshal);
+               
+                // Return the group ID as a string
+                resolver(trace.succeed(groupId));
+            } else {
+                rejecter(@"E_MLS", @"Failed to join group", MLSTakeLastFFIError());
+            }
+        } @catch (NSException *exception) {
+            rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
+        }
+    }];
+}
+
+// Join an existing MLS group with ratchet tree
+RCT_EXPORT_METHOD(joinGroupWithRatchetTree:(NSString *)groupId
+                  receiverId:(NSString *)receiverId
+                  welcomeMessage:(NSString *)welcomeMessage
+                  ratchetTree:(NSString *)ratchetTree
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    MLSIdentityClient *owner = [_clients clientForIdentity:receiverId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "joinGroupWithRatchetTree", MLSPayloadSize(groupId) + MLSPayloadSize(receiverId) + MLSPayloadSize(welcomeMessage) + MLSPayloadSize(ratchetTree));
+
+        @try {
+            if (!owner.client) {
+                rejecter(@"E_MLS", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
+                return;
+            }
+        
+            // Note: The Rust FFI function expects base64 encoded strings and will decode them,
+            // so we pass the strings directly without additional encoding/decoding
+            const char* groupIdStr = [groupId UTF8String];
+            const char* receiverIdStr = [receiverId UTF8String];
+            const char* welcomeMessageStr = [welcomeMessage UTF8String];
+            const char* ratchetTreeStr = [ratchetTree UTF8String];
+        
+            trace.enterPhase(MLSOperationPhase::FFI);
+            void* groupHandle = mls_join_group_with_ratchet_tree(owner.client, groupIdStr, receiverIdStr, welcomeMessageStr, ratchetTreeStr);
+            trace.enterPhase(MLSOperationPhase::Marshal);
+        
+            if (groupHandle != NULL) {
+                // Keep the handle alive for later operations on this group
+                _groupHandles->put(MLSGroupHandleKey(groupIdStr, [receiverId UTF8String]), groupHandle);
+                [_warmStart groupWasUsed:groupId userId:receiverId];
+            
+                trace.enterPhase(MLSOperationPhase::FFI);
+                [self groupStateDidChange:MLSGroupStateChangeNewEpoch groupId:groupId userId:receiverId client:owner.client];
+                trace.enterPhase(MLSOperationPhase::Marshal);
+               
+                // Return the group ID as a string
+                resolver(trace.succeed(groupId));
+            } else {
+                rejecter(@"E_MLS", @"Failed to join group with ratchet tree", MLSTakeLastFFIError());
+            }
+        } @catch (NSException *exception) {
+            rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
+        }
+    }];
+}
+
+// Join many groups from their Welcome messages in one bridge call. Each join
+// runs on its group's lane, so Welcomes for different groups are decrypted
+// and validated in parallel; at most MLSJoinGroupsConcurrency are in flight.
+// Results stay aligned with the input and a failed join does not fail the batch.
+RCT_EXPORT_METHOD(joinGroups:(NSString *)receiverId
+                  welcomes:(NSArray *)welcomes
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    if (![welcomes isKindOfClass:[NSArray class]]) {
+        rejecter(@"E_MLS", @"welcomes must be an array", MLSBridgeError(MLSErrorCodeInvalidInput));
+        return;
+    }
+
+    auto trace = std::make_shared<MLSOperationTrace>(_metrics.get(), "joinGroups", MLSPayloadSize(receiverId) + MLSPayloadSize(welcomes));
+    NSUInteger count = welcomes.count;
+    auto results = std::make_shared<std::vector<NSDictionary *>>(count);
+    MLSIdentityClient *owner = [_clients clientForIdentity:receiverId];
+
+    // The joined group states are stored in one transaction, opened and
+    // committed by barriers around the joins
+    auto batchGeneration = std::make_shared<uint64_t>(0);
+    [owner.scheduler dispatchBarrierAsync:^{
+        [_storageTuning beginBatchForIdentity:receiverId generation:batchGeneration.get()];
+    }];
+
+    // The coordinator blocks while the window is full, so keep it off the method queue
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        dispatch_group_t joins = dispatch_group_create();
+        dispatch_semaphore_t window = dispatch_semaphore_create(MLSJoinGroupsConcurrency);
+        NSMutableSet<NSString *> *seenGroupIds = [NSMutableSet setWithCapacity:count];
+        trace->enterPhase(MLSOperationPhase::FFI);
+
+        for (NSUInteger i = 0; i < count; i++) {
+            NSDictionary *entry = [welcomes[i] isKindOfClass:[NSDictionary class]] ? welcomes[i] : nil;
+            NSString *groupId = [entry[@"groupId"] isKindOfClass:[NSString class]] ? entry[@"groupId"] : nil;
+            NSString *welcome = [entry[@"welcome"] isKindOfClass:[NSString class]] ? entry[@"welcome"] : nil;
+            NSString *ratchetTree = [entry[@"ratchetTree"] isKindOfClass:[NSString class]] ? entry[@"ratchetTree"] : nil;
+
+            if (groupId == nil || welcome == nil) {
+                (*results)[i] = MLSBatchFailure(@{ @"groupId": groupId ?: [NSNull null], @"joined": @NO, @"error": @"Entry needs groupId and welcome" },
+                                                MLSBridgeError(MLSErrorCodeInvalidInput));
+                continue;
+            }
+            // A second Welcome for the same group in one batch would race the first
+            if ([seenGroupIds containsObject:groupId]) {
+                (*results)[i] = MLSBatchFailure(@{ @"groupId": groupId, @"joined": @NO, @"error": @"Duplicate groupId in batch" },
+                                                MLSBridgeError(MLSErrorCodeInvalidInput));
+                continue;
+            }
+            [seenGroupIds addObject:groupId];
+
+            dispatch_semaphore_wait(window, DISPATCH_TIME_FOREVER);
+            dispatch_group_enter(joins);
+            [owner.scheduler dispatchAsyncForKey:groupId block:^{
+                NSString *error = nil;
+                NSError *cause = nil;
+                @try {
+                    void *client = owner.client;
+                    if (!client) {
+                        error = @"MLS client not initialized";
+                        cause = MLSBridgeError(MLSErrorCodeClientNotInitialized);
+                    } else {
+                        const char* groupIdStr = [groupId UTF8String];
+                        void* groupHandle = ratchetTree != nil
+                            ? mls_join_group_with_ratchet_tree(client, groupIdStr, [receiverId UTF8String], [welcome UTF8String], [ratchetTree UTF8String])
+                            : mls_join_group(client, groupIdStr, [receiverId UTF8String], [welcome UTF8String]);
+                        if (groupHandle != NULL) {
+                            _groupHandles->put(MLSGroupHandleKey(groupIdStr, [receiverId UTF8String]), groupHandle);
+                            [_warmStart groupWasUsed:groupId userId:receiverId];
+                            [self groupStateDidChange:MLSGroupStateChangeNewEpoch groupId:groupId userId:receiverId client:owner.client];
+                        } else {
+                            error = @"Failed to join group";
+                            cause = MLSTakeLastFFIError();
+                        }
+                    }
+                } @catch (NSException *exception) {
+                    error = exception.reason ?: @"Failed to join group";
+                    cause = MLSBridgeError(MLSErrorCodeInternal);
+                }
+
+                // Each join owns its slot, so no lock is needed
+                (*results)[i] = error == nil
+                    ? @{ @"groupId": groupId, @"joined": @YES }
+                    : MLSBatchFailure(@{ @"groupId": groupId, @"joined": @NO, @"error": error }, cause);
+                dispatch_semaphore_signal(window);
+                dispatch_group_leave(joins);
+            }];
+        }
+
+        dispatch_group_notify(joins, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+            [owner.scheduler dispatchBarrierAsync:^{
+                [_storageTuning endBatchForIdentity:receiverId generation:*batchGeneration];
+                trace->enterPhase(MLSOperationPhase::Marshal);
+                NSMutableArray *joined = [NSMutableArray arrayWithCapacity:count];
+                for (NSDictionary *result : *results) {
+                    [joined addObject:result];
+                }
+                resolver(trace->succeed(joined));
+            }];
+        });
+    });
+}
+
+// Limit how many live group handles are kept; least recently used
+// handles beyond the limit are released
+RCT_EXPORT_METHOD(setGroupHandleLimit:(NSInteger)limit
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    if (limit <= 0) {
+        rejecter(@"E_MLS", @"Group handle limit must be positive", MLSBridgeError(MLSErrorCodeInvalidInput));
+        return;
+    }
+
+    // Each client's handles are released while its lanes are held off
+    _groupHandles->setCapacity((size_t)limit);
+    [self dispatchForEachClient:nil block:^(MLSIdentityClient *owner) {
+        _groupHandles->trimIf((size_t)limit, [self, owner](const std::string &key) { return [self groupHandleKey:key belongsTo:owner]; });
+    } completion:^{
+        resolver(nil);
+    }];
+}
+
+// Release the cached handle for a group
+RCT_EXPORT_METHOD(evictGroupHandle:(NSString *)groupId
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    // Handles of every local member of the group, each on the group's lane
+    // of the client it belongs to
+    auto evicted = std::make_shared<std::atomic<size_t>>(0);
+    [self dispatchForEachClient:groupId block:^(MLSIdentityClient *owner) {
+        const char *groupIdStr = [groupId UTF8String];
+        evicted->fetch_add(_groupHandles->evictIf([self, owner, groupIdStr](const std::string &key) {
+            return MLSGroupHandleKeyHasGroup(key, groupIdStr) && [self groupHandleKey:key belongsTo:owner];
+        }));
+    } completion:^{
+        resolver(@(evicted->load() > 0));
+    }];
+}
+
+// Run `block` for the shared client and each dedicated one: on the group's
+// lane of the client's scheduler, or as a barrier on it without a group.
+// `completion` runs once every block has.
+- (void)dispatchForEachClient:(NSString *)groupId
+                        block:(void (^)(MLSIdentityClient *owner))block
+                   completion:(dispatch_block_t)completion
+{
+    NSMutableArray<MLSIdentityClient *> *owners = [NSMutableArray arrayWithObject:_clients.sharedClient];
+    for (NSString *identity in [_clients identities]) {
+        [owners addObject:[_clients clientForIdentity:identity]];
+    }
+
+    dispatch_group_t done = dispatch_group_create();
+    for (MLSIdentityClient *owner in owners) {
+        dispatch_group_enter(done);
+        dispatch_block_t work = ^{
+            block(owner);
+            dispatch_group_leave(done);
+        };
+        if (groupId != nil) {
+            [owner.scheduler dispatchAsyncForKey:groupId block:work];
+        } else {
+            [owner.scheduler dispatchBarrierAsync:work];
+        }
+    }
+    dispatch_group_notify(done, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), completion);
+}
+
+// Run `block` on `owner`'s scheduler, as a barrier or on the group's lane
+- (void)dispatchForClient:(MLSIdentityClient *)owner
+                  groupId:(NSString *)groupId
+                  barrier:(BOOL)barrier
+                    block:(dispatch_block_t)block
+{
+    if (barrier) {
+        [owner.scheduler dispatchBarrierAsync:block];
+    } else {
+        [owner.scheduler dispatchAsyncForKey:groupId block:block];
+    }
+}
+
+// Whether the handle under `key` was opened by `owner`'s client
+- (BOOL)groupHandleKey:(const std::string &)key belongsTo:(MLSIdentityClient *)owner
+{
+    size_t separator = key.find('\0');
+    NSString *userId = separator != std::string::npos ? @(key.c_str() + separator + 1) : nil;
+    return userId != nil && [_clients clientForIdentity:userId] == owner;
+}
+
+// Snapshot of per-operation counters, byte sizes and latency histograms
+RCT_EXPORT_METHOD(getMetrics:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    @try {
+        resolver(@{
+            @"operations": _metrics->snapshot(),
+            @"keyPackagePool": [_keyPackagePool statistics],
+            @"groupHandles": @{
+                @"cached": @(_groupHandles->size()),
+                @"limit": @(_groupHandles->capacity()),
+            },
+            @"exporterSecrets": @{
+                @"cached": @(_exporterSecrets->size()),
+                @"limit": @(_exporterSecrets->capacity()),
+                @"hits": @(_exporterSecrets->hits()),
+                @"misses": @(_exporterSecrets->misses()),
+            },
+            @"storage": [_storageTuning statistics],
+            @"clients": [_clients identities],
+            @"startup": [_warmStart statistics],
+            @"reorderBuffer": [self reorderBufferStatistics],
+            @"duplicateFilter": [self ciphertextFilterStatistics],
+            @"backgroundWork": [_backgroundWork statistics],
+            @"keyRotation": [_keyRotations statistics],
+            @"proposalAggregation": [_proposalAggregator statistics],
+            @"memory": [self memoryStatistics],
+        });
+    } @catch (NSException *exception) {
+        rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
+    }
+}
+
+- (NSDictionary *)ciphertextFilterStatistics
+{
+    MLSCiphertextFilter::Statistics statistics = _ciphertextFilter->statistics();
+    return @{
+        @"capacity": @(statistics.capacity),
+        @"remembered": @(statistics.remembered),
+        @"checked": @(statistics.checked),
+        @"duplicates": @(statistics.duplicates),
+        @"falsePositives": @(statistics.falsePositives),
+        @"memoryBytes": @(statistics.memoryBytes),
+    };
+}
+
+- (NSDictionary *)reorderBufferStatistics
+{
+    MLSEpochReorderBuffer::Limits limits = _reorderBuffer->limits();
+    MLSEpochReorderBuffer::Statistics statistics = _reorderBuffer->statistics();
+    return @{
+        @"messagesPerGroup": @(limits.messagesPerGroup),
+        @"maxBytes": @(limits.bytes),
+        @"epochsAhead": @(limits.epochsAhead),
+        @"timeToLiveMs": @(std::chrono::duration_cast<std::chrono::milliseconds>(limits.timeToLive).count()),
+        @"messages": @(statistics.messages),
+        @"bytes": @(statistics.bytes),
+        @"parked": @(statistics.parked),
+        @"replayed": @(statistics.replayed),
+        @"expired": @(statistics.expired),
+        @"evicted": @(statistics.evicted),
+    };
+}
+
+- (NSDictionary *)memoryStatistics
+{
+    NSMutableDictionary *statistics = [[_memoryBudget statistics] mutableCopy];
+    statistics[@"caches"] = @{
+        @"groupHandles": @(_groupHandles->size()),
+        @"exporterSecretBytes": @(_exporterSecrets->bytes()),
+        @"keyPackageBytes": @([_keyPackagePool byteCount]),
+        @"reorderBufferBytes": @(_reorderBuffer->statistics().bytes),
+        @"duplicateFilterBytes": @(_ciphertextFilter->statistics().memoryBytes),
+    };
+    return statistics;
+}
+
+// Release cached state in order of what it costs to get back: group
+// handles, the bulk of the Rust-side memory, reopen from storage; exporter
+// secrets are derived again; pooled key packages take a refill. Each
+// client's handles are released in a barrier on its scheduler, so none is
+// freed under a lane still using it. `completion` gets what was released.
+- (void)trimMemoryToLevel:(MLSMemoryTrimLevel)level completion:(void (^)(NSDictionary *trimmed))completion
+{
+    size_t keep = level == MLSMemoryTrimLevelLow ? _groupHandles->size() / 2 : 0;
+    auto handles = std::make_shared<std::atomic<size_t>>(0);
+    [self dispatchForEachClient:nil block:^(MLSIdentityClient *owner) {
+        handles->fetch_add(_groupHandles->trimIf(keep, [self, owner](const std::string &key) { return [self groupHandleKey:key belongsTo:owner]; }));
+    } completion:^{
+        size_t secrets = _exporterSecrets->size();
+        _exporterSecrets->clear();
+        NSUInteger keyPackages = 0;
+        if (level == MLSMemoryTrimLevelModerate) {
+            keyPackages = [_keyPackagePool trimToCount:_keyPackagePool.lowWaterMark];
+        } else if (level == MLSMemoryTrimLevelCritical) {
+            keyPackages = [_keyPackagePool trimToCount:0];
+        }
+        [_memoryBudget trimDidFinish:level released:handles->load() + secrets + keyPackages];
+
+        completion(@{
+            @"level": MLSMemoryTrimLevelName(level),
+            @"groupHandles": @(handles->load()),
+            @"exporterSecrets": @(secrets),
+            @"keyPackages": @(keyPackages),
+            @"footprintBytes": @(MLSProcessFootprint()),
+        });
+    }];
+}
+
+// A memory warning, memory pressure or the budget asked for a trim
+- (void)memoryTrimRequested:(MLSMemoryTrimLevel)level reason:(NSString *)reason
+{
+    [self trimMemoryToLevel:level completion:^(NSDictionary *trimmed) {
+        if (_hasListeners) {
+            NSMutableDictionary *body = [trimmed mutableCopy];
+            body[@"reason"] = reason;
+            [self sendEventWithName:MLSMemoryTrimmedEvent body:body];
+        }
+    }];
+}
+
+// Trim cached state whenever the process footprint goes over `budget`
+// bytes; 0 removes the budget
+RCT_EXPORT_METHOD(setMemoryBudget:(double)budget
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    if (!(budget >= 0)) {
+        rejecter(@"E_MLS", @"Memory budget must be 0 or more bytes", MLSBridgeError(MLSErrorCodeInvalidInput));
+        return;
+    }
+    @try {
+        _memoryBudget.budget = (uint64_t)budget;
+        [_memoryBudget checkFootprint];
+        resolver([self memoryStatistics]);
+    } @catch (NSException *exception) {
+        rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
+    }
+}
+
+// Release cached state now, e.g. before the app starts a large catch-up
+RCT_EXPORT_METHOD(trimMemory:(NSString *)level
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    MLSMemoryTrimLevel trimLevel;
+    if (![level isKindOfClass:[NSString class]] || !MLSMemoryTrimLevelFromName(level, &trimLevel)) {
+        rejecter(@"E_MLS", @"Trim level must be low, moderate or critical", MLSBridgeError(MLSErrorCodeInvalidInput));
+        return;
+    }
+    [self trimMemoryToLevel:trimLevel completion:^(NSDictionary *trimmed) {
+        resolver(trimmed);
+    }];
+}
+
+// Bound the buffer of messages that arrived ahead of their epoch's commit.
+// New limits apply to messages parked afterwards.
+RCT_EXPORT_METHOD(configureReorderBuffer:(NSDictionary *)options
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    @try {
+        id messagesPerGroup = options[@"messagesPerGroup"];
+        id maxBytes = options[@"maxBytes"];
+        id epochsAhead = options[@"epochsAhead"];
+        id timeToLive = options[@"timeToLiveMs"];
+        if ((messagesPerGroup && !([messagesPerGroup isKindOfClass:[NSNumber class]] && [messagesPerGroup integerValue] >= 0)) ||
+            (maxBytes && !([maxBytes isKindOfClass:[NSNumber class]] && [maxBytes integerValue] > 0)) ||
+            (epochsAhead && !([epochsAhead isKindOfClass:[NSNumber class]] && [epochsAhead integerValue] > 0)) ||
+            (timeToLive && !([timeToLive isKindOfClass:[NSNumber class]] && [timeToLive integerValue] > 0))) {
+            rejecter(@"E_MLS", @"Reorder buffer options need messagesPerGroup >= 0, maxBytes > 0, epochsAhead > 0, timeToLiveMs > 0", MLSBridgeError(MLSErrorCodeInvalidInput));
+            return;
+        }
+
+        MLSEpochReorderBuffer::Limits limits = _reorderBuffer->limits();
+        if (messagesPerGroup) {
+            limits.messagesPerGroup = [messagesPerGroup unsignedIntegerValue];
+        }
+        if (maxBytes) {
+            limits.bytes = [maxBytes unsignedIntegerValue];
+        }
+        if (epochsAhead) {
+            limits.epochsAhead = [epochsAhead unsignedLongLongValue];
+        }
+        if (timeToLive) {
+            limits.timeToLive = std::chrono::milliseconds([timeToLive longLongValue]);
+        }
+        _reorderBuffer->setLimits(limits);
+        resolver([self reorderBufferStatistics]);
+    } @catch (NSException *exception) {
+        rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
+    }
+}
+
+// Hold maintenance work while the app's battery policy saves energy
+RCT_EXPORT_METHOD(setPowerMode:(NSString *)powerMode
+                  inBackground:(BOOL)inBackground
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    if (![_backgroundWork setPowerMode:powerMode inBackground:inBackground]) {
+        rejecter(@"E_MLS", @"Power mode must be performance, balanced, powerSaver or ultraLowPower", MLSBridgeError(MLSErrorCodeInvalidInput));
+        return;
+    }
+    resolver([_backgroundWork statistics]);
+}
+
+// Cancel maintenance work for a group, or all of it, that has not started;
+// what is already running finishes
+RCT_EXPORT_METHOD(cancelBackgroundWork:(NSString *)groupId
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    NSString *key = groupId.length > 0 ? groupId : nil;
+    resolver(@([_backgroundWork cancelWorkForKey:key]));
+}
+
+// Clear the per-operation metrics
+RCT_EXPORT_METHOD(resetMetrics:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    _metrics->reset();
+    resolver(nil);
+}
+
+// Export ratchet tree
+RCT_EXPORT_METHOD(exportRatchetTree:(NSString *)groupId
+                   userId:(NSString *)userId
+                   resolver:(RCTPromiseResolveBlock)resolver
+                   rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    MLSIdentityClient *owner = [_clients clientForIdentity:userId];
+    [_backgroundWork scheduleOn:owner.scheduler key:groupId work:^{
+        MLSOperationTrace trace(_metrics.get(), "exportRatchetTree", MLSPayloadSize(groupId) + MLSPayloadSize(userId));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
+            return;
+        }
+    
+        const char* groupIdStr = [groupId UTF8String];
+        const char* userIdStr = [userId UTF8String];
+    
+        int treeLen = 0;
+        trace.enterPhase(MLSOperationPhase::FFI);
+        uint8_t* treeBytes = mls_export_ratchet_tree(owner.client, groupIdStr, userIdStr, &treeLen);
+        trace.enterPhase(MLSOperationPhase::Marshal);
+    
+        if (treeBytes != NULL) {
+            // Convert the tree bytes to a base64 string
+            NSData* treeData = MLSDataFromRustBytes(treeBytes, treeLen);
+            NSString* treeBase64 = [treeData base64EncodedStringWithOptions:0];
+        
+            resolver(trace.succeed(treeBase64));
+        } else {
+            rejecter(@"export_ratchet_tree_error", @"Failed to export ratchet tree", MLSTakeLastFFIError());
+        }
+    } cancelled:MLSCancelledRejection(rejecter)];
+}
+
+// Export the ratchet tree as raw bytes straight to a file. The Rust buffer
+// is written without a copy or base64 string, so large trees never exist
+// twice in memory and the file can be fragmented for transport directly.
+RCT_EXPORT_METHOD(exportRatchetTreeToFile:(NSString *)groupId
+                  userId:(NSString *)userId
+                  path:(NSString *)path
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    MLSIdentityClient *owner = [_clients clientForIdentity:userId];
+    [_backgroundWork scheduleOn:owner.scheduler key:groupId work:^{
+        MLSOperationTrace trace(_metrics.get(), "exportRatchetTreeToFile", MLSPayloadSize(groupId) + MLSPayloadSize(userId) + MLSPayloadSize(path));
+
+        @try {
+            if (!owner.client) {
+                rejecter(@"E_MLS", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
+                return;
+            }
+        
+            const char* groupIdStr = [groupId UTF8String];
+            const char* userIdStr = [userId UTF8String];
+        
+            int treeLen = 0;
+            trace.enterPhase(MLSOperationPhase::FFI);
+            uint8_t* treeBytes = mls_export_ratchet_tree(owner.client, groupIdStr, userIdStr, &treeLen);
+            trace.enterPhase(MLSOperationPhase::Marshal);
+            if (treeBytes == NULL) {
+                rejecter(@"E_MLS", @"Failed to export ratchet tree", MLSTakeLastFFIError());
+                return;
+            }
+        
+            NSData* treeData = MLSDataFromRustBytes(treeBytes, treeLen);
+            NSError* writeError = nil;
+            if (![treeData writeToFile:path options:NSDataWritingAtomic error:&writeError]) {
+                rejecter(@"E_MLS", @"Failed to write ratchet tree file", writeError);
+                return;
+            }
+        
+            // Return the number of bytes written
+            resolver(trace.succeed(@(treeLen)));
+        } @catch (NSException *exception) {
+            rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
+        }
+    } cancelled:MLSCancelledRejection(rejecter)];
+}
+
+// Join an existing MLS group with a ratchet tree read from a file written by
+// exportRatchetTreeToFile. The file is encoded in chunks into the single
+// buffer the FFI needs instead of going through NSData and NSString copies.
+RCT_EXPORT_METHOD(joinGroupWithRatchetTreeFile:(NSString *)groupId
+                  receiverId:(NSString *)receiverId
+                  welcomeMessage:(NSString *)welcomeMessage
+                  ratchetTreePath:(NSString *)ratchetTreePath
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    MLSIdentityClient *owner = [_clients clientForIdentity:receiverId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "joinGroupWithRatchetTreeFile", MLSPayloadSize(groupId) + MLSPayloadSize(receiverId) + MLSPayloadSize(welcomeMessage) + MLSPayloadSize(ratchetTreePath));
+
+        @try {
+            if (!owner.client) {
+                rejecter(@"E_MLS", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
+                return;
+            }
+        
+            NSError* readError = nil;
+            char* ratchetTreeStr = MLSCopyBase64CStringFromFile(ratchetTreePath, &readError);
+            if (ratchetTreeStr == NULL) {
+                rejecter(@"E_MLS", @"Failed to read ratchet tree file", readError);
+                return;
+            }
+        
+            const char* groupIdStr = [groupId UTF8String];
+            const char* receiverIdStr = [receiverId UTF8String];
+            const char* welcomeMessageStr = [welcomeMessage UTF8String];
+        
+            trace.enterPhase(MLSOperationPhase::FFI);
+            void* groupHandle = mls_join_group_with_ratchet_tree(owner.client, groupIdStr, receiverIdStr, welcomeMessageStr, ratchetTreeStr);
+            trace.enterPhase(MLSOperationPhase::Marshal);
+            free(ratchetTreeStr);
+        
+            if (groupHandle != NULL) {
+                // Keep the handle alive for later operations on this group
+                _groupHandles->put(MLSGroupHandleKey(groupIdStr, [receiverId UTF8String]), groupHandle);
+                [_warmStart groupWasUsed:groupId userId:receiverId];
+            
+                trace.enterPhase(MLSOperationPhase::FFI);
+                [self groupStateDidChange:MLSGroupStateChangeNewEpoch groupId:groupId userId:receiverId client:owner.client];
+                trace.enterPhase(MLSOperationPhase::Marshal);
+               
+                // Return the group ID as a string
+                resolver(trace.succeed(groupId));
+            } else {
+                rejecter(@"E_MLS", @"Failed to join group with ratchet tree", MLSTakeLastFFIError());
+            }
+        } @catch (NSException *exception) {
+            rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
+        }
+    }];
+}
+
+// Add a member to an MLS group
+RCT_EXPORT_METHOD(addMember:(NSString *)groupId
+                  creatorId:(NSString *)creatorId
+                  receiverId:(NSString *)receiverId
+                  keyPackage:(NSString *)keyPackage
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    MLSIdentityClient *owner = [_clients clientForIdentity:creatorId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "addMember", MLSPayloadSize(groupId) + MLSPayloadSize(creatorId) + MLSPayloadSize(receiverId) + MLSPayloadSize(keyPackage));
+
+        @try {
+            if (!owner.client) {
+                rejecter(@"E_MLS", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
+                return;
+            }
+        
+            const char* groupIdStr = [groupId UTF8String];
+            const char* creatorIdStr = [creatorId UTF8String];
+            const char* receiverIdStr = [receiverId UTF8String];
+            const char* keyPackageStr = [keyPackage UTF8String];
+        
+            int commitLen = 0;
+            uint8_t* welcomeBytes = NULL;
+            int welcomeLen = 0;
+        
+            trace.enterPhase(MLSOperationPhase::FFI);
+            uint8_t* commitBytes = mls_add_member(owner.client, groupIdStr, creatorIdStr, receiverIdStr, keyPackageStr, &commitLen, &welcomeBytes, &welcomeLen);
+            trace.enterPhase(MLSOperationPhase::Marshal);
+        
+            if (commitBytes != NULL) {
+                // Hand the raw buffers to the mesh outbox before encoding them for JS
+                NSData* commitData = MLSDataFromRustBytes(commitBytes, commitLen);
+                NSData* welcomeData = welcomeBytes != NULL ? MLSDataFromRustBytes(welcomeBytes, welcomeLen) : nil;
+                [self handOffCommit:commitData welcome:welcomeData groupId:groupId senderId:creatorId];
+            
+                NSString* commitBase64 = [commitData base64EncodedStringWithOptions:0];
+                NSString* welcomeBase64 = [welcomeData base64EncodedStringWithOptions:0];
+            
+                // Create result dictionary
+                NSDictionary* result = @{
+                    @"id": [[NSUUID UUID] UUIDString],
+                    @"type": @"add",
+                    @"sender": creatorId,
+                    @"data": commitBase64
+                };
+            
+                // Add welcome message if available
+                if (welcomeBase64 != nil) {
+                    NSMutableDictionary* mutableResult = [result mutableCopy];
+                    [mutableResult setObject:welcomeBase64 forKey:@"welcome"];
+                    result = mutableResult;
+                }
+            
+                trace.enterPhase(MLSOperationPhase::FFI);
+                [self groupStateDidChange:MLSGroupStateChangeNewEpoch groupId:groupId userId:creatorId client:owner.client];
+                trace.enterPhase(MLSOperationPhase::Marshal);
+                resolver(trace.succeed(result));
+            } else {
+                rejecter(@"E_MLS", @"Failed to add member to MLS group", MLSTakeLastFFIError());
+            }
+        } @catch (NSException *exception) {
+            rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
+        }
+    }];
+}
 
-RCT_EXPORT_MODULE()
+// Remove members from an MLS group
+RCT_EXPORT_METHOD(removeMembers:(NSString *)groupId
+                  creatorId:(NSString *)creatorId
+                  memberIndices:(NSArray *)memberIndices
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    MLSIdentityClient *owner = [_clients clientForIdentity:creatorId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "removeMembers", MLSPayloadSize(groupId) + MLSPayloadSize(creatorId) + MLSPayloadSize(memberIndices));
 
-// Return a background queue for processing
-- (dispatch_queue_t)methodQueue
+        @try {
+            if (!owner.client) {
+                rejecter(@"E_MLS", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
+                return;
+            }
+        
+            const char* groupIdStr = [groupId UTF8String];
+            const char* creatorIdStr = [creatorId UTF8String];
+        
+            // Indices live flat in the lane's scratch arena; the FFI still
+            // takes a pointer per index, so the table points into them
+            MLSScratchScope scratch([owner.scheduler queueForKey:groupId]);
+            NSUInteger count = [memberIndices count];
+            int* indices = scratch.arena().allocate<int>(count);
+            const int** indicesPtrs = scratch.arena().allocate<const int*>(count);
+        
+            for (NSUInteger i = 0; i < count; i++) {
+                indices[i] = [[memberIndices objectAtIndex:i] intValue];
+                indicesPtrs[i] = &indices[i];
+            }
+        
+            int commitLen = 0;
+            trace.enterPhase(MLSOperationPhase::FFI);
+            uint8_t* commitBytes = mls_remove_members(owner.client, groupIdStr, creatorIdStr, indicesPtrs, (int)count, &commitLen);
+            trace.enterPhase(MLSOperationPhase::Marshal);
+        
+            if (commitBytes != NULL) {
+                // Hand the raw commit to the mesh outbox before encoding it for JS
+                NSData* commitData = MLSDataFromRustBytes(commitBytes, commitLen);
+                [self handOffCommit:commitData welcome:nil groupId:groupId senderId:creatorId];
+                NSString* commitBase64 = [commitData base64EncodedStringWithOptions:0];
+            
+                // Create result dictionary
+                NSDictionary* result = @{
+                    @"id": [[NSUUID UUID] UUIDString],
+                    @"type": @"remove",
+                    @"sender": @"self",
+                    @"data": commitBase64
+                };
+            
+                trace.enterPhase(MLSOperationPhase::FFI);
+                [self groupStateDidChange:MLSGroupStateChangeNewEpoch groupId:groupId userId:creatorId client:owner.client];
+                trace.enterPhase(MLSOperationPhase::Marshal);
+                resolver(trace.succeed(result));
+            } else {
+                rejecter(@"E_MLS", @"Failed to remove members from MLS group", MLSTakeLastFFIError());
+            }
+        } @catch (NSException *exception) {
+            rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
+        }
+    }];
+}
+// Commit pending proposals in an MLS group
+RCT_EXPORT_METHOD(commitPendingProposals:(NSString *)groupId
+                  creatorId:(NSString *)creatorId
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    return dispatch_queue_create("com.reactnativemls.MLSQueue", DISPATCH_QUEUE_SERIAL);
+    MLSIdentityClient *owner = [_clients clientForIdentity:creatorId];
+    [_backgroundWork scheduleOn:owner.scheduler key:groupId work:^{
+        MLSOperationTrace trace(_metrics.get(), "commitPendingProposals", MLSPayloadSize(groupId) + MLSPayloadSize(creatorId));
+
+        @try {
+            if (!owner.client) {
+                rejecter(@"E_MLS", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
+                return;
+            }
+        
+            NSError* cause = nil;
+            NSDictionary* result = [self commitPendingProposalsOfGroup:groupId creatorId:creatorId client:owner.client trace:trace cause:&cause];
+            if (result != nil) {
+                resolver(trace.succeed(result));
+            } else {
+                rejecter(@"E_MLS", @"Failed to commit pending proposals", cause);
+            }
+        } @catch (NSException *exception) {
+            rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
+        }
+    } cancelled:MLSCancelledRejection(rejecter)];
 }
 
-// Export methods to JavaScript
+// Commit the group's pending proposals and hand the commit to the mesh
+// outbox. Returns {commit, welcome?} in base64, or nil with the FFI's error.
+// Must run on the group's lane.
+- (NSDictionary *)commitPendingProposalsOfGroup:(NSString *)groupId
+                                      creatorId:(NSString *)creatorId
+                                         client:(void *)client
+                                          trace:(MLSOperationTrace &)trace
+                                          cause:(NSError **)cause
+{
+    const char* groupIdStr = [groupId UTF8String];
+    const char* creatorIdStr = [creatorId UTF8String];
 
- // Initialize the MLS module for macOS
- RCT_EXPORT_METHOD(initialize:(NSString *)groupID      
-                   resolver:(RCTPromiseResolveBlock)resolve
-                   rejecter:(RCTPromiseRejectBlock)reject)
- {
-     // For macOS, use Application Support directory
-     NSArray *paths = NSSearchPathForDirectoriesInDomains(NSApplicationSupportDirectory, NSUserDomainMask, YES);
-     NSString *applicationSupportDirectory = [paths firstObject];
-     
-     if (!applicationSupportDirectory) {
-         reject(@"init_error", @"Failed to get Application Support directory", nil);
-         return;
-     }
-     
-     // Create the "MLSStorage" folder inside Application Support
-     NSString *storageDir = [applicationSupportDirectory stringByAppendingPathComponent:@"MLSStorage"];
-     NSError *fsError = nil;
-     [[NSFileManager defaultManager] createDirectoryAtPath:storageDir
-                             withIntermediateDirectories:YES
-                                              attributes:nil
-                                                   error:&fsError];
-     if (fsError) {
-         reject(@"init_error", @"Failed to create storage directory", fsError);
-         return;
-     }
-
-     // Tell Rust to use this directory as its storage root
-     mls_set_storage_path(storageDir.UTF8String);
-
-     // Now create the MLS client
-     void *client = mls_client_create();
-     if (!client) {
-         reject(@"init_error", @"mls_client_create() failed", nil);
-         return;
-     }
-     self.mlsClient = client;
-     resolve(nil);
- }
+    int commitLen = 0;
+    uint8_t* welcomeBytes = NULL;
+    int welcomeLen = 0;
 
-// Set storage key for a user
-RCT_EXPORT_METHOD(setStorageKey:(NSString *)userId
-                  key:(NSString *)key
-                  resolver:(RCTPromiseResolveBlock)resolve
-                  rejecter:(RCTPromiseRejectBlock)reject)
-{
-    @try {
-        const char *user_id_cstr = [userId UTF8String];
-        const char *key_cstr = [key UTF8String];
-        mls_set_storage_key(user_id_cstr, key_cstr);
-        resolve(nil);
-    } @catch (NSException *exception) {
-        reject(@"set_storage_key_error", exception.reason, nil);
+    // Close to its next rotation, the commit is made as a self-update,
+    // which commits the pending proposals and refreshes our leaf at once
+    BOOL rotate = [_keyRotations shouldMergeRotationForGroup:groupId userId:creatorId];
+    trace.enterPhase(MLSOperationPhase::FFI);
+    uint8_t* commitBytes = rotate
+        ? mls_self_update(client, groupIdStr, creatorIdStr, &commitLen, &welcomeBytes, &welcomeLen)
+        : mls_commit_pending_proposals(client, groupIdStr, creatorIdStr, &commitLen, &welcomeBytes, &welcomeLen);
+    trace.enterPhase(MLSOperationPhase::Marshal);
+    if (commitBytes == NULL) {
+        *cause = MLSTakeLastFFIError();
+        return nil;
     }
+    if (rotate) {
+        [_keyRotations groupDidRotate:groupId userId:creatorId merged:YES];
+    }
+
+    // Hand the raw buffers to the mesh outbox before encoding them for JS
+    NSData* commitData = MLSDataFromRustBytes(commitBytes, commitLen);
+    NSData* welcomeData = welcomeBytes != NULL ? MLSDataFromRustBytes(welcomeBytes, welcomeLen) : nil;
+    [self handOffCommit:commitData welcome:welcomeData groupId:groupId senderId:creatorId];
+
+    NSMutableDictionary* result = [[NSMutableDictionary alloc] init];
+    result[@"commit"] = [commitData base64EncodedStringWithOptions:0];
+    result[@"welcome"] = [welcomeData base64EncodedStringWithOptions:0];
+
+    trace.enterPhase(MLSOperationPhase::FFI);
+    [self groupStateDidChange:MLSGroupStateChangeNewEpoch groupId:groupId userId:creatorId client:client];
+    trace.enterPhase(MLSOperationPhase::Marshal);
+    return result;
 }
 
-// Rekey storage for a user
-RCT_EXPORT_METHOD(setStorageRekey:(NSString *)userId
-                  oldKey:(NSString *)oldKey
-                  newKey:(NSString *)newKey
-                  resolver:(RCTPromiseResolveBlock)resolve
-                  rejecter:(RCTPromiseRejectBlock)reject)
+// Collect the group's proposals and commit them together once enough are
+// pending, the oldest has waited long enough or the mesh has gone quiet.
+// Each commit goes to the mesh outbox and an MLSProposalsCommitted event.
+RCT_EXPORT_METHOD(enableProposalAggregation:(NSString *)groupId
+                  userId:(NSString *)userId
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    [_proposalAggregator addGroup:groupId userId:userId];
+    resolver(nil);
+}
+
+RCT_EXPORT_METHOD(disableProposalAggregation:(NSString *)groupId
+                  userId:(NSString *)userId
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    [_proposalAggregator removeGroup:groupId userId:userId];
+    resolver(nil);
+}
+
+RCT_EXPORT_METHOD(configureProposalAggregation:(NSDictionary *)options
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
 {
     @try {
-        const char *user_id_cstr = [userId UTF8String];
-        const char *old_key_cstr = [oldKey UTF8String];
-        const char *new_key_cstr = [newKey UTF8String];
-        mls_set_storage_rekey(user_id_cstr, old_key_cstr, new_key_cstr);
-        resolve(nil);
+        id maxProposals = options[@"maxProposals"];
+        id maxDelay = options[@"maxDelayMs"];
+        id idle = options[@"idleMs"];
+        if ((maxProposals && !([maxProposals isKindOfClass:[NSNumber class]] && [maxProposals integerValue] > 0)) ||
+            (maxDelay && !([maxDelay isKindOfClass:[NSNumber class]] && [maxDelay doubleValue] >= 0)) ||
+            (idle && !([idle isKindOfClass:[NSNumber class]] && [idle doubleValue] >= 0))) {
+            rejecter(@"E_MLS", @"Proposal aggregation options need maxProposals > 0, maxDelayMs >= 0, idleMs >= 0", MLSBridgeError(MLSErrorCodeInvalidInput));
+            return;
+        }
+
+        NSDictionary *current = [_proposalAggregator statistics];
+        [_proposalAggregator setMaxProposals:[(maxProposals ?: current[@"maxProposals"]) unsignedIntegerValue]
+                                    maxDelay:[(maxDelay ?: current[@"maxDelayMs"]) doubleValue] / 1000.0
+                                   idleDelay:[(idle ?: current[@"idleMs"]) doubleValue] / 1000.0];
+        resolver([_proposalAggregator statistics]);
     } @catch (NSException *exception) {
-        reject(@"set_storage_rekey_error", exception.reason, nil);
+        rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
     }
 }
 
-- (void)dealloc
+// The mesh layer knows when the radio is free: commit every aggregating
+// group with pending proposals now
+RCT_EXPORT_METHOD(flushProposals:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    // Free the client when the module is deallocated
-    if (self.mlsClient) {
-        mls_free_client(self.mlsClient);
-        self.mlsClient = NULL;
-    }
+    [_proposalAggregator flush];
+    resolver(nil);
 }
 
-// Create a new MLS group
-RCT_EXPORT_METHOD(createGroup:(NSString *)groupId
-                  creatorId:(NSString *)creatorId
+// Commit what the aggregator collected, as background work on the group's lane
+- (void)commitAggregatedProposals:(NSString *)groupId userId:(NSString *)userId reason:(MLSProposalCommitReason)reason
+{
+    MLSIdentityClient *owner = [_clients clientForIdentity:userId];
+    [_backgroundWork scheduleOn:owner.scheduler key:groupId work:^{
+        MLSOperationTrace trace(_metrics.get(), "aggregatedCommit", MLSPayloadSize(groupId) + MLSPayloadSize(userId));
+
+        // Nobody would send the commit, and other members could not read the group after it
+        if (!owner.client || (MLSModule.meshOutbox == nil && !_hasListeners)) {
+            [_proposalAggregator commitDidFail:groupId userId:userId];
+            return;
+        }
+        NSError* cause = nil;
+        NSDictionary* result = [self commitPendingProposalsOfGroup:groupId creatorId:userId client:owner.client trace:trace cause:&cause];
+        if (result == nil) {
+            [_proposalAggregator commitDidFail:groupId userId:userId];
+            return;
+        }
+        if (_hasListeners) {
+            [self sendEventWithName:MLSProposalsCommittedEvent
+                               body:@{ @"groupId": groupId, @"userId": userId, @"reason": MLSProposalCommitReasonName(reason),
+                                       @"commit": result[@"commit"], @"welcome": result[@"welcome"] ?: [NSNull null] }];
+        }
+        trace.succeed(result);
+    } cancelled:^{
+        [_proposalAggregator commitDidFail:groupId userId:userId];
+    }];
+}
+
+// Enroll a group in scheduled key rotation. Its local member then
+// self-updates about once per interval without JS asking; each commit goes
+// to the mesh outbox and an MLSKeyRotated event.
+RCT_EXPORT_METHOD(enableKeyRotation:(NSString *)groupId
+                  userId:(NSString *)userId
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    [_keyRotations addGroup:groupId userId:userId];
+    resolver(nil);
+}
+
+RCT_EXPORT_METHOD(disableKeyRotation:(NSString *)groupId
+                  userId:(NSString *)userId
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    [_keyRotations removeGroup:groupId userId:userId];
+    resolver(nil);
+}
+
+RCT_EXPORT_METHOD(configureKeyRotation:(NSDictionary *)options
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
     @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+        id interval = options[@"intervalMs"];
+        id jitter = options[@"jitter"];
+        id maxConcurrent = options[@"maxConcurrent"];
+        if ((interval && !([interval isKindOfClass:[NSNumber class]] && [interval doubleValue] >= 1000)) ||
+            (jitter && !([jitter isKindOfClass:[NSNumber class]] && [jitter doubleValue] >= 0 && [jitter doubleValue] <= 1)) ||
+            (maxConcurrent && !([maxConcurrent isKindOfClass:[NSNumber class]] && [maxConcurrent integerValue] > 0))) {
+            rejecter(@"E_MLS", @"Key rotation options need intervalMs >= 1000, jitter in [0, 1], maxConcurrent > 0", MLSBridgeError(MLSErrorCodeInvalidInput));
+            return;
+        }
+
+        NSDictionary *current = [_keyRotations statistics];
+        [_keyRotations setInterval:[(interval ?: current[@"intervalMs"]) doubleValue] / 1000.0
+                            jitter:[(jitter ?: current[@"jitter"]) doubleValue]
+                     maxConcurrent:[(maxConcurrent ?: current[@"maxConcurrent"]) unsignedIntegerValue]];
+        resolver([_keyRotations statistics]);
+    } @catch (NSException *exception) {
+        rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
+    }
+}
+
+// Self-update a group whose rotation came due, as background work on its lane
+- (void)rotateKeysOfGroup:(NSString *)groupId userId:(NSString *)userId
+{
+    MLSIdentityClient *owner = [_clients clientForIdentity:userId];
+    [_backgroundWork scheduleOn:owner.scheduler key:groupId work:^{
+        MLSOperationTrace trace(_metrics.get(), "keyRotation", MLSPayloadSize(groupId) + MLSPayloadSize(userId));
+
+        // A self-update since it was handed out already rotated the group
+        if (![_keyRotations isRotationDueForGroup:groupId userId:userId]) {
+            [_keyRotations rotationDidFinish:groupId userId:userId succeeded:YES];
+            trace.succeed();
+            return;
+        }
+        // Nobody would send the commit, and other members could not read the group after it
+        if (!owner.client || (MLSModule.meshOutbox == nil && !_hasListeners)) {
+            [_keyRotations rotationDidFinish:groupId userId:userId succeeded:NO];
             return;
         }
+
+        int commitLen = 0;
+        uint8_t* welcomeBytes = NULL;
+        int welcomeLen = 0;
+        trace.enterPhase(MLSOperationPhase::FFI);
+        uint8_t* commitBytes = mls_self_update(owner.client, [groupId UTF8String], [userId UTF8String], &commitLen, &welcomeBytes, &welcomeLen);
+        trace.enterPhase(MLSOperationPhase::Marshal);
+        if (commitBytes == NULL) {
+            [_keyRotations rotationDidFinish:groupId userId:userId succeeded:NO];
+            return;
+        }
+
+        NSData* commitData = MLSDataFromRustBytes(commitBytes, commitLen);
+        NSData* welcomeData = welcomeBytes != NULL ? MLSDataFromRustBytes(welcomeBytes, welcomeLen) : nil;
+        [self handOffCommit:commitData welcome:welcomeData groupId:groupId senderId:userId];
+        [_keyRotations groupDidRotate:groupId userId:userId merged:NO];
+        [_keyRotations rotationDidFinish:groupId userId:userId succeeded:YES];
+
+        trace.enterPhase(MLSOperationPhase::FFI);
+        [self groupStateDidChange:MLSGroupStateChangeNewEpoch groupId:groupId userId:userId client:owner.client];
+        trace.enterPhase(MLSOperationPhase::Marshal);
+        if (_hasListeners) {
+            [self sendEventWithName:MLSKeyRotatedEvent
+                               body:@{ @"groupId": groupId, @"userId": userId,
+                                       @"commit": [commitData base64EncodedStringWithOptions:0],
+                                       @"welcome": [welcomeData base64EncodedStringWithOptions:0] ?: [NSNull null] }];
+        }
+        trace.addBytesOut((uint64_t)commitLen + (uint64_t)welcomeLen);
+        trace.succeed();
+    } cancelled:^{
+        [_keyRotations rotationDidFinish:groupId userId:userId succeeded:NO];
+    }];
+}
+
+// Start a background refill of an identity's key package pool if it has
+// dropped below the low-water mark
+- (void)refillKeyPackagePoolIfNeeded:(NSString *)identity
+{
+    if ([_keyPackagePool beginRefillForIdentity:identity]) {
+        [self scheduleKeyPackageRefillStep:identity];
+    }
+}
+
+// Generate one small batch as background work on the identity lane, then
+// queue the next, so interactive requests for the identity interleave with
+// refill
+- (void)scheduleKeyPackageRefillStep:(NSString *)identity
+{
+    MLSIdentityClient *owner = [_clients clientForIdentity:identity];
+    [_backgroundWork scheduleOn:owner.scheduler key:MLSIdentityLaneKey(identity) work:^{
+        NSUInteger wanted = MIN([_keyPackagePool shortfallForIdentity:identity], (NSUInteger)MLSKeyPackageRefillBatch);
+        NSArray<NSString *>* generated = nil;
+        if (wanted > 0 && owner.client) {
+            generated = [self generateKeyPackageStrings:identity count:(NSInteger)wanted client:owner.client];
+        }
         
-        const char* groupIdStr = [groupId UTF8String];
-        const char* creatorIdStr = [creatorId UTF8String];
-        void* groupHandle = mls_create_group(self.mlsClient, groupIdStr, creatorIdStr);
+        // Stop when the target is reached or generation fails; the next
+        // request below the low-water mark starts a new refill
+        if (generated.count == 0) {
+            [_keyPackagePool endRefillForIdentity:identity];
+            return;
+        }
         
-        if (groupHandle != NULL) {
-            // Free the group handle
-            mls_free_group(groupHandle);
-            
-            // Return the group ID as a string
-            resolver(groupId);
-        } else {
-            rejecter(@"E_MLS", @"Failed to create group", nil);
+        [_keyPackagePool addKeyPackages:generated forIdentity:identity];
+        [self scheduleKeyPackageRefillStep:identity];
+    } cancelled:^{
+        [_keyPackagePool endRefillForIdentity:identity];
+    }];
+}
+
+// Generate key packages through the FFI, skipping any that fail
+- (NSArray<NSString *> *)generateKeyPackageStrings:(NSString *)identity count:(NSInteger)count client:(void *)client
+{
+    const char* identityStr = [identity UTF8String];
+    int outCount = 0;
+    int* outLens = NULL;
+    
+    char** keyPackageStrs = (char**)mls_generate_keypackages(client, identityStr, (int)count, &outCount, &outLens);
+    
+    NSMutableArray* keyPackages = [NSMutableArray arrayWithCapacity:MAX(outCount, 0)];
+    if (keyPackageStrs != NULL && outCount > 0) {
+        for (int i = 0; i < outCount; i++) {
+            if (keyPackageStrs[i] != NULL) {
+                NSString* keyPackage = [NSString stringWithUTF8String:keyPackageStrs[i]];
+                [keyPackages addObject:keyPackage];
+            }
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
     }
+    
+    // The two Rust builds allocate the result differently
+    MLSFreeKeyPackageStrings(keyPackageStrs, MAX(outCount, 0), outLens);
+    
+    return keyPackages;
 }
 
-// Join an existing MLS group
-RCT_EXPORT_METHOD(joinGroup:(NSString *)groupId
-                  receiverId:(NSString *)receiverId
-                  welcomeMessage:(NSString *)welcomeMessage
+// Generate a key package, served from the pre-generated pool when possible
+RCT_EXPORT_METHOD(generateKeyPackage:(NSString *)identity
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
-            return;
-        }
+    MLSIdentityClient *owner = [_clients clientForIdentity:identity];
+    [owner.scheduler dispatchAsyncForKey:MLSIdentityLaneKey(identity) block:^{
+        MLSOperationTrace trace(_metrics.get(), "generateKeyPackage", MLSPayloadSize(identity));
+
+        @try {
+            if (!owner.client) {
+                rejecter(@"E_MLS", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
+                return;
+            }
         
-        const char* groupIdStr = [groupId UTF8String];
-        const char* receiverIdStr = [receiverId UTF8String];
-        const char* welcomeMessageStr = [welcomeMessage UTF8String];
+            NSString* keyPackage = [_keyPackagePool takeKeyPackages:1 forIdentity:identity].firstObject;
+            if (keyPackage == nil) {
+                const char* identityStr = [identity UTF8String];
+                trace.enterPhase(MLSOperationPhase::FFI);
+                char* keyPackageStr = mls_generate_key_package(owner.client, identityStr);
+                trace.enterPhase(MLSOperationPhase::Marshal);
+                if (keyPackageStr != NULL) {
+                    keyPackage = [NSString stringWithUTF8String:keyPackageStr];
+                    
+                    // Free the key package string
+                    mls_free_string(keyPackageStr);
+                }
+            }
+            [self refillKeyPackagePoolIfNeeded:identity];
+        
+            if (keyPackage != nil) {
+                resolver(trace.succeed(keyPackage));
+            } else {
+                rejecter(@"E_MLS", @"Failed to generate key package", MLSTakeLastFFIError());
+            }
+        } @catch (NSException *exception) {
+            rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
+        }
+    }];
+}
+
+// Generate multiple key packages, taking as many as possible from the pool
+RCT_EXPORT_METHOD(generateKeyPackages:(NSString *)identity
+                  count:(NSInteger)count
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    MLSIdentityClient *owner = [_clients clientForIdentity:identity];
+    [owner.scheduler dispatchAsyncForKey:MLSIdentityLaneKey(identity) block:^{
+        MLSOperationTrace trace(_metrics.get(), "generateKeyPackages", MLSPayloadSize(identity));
+
+        @try {
+            if (!owner.client) {
+                rejecter(@"E_MLS", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
+                return;
+            }
         
-        void* groupHandle = mls_join_group(self.mlsClient, groupIdStr, receiverIdStr, welcomeMessageStr);
+            NSUInteger requested = count > 0 ? (NSUInteger)count : 0;
+            NSMutableArray* keyPackages = [[_keyPackagePool takeKeyPackages:requested forIdentity:identity] mutableCopy];
+            if (keyPackages.count < requested) {
+                trace.enterPhase(MLSOperationPhase::FFI);
+                [keyPackages addObjectsFromArray:[self generateKeyPackageStrings:identity count:(NSInteger)(requested - keyPackages.count) client:owner.client]];
+                trace.enterPhase(MLSOperationPhase::Marshal);
+            }
+            [self refillKeyPackagePoolIfNeeded:identity];
         
-        if (groupHandle != NULL) {
-            // Free the group handle
-            mls_free_group(groupHandle);
-            
-            // Return the group ID as a string
-            resolver(groupId);
-        } else {
-            rejecter(@"E_MLS", @"Failed to join group", nil);
+            if (keyPackages.count > 0) {
+                resolver(trace.succeed(keyPackages));
+            } else {
+                // Nothing reached the FFI when nothing was asked for
+                rejecter(@"E_MLS", @"Failed to generate key packages",
+                         requested > 0 ? MLSTakeLastFFIError() : MLSBridgeError(MLSErrorCodeInvalidInput));
+            }
+        } @catch (NSException *exception) {
+            rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
-    }
+    }];
 }
 
-// Join an existing MLS group with ratchet tree
-RCT_EXPORT_METHOD(joinGroupWithRatchetTree:(NSString *)groupId
-                  receiverId:(NSString *)receiverId
-                  welcomeMessage:(NSString *)welcomeMessage
-                  ratchetTree:(NSString *)ratchetTree
+// Size the per-identity key package pool. Refill starts once fewer than
+// lowWaterMark packages remain and tops the pool up to targetSize;
+// a targetSize of 0 disables pooling.
+RCT_EXPORT_METHOD(configureKeyPackagePool:(NSInteger)lowWaterMark
+                  targetSize:(NSInteger)targetSize
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
     @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+        if (lowWaterMark < 0 || targetSize < 0 || lowWaterMark > targetSize) {
+            rejecter(@"E_MLS", @"Key package pool needs 0 <= lowWaterMark <= targetSize", MLSBridgeError(MLSErrorCodeInvalidInput));
             return;
         }
         
-        const char* groupIdStr = [groupId UTF8String];
-        const char* receiverIdStr = [receiverId UTF8String];
-        const char* welcomeMessageStr = [welcomeMessage UTF8String];
-        const char* ratchetTreeStr = [ratchetTree UTF8String];
-        
-        void* groupHandle = mls_join_group_with_ratchet_tree(self.mlsClient, groupIdStr, receiverIdStr, welcomeMessageStr, ratchetTreeStr);
-        
-        if (groupHandle != NULL) {
-            // Free the group handle
-            mls_free_group(groupHandle);
-            
-            // Return the group ID as a string
-            resolver(groupId);
-        } else {
-            rejecter(@"E_MLS", @"Failed to join group with ratchet tree", nil);
+        _keyPackagePool.lowWaterMark = (NSUInteger)lowWaterMark;
+        _keyPackagePool.targetSize = (NSUInteger)targetSize;
+        if (targetSize == 0) {
+            [_keyPackagePool removeAllKeyPackages];
         }
+        resolver(nil);
     } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
+        rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
     }
 }
 
-// Export ratchet tree from a group
-RCT_EXPORT_METHOD(exportRatchetTree:(NSString *)groupId
-                  userId:(NSString *)userId
+// Pre-generate key packages for an identity ahead of demand
+RCT_EXPORT_METHOD(warmKeyPackagePool:(NSString *)identity
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
     @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+        if (![_clients clientForIdentity:identity].client) {
+            rejecter(@"E_MLS", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
             return;
         }
         
-        const char* groupIdStr = [groupId UTF8String];
-        const char* userIdStr = [userId UTF8String];
-        
-        int out_len = 0;
-        uint8_t* ratchetTreeBytes = mls_export_ratchet_tree(self.mlsClient, groupIdStr, userIdStr, &out_len);
-        
-        if (ratchetTreeBytes && out_len > 0) {
-            NSData *data = [NSData dataWithBytes:ratchetTreeBytes length:out_len];
-            NSString *base64String = [data base64EncodedStringWithOptions:0];
-            
-            // Free the bytes
-            mls_free_bytes(ratchetTreeBytes);
-            
-            resolver(base64String);
-        } else {
-            rejecter(@"E_MLS", @"Failed to export ratchet tree", nil);
-        }
+        [self refillKeyPackagePoolIfNeeded:identity];
+        resolver(nil);
     } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
+        rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
     }
 }
 
-// Generate a key package
-RCT_EXPORT_METHOD(generateKeyPackage:(NSString *)identity
+// Pool hit/miss counters and packages available per identity
+RCT_EXPORT_METHOD(getKeyPackagePoolStats:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    resolver([_keyPackagePool statistics]);
+}
+
+// Import a key package
+RCT_EXPORT_METHOD(importKeyPackage:(NSString *)identity
+                  keyPackage:(NSString *)keyPackage
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+    MLSIdentityClient *owner = [_clients clientForIdentity:identity];
+    [owner.scheduler dispatchAsyncForKey:MLSIdentityLaneKey(identity) block:^{
+        MLSOperationTrace trace(_metrics.get(), "importKeyPackage", MLSPayloadSize(identity) + MLSPayloadSize(keyPackage));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
             return;
         }
-        
+    
         const char* identityStr = [identity UTF8String];
-        char* keyPackage = mls_generate_key_package(self.mlsClient, identityStr);
-        
-        if (keyPackage) {
-            NSString *keyPackageString = [NSString stringWithUTF8String:keyPackage];
-            
-            // Free the string
-            mls_free_string(keyPackage);
-            
-            resolver(keyPackageString);
+        const char* keyPackageStr = [keyPackage UTF8String];
+    
+        // Use mls_add_keypackage to import the key package
+        trace.enterPhase(MLSOperationPhase::FFI);
+        int result = mls_add_keypackage(owner.client, identityStr, keyPackageStr);
+        trace.enterPhase(MLSOperationPhase::Marshal);
+    
+        if (result == MLSFFIStatusOK) {
+            resolver(trace.succeed(nil));
         } else {
-            rejecter(@"E_MLS", @"Failed to generate key package", nil);
+            rejecter(@"import_key_package_error", @"Failed to import key package", MLSTakeLastFFIError());
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
-    }
+    }];
 }
 
-// Generate multiple key packages
-RCT_EXPORT_METHOD(generateKeyPackages:(NSString *)identity
-                  count:(NSInteger)count
+// Add multiple members to a group
+RCT_EXPORT_METHOD(addMembers:(NSString *)groupId
+                  creatorId:(NSString *)creatorId
+                  receiverKeyPackages:(NSArray *)receiverKeyPackages
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+    MLSIdentityClient *owner = [_clients clientForIdentity:creatorId];
+    [_backgroundWork scheduleOn:owner.scheduler key:groupId work:^{
+        MLSOperationTrace trace(_metrics.get(), "addMembers", MLSPayloadSize(groupId) + MLSPayloadSize(creatorId) + MLSPayloadSize(receiverKeyPackages));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
             return;
         }
-        
-        const char* identityStr = [identity UTF8String];
-        int out_count = 0;
-        int* out_lens = NULL;
-        char** keyPackages = mls_generate_keypackages(self.mlsClient, identityStr, (int)count, &out_count, &out_lens);
-        
-        if (keyPackages && out_count > 0) {
-            NSMutableArray *keyPackageArray = [NSMutableArray arrayWithCapacity:out_count];
-            
-            for (int i = 0; i < out_count; i++) {
-                if (keyPackages[i]) {
-                    NSString *keyPackageString = [NSString stringWithUTF8String:keyPackages[i]];
-                    [keyPackageArray addObject:keyPackageString];
-                }
+    
+        const char* groupIdStr = [groupId UTF8String];
+        const char* creatorIdStr = [creatorId UTF8String];
+    
+        // Copy the receiver key packages into one C string buffer
+        MLSScratchScope scratch([owner.scheduler queueForKey:groupId]);
+        NSUInteger count = [receiverKeyPackages count];
+        const char** receiverKeyPackageStrs = MLSPackUTF8Strings(scratch.arena(), receiverKeyPackages);
+        if (receiverKeyPackageStrs == NULL) {
+            rejecter(@"add_members_error", @"Key packages must be strings", MLSBridgeError(MLSErrorCodeInvalidInput));
+            return;
+        }
+    
+        int* outLens = NULL;
+        int outCount = 0;
+    
+        trace.enterPhase(MLSOperationPhase::FFI);
+        uint8_t* result = mls_add_members(owner.client, groupIdStr, creatorIdStr, receiverKeyPackageStrs, (int)count, &outLens, &outCount);
+        trace.enterPhase(MLSOperationPhase::Marshal);
+    
+        // The two Rust builds lay the result out differently
+        MLSAddMembersOutput output;
+        if (MLSUnpackAddMembersResult(result, outLens, outCount, &output)) {
+            // Hand the raw buffers to the mesh outbox before encoding them for JS
+            NSData* commitData = MLSDataFromRustBytes(output.commit, output.commitLength);
+            NSData* welcomeData = output.welcome != NULL ? MLSDataFromRustBytes(output.welcome, output.welcomeLength) : nil;
+            [self handOffCommit:commitData welcome:welcomeData groupId:groupId senderId:creatorId];
+        
+            // Create the result dictionary; the macOS build makes no welcome
+            NSMutableDictionary* resultDict = [NSMutableDictionary dictionaryWithObject:[commitData base64EncodedStringWithOptions:0]
+                                                                                 forKey:@"commit"];
+            if (welcomeData != nil) {
+                resultDict[@"welcome"] = [welcomeData base64EncodedStringWithOptions:0];
             }
-            
-            // Free the string array
-            mls_free_string_array(keyPackages, out_count);
-            
-            resolver(keyPackageArray);
+        
+            trace.enterPhase(MLSOperationPhase::FFI);
+            [self groupStateDidChange:MLSGroupStateChangeNewEpoch groupId:groupId userId:creatorId client:owner.client];
+            trace.enterPhase(MLSOperationPhase::Marshal);
+            resolver(trace.succeed(resultDict));
         } else {
-            rejecter(@"E_MLS", @"Failed to generate key packages", nil);
+            rejecter(@"add_members_error", @"Failed to add members to group", MLSTakeLastFFIError());
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
+    } cancelled:MLSCancelledRejection(rejecter)];
+}
+
+// Export a secret from an MLS group
+RCT_EXPORT_METHOD(exportSecret:(NSString *)groupId
+                  creatorId:(NSString *)creatorId
+                  label:(NSString *)label
+                  context:(NSData *)context
+                  length:(NSInteger)length
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    MLSIdentityClient *owner = [_clients clientForIdentity:creatorId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "exportSecret", MLSPayloadSize(groupId) + MLSPayloadSize(creatorId) + MLSPayloadSize(label) + MLSPayloadSize(context));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
+            return;
+        }
+    
+        const char* groupIdStr = [groupId UTF8String];
+        const char* creatorIdStr = [creatorId UTF8String];
+        const char* labelStr = [label UTF8String];
+    
+        // Convert the context to bytes
+        const uint8_t* contextBytes = NULL;
+        int contextLen = 0;
+    
+        if (context != nil) {
+            contextBytes = (const uint8_t *)[context bytes];
+            contextLen = (int)[context length];
+        }
+    
+        trace.enterPhase(MLSOperationPhase::FFI);
+        char* secretStr = mls_export_secret(owner.client, groupIdStr, creatorIdStr, labelStr, contextBytes, contextLen, (unsigned int)length);
+        trace.enterPhase(MLSOperationPhase::Marshal);
+    
+        if (secretStr != NULL) {
+            NSString* secret = [NSString stringWithUTF8String:secretStr];
+        
+            // Free the secret string
+            mls_free_string(secretStr);
+        
+            resolver(trace.succeed(secret));
+        } else {
+            rejecter(@"export_secret_error", @"Failed to export secret", MLSTakeLastFFIError());
+        }
+    }];
+}
+
+- (BOOL)exporterSecretForGroup:(NSString *)groupId
+                        userId:(NSString *)userId
+                         label:(NSString *)label
+                       context:(NSData *)context
+                        length:(uint32_t)length
+                        secret:(std::vector<uint8_t> &)secret
+                        client:(void *)client
+{
+    MLSExporterSecretKey key;
+    key.groupId = [groupId UTF8String];
+    key.userId = [userId UTF8String];
+    key.label = [label UTF8String];
+    key.contextDigest.assign(CC_SHA256_DIGEST_LENGTH, '\0');
+    key.length = length;
+    CC_SHA256(context.bytes, (CC_LONG)context.length, (unsigned char *)&key.contextDigest[0]);
+
+    // Always Rust's epoch, never the one cached: an epoch change the bridge
+    // did not see must not serve the previous epoch's secret. The lookup is
+    // cheap next to mls_export_secret.
+    key.epoch = mls_get_current_epoch(client, key.groupId.c_str(), key.userId.c_str());
+    if (_exporterSecrets->get(key, secret)) {
+        return YES;
+    }
+
+    char* secretStr = mls_export_secret(client, key.groupId.c_str(), key.userId.c_str(), key.label.c_str(),
+                                        (const uint8_t *)context.bytes, (int)context.length, length);
+    if (secretStr == NULL) {
+        return NO;
+    }
+    bool decoded = MLSDecodeExportedSecret(secretStr, length, secret);
+    memset(secretStr, 0, strlen(secretStr));
+    mls_free_string(secretStr);
+
+    if (decoded) {
+        _exporterSecrets->put(key, secret);
     }
+    return decoded;
 }
 
-// Import a key package
-RCT_EXPORT_METHOD(importKeyPackage:(NSString *)identity
-                  keyPackage:(NSString *)keyPackage
+// Export a secret as raw bytes (base64 over the bridge), cached per epoch.
+// Repeated derivations with the same label, context and length within an
+// epoch do not reach the FFI.
+RCT_EXPORT_METHOD(exportSecretBytes:(NSString *)groupId
+                  creatorId:(NSString *)creatorId
+                  label:(NSString *)label
+                  context:(NSData *)context
+                  length:(NSInteger)length
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+    MLSIdentityClient *owner = [_clients clientForIdentity:creatorId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "exportSecretBytes", MLSPayloadSize(groupId) + MLSPayloadSize(creatorId) + MLSPayloadSize(label) + MLSPayloadSize(context));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
             return;
         }
-        
-        const char* identityStr = [identity UTF8String];
-        const char* keyPackageStr = [keyPackage UTF8String];
-        
-        int result = mls_add_keypackage(self.mlsClient, identityStr, keyPackageStr);
-        
-        if (result == 0) {
-            resolver(@(YES));
+        if (length <= 0 || length > UINT16_MAX) {
+            rejecter(@"export_secret_error", @"Invalid secret length", MLSBridgeError(MLSErrorCodeInvalidInput));
+            return;
+        }
+    
+        std::vector<uint8_t> secret;
+        trace.enterPhase(MLSOperationPhase::FFI);
+        BOOL exported = [self exporterSecretForGroup:groupId userId:creatorId label:label context:context length:(uint32_t)length secret:secret client:owner.client];
+        trace.enterPhase(MLSOperationPhase::Marshal);
+    
+        if (exported) {
+            NSData* secretData = [[NSData alloc] initWithBytesNoCopy:secret.data() length:secret.size() freeWhenDone:NO];
+            NSString* secretBase64 = [secretData base64EncodedStringWithOptions:0];
+            MLSZeroize(secret);
+            resolver(trace.succeed(secretBase64));
         } else {
-            rejecter(@"E_MLS", @"Failed to import key package", nil);
+            rejecter(@"export_secret_error", @"Failed to export secret", MLSTakeLastFFIError());
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
-    }
+    }];
 }
 
-// Add a member to an MLS group
-RCT_EXPORT_METHOD(addMember:(NSString *)groupId
+// Encrypt a message
+RCT_EXPORT_METHOD(encryptMessage:(NSString *)groupId
                   creatorId:(NSString *)creatorId
-                  receiverId:(NSString *)receiverId
-                  keyPackage:(NSString *)keyPackage
+                  message:(NSString *)message
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+    MLSIdentityClient *owner = [_clients clientForIdentity:creatorId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "encryptMessage", MLSPayloadSize(groupId) + MLSPayloadSize(creatorId) + MLSPayloadSize(message));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
             return;
         }
-        
+    
         const char* groupIdStr = [groupId UTF8String];
         const char* creatorIdStr = [creatorId UTF8String];
-        const char* receiverIdStr = [receiverId UTF8String];
-        const char* keyPackageStr = [keyPackage UTF8String];
-        
-        int out_len = 0;
-        uint8_t* out_welcome = NULL;
-        int out_welcome_len = 0;
-        
-        uint8_t* commitBytes = mls_add_member(self.mlsClient, groupIdStr, creatorIdStr, receiverIdStr, keyPackageStr, &out_len, &out_welcome, &out_welcome_len);
+        const char* messageStr = [message UTF8String];
+    
+        int encryptedLen = 0;
+        trace.enterPhase(MLSOperationPhase::FFI);
+        uint8_t* encryptedBytes = mls_encrypt_message(owner.client, groupIdStr, creatorIdStr, messageStr, &encryptedLen);
+        trace.enterPhase(MLSOperationPhase::Marshal);
+    
+        if (encryptedBytes != NULL) {
+            [self groupWasUsed:groupId userId:creatorId decrypted:NO];
+
+            // Convert the encrypted bytes to a base64 string
+            NSData* encryptedData = MLSDataFromRustBytes(encryptedBytes, encryptedLen);
+            NSString* encryptedBase64 = [encryptedData base64EncodedStringWithOptions:0];
         
-        if (commitBytes && out_len > 0) {
-            NSMutableDictionary *result = [NSMutableDictionary dictionary];
-            
-            // Add commit data
-            NSData *commitData = [NSData dataWithBytes:commitBytes length:out_len];
-            NSString *commitBase64 = [commitData base64EncodedStringWithOptions:0];
-            result[@"commit"] = commitBase64;
-            
-            // Add welcome message if present
-            if (out_welcome && out_welcome_len > 0) {
-                NSData *welcomeData = [NSData dataWithBytes:out_welcome length:out_welcome_len];
-                NSString *welcomeBase64 = [welcomeData base64EncodedStringWithOptions:0];
-                result[@"welcome"] = welcomeBase64;
-                mls_free_bytes(out_welcome);
-            }
-            
-            // Free the commit bytes
-            mls_free_bytes(commitBytes);
-            
-            resolver(result);
+            resolver(trace.succeed(encryptedBase64));
         } else {
-            rejecter(@"E_MLS", @"Failed to add member", nil);
+            rejecter(@"encrypt_message_error", @"Failed to encrypt message", MLSTakeLastFFIError());
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
-    }
+    }];
 }
 
-// Add multiple members to an MLS group
-RCT_EXPORT_METHOD(addMembers:(NSString *)groupId
+// Decrypt a message
+RCT_EXPORT_METHOD(decryptMessage:(NSString *)groupId
                   creatorId:(NSString *)creatorId
-                  receiverKeyPackages:(NSArray *)receiverKeyPackages
+                  encryptedMessage:(NSString *)encryptedMessage
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+    MLSIdentityClient *owner = [_clients clientForIdentity:creatorId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "decryptMessage", MLSPayloadSize(groupId) + MLSPayloadSize(creatorId) + MLSPayloadSize(encryptedMessage));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
             return;
         }
+    
+        // Convert the base64 string to bytes
+        NSData* encryptedData = [[NSData alloc] initWithBase64EncodedString:encryptedMessage options:0];
+    
+        if (encryptedData != nil) {
+            const char* groupIdStr = [groupId UTF8String];
+            const char* creatorIdStr = [creatorId UTF8String];
+            const uint8_t* encryptedBytes = (const uint8_t*)[encryptedData bytes];
+            int encryptedLen = (int)[encryptedData length];
         
-        const char* groupIdStr = [groupId UTF8String];
-        const char* creatorIdStr = [creatorId UTF8String];
-        
-        // Convert NSArray to C array
-        int receiver_count = (int)[receiverKeyPackages count];
-        const char** receiver_keypackages = (const char**)malloc(receiver_count * sizeof(char*));
-        
-        for (int i = 0; i < receiver_count; i++) {
-            NSString *keyPackage = receiverKeyPackages[i];
-            receiver_keypackages[i] = [keyPackage UTF8String];
-        }
-        
-        int* out_lens = NULL;
-        int out_count = 0;
-        
-        uint8_t* result = mls_add_members(self.mlsClient, groupIdStr, creatorIdStr, receiver_keypackages, receiver_count, &out_lens, &out_count);
-        
-        free(receiver_keypackages);
+            trace.enterPhase(MLSOperationPhase::FFI);
+            char* decryptedStr = mls_decrypt_message(owner.client, groupIdStr, creatorIdStr, encryptedBytes, encryptedLen);
+            trace.enterPhase(MLSOperationPhase::Marshal);
         
-        if (result && out_count > 0) {
-            NSData *resultData = [NSData dataWithBytes:result length:out_lens[0]];
-            NSString *resultBase64 = [resultData base64EncodedStringWithOptions:0];
+            if (decryptedStr != NULL) {
+                [self groupWasUsed:groupId userId:creatorId decrypted:YES];
+                NSString* decryptedMessage = [NSString stringWithUTF8String:decryptedStr];
             
-            // Free the result
-            mls_free_bytes(result);
+                // Free the decrypted string
+                mls_free_string(decryptedStr);
             
-            resolver(resultBase64);
+                resolver(trace.succeed(decryptedMessage));
+            } else {
+                rejecter(@"decrypt_message_error", @"Failed to decrypt message", MLSTakeLastFFIError());
+            }
         } else {
-            rejecter(@"E_MLS", @"Failed to add members", nil);
+            rejecter(@"decrypt_message_error", @"Invalid encrypted message format", MLSBridgeError(MLSErrorCodeInvalidInput));
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
-    }
+    }];
 }
 
-// Remove members from an MLS group
-RCT_EXPORT_METHOD(removeMembers:(NSString *)groupId
+// Encrypt an arbitrary byte payload. The plaintext is passed to the FFI with
+// its length, so compressed data and file chunks need no text encoding and
+// may contain NUL bytes. Pair with decryptBytes.
+RCT_EXPORT_METHOD(encryptBytes:(NSString *)groupId
                   creatorId:(NSString *)creatorId
-                  memberIndices:(NSArray *)memberIndices
+                  data:(NSString *)data
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+    MLSIdentityClient *owner = [_clients clientForIdentity:creatorId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "encryptBytes", MLSPayloadSize(groupId) + MLSPayloadSize(creatorId) + MLSPayloadSize(data));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
             return;
         }
-        
-        const char* groupIdStr = [groupId UTF8String];
-        const char* creatorIdStr = [creatorId UTF8String];
-        
-        // Convert NSArray to C array
-        int member_count = (int)[memberIndices count];
-        const int** member_indices = (const int**)malloc(member_count * sizeof(int*));
-        int* indices = (int*)malloc(member_count * sizeof(int));
-        
-        for (int i = 0; i < member_count; i++) {
-            indices[i] = [memberIndices[i] intValue];
-            member_indices[i] = &indices[i];
-        }
-        
-        int out_count = 0;
-        uint8_t* result = mls_remove_members(self.mlsClient, groupIdStr, creatorIdStr, member_indices, member_count, &out_count);
-        
-        free(member_indices);
-        free(indices);
-        
-        if (result && out_count > 0) {
-            NSData *resultData = [NSData dataWithBytes:result length:out_count];
-            NSString *resultBase64 = [resultData base64EncodedStringWithOptions:0];
-            
-            // Free the result
-            mls_free_bytes(result);
-            
-            resolver(resultBase64);
+    
+        // The bridge can only carry the payload as base64
+        NSData* plaintextData = [[NSData alloc] initWithBase64EncodedString:data options:0];
+    
+        if (plaintextData != nil) {
+            int encryptedLen = 0;
+            trace.enterPhase(MLSOperationPhase::FFI);
+            uint8_t* encryptedBytes = MLSCreateApplicationMessage(
+                _groupHandles.get(),
+                owner.client,
+                [groupId UTF8String],
+                [creatorId UTF8String],
+                (const uint8_t*)[plaintextData bytes],
+                (int)[plaintextData length],
+                &encryptedLen
+            );
+            trace.enterPhase(MLSOperationPhase::Marshal);
+        
+            if (encryptedBytes != NULL) {
+                [self groupWasUsed:groupId userId:creatorId decrypted:NO];
+                NSData* encryptedData = MLSDataFromRustBytes(encryptedBytes, encryptedLen);
+                resolver(trace.succeed([encryptedData base64EncodedStringWithOptions:0]));
+            } else {
+                rejecter(@"encrypt_message_error", @"Failed to encrypt message", MLSTakeLastFFIError());
+            }
         } else {
-            rejecter(@"E_MLS", @"Failed to remove members", nil);
+            rejecter(@"encrypt_message_error", @"Invalid payload format", MLSBridgeError(MLSErrorCodeInvalidInput));
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
-    }
+    }];
 }
 
-// Commit pending proposals in an MLS group
-RCT_EXPORT_METHOD(commitPendingProposals:(NSString *)groupId
+// Decrypt a ciphertext produced by encryptBytes (or createApplicationMessage)
+// and resolve the plaintext as base64, without assuming it is text
+RCT_EXPORT_METHOD(decryptBytes:(NSString *)groupId
                   creatorId:(NSString *)creatorId
+                  encryptedMessage:(NSString *)encryptedMessage
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+    MLSIdentityClient *owner = [_clients clientForIdentity:creatorId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "decryptBytes", MLSPayloadSize(groupId) + MLSPayloadSize(creatorId) + MLSPayloadSize(encryptedMessage));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
             return;
         }
+    
+        NSData* encryptedData = [[NSData alloc] initWithBase64EncodedString:encryptedMessage options:0];
+    
+        if (encryptedData != nil) {
+            int messageType = 0;
+            uint8_t* contentBytes = NULL;
+            int contentLen = 0;
+            uint8_t* senderBytes = NULL;
+            int senderLen = 0;
+            int validated = 0;
+        
+            trace.enterPhase(MLSOperationPhase::FFI);
+            int result = MLSProcessMessage(
+                _groupHandles.get(),
+                owner.client,
+                [groupId UTF8String],
+                [creatorId UTF8String],
+                (const uint8_t*)[encryptedData bytes],
+                (int)[encryptedData length],
+                &messageType,
+                &contentBytes,
+                &contentLen,
+                &senderBytes,
+                &senderLen,
+                &validated
+            );
+            trace.enterPhase(MLSOperationPhase::Marshal);
+        
+            // Only the length-delimited content is needed
+            if (senderBytes != NULL) {
+                mls_free_bytes(senderBytes);
+            }
+            NSData* contentData = MLSDataFromRustBytes(contentBytes, contentLen);
         
-        const char* groupIdStr = [groupId UTF8String];
-        const char* creatorIdStr = [creatorId UTF8String];
-        
-        int out_len = 0;
-        uint8_t* out_welcome = NULL;
-        int out_welcome_len = 0;
-        
-        uint8_t* commitBytes = mls_commit_pending_proposals(self.mlsClient, groupIdStr, creatorIdStr, &out_len, &out_welcome, &out_welcome_len);
+            if (result != MLSFFIStatusOK) {
+                rejecter(@"decrypt_message_error", @"Failed to decrypt message", MLSTakeLastFFIError());
+                return;
+            }
         
-        if (commitBytes && out_len > 0) {
-            NSMutableDictionary *result = [NSMutableDictionary dictionary];
-            
-            // Add commit data
-            NSData *commitData = [NSData dataWithBytes:commitBytes length:out_len];
-            NSString *commitBase64 = [commitData base64EncodedStringWithOptions:0];
-            result[@"commit"] = commitBase64;
-            
-            // Add welcome message if present
-            if (out_welcome && out_welcome_len > 0) {
-                NSData *welcomeData = [NSData dataWithBytes:out_welcome length:out_welcome_len];
-                NSString *welcomeBase64 = [welcomeData base64EncodedStringWithOptions:0];
-                result[@"welcome"] = welcomeBase64;
-                mls_free_bytes(out_welcome);
+            // Rust has applied a proposal or commit by now, so report it
+            // like processMessage does before turning the message down
+            [self groupWasUsed:groupId userId:creatorId decrypted:messageType == 0];
+            if (messageType == 1 || messageType == 2) {
+                MLSGroupStateChange change = messageType == 1 ? MLSGroupStateChangeProposal : MLSGroupStateChangeNewEpoch;
+                trace.enterPhase(MLSOperationPhase::FFI);
+                [self groupStateDidChange:change groupId:groupId userId:creatorId client:owner.client];
+                trace.enterPhase(MLSOperationPhase::Marshal);
+            }
+            if (messageType != 0) {
+                rejecter(@"decrypt_message_error", @"Not an application message", MLSBridgeError(MLSErrorCodeInvalidInput));
+            } else {
+                resolver(trace.succeed([contentData base64EncodedStringWithOptions:0]));
             }
-            
-            // Free the commit bytes
-            mls_free_bytes(commitBytes);
-            
-            resolver(result);
         } else {
-            rejecter(@"E_MLS", @"Failed to commit pending proposals", nil);
+            rejecter(@"decrypt_message_error", @"Invalid encrypted message format", MLSBridgeError(MLSErrorCodeInvalidInput));
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
-    }
+    }];
 }
 
-// Export a secret from an MLS group
-RCT_EXPORT_METHOD(exportSecret:(NSString *)groupId
+
+// Create a commit
+RCT_EXPORT_METHOD(createCommit:(NSString *)groupId
                   creatorId:(NSString *)creatorId
-                  label:(NSString *)label
-                  context:(NSData *)context
-                  length:(NSInteger)length
+                  keyPackages:(NSArray *)keyPackages
+                  proposals:(NSArray *)proposals
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+    MLSIdentityClient *owner = [_clients clientForIdentity:creatorId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "createCommit", MLSPayloadSize(groupId) + MLSPayloadSize(creatorId) + MLSPayloadSize(keyPackages) + MLSPayloadSize(proposals));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
             return;
         }
-        
+    
         const char* groupIdStr = [groupId UTF8String];
         const char* creatorIdStr = [creatorId UTF8String];
-        const char* labelStr = [label UTF8String];
+    
+        // Decode the key packages and proposals into the lane's scratch arena
+        MLSScratchScope scratch([owner.scheduler queueForKey:groupId]);
+        NSMutableArray* proposalDataStrings = [NSMutableArray arrayWithCapacity:[proposals count]];
+        for (NSDictionary* proposal in proposals) {
+            [proposalDataStrings addObject:proposal[@"data"] ?: [NSNull null]];
+        }
+    
+        MLSPackedBytes packedKeyPackages;
+        MLSPackedBytes packedProposals;
+        if (!MLSPackBase64Strings(scratch.arena(), keyPackages, packedKeyPackages) ||
+            !MLSPackBase64Strings(scratch.arena(), proposalDataStrings, packedProposals)) {
+            rejecter(@"create_commit_error", @"Key packages and proposals must be base64", MLSBridgeError(MLSErrorCodeInvalidInput));
+            return;
+        }
+    
+        const uint8_t** keyPackagePtrsArray = NULL;
+        int* keyPackageLensArray = NULL;
+        packedKeyPackages.table(scratch.arena(), keyPackagePtrsArray, keyPackageLensArray);
+    
+        const uint8_t** proposalPtrsArray = NULL;
+        int* proposalLensArray = NULL;
+        packedProposals.table(scratch.arena(), proposalPtrsArray, proposalLensArray);
+    
+        // Call the Rust function
+        int commitLen = 0;
+        uint8_t* welcomeBytes = NULL;
+        int welcomeLen = 0;
+    
+        trace.enterPhase(MLSOperationPhase::FFI);
+        uint8_t* commitBytes = mls_create_commit(
+            owner.client,
+            groupIdStr,
+            creatorIdStr,
+            keyPackagePtrsArray,
+            keyPackageLensArray,
+            (int)[keyPackages count],
+            proposalPtrsArray,
+            proposalLensArray,
+            (int)[proposals count],
+            &commitLen,
+            &welcomeBytes,
+            &welcomeLen
+        );
+        trace.enterPhase(MLSOperationPhase::Marshal);
+    
+        if (commitBytes != NULL) {
+            // Hand the raw buffers to the mesh outbox before encoding them for JS
+            NSData* commitData = MLSDataFromRustBytes(commitBytes, commitLen);
+            NSData* welcomeData = welcomeBytes != NULL ? MLSDataFromRustBytes(welcomeBytes, welcomeLen) : nil;
+            [self handOffCommit:commitData welcome:welcomeData groupId:groupId senderId:creatorId];
+        
+            NSString* commitBase64 = [commitData base64EncodedStringWithOptions:0];
+            NSString* welcomeBase64 = [welcomeData base64EncodedStringWithOptions:0];
+        
+            // Create the result object
+            NSMutableArray* proposalIds = [NSMutableArray arrayWithCapacity:[proposals count]];
+            for (NSDictionary* proposal in proposals) {
+                [proposalIds addObject:proposal[@"id"]];
+            }
         
-        const uint8_t* contextBytes = context ? (const uint8_t*)[context bytes] : NULL;
-        int contextLen = context ? (int)[context length] : 0;
+            NSMutableDictionary* result = [NSMutableDictionary dictionaryWithDictionary:@{
+                @"id": [[NSUUID UUID] UUIDString],
+                @"proposals": proposalIds,
+                @"sender": @"self",
+                @"data": commitBase64
+            }];
         
-        char* secret = mls_export_secret(self.mlsClient, groupIdStr, creatorIdStr, labelStr, contextBytes, contextLen, (unsigned int)length);
+            if (welcomeBase64) {
+                [result setObject:welcomeBase64 forKey:@"welcome"];
+            }
         
-        if (secret) {
-            NSString *secretString = [NSString stringWithUTF8String:secret];
-            
-            // Free the string
-            mls_free_string(secret);
-            
-            resolver(secretString);
+            trace.enterPhase(MLSOperationPhase::FFI);
+            [self groupStateDidChange:MLSGroupStateChangeNewEpoch groupId:groupId userId:creatorId client:owner.client];
+            trace.enterPhase(MLSOperationPhase::Marshal);
+            resolver(trace.succeed(result));
         } else {
-            rejecter(@"E_MLS", @"Failed to export secret", nil);
+            rejecter(@"create_commit_error", @"Failed to create commit", MLSTakeLastFFIError());
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
+    }];
+}
+
+- (void)reportMembershipProgress:(NSString *)operationId
+                         groupId:(NSString *)groupId
+                           phase:(NSString *)phase
+                       completed:(NSUInteger)completed
+                           total:(NSUInteger)total
+{
+    if (_hasListeners) {
+        [self sendEventWithName:MLSMembershipProgressEvent
+                           body:@{ @"operationId": operationId, @"groupId": groupId, @"phase": phase,
+                                   @"completed": @(completed), @"total": @(total) }];
     }
 }
 
-// Encrypt a message
-RCT_EXPORT_METHOD(encryptMessage:(NSString *)groupId
+// Stage every add and remove of a bulk membership change and commit them
+// together. Runs on the group's lane; returns nil with `error` and `cause`
+// set on failure.
+- (NSDictionary *)bulkUpdateMembersOfGroup:(NSString *)groupId
+                                 creatorId:(NSString *)creatorId
+                                      adds:(NSArray *)adds
+                                   removes:(NSArray *)removes
+                               operationId:(NSString *)operationId
+                                     owner:(MLSIdentityClient *)owner
+                                     trace:(MLSOperationTrace &)trace
+                                     error:(NSString **)error
+                                     cause:(NSError **)cause
+{
+    MLSScratchScope scratch([owner.scheduler queueForKey:groupId]);
+    MLSScratchArena &arena = scratch.arena();
+    const char* groupIdStr = [groupId UTF8String];
+    const char* creatorIdStr = [creatorId UTF8String];
+
+    // Adds are bare key packages or {identity, keyPackage}; the identity is
+    // only echoed back for Welcome routing
+    NSMutableArray<NSString *> *keyPackages = [NSMutableArray arrayWithCapacity:adds.count];
+    NSMutableArray<NSDictionary *> *recipients = [NSMutableArray arrayWithCapacity:adds.count];
+    for (id add in adds) {
+        id keyPackage = add;
+        id identity = [NSNull null];
+        if ([add isKindOfClass:[NSDictionary class]]) {
+            keyPackage = add[@"keyPackage"];
+            identity = add[@"identity"] ?: [NSNull null];
+        }
+        if (![keyPackage isKindOfClass:[NSString class]]) {
+            *error = @"Each add must be a key package or {identity, keyPackage}";
+            *cause = MLSBridgeError(MLSErrorCodeInvalidInput);
+            return nil;
+        }
+        [recipients addObject:@{ @"identity": identity, @"keyPackageIndex": @(keyPackages.count) }];
+        [keyPackages addObject:keyPackage];
+    }
+
+    MLSPackedBytes packedKeyPackages;
+    if (!MLSPackBase64Strings(arena, keyPackages, packedKeyPackages)) {
+        *error = @"Key packages must be base64";
+        *cause = MLSBridgeError(MLSErrorCodeInvalidInput);
+        return nil;
+    }
+
+    // Removing a leaf twice would invalidate the commit
+    size_t removeCount = removes.count;
+    unsigned int* indices = arena.allocate<unsigned int>(removeCount);
+    for (size_t i = 0; i < removeCount; i++) {
+        id index = removes[i];
+        if (![index isKindOfClass:[NSNumber class]] || [index longLongValue] < 0 || [index longLongValue] > UINT32_MAX) {
+            *error = @"Each remove must be a member index";
+            *cause = MLSBridgeError(MLSErrorCodeInvalidInput);
+            return nil;
+        }
+        indices[i] = [index unsignedIntValue];
+    }
+    std::sort(indices, indices + removeCount);
+    removeCount = std::unique(indices, indices + removeCount) - indices;
+
+    NSUInteger total = keyPackages.count + removeCount;
+    NSUInteger staged = keyPackages.count;
+    [self reportMembershipProgress:operationId groupId:groupId phase:@"staging" completed:staged total:total];
+
+    // Removes go into the commit as proposals, the way createCommit takes them
+    uint8_t** proposals = arena.allocate<uint8_t*>(removeCount);
+    int* proposalLens = arena.allocate<int>(removeCount);
+    size_t created = 0;
+    trace.enterPhase(MLSOperationPhase::FFI);
+    for (; created < removeCount; created++) {
+        proposals[created] = mls_create_remove_proposal(owner.client, groupIdStr, creatorIdStr, indices[created], &proposalLens[created]);
+        if (proposals[created] == NULL) {
+            *cause = MLSTakeLastFFIError();
+            break;
+        }
+        staged++;
+        if (staged % MLSMembershipProgressStride == 0) {
+            [self reportMembershipProgress:operationId groupId:groupId phase:@"staging" completed:staged total:total];
+        }
+    }
+
+    uint8_t* commitBytes = NULL;
+    int commitLen = 0;
+    uint8_t* welcomeBytes = NULL;
+    int welcomeLen = 0;
+    if (created == removeCount) {
+        [self reportMembershipProgress:operationId groupId:groupId phase:@"committing" completed:staged total:total];
+
+        const uint8_t** keyPackagePtrs = NULL;
+        int* keyPackageLens = NULL;
+        packedKeyPackages.table(arena, keyPackagePtrs, keyPackageLens);
+        commitBytes = mls_create_commit(owner.client, groupIdStr, creatorIdStr,
+                                        keyPackagePtrs, keyPackageLens, (int)packedKeyPackages.count,
+                                        (const uint8_t**)proposals, proposalLens, (int)removeCount,
+                                        &commitLen, &welcomeBytes, &welcomeLen);
+        if (commitBytes == NULL) {
+            *cause = MLSTakeLastFFIError();
+        }
+    }
+    for (size_t i = 0; i < created; i++) {
+        mls_free_bytes(proposals[i]);
+    }
+    trace.enterPhase(MLSOperationPhase::Marshal);
+
+    if (created < removeCount) {
+        *error = [NSString stringWithFormat:@"Failed to remove member at index %u", indices[created]];
+        return nil;
+    }
+    if (commitBytes == NULL) {
+        if (welcomeBytes != NULL) {
+            mls_free_bytes(welcomeBytes);
+        }
+        *error = @"Failed to create commit";
+        return nil;
+    }
+
+    NSMutableArray<NSNumber *> *removed = [NSMutableArray arrayWithCapacity:removeCount];
+    for (size_t i = 0; i < removeCount; i++) {
+        [removed addObject:@(indices[i])];
+    }
+    NSData *commitData = MLSDataFromRustBytes(commitBytes, commitLen);
+    NSData *welcomeData = welcomeBytes != NULL ? MLSDataFromRustBytes(welcomeBytes, welcomeLen) : nil;
+    [self handOffCommit:commitData welcome:welcomeData groupId:groupId senderId:creatorId];
+
+    NSMutableDictionary *result = [NSMutableDictionary dictionaryWithDictionary:@{
+        @"operationId": operationId,
+        @"commit": [commitData base64EncodedStringWithOptions:0],
+        @"recipients": recipients,
+        @"removed": removed,
+    }];
+    if (welcomeData != nil) {
+        result[@"welcome"] = [welcomeData base64EncodedStringWithOptions:0];
+    }
+
+    trace.enterPhase(MLSOperationPhase::FFI);
+    NSDictionary *memberChanges = [self groupStateDidChange:MLSGroupStateChangeNewEpoch groupId:groupId userId:creatorId client:owner.client];
+    trace.enterPhase(MLSOperationPhase::Marshal);
+    if (memberChanges != nil) {
+        result[@"memberChanges"] = memberChanges;
+    }
+
+    [self reportMembershipProgress:operationId groupId:groupId phase:@"done" completed:total total:total];
+    return result;
+}
+
+// Add and remove many members in one commit, reporting progress events
+RCT_EXPORT_METHOD(bulkUpdateMembers:(NSString *)groupId
                   creatorId:(NSString *)creatorId
-                  message:(NSString *)message
+                  adds:(NSArray *)adds
+                  removes:(NSArray *)removes
+                  operationId:(NSString *)operationId
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+    NSString *bulkOperationId = operationId.length > 0 ? operationId : [[NSUUID UUID] UUIDString];
+    MLSIdentityClient *owner = [_clients clientForIdentity:creatorId];
+    [_backgroundWork scheduleOn:owner.scheduler key:groupId work:^{
+        MLSOperationTrace trace(_metrics.get(), "bulkUpdateMembers", MLSPayloadSize(groupId) + MLSPayloadSize(creatorId) + MLSPayloadSize(adds) + MLSPayloadSize(removes));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
             return;
         }
-        
-        const char* groupIdStr = [groupId UTF8String];
-        const char* creatorIdStr = [creatorId UTF8String];
-        const char* messageStr = [message UTF8String];
-        
-        int out_len = 0;
-        uint8_t* encryptedBytes = mls_encrypt_message(self.mlsClient, groupIdStr, creatorIdStr, messageStr, &out_len);
-        
-        if (encryptedBytes && out_len > 0) {
-            NSData *encryptedData = [NSData dataWithBytes:encryptedBytes length:out_len];
-            NSString *encryptedBase64 = [encryptedData base64EncodedStringWithOptions:0];
-            
-            // Free the bytes
-            mls_free_bytes(encryptedBytes);
-            
-            resolver(encryptedBase64);
+        if (adds.count == 0 && removes.count == 0) {
+            rejecter(@"bulk_update_members_error", @"Nothing to add or remove", MLSBridgeError(MLSErrorCodeInvalidInput));
+            return;
+        }
+    
+        NSString* error = nil;
+        NSError* cause = nil;
+        NSDictionary* result = [self bulkUpdateMembersOfGroup:groupId creatorId:creatorId adds:adds removes:removes
+                                                  operationId:bulkOperationId owner:owner trace:trace
+                                                        error:&error cause:&cause];
+        if (result != nil) {
+            resolver(trace.succeed(result));
         } else {
-            rejecter(@"E_MLS", @"Failed to encrypt message", nil);
+            rejecter(@"bulk_update_members_error", error, cause);
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
-    }
+    } cancelled:MLSCancelledRejection(rejecter)];
 }
 
-// Decrypt a message
-RCT_EXPORT_METHOD(decryptMessage:(NSString *)groupId
-                  creatorId:(NSString *)creatorId
-                  encryptedMessage:(NSString *)encryptedMessage
+// Get current epoch
+RCT_EXPORT_METHOD(getCurrentEpoch:(NSString *)groupId
+                  userId:(NSString *)userId
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+    MLSIdentityClient *owner = [_clients clientForIdentity:userId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "getCurrentEpoch", MLSPayloadSize(groupId) + MLSPayloadSize(userId));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
             return;
         }
-        
+
         const char* groupIdStr = [groupId UTF8String];
-        const char* creatorIdStr = [creatorId UTF8String];
-        
-        // Decrypt a message
-        
-        // Convert the base64 string to bytes
-        NSData* encryptedData = [[NSData alloc] initWithBase64EncodedString:encryptedMessage options:0];
-        
-        if (encryptedData != nil) {
-            const uint8_t* encryptedBytes = (const uint8_t*)[encryptedData bytes];
-            int encryptedLen = (int)[encryptedData length];
-            
-            char* decryptedStr = mls_decrypt_message(self.mlsClient, groupIdStr, creatorIdStr, encryptedBytes, encryptedLen);
-            
-            if (decryptedStr != NULL) {
-                NSString* decryptedMessage = [NSString stringWithUTF8String:decryptedStr];
-                
-                // Free the decrypted string
-                mls_free_string(decryptedStr);
-                
-                resolver(decryptedMessage);
+        const char* userIdStr = [userId UTF8String];
+
+        trace.enterPhase(MLSOperationPhase::FFI);
+        unsigned long epoch = mls_get_current_epoch(owner.client, groupIdStr, userIdStr);
+        trace.enterPhase(MLSOperationPhase::Marshal);
+        resolver(trace.succeed(@(epoch)));
+    }];
+}
+
+// Process one decoded MLS message. Returns NO, with `error` set, if the FFI
+// rejects the message and it cannot be parked. With checkDuplicates, a
+// ciphertext already processed or parked comes back as a duplicate without
+// reaching the FFI; one that failed, or was parked and then dropped or
+// failed its replay, may be tried again.
+- (BOOL)processMessageBytes:(NSData *)encryptedData
+                    groupId:(const char *)groupIdStr
+                     userId:(const char *)userIdStr
+                     client:(void *)client
+            checkDuplicates:(BOOL)checkDuplicates
+                    message:(MLSProcessedMessage &)message
+                      error:(NSError **)error
+{
+    const uint8_t* encryptedBytes = (const uint8_t*)[encryptedData bytes];
+    int encryptedLen = (int)[encryptedData length];
+
+    MLSCiphertextDigest digest = {0, 0};
+    if (checkDuplicates) {
+        digest = MLSDigestCiphertext(groupIdStr, userIdStr, encryptedBytes, (size_t)encryptedLen);
+        if (_ciphertextFilter->contains(digest)) {
+            message.outcome = MLSProcessedMessage::Outcome::Duplicate;
+            return YES;
+        }
+    }
+    
+    // Output parameters
+    int messageType = 0;
+    uint8_t* contentBytes = NULL;
+    int contentLen = 0;
+    uint8_t* senderBytes = NULL;
+    int senderLen = 0;
+    int validated = 0;
+    
+    // Call the Rust FFI function
+    int result = MLSProcessMessage(
+        _groupHandles.get(),
+        client,
+        groupIdStr,
+        userIdStr,
+        encryptedBytes,
+        encryptedLen,
+        &messageType,
+        &contentBytes,
+        &contentLen,
+        &senderBytes,
+        &senderLen,
+        &validated
+    );
+    
+    if (result != MLSFFIStatusOK) {
+        // Taken first: parking makes FFI calls of its own
+        NSError *processError = MLSTakeLastFFIError();
+
+        // A message from a later epoch waits for the commit that gets there
+        uint64_t epoch = 0;
+        uint64_t ticket = [self deferMessageBytes:encryptedBytes length:(size_t)encryptedLen
+                                          groupId:groupIdStr userId:userIdStr client:client epoch:&epoch];
+        if (ticket == 0) {
+            // A later epoch that could not be parked can be sent again once its commit is in
+            *error = epoch != 0 ? MLSBridgeError(MLSErrorCodeWrongEpoch) : processError;
+            return NO;
+        }
+        if (checkDuplicates) {
+            _ciphertextFilter->insert(digest);
+        }
+        message.outcome = MLSProcessedMessage::Outcome::Deferred;
+        message.epoch = epoch;
+        message.ticket = ticket;
+        return YES;
+    }
+    if (checkDuplicates) {
+        _ciphertextFilter->insert(digest);
+    }
+    [self groupWasUsed:@(groupIdStr) userId:@(userIdStr) decrypted:messageType == 0];
+
+    message.outcome = MLSProcessedMessage::Outcome::Processed;
+    message.messageType = messageType;
+    message.content = MLSDataFromRustBytes(contentBytes, contentLen);
+    message.sender = MLSDataFromRustBytes(senderBytes, senderLen);
+    message.validated = validated == 1;
+    MLSMessageHeader header;
+    if (MLSReadMessageHeader(encryptedBytes, (size_t)encryptedLen, header)) {
+        message.epoch = header.epoch;
+    }
+
+    // Proposals and commits change group state; a commit reports its roster delta
+    if (messageType == 1) {
+        [self groupStateDidChange:MLSGroupStateChangeProposal groupId:@(groupIdStr) userId:@(userIdStr) client:client];
+    } else if (messageType == 2) {
+        message.memberChanges = [self groupStateDidChange:MLSGroupStateChangeNewEpoch groupId:@(groupIdStr) userId:@(userIdStr) client:client];
+    }
+    return YES;
+}
+
+// Process one decoded MLS message and build its result dictionary.
+// Returns nil, with `error` set, if the FFI rejects the message. With
+// checkDuplicates, a ciphertext already processed or parked resolves as
+// {type: "duplicate"} without reaching the FFI; one that failed may be
+// tried again.
+- (NSDictionary *)processMessageBytes:(NSData *)encryptedData
+                              groupId:(const char *)groupIdStr
+                               userId:(const char *)userIdStr
+                               client:(void *)client
+                      checkDuplicates:(BOOL)checkDuplicates
+                                error:(NSError **)error
+{
+    MLSProcessedMessage message;
+    if (![self processMessageBytes:encryptedData groupId:groupIdStr userId:userIdStr client:client
+                   checkDuplicates:checkDuplicates message:message error:error]) {
+        return nil;
+    }
+    if (message.outcome == MLSProcessedMessage::Outcome::Duplicate) {
+        return @{ @"type": @"duplicate" };
+    }
+    if (message.outcome == MLSProcessedMessage::Outcome::Deferred) {
+        return @{ @"type": @"deferred", @"epoch": @(message.epoch), @"ticket": @(message.ticket) };
+    }
+    
+    // Create the result dictionary
+    NSMutableDictionary* resultDict = [NSMutableDictionary dictionary];
+    
+    // Add the message type
+    NSString* typeStr;
+    switch (message.messageType) {
+        case 0:
+            typeStr = @"application";
+            break;
+        case 1:
+            typeStr = @"proposal";
+            break;
+        case 2:
+            typeStr = @"commit";
+            break;
+        case 3:
+            typeStr = @"welcome";
+            break;
+        default:
+            typeStr = @"unknown";
+    }
+    [resultDict setObject:typeStr forKey:@"type"];
+    
+    // Add the content if available
+    if (message.content.length > 0) {
+        // Try to convert to string if it's application message content
+        if (message.messageType == 0) {
+            NSString* contentStr = [[NSString alloc] initWithData:message.content encoding:NSUTF8StringEncoding];
+            if (contentStr) {
+                [resultDict setObject:contentStr forKey:@"content"];
             } else {
-                rejecter(@"E_MLS", @"Failed to decrypt message", nil);
+                [resultDict setObject:[message.content base64EncodedStringWithOptions:0] forKey:@"content"];
             }
         } else {
-            rejecter(@"E_MLS", @"Invalid encrypted message format", nil);
+            [resultDict setObject:[message.content base64EncodedStringWithOptions:0] forKey:@"content"];
+        }
+    }
+    
+    // Add the sender if available
+    if (message.sender.length > 0) {
+        NSString* senderStr = [[NSString alloc] initWithData:message.sender encoding:NSUTF8StringEncoding];
+        if (senderStr) {
+            [resultDict setObject:senderStr forKey:@"sender"];
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
     }
+    
+    // Add the validated flag
+    [resultDict setObject:@(message.validated) forKey:@"validated"];
+    
+    if (message.memberChanges != nil) {
+        [resultDict setObject:message.memberChanges forKey:@"memberChanges"];
+    }
+    
+    return resultDict;
 }
 
-// Create a commit
-RCT_EXPORT_METHOD(createCommit:(NSString *)groupId
-                  creatorId:(NSString *)creatorId
-                  keyPackages:(NSArray *)keyPackages
-                  proposals:(NSArray *)proposals
+// Process an MLS message
+RCT_EXPORT_METHOD(processMessage:(NSString *)groupId
+                  userId:(NSString *)userId
+                  encryptedMessage:(NSString *)encryptedMessage
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+    MLSIdentityClient *owner = [_clients clientForIdentity:userId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "processMessage", MLSPayloadSize(groupId) + MLSPayloadSize(userId) + MLSPayloadSize(encryptedMessage));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
             return;
         }
-        
-        const char* groupIdStr = [groupId UTF8String];
-        const char* creatorIdStr = [creatorId UTF8String];
-        
-        // Convert the key packages to byte arrays
-        NSMutableArray* keyPackageDataArray = [NSMutableArray arrayWithCapacity:[keyPackages count]];
-        const uint8_t** keyPackagePtrsArray = (const uint8_t**)malloc(sizeof(uint8_t*) * [keyPackages count]);
-        int* keyPackageLensArray = (int*)malloc(sizeof(int) * [keyPackages count]);
-        
-        for (int i = 0; i < [keyPackages count]; i++) {
-            NSString* keyPackage = keyPackages[i];
-            NSData* data = [[NSData alloc] initWithBase64EncodedString:keyPackage options:0];
-            [keyPackageDataArray addObject:data];
-            keyPackagePtrsArray[i] = (const uint8_t*)[data bytes];
-            keyPackageLensArray[i] = (int)[data length];
-        }
-        
-        // Convert the proposals to byte arrays
-        NSMutableArray* proposalDataArray = [NSMutableArray arrayWithCapacity:[proposals count]];
-        const uint8_t** proposalPtrsArray = (const uint8_t**)malloc(sizeof(uint8_t*) * [proposals count]);
-        int* proposalLensArray = (int*)malloc(sizeof(int) * [proposals count]);
-        
-        for (int i = 0; i < [proposals count]; i++) {
-            NSDictionary* proposal = proposals[i];
-            NSString* proposalData = proposal[@"data"];
-            NSData* data = [[NSData alloc] initWithBase64EncodedString:proposalData options:0];
-            [proposalDataArray addObject:data];
-            proposalPtrsArray[i] = (const uint8_t*)[data bytes];
-            proposalLensArray[i] = (int)[data length];
-        }
-        
-        int out_commit_len = 0;
-        uint8_t* out_welcome = NULL;
-        int out_welcome_len = 0;
-        
-        uint8_t* commitBytes = mls_create_commit(self.mlsClient, groupIdStr, creatorIdStr, 
-                                               keyPackagePtrsArray, keyPackageLensArray, (int)[keyPackages count],
-                                               proposalPtrsArray, proposalLensArray, (int)[proposals count],
-                                               &out_commit_len, &out_welcome, &out_welcome_len);
-        
-        free(keyPackagePtrsArray);
-        free(keyPackageLensArray);
-        free(proposalPtrsArray);
-        free(proposalLensArray);
-        
-        if (commitBytes && out_commit_len > 0) {
-            NSMutableDictionary *result = [NSMutableDictionary dictionary];
-            
-            // Add commit data
-            NSData *commitData = [NSData dataWithBytes:commitBytes length:out_commit_len];
-            NSString *commitBase64 = [commitData base64EncodedStringWithOptions:0];
-            result[@"commit"] = commitBase64;
-            
-            // Add welcome message if present
-            if (out_welcome && out_welcome_len > 0) {
-                NSData *welcomeData = [NSData dataWithBytes:out_welcome length:out_welcome_len];
-                NSString *welcomeBase64 = [welcomeData base64EncodedStringWithOptions:0];
-                result[@"welcome"] = welcomeBase64;
-                mls_free_bytes(out_welcome);
+    
+        // Convert the base64 string to bytes
+        NSData* encryptedData = [[NSData alloc] initWithBase64EncodedString:encryptedMessage options:0];
+    
+        if (encryptedData != nil) {
+            NSError* error = nil;
+            trace.enterPhase(MLSOperationPhase::FFI);
+            NSDictionary* resultDict = [self processMessageBytes:encryptedData
+                                                         groupId:[groupId UTF8String]
+                                                          userId:[userId UTF8String]
+                                                          client:owner.client
+                                                 checkDuplicates:YES
+                                                           error:&error];
+            trace.enterPhase(MLSOperationPhase::Marshal);
+        
+            if (resultDict != nil) {
+                resolver(trace.succeed(resultDict));
+            } else {
+                rejecter(@"process_message_error", @"Failed to process message", error);
             }
-            
-            // Free the commit bytes
-            mls_free_bytes(commitBytes);
-            
-            resolver(result);
         } else {
-            rejecter(@"E_MLS", @"Failed to create commit", nil);
+            rejecter(@"process_message_error", @"Invalid encrypted message format", MLSBridgeError(MLSErrorCodeInvalidInput));
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
-    }
+    }];
 }
 
-// Get current epoch
-RCT_EXPORT_METHOD(getCurrentEpoch:(NSString *)groupId
+// Process a batch of MLS messages for one group in a single bridge call.
+// Messages are applied in order; a failing message yields an error entry
+// and does not stop the rest of the batch.
+RCT_EXPORT_METHOD(processMessages:(NSString *)groupId
                   userId:(NSString *)userId
+                  encryptedMessages:(NSArray *)encryptedMessages
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+    // With storage batches a barrier, so the batch's transaction holds only
+    // these messages and has committed when the promise resolves. Without
+    // them there is nothing to protect, and the group's lane leaves the
+    // identity's other groups running.
+    MLSIdentityClient *owner = [_clients clientForIdentity:userId];
+    BOOL transactional = _storageTuning.supported;
+    [self dispatchForClient:owner groupId:groupId barrier:transactional block:^{
+        MLSOperationTrace trace(_metrics.get(), "processMessages", MLSPayloadSize(groupId) + MLSPayloadSize(userId) + MLSPayloadSize(encryptedMessages));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
             return;
         }
-        
+    
         const char* groupIdStr = [groupId UTF8String];
         const char* userIdStr = [userId UTF8String];
+    
+        NSMutableArray* results = [NSMutableArray arrayWithCapacity:[encryptedMessages count]];
+
+        // The whole batch shares one storage transaction
+        uint64_t batchGeneration = 0;
+        if (transactional) {
+            [_storageTuning beginBatchForIdentity:userId generation:&batchGeneration];
+        }
+    
+        for (id encryptedMessage in encryptedMessages) {
+            NSData* encryptedData = nil;
+            if ([encryptedMessage isKindOfClass:[NSString class]]) {
+                encryptedData = [[NSData alloc] initWithBase64EncodedString:encryptedMessage options:0];
+            }
         
-        unsigned long epoch = mls_get_current_epoch(self.mlsClient, groupIdStr, userIdStr);
+            if (encryptedData == nil) {
+                [results addObject:MLSBatchFailure(@{ @"type": @"error", @"error": @"Invalid encrypted message format" },
+                                                   MLSBridgeError(MLSErrorCodeInvalidInput))];
+                continue;
+            }
         
-        resolver(@(epoch));
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
-    }
+            NSError* error = nil;
+            trace.enterPhase(MLSOperationPhase::FFI);
+            NSDictionary* resultDict = [self processMessageBytes:encryptedData groupId:groupIdStr userId:userIdStr
+                                                               client:owner.client checkDuplicates:YES error:&error];
+            trace.enterPhase(MLSOperationPhase::Marshal);
+            [results addObject:resultDict ?: MLSBatchFailure(@{ @"type": @"error", @"error": @"Failed to process message" }, error)];
+        }
+
+        if (transactional) {
+            trace.enterPhase(MLSOperationPhase::FFI);
+            [_storageTuning endBatchForIdentity:userId];
+            trace.enterPhase(MLSOperationPhase::Marshal);
+        }
+    
+        resolver(trace.succeed(results));
+    }];
 }
 
-// Process an MLS message
-RCT_EXPORT_METHOD(processMessage:(NSString *)groupId
+// processMessage with the result as one base64 compact record, see
+// MLSCompactResult.h. Content and sender stay bytes; a commit's roster
+// delta comes with MLSMembershipChanged.
+RCT_EXPORT_METHOD(processMessageCompact:(NSString *)groupId
                   userId:(NSString *)userId
                   encryptedMessage:(NSString *)encryptedMessage
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+    MLSIdentityClient *owner = [_clients clientForIdentity:userId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "processMessageCompact", MLSPayloadSize(groupId) + MLSPayloadSize(userId) + MLSPayloadSize(encryptedMessage));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
             return;
         }
-        
-        const char* groupIdStr = [groupId UTF8String];
-        const char* userIdStr = [userId UTF8String];
-        
-        // Convert the base64 string to bytes
-        NSData* messageData = [[NSData alloc] initWithBase64EncodedString:encryptedMessage options:0];
-        
-        if (messageData != nil) {
-            const uint8_t* messageBytes = (const uint8_t*)[messageData bytes];
-            int messageLen = (int)[messageData length];
-            
-            int out_type = 0;
-            uint8_t* out_content = NULL;
-            int out_content_len = 0;
-            uint8_t* out_sender = NULL;
-            int out_sender_len = 0;
-            int out_validated = 0;
-            
-            int result = mls_process_message(self.mlsClient, groupIdStr, userIdStr, messageBytes, messageLen,
-                                           &out_type, &out_content, &out_content_len, &out_sender, &out_sender_len, &out_validated);
-            
-            if (result == 0) {
-                NSMutableDictionary *resultDict = [NSMutableDictionary dictionary];
-                resultDict[@"messageType"] = @(out_type);
-                resultDict[@"validated"] = @(out_validated == 1);
-                
-                if (out_content && out_content_len > 0) {
-                    NSData *contentData = [NSData dataWithBytes:out_content length:out_content_len];
-                    NSString *contentBase64 = [contentData base64EncodedStringWithOptions:0];
-                    resultDict[@"content"] = contentBase64;
-                    mls_free_bytes(out_content);
-                }
-                
-                if (out_sender && out_sender_len > 0) {
-                    NSData *senderData = [NSData dataWithBytes:out_sender length:out_sender_len];
-                    NSString *senderBase64 = [senderData base64EncodedStringWithOptions:0];
-                    resultDict[@"sender"] = senderBase64;
-                    mls_free_bytes(out_sender);
-                }
-                
-                resolver(resultDict);
-            } else {
-                rejecter(@"E_MLS", @"Failed to process message", nil);
-            }
-        } else {
-            rejecter(@"E_MLS", @"Invalid message format", nil);
+
+        NSData* encryptedData = [[NSData alloc] initWithBase64EncodedString:encryptedMessage options:0];
+        if (encryptedData == nil) {
+            rejecter(@"process_message_error", @"Invalid encrypted message format", MLSBridgeError(MLSErrorCodeInvalidInput));
+            return;
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
-    }
+
+        NSError* error = nil;
+        MLSProcessedMessage message;
+        trace.enterPhase(MLSOperationPhase::FFI);
+        BOOL processed = [self processMessageBytes:encryptedData groupId:[groupId UTF8String] userId:[userId UTF8String]
+                                            client:owner.client checkDuplicates:YES message:message error:&error];
+        trace.enterPhase(MLSOperationPhase::Marshal);
+        if (!processed) {
+            rejecter(@"process_message_error", @"Failed to process message", error);
+            return;
+        }
+
+        NSMutableData* record = [NSMutableData dataWithCapacity:MLSCompactHeaderSize + message.sender.length + message.content.length];
+        MLSAppendCompactMessage(record, message);
+        resolver(trace.succeed([record base64EncodedStringWithOptions:0]));
+    }];
 }
 
-// Accept a proposal
-RCT_EXPORT_METHOD(acceptProposal:(NSString *)groupId
+// processMessages with the results as compact records back to back in one
+// base64 buffer. A failing message yields an error record.
+RCT_EXPORT_METHOD(processMessagesCompact:(NSString *)groupId
                   userId:(NSString *)userId
-                  message:(NSString *)message
+                  encryptedMessages:(NSArray *)encryptedMessages
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+    // With storage batches a barrier, so the batch's transaction holds only
+    // these messages and has committed when the promise resolves. Without
+    // them there is nothing to protect, and the group's lane leaves the
+    // identity's other groups running.
+    MLSIdentityClient *owner = [_clients clientForIdentity:userId];
+    BOOL transactional = _storageTuning.supported;
+    [self dispatchForClient:owner groupId:groupId barrier:transactional block:^{
+        MLSOperationTrace trace(_metrics.get(), "processMessagesCompact", MLSPayloadSize(groupId) + MLSPayloadSize(userId) + MLSPayloadSize(encryptedMessages));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
             return;
         }
-        
+
         const char* groupIdStr = [groupId UTF8String];
         const char* userIdStr = [userId UTF8String];
-        
-        // Convert the base64 string to bytes
-        NSData* messageData = [[NSData alloc] initWithBase64EncodedString:message options:0];
-        
-        if (messageData != nil) {
-            const uint8_t* messageBytes = (const uint8_t*)[messageData bytes];
-            int messageLen = (int)[messageData length];
-            
-            int result = mls_accept_proposal(self.mlsClient, groupIdStr, userIdStr, messageBytes, messageLen);
-            
-            if (result == 0) {
-                resolver(@(YES));
+        NSMutableData* records = [NSMutableData data];
+
+        // The whole batch shares one storage transaction
+        uint64_t batchGeneration = 0;
+        if (transactional) {
+            [_storageTuning beginBatchForIdentity:userId generation:&batchGeneration];
+        }
+
+        for (id encryptedMessage in encryptedMessages) {
+            NSData* encryptedData = nil;
+            if ([encryptedMessage isKindOfClass:[NSString class]]) {
+                encryptedData = [[NSData alloc] initWithBase64EncodedString:encryptedMessage options:0];
+            }
+            if (encryptedData == nil) {
+                MLSAppendCompactFailure(records, MLSBridgeError(MLSErrorCodeInvalidInput));
+                continue;
+            }
+
+            NSError* error = nil;
+            MLSProcessedMessage message;
+            trace.enterPhase(MLSOperationPhase::FFI);
+            BOOL processed = [self processMessageBytes:encryptedData groupId:groupIdStr userId:userIdStr
+                                                client:owner.client checkDuplicates:YES message:message error:&error];
+            trace.enterPhase(MLSOperationPhase::Marshal);
+            if (processed) {
+                MLSAppendCompactMessage(records, message);
             } else {
-                rejecter(@"E_MLS", @"Failed to accept proposal", nil);
+                MLSAppendCompactFailure(records, error);
             }
-        } else {
-            rejecter(@"E_MLS", @"Invalid message format", nil);
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
-    }
+
+        if (transactional) {
+            trace.enterPhase(MLSOperationPhase::FFI);
+            [_storageTuning endBatchForIdentity:userId];
+            trace.enterPhase(MLSOperationPhase::Marshal);
+        }
+
+        resolver(trace.succeed([records base64EncodedStringWithOptions:0]));
+    }];
 }
 
 // Create a proposal to add a member to a group
@@ -920,42 +3338,54 @@ RCT_EXPORT_METHOD(createAddProposal:(NSString *)groupId
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+    MLSIdentityClient *owner = [_clients clientForIdentity:senderId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "createAddProposal", MLSPayloadSize(groupId) + MLSPayloadSize(senderId) + MLSPayloadSize(keyPackage));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
             return;
         }
-        
+    
         const char* groupIdStr = [groupId UTF8String];
         const char* senderIdStr = [senderId UTF8String];
-        
-        // Convert the base64 string to bytes
+    
+        // Convert the key package to bytes
         NSData* keyPackageData = [[NSData alloc] initWithBase64EncodedString:keyPackage options:0];
-        
+    
         if (keyPackageData != nil) {
             const uint8_t* keyPackageBytes = (const uint8_t*)[keyPackageData bytes];
             int keyPackageLen = (int)[keyPackageData length];
+        
+            // Output parameter
+            int proposalLen = 0;
+        
+            // Call the Rust FFI function
+            trace.enterPhase(MLSOperationPhase::FFI);
+            uint8_t* proposalBytes = mls_create_add_proposal(
+                owner.client,
+                groupIdStr,
+                senderIdStr,
+                keyPackageBytes,
+                keyPackageLen,
+                &proposalLen
+            );
+            trace.enterPhase(MLSOperationPhase::Marshal);
+        
+            if (proposalBytes != NULL) {
+                // Convert the proposal bytes to a base64 string
+                NSData* proposalData = MLSDataFromRustBytes(proposalBytes, proposalLen);
+                NSString* proposalBase64 = [proposalData base64EncodedStringWithOptions:0];
             
-            int out_len = 0;
-            uint8_t* proposalBytes = mls_create_add_proposal(self.mlsClient, groupIdStr, senderIdStr, keyPackageBytes, keyPackageLen, &out_len);
-            
-            if (proposalBytes && out_len > 0) {
-                NSData *proposalData = [NSData dataWithBytes:proposalBytes length:out_len];
-                NSString *proposalBase64 = [proposalData base64EncodedStringWithOptions:0];
-                
-                // Free the bytes
-                mls_free_bytes(proposalBytes);
-                
-                resolver(proposalBase64);
+                [self groupStateDidChange:MLSGroupStateChangeProposal groupId:groupId userId:senderId client:owner.client];
+                resolver(trace.succeed(proposalBase64));
             } else {
-                rejecter(@"E_MLS", @"Failed to create add proposal", nil);
+                rejecter(@"create_add_proposal_error", @"Failed to create add proposal", MLSTakeLastFFIError());
             }
         } else {
-            rejecter(@"E_MLS", @"Invalid key package format", nil);
+            rejecter(@"create_add_proposal_error", @"Invalid key package format", MLSBridgeError(MLSErrorCodeInvalidInput));
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
-    }
+    }];
 }
 
 // Create a proposal to remove a member from a group
@@ -965,81 +3395,99 @@ RCT_EXPORT_METHOD(createRemoveProposal:(NSString *)groupId
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+    MLSIdentityClient *owner = [_clients clientForIdentity:creatorId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "createRemoveProposal", MLSPayloadSize(groupId) + MLSPayloadSize(creatorId));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
             return;
         }
-        
+    
         const char* groupIdStr = [groupId UTF8String];
         const char* creatorIdStr = [creatorId UTF8String];
-        
-        int out_len = 0;
-        uint8_t* proposalBytes = mls_create_remove_proposal(self.mlsClient, groupIdStr, creatorIdStr, (unsigned int)memberIndex, &out_len);
-        
-        if (proposalBytes && out_len > 0) {
-            NSData *proposalData = [NSData dataWithBytes:proposalBytes length:out_len];
-            NSString *proposalBase64 = [proposalData base64EncodedStringWithOptions:0];
-            
-            // Free the bytes
-            mls_free_bytes(proposalBytes);
-            
-            resolver(proposalBase64);
+    
+        // Output parameter
+        int proposalLen = 0;
+    
+        // Call the Rust FFI function
+        trace.enterPhase(MLSOperationPhase::FFI);
+        uint8_t* proposalBytes = mls_create_remove_proposal(
+            owner.client,
+            groupIdStr,
+            creatorIdStr,
+            (unsigned int)memberIndex,
+            &proposalLen
+        );
+        trace.enterPhase(MLSOperationPhase::Marshal);
+    
+        if (proposalBytes != NULL) {
+            // Convert the proposal bytes to a base64 string
+            NSData* proposalData = MLSDataFromRustBytes(proposalBytes, proposalLen);
+            NSString* proposalBase64 = [proposalData base64EncodedStringWithOptions:0];
+        
+            [self groupStateDidChange:MLSGroupStateChangeProposal groupId:groupId userId:creatorId client:owner.client];
+            resolver(trace.succeed(proposalBase64));
         } else {
-            rejecter(@"E_MLS", @"Failed to create remove proposal", nil);
+            rejecter(@"create_remove_proposal_error", @"Failed to create remove proposal", MLSTakeLastFFIError());
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
-    }
+    }];
 }
 
-// Update the key for the current member in an MLS group
+// Update the key for the current member in an MLS group (renamed from rotateKey)
 RCT_EXPORT_METHOD(selfUpdate:(NSString *)groupId
                   memberId:(NSString *)memberId
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
-            return;
-        }
+    MLSIdentityClient *owner = [_clients clientForIdentity:memberId];
+    [_backgroundWork scheduleOn:owner.scheduler key:groupId work:^{
+        MLSOperationTrace trace(_metrics.get(), "selfUpdate", MLSPayloadSize(groupId) + MLSPayloadSize(memberId));
+
+        @try {
+            if (!owner.client) {
+                rejecter(@"E_MLS", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
+                return;
+            }
         
-        const char* groupIdStr = [groupId UTF8String];
-        const char* memberIdStr = [memberId UTF8String];
+            const char* groupIdStr = [groupId UTF8String];
+            const char* memberIdStr = [memberId UTF8String];
         
-        int out_len = 0;
-        uint8_t* out_welcome = NULL;
-        int out_welcome_len = 0;
+            int commitLen = 0;
+            uint8_t* welcomeBytes = NULL;
+            int welcomeLen = 0;
         
-        uint8_t* updateBytes = mls_self_update(self.mlsClient, groupIdStr, memberIdStr, &out_len, &out_welcome, &out_welcome_len);
+            trace.enterPhase(MLSOperationPhase::FFI);
+            uint8_t* commitBytes = mls_self_update(owner.client, groupIdStr, memberIdStr, &commitLen, &welcomeBytes, &welcomeLen);
+            trace.enterPhase(MLSOperationPhase::Marshal);
         
-        if (updateBytes && out_len > 0) {
-            NSMutableDictionary *result = [NSMutableDictionary dictionary];
+            if (commitBytes != NULL) {
+                [_keyRotations groupDidRotate:groupId userId:memberId merged:NO];
+                // Hand the raw buffers to the mesh outbox before encoding them for JS
+                NSData* commitData = MLSDataFromRustBytes(commitBytes, commitLen);
+                NSData* welcomeData = welcomeBytes != NULL ? MLSDataFromRustBytes(welcomeBytes, welcomeLen) : nil;
+                [self handOffCommit:commitData welcome:welcomeData groupId:groupId senderId:memberId];
             
-            // Add update data
-            NSData *updateData = [NSData dataWithBytes:updateBytes length:out_len];
-            NSString *updateBase64 = [updateData base64EncodedStringWithOptions:0];
-            result[@"update"] = updateBase64;
+                NSString* commitBase64 = [commitData base64EncodedStringWithOptions:0];
+                NSString* welcomeBase64 = [welcomeData base64EncodedStringWithOptions:0];
             
-            // Add welcome message if present
-            if (out_welcome && out_welcome_len > 0) {
-                NSData *welcomeData = [NSData dataWithBytes:out_welcome length:out_welcome_len];
-                NSString *welcomeBase64 = [welcomeData base64EncodedStringWithOptions:0];
-                result[@"welcome"] = welcomeBase64;
-                mls_free_bytes(out_welcome);
-            }
-            
-            // Free the update bytes
-            mls_free_bytes(updateBytes);
+                // Create the result object
+                NSDictionary* result = @{
+                    @"commit": commitBase64,
+                    @"welcome": welcomeBase64 ?: [NSNull null]
+                };
             
-            resolver(result);
-        } else {
-            rejecter(@"E_MLS", @"Failed to perform self update", nil);
+                trace.enterPhase(MLSOperationPhase::FFI);
+                [self groupStateDidChange:MLSGroupStateChangeNewEpoch groupId:groupId userId:memberId client:owner.client];
+                trace.enterPhase(MLSOperationPhase::Marshal);
+                resolver(trace.succeed(result));
+            } else {
+                rejecter(@"E_MLS", @"Failed to update key for member", MLSTakeLastFFIError());
+            }
+        } @catch (NSException *exception) {
+            rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
-    }
+    } cancelled:MLSCancelledRejection(rejecter)];
 }
 
 // Remove self from an MLS group
@@ -1048,32 +3496,42 @@ RCT_EXPORT_METHOD(selfRemove:(NSString *)groupId
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+    MLSIdentityClient *owner = [_clients clientForIdentity:memberId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "selfRemove", MLSPayloadSize(groupId) + MLSPayloadSize(memberId));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
             return;
         }
-        
+    
         const char* groupIdStr = [groupId UTF8String];
         const char* memberIdStr = [memberId UTF8String];
-        
-        int out_len = 0;
-        uint8_t* removeBytes = mls_self_remove(self.mlsClient, groupIdStr, memberIdStr, &out_len);
-        
-        if (removeBytes && out_len > 0) {
-            NSData *removeData = [NSData dataWithBytes:removeBytes length:out_len];
-            NSString *removeBase64 = [removeData base64EncodedStringWithOptions:0];
-            
-            // Free the bytes
-            mls_free_bytes(removeBytes);
-            
-            resolver(removeBase64);
+    
+        // Output parameter
+        int proposalLen = 0;
+    
+        // Call the Rust FFI function
+        trace.enterPhase(MLSOperationPhase::FFI);
+        uint8_t* proposalBytes = mls_self_remove(
+            owner.client,
+            groupIdStr,
+            memberIdStr,
+            &proposalLen
+        );
+        trace.enterPhase(MLSOperationPhase::Marshal);
+    
+        if (proposalBytes != NULL) {
+            // Convert the proposal bytes to a base64 string
+            NSData* proposalData = MLSDataFromRustBytes(proposalBytes, proposalLen);
+            NSString* proposalBase64 = [proposalData base64EncodedStringWithOptions:0];
+        
+            [self groupStateDidChange:MLSGroupStateChangeProposal groupId:groupId userId:memberId client:owner.client];
+            resolver(trace.succeed(proposalBase64));
         } else {
-            rejecter(@"E_MLS", @"Failed to perform self remove", nil);
+            rejecter(@"self_remove_error", @"Failed to create self-remove proposal", MLSTakeLastFFIError());
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
-    }
+    }];
 }
 
 // Create an application message for an MLS group
@@ -1083,77 +3541,453 @@ RCT_EXPORT_METHOD(createApplicationMessage:(NSString *)groupId
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+    MLSIdentityClient *owner = [_clients clientForIdentity:userId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "createApplicationMessage", MLSPayloadSize(groupId) + MLSPayloadSize(userId) + MLSPayloadSize(message));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
             return;
         }
-        
+    
         const char* groupIdStr = [groupId UTF8String];
         const char* userIdStr = [userId UTF8String];
-        
+    
         // Convert the message to bytes
         NSData* messageData = [message dataUsingEncoding:NSUTF8StringEncoding];
         const uint8_t* messageBytes = (const uint8_t*)[messageData bytes];
         int messageLen = (int)[messageData length];
+    
+        // Output parameter
+        int encryptedLen = 0;
+    
+        // Call the Rust FFI function
+        trace.enterPhase(MLSOperationPhase::FFI);
+        uint8_t* encryptedBytes = MLSCreateApplicationMessage(
+            _groupHandles.get(),
+            owner.client,
+            groupIdStr,
+            userIdStr,
+            messageBytes,
+            messageLen,
+            &encryptedLen
+        );
+        trace.enterPhase(MLSOperationPhase::Marshal);
+    
+        if (encryptedBytes != NULL) {
+            [self groupWasUsed:groupId userId:userId decrypted:NO];
+
+            // Convert the encrypted bytes to a base64 string
+            NSData* encryptedData = MLSDataFromRustBytes(encryptedBytes, encryptedLen);
+            NSString* encryptedBase64 = [encryptedData base64EncodedStringWithOptions:0];
         
-        int out_len = 0;
-        uint8_t* appMessageBytes = mls_create_application_message(self.mlsClient, groupIdStr, userIdStr, messageBytes, messageLen, &out_len);
-        
-        if (appMessageBytes && out_len > 0) {
-            NSData *appMessageData = [NSData dataWithBytes:appMessageBytes length:out_len];
-            NSString *appMessageBase64 = [appMessageData base64EncodedStringWithOptions:0];
-            
-            // Free the bytes
-            mls_free_bytes(appMessageBytes);
-            
-            resolver(appMessageBase64);
+            resolver(trace.succeed(encryptedBase64));
         } else {
-            rejecter(@"E_MLS", @"Failed to create application message", nil);
+            rejecter(@"create_application_message_error", @"Failed to create application message", MLSTakeLastFFIError());
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
-    }
+    }];
 }
 
-// Get group members
-RCT_EXPORT_METHOD(groupMembers:(NSString *)groupId
+// Create application messages for a batch of plaintexts in one bridge call.
+// Plaintexts are encrypted in order so the sender ratchet advances exactly
+// as it would for individual calls.
+RCT_EXPORT_METHOD(createApplicationMessages:(NSString *)groupId
                   userId:(NSString *)userId
+                  messages:(NSArray *)messages
                   resolver:(RCTPromiseResolveBlock)resolver
                   rejecter:(RCTPromiseRejectBlock)rejecter)
 {
-    @try {
-        if (!self.mlsClient) {
-            rejecter(@"E_MLS", @"MLS client not initialized", nil);
+    MLSIdentityClient *owner = [_clients clientForIdentity:userId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "createApplicationMessages", MLSPayloadSize(groupId) + MLSPayloadSize(userId) + MLSPayloadSize(messages));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
             return;
         }
-        
+    
         const char* groupIdStr = [groupId UTF8String];
         const char* userIdStr = [userId UTF8String];
+    
+        NSMutableArray* encryptedMessages = [NSMutableArray arrayWithCapacity:[messages count]];
+        BOOL encrypted = NO;
+    
+        for (id message in messages) {
+            // Keep positions aligned with the input so callers can retry individual items
+            if (![message isKindOfClass:[NSString class]]) {
+                [encryptedMessages addObject:[NSNull null]];
+                continue;
+            }
+
+            // The same bytes as createApplicationMessage, embedded U+0000 included
+            NSData* messageData = [(NSString *)message dataUsingEncoding:NSUTF8StringEncoding];
+            const uint8_t* messageBytes = (const uint8_t*)[messageData bytes];
+            int messageLen = (int)[messageData length];
+        
+            int encryptedLen = 0;
+            trace.enterPhase(MLSOperationPhase::FFI);
+            uint8_t* encryptedBytes = MLSCreateApplicationMessage(
+                _groupHandles.get(),
+                owner.client,
+                groupIdStr,
+                userIdStr,
+                messageBytes,
+                messageLen,
+                &encryptedLen
+            );
+            trace.enterPhase(MLSOperationPhase::Marshal);
+        
+            if (encryptedBytes != NULL) {
+                NSData* encryptedData = MLSDataFromRustBytes(encryptedBytes, encryptedLen);
+                [encryptedMessages addObject:[encryptedData base64EncodedStringWithOptions:0]];
+                encrypted = YES;
+            } else {
+                [encryptedMessages addObject:[NSNull null]];
+            }
+        }
+        // Like createApplicationMessage, only a group that produced a message counts as used
+        if (encrypted) {
+            [self groupWasUsed:groupId userId:userId decrypted:NO];
+        }
+    
+        resolver(trace.succeed(encryptedMessages));
+    }];
+}
+
+// Accept an MLS proposal message
+RCT_EXPORT_METHOD(acceptProposal:(NSString *)groupId
+                  userId:(NSString *)userId
+                  message:(NSString *)message
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    MLSIdentityClient *owner = [_clients clientForIdentity:userId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "acceptProposal", MLSPayloadSize(groupId) + MLSPayloadSize(userId) + MLSPayloadSize(message));
+
+        @try {
+            if (!owner.client) {
+                rejecter(@"E_MLS", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
+                return;
+            }
         
-        int out_len = 0;
-        char** members = mls_group_members(self.mlsClient, groupIdStr, userIdStr, &out_len);
+            const char* groupIdStr = [groupId UTF8String];
+            const char* userIdStr = [userId UTF8String];
         
-        if (members && out_len > 0) {
-            NSMutableArray *memberArray = [NSMutableArray arrayWithCapacity:out_len];
-            
-            for (int i = 0; i < out_len; i++) {
-                if (members[i]) {
-                    NSString *memberString = [NSString stringWithUTF8String:members[i]];
-                    [memberArray addObject:memberString];
-                }
+            // Decode the base64 message to bytes
+            NSData* messageData = [[NSData alloc] initWithBase64EncodedString:message options:0];
+            if (!messageData) {
+                rejecter(@"E_MLS", @"Failed to decode base64 message", MLSBridgeError(MLSErrorCodeInvalidInput));
+                return;
             }
-            
-            // Free the string array
-            mls_free_string_array(members, out_len);
-            
-            resolver(memberArray);
-        } else {
-            rejecter(@"E_MLS", @"Failed to get group members", nil);
+        
+            const uint8_t* messageBytes = (const uint8_t*)[messageData bytes];
+            int messageLen = (int)[messageData length];
+        
+            // Call the Rust FFI function
+            trace.enterPhase(MLSOperationPhase::FFI);
+            int result = mls_accept_proposal(
+                owner.client,
+                groupIdStr,
+                userIdStr,
+                messageBytes,
+                messageLen
+            );
+            trace.enterPhase(MLSOperationPhase::Marshal);
+        
+            if (result == MLSFFIStatusOK) {
+                [self groupStateDidChange:MLSGroupStateChangeProposal groupId:groupId userId:userId client:owner.client];
+                resolver(trace.succeed(@YES));
+            } else {
+                rejecter(@"E_MLS", @"Failed to accept proposal", MLSTakeLastFFIError());
+            }
+        } @catch (NSException *exception) {
+            rejecter(@"E_MLS", exception.reason, MLSBridgeError(MLSErrorCodeInternal));
         }
-    } @catch (NSException *exception) {
-        rejecter(@"E_MLS", exception.reason, nil);
+    }];
+}
+
+// Current member list straight from the FFI, or nil if it has none
+- (NSArray<NSString *> *)fetchGroupMembers:(NSString *)groupId userId:(NSString *)userId client:(void *)client
+{
+    int count = 0;
+    char** members = mls_group_members(client, [groupId UTF8String], [userId UTF8String], &count);
+    if (members == NULL || count <= 0) {
+        return nil;
+    }
+
+    NSMutableArray* membersArray = [NSMutableArray arrayWithCapacity:count];
+    for (int i = 0; i < count; i++) {
+        if (members[i] != NULL) {
+            [membersArray addObject:[NSString stringWithUTF8String:members[i]]];
+        }
+    }
+    mls_free_string_array(members, count);
+    return membersArray;
+}
+
+// Load a roster from the FFI the first time it is used. Returns NO if the
+// group has no member list for this user. Call on the group's lane.
+- (BOOL)trackMemberRoster:(NSString *)groupId userId:(NSString *)userId client:(void *)client
+{
+    if ([_memberRoster isTrackingGroup:groupId userId:userId]) {
+        return YES;
+    }
+    NSArray<NSString *> *members = [self fetchGroupMembers:groupId userId:userId client:client];
+    if (members == nil) {
+        return NO;
+    }
+    [_memberRoster updateMembers:members ofGroup:groupId userId:userId];
+    return YES;
+}
+
+- (NSDictionary *)refreshMemberRoster:(NSString *)groupId userId:(NSString *)userId client:(void *)client
+{
+    // Untracked rosters are loaded lazily, so commits cost nothing extra for
+    // them. A tracked one is fetched in full: the FFI does not say which
+    // members a commit added or removed, only who is left.
+    if (![_memberRoster isTrackingGroup:groupId userId:userId]) {
+        return nil;
+    }
+    NSArray<NSString *> *members = [self fetchGroupMembers:groupId userId:userId client:client];
+    return members ? [_memberRoster updateMembers:members ofGroup:groupId userId:userId] : nil;
+}
+
+- (NSDictionary *)groupStateDidChange:(MLSGroupStateChange)change
+                              groupId:(NSString *)groupId
+                               userId:(NSString *)userId
+                               client:(void *)client
+{
+    BOOL observing = _hasListeners;
+
+    if (change == MLSGroupStateChangeProposal) {
+        [_proposalAggregator proposalAddedToGroup:groupId userId:userId];
+        if (observing) {
+            NSUInteger pending = [_groupStates addPendingProposalForGroup:groupId userId:userId];
+            [self sendEventWithName:MLSPendingProposalsChangedEvent
+                               body:@{ @"groupId": groupId, @"userId": userId, @"pendingProposals": @(pending) }];
+        }
+        return nil;
+    }
+
+    // Exporter secrets are per epoch, and the new one consumed every pending proposal
+    _exporterSecrets->invalidate([groupId UTF8String], [userId UTF8String]);
+    [_proposalAggregator groupDidCommit:groupId userId:userId];
+
+    // Listeners get membership events for every group, so start tracking its
+    // roster now; the first commit seen only establishes the baseline
+    NSDictionary *memberChanges = nil;
+    if (observing && ![_memberRoster isTrackingGroup:groupId userId:userId]) {
+        [self trackMemberRoster:groupId userId:userId client:client];
+    } else {
+        memberChanges = [self refreshMemberRoster:groupId userId:userId client:client];
+    }
+    if (!observing) {
+        [self replayDeferredMessages:groupId userId:userId client:client];
+        return memberChanges;
+    }
+
+    NSNumber *previousEpoch = nil;
+    uint64_t epoch = mls_get_current_epoch(client, [groupId UTF8String], [userId UTF8String]);
+    if ([_groupStates updateEpoch:epoch forGroup:groupId userId:userId previousEpoch:&previousEpoch]) {
+        [self sendEventWithName:MLSEpochChangedEvent
+                           body:@{ @"groupId": groupId, @"userId": userId, @"epoch": @(epoch),
+                                   @"previousEpoch": previousEpoch ?: [NSNull null] }];
+    }
+    if (memberChanges != nil) {
+        [self sendEventWithName:MLSMembershipChangedEvent
+                           body:@{ @"groupId": groupId, @"userId": userId, @"version": memberChanges[@"version"],
+                                   @"added": memberChanges[@"added"], @"removed": memberChanges[@"removed"] }];
+    }
+    // A new epoch consumes every proposal that was pending
+    if ([_groupStates clearPendingProposalsForGroup:groupId userId:userId]) {
+        [self sendEventWithName:MLSPendingProposalsChangedEvent
+                           body:@{ @"groupId": groupId, @"userId": userId, @"pendingProposals": @0 }];
+    }
+    [self replayDeferredMessages:groupId userId:userId client:client];
+    return memberChanges;
+}
+
+- (uint64_t)deferMessageBytes:(const uint8_t *)bytes
+                       length:(size_t)length
+                      groupId:(const char *)groupIdStr
+                       userId:(const char *)userIdStr
+                       client:(void *)client
+                        epoch:(uint64_t *)epoch
+{
+    MLSMessageHeader header;
+    if (!MLSReadMessageHeader(bytes, length, header)) {
+        return 0;
+    }
+    uint64_t currentEpoch = mls_get_current_epoch(client, groupIdStr, userIdStr);
+    if (header.epoch <= currentEpoch) {
+        return 0;
+    }
+    // Too early rather than corrupt, whether or not it can wait here
+    *epoch = header.epoch;
+
+    // Replayed messages are only reported through events
+    if (!_hasListeners) {
+        return 0;
+    }
+    std::vector<MLSDeferredMessage> dropped;
+    uint64_t ticket = _reorderBuffer->park(groupIdStr, userIdStr, header, currentEpoch, bytes, length, dropped);
+    [self reportDroppedMessages:dropped];
+    return ticket;
+}
+
+// Process the parked messages a new epoch has made readable, reporting each
+// result as an MLSDeferredMessage event. A replayed commit replays the next
+// epoch's messages in turn. Must run on the group's lane.
+- (void)replayDeferredMessages:(NSString *)groupId userId:(NSString *)userId client:(void *)client
+{
+    if (_reorderBuffer->empty()) {
+        return;
+    }
+
+    const char *groupIdStr = [groupId UTF8String];
+    const char *userIdStr = [userId UTF8String];
+    uint64_t epoch = mls_get_current_epoch(client, groupIdStr, userIdStr);
+    std::vector<MLSDeferredMessage> dropped;
+    std::vector<MLSDeferredMessage> ready = _reorderBuffer->takeReady(groupIdStr, userIdStr, epoch, dropped);
+    [self reportDroppedMessages:dropped];
+
+    for (MLSDeferredMessage &message : ready) {
+        NSData *encryptedData = [[NSData alloc] initWithBytesNoCopy:message.bytes.data()
+                                                             length:message.bytes.size()
+                                                       freeWhenDone:NO];
+        // Recorded by the filter when it was parked; forgotten if it fails, so a resend is retried
+        NSError *error = nil;
+        NSDictionary *result = [self processMessageBytes:encryptedData groupId:groupIdStr userId:userIdStr
+                                                  client:client checkDuplicates:NO error:&error];
+        if (result == nil) {
+            _ciphertextFilter->remove(MLSDigestCiphertext(groupIdStr, userIdStr, message.bytes.data(), message.bytes.size()));
+        }
+        if (_hasListeners) {
+            NSMutableDictionary *body = [@{ @"ticket": @(message.ticket), @"groupId": groupId, @"userId": userId,
+                                            @"epoch": @(message.header.epoch) } mutableCopy];
+            if (result != nil) {
+                body[@"result"] = result;
+            } else {
+                body[@"error"] = @"Failed to process message";
+                [body addEntriesFromDictionary:MLSErrorFields(error)];
+            }
+            [self sendEventWithName:MLSDeferredMessageEvent body:body];
+        }
+    }
+}
+
+// The duplicate filter recorded parked messages; forget the ones that will
+// not be replayed, so their resends are processed
+- (void)forgetDeferredMessages:(const std::vector<MLSDeferredMessage> &)messages
+{
+    for (const MLSDeferredMessage &message : messages) {
+        _ciphertextFilter->remove(MLSDigestCiphertext(message.groupId.c_str(), message.userId.c_str(),
+                                                      message.bytes.data(), message.bytes.size()));
+    }
+}
+
+// Tell JS about parked messages that will not be replayed, so it can ask
+// for them again
+- (void)reportDroppedMessages:(const std::vector<MLSDeferredMessage> &)dropped
+{
+    [self forgetDeferredMessages:dropped];
+    if (!_hasListeners) {
+        return;
     }
+    for (const MLSDeferredMessage &message : dropped) {
+        [self sendEventWithName:MLSDeferredMessageEvent
+                           body:@{ @"ticket": @(message.ticket), @"groupId": @(message.groupId.c_str()),
+                                   @"userId": @(message.userId.c_str()), @"epoch": @(message.header.epoch),
+                                   @"error": message.expired ? @"Expired before its epoch arrived" : @"Evicted from the reorder buffer" }];
+    }
+}
+
+// Get the members of a group. Served from the cached roster, which is
+// loaded on first use and refreshed by the commits this module handles.
+RCT_EXPORT_METHOD(groupMembers:(NSString *)groupId
+                   userId:(NSString *)userId
+                   resolver:(RCTPromiseResolveBlock)resolver
+                   rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    MLSIdentityClient *owner = [_clients clientForIdentity:userId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "groupMembers", MLSPayloadSize(groupId) + MLSPayloadSize(userId));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
+            return;
+        }
+    
+        trace.enterPhase(MLSOperationPhase::FFI);
+        BOOL tracked = [self trackMemberRoster:groupId userId:userId client:owner.client];
+        trace.enterPhase(MLSOperationPhase::Marshal);
+    
+        if (tracked) {
+            resolver(trace.succeed([_memberRoster membersOfGroup:groupId userId:userId]));
+        } else {
+            rejecter(@"group_members_error", @"Failed to get group members", MLSTakeLastFFIError());
+        }
+    }];
+}
+
+// Check whether an identity is a member of a group, in O(1) once the
+// group's roster is cached
+RCT_EXPORT_METHOD(isGroupMember:(NSString *)groupId
+                  userId:(NSString *)userId
+                  identity:(NSString *)identity
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    MLSIdentityClient *owner = [_clients clientForIdentity:userId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "isGroupMember", MLSPayloadSize(groupId) + MLSPayloadSize(userId) + MLSPayloadSize(identity));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
+            return;
+        }
+    
+        trace.enterPhase(MLSOperationPhase::FFI);
+        BOOL tracked = [self trackMemberRoster:groupId userId:userId client:owner.client];
+        trace.enterPhase(MLSOperationPhase::Marshal);
+    
+        if (tracked) {
+            resolver(trace.succeed(@([_memberRoster group:groupId userId:userId containsMember:identity])));
+        } else {
+            rejecter(@"group_members_error", @"Failed to get group members", MLSTakeLastFFIError());
+        }
+    }];
+}
+
+// Get the members added and removed since a roster version the caller
+// already has. Version 0 (or one that has aged out) returns the full roster.
+RCT_EXPORT_METHOD(groupMemberChanges:(NSString *)groupId
+                  userId:(NSString *)userId
+                  sinceVersion:(NSInteger)sinceVersion
+                  resolver:(RCTPromiseResolveBlock)resolver
+                  rejecter:(RCTPromiseRejectBlock)rejecter)
+{
+    MLSIdentityClient *owner = [_clients clientForIdentity:userId];
+    [owner.scheduler dispatchAsyncForKey:groupId block:^{
+        MLSOperationTrace trace(_metrics.get(), "groupMemberChanges", MLSPayloadSize(groupId) + MLSPayloadSize(userId));
+
+        if (!owner.client) {
+            rejecter(@"client_error", @"MLS client not initialized", MLSBridgeError(MLSErrorCodeClientNotInitialized));
+            return;
+        }
+    
+        trace.enterPhase(MLSOperationPhase::FFI);
+        BOOL tracked = [self trackMemberRoster:groupId userId:userId client:owner.client];
+        trace.enterPhase(MLSOperationPhase::Marshal);
+    
+        if (tracked) {
+            NSUInteger version = (NSUInteger)MAX(sinceVersion, (NSInteger)0);
+            resolver(trace.succeed([_memberRoster changesForGroup:groupId userId:userId sinceVersion:version]));
+        } else {
+            rejecter(@"group_members_error", @"Failed to get group members", MLSTakeLastFFIError());
+        }
+    }];
 }
 
 @end
\ No newline at end of file
@@ -0,0 +1,135 @@
+#import "MLSPlatform.h"
+#import <TargetConditionals.h>
+#import <mach/mach.h>
+#import "MLSFFI.h"
+
+#if !TARGET_OS_OSX
+#import <UIKit/UIKit.h>
+#import <os/proc.h>
+#endif
+
+#if TARGET_OS_OSX
+const int MLSFFIStatusOK = 0;
+#else
+const int MLSFFIStatusOK = 1;
+#endif
+
+BOOL MLSUnpackAddMembersResult(uint8_t *result, int *lengths, int count, MLSAddMembersOutput *output)
+{
+    *output = (MLSAddMembersOutput){NULL, 0, NULL, 0};
+#if TARGET_OS_OSX
+    // out_lens is not ours to free on this build
+    if (result == NULL || count < 1) {
+        if (result != NULL) {
+            mls_free_bytes(result);
+        }
+        return NO;
+    }
+    output->commit = result;
+    output->commitLength = lengths[0];
+    return YES;
+#else
+    BOOL succeeded = result != NULL && count >= 2;
+    if (succeeded) {
+        output->commit = ((uint8_t **)result)[0];
+        output->welcome = ((uint8_t **)result)[1];
+        output->commitLength = lengths[0];
+        output->welcomeLength = lengths[1];
+    }
+    if (result != NULL) {
+        free(result);
+    }
+    if (lengths != NULL) {
+        free(lengths);
+    }
+    return succeeded;
+#endif
+}
+
+void MLSFreeKeyPackageStrings(char **strings, int count, int *lengths)
+{
+#if TARGET_OS_OSX
+    if (strings != NULL) {
+        mls_free_string_array(strings, count);
+    }
+#else
+    if (strings != NULL) {
+        for (int i = 0; i < count; i++) {
+            if (strings[i] != NULL) {
+                mls_free_string(strings[i]);
+            }
+        }
+        mls_free_string_array(strings, count);
+    }
+    if (lengths != NULL) {
+        free(lengths);
+    }
+#endif
+}
+
+static NSURL *MLSStorageRoot(NSString *groupID, NSError **error)
+{
+#if TARGET_OS_OSX
+    NSURL *applicationSupport = [[NSFileManager defaultManager] URLsForDirectory:NSApplicationSupportDirectory
+                                                                       inDomains:NSUserDomainMask].firstObject;
+    if (!applicationSupport && error) {
+        *error = [NSError errorWithDomain:NSCocoaErrorDomain
+                                     code:NSFileNoSuchFileError
+                                 userInfo:@{ NSLocalizedDescriptionKey: @"Failed to get Application Support directory" }];
+    }
+    return applicationSupport;
+#else
+    NSURL *container = groupID.length > 0
+        ? [[NSFileManager defaultManager] containerURLForSecurityApplicationGroupIdentifier:groupID]
+        : nil;
+    return container ?: [NSURL fileURLWithPath:NSHomeDirectory()];
+#endif
+}
+
+NSString *MLSResolveStorageDirectory(NSString *groupID, NSError **error)
+{
+    NSURL *root = MLSStorageRoot(groupID, error);
+    if (!root) {
+        return nil;
+    }
+
+    NSURL *storageDir = [root URLByAppendingPathComponent:@"MLSStorage"];
+    if (![[NSFileManager defaultManager] createDirectoryAtURL:storageDir
+                                  withIntermediateDirectories:YES
+                                                   attributes:nil
+                                                        error:error]) {
+        return nil;
+    }
+    return storageDir.path;
+}
+
+NSNotificationName MLSMemoryWarningNotification(void)
+{
+#if TARGET_OS_OSX
+    return nil;
+#else
+    return UIApplicationDidReceiveMemoryWarningNotification;
+#endif
+}
+
+uint64_t MLSProcessFootprint(void)
+{
+    task_vm_info_data_t info;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    if (task_info(mach_task_self(), TASK_VM_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.phys_footprint;
+}
+
+uint64_t MLSAvailableMemory(void)
+{
+#if TARGET_OS_OSX
+    return 0;
+#else
+    if (@available(iOS 13.0, *)) {
+        return os_proc_available_memory();
+    }
+    return 0;
+#endif
+}
@@ -0,0 +1,303 @@
+#pragma once
+
+#ifdef __cplusplus
+
+#import <Foundation/Foundation.h>
+#include <dispatch/dispatch.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Largest block an idle arena keeps between operations
+static const size_t MLSScratchArenaRetainLimit = 256 * 1024;
+static const size_t MLSScratchArenaMinimumBlock = 4 * 1024;
+
+/**
+ * Bump allocator for the temporary argument vectors of one FFI call.
+ *
+ * Allocations are never freed individually; reset() releases them all at
+ * once. After an operation that needed more than one block, reset()
+ * replaces them with a single block of the combined size (up to the retain
+ * limit), so the next operation of the same shape allocates nothing.
+ *
+ * Not thread-safe: each scheduler lane owns one arena, see MLSScratchScope.
+ */
+class MLSScratchArena {
+public:
+    explicit MLSScratchArena(size_t retainLimit = MLSScratchArenaRetainLimit) : retainLimit_(retainLimit) {}
+
+    MLSScratchArena(const MLSScratchArena &) = delete;
+    MLSScratchArena &operator=(const MLSScratchArena &) = delete;
+
+    // Uninitialised storage for `count` values of a trivial type
+    template <typename T>
+    T *allocate(size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "arena memory is never destructed");
+        return static_cast<T *>(allocateBytes(sizeof(T) * count, alignof(T)));
+    }
+
+    void reset()
+    {
+        if (blocks_.size() > 1) {
+            size_t combined = 0;
+            for (const Block &block : blocks_) {
+                combined += block.size;
+            }
+            blocks_.clear();
+            addBlock(std::min(combined, retainLimit_));
+        } else if (!blocks_.empty() && blocks_.front().size > retainLimit_) {
+            blocks_.clear();
+        }
+        if (!blocks_.empty()) {
+            blocks_.front().used = 0;
+        }
+    }
+
+    // Drop every block, e.g. under memory pressure
+    void release() { blocks_.clear(); }
+
+    size_t capacity() const
+    {
+        size_t capacity = 0;
+        for (const Block &block : blocks_) {
+            capacity += block.size;
+        }
+        return capacity;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<uint8_t[]> bytes;
+        size_t size;
+        size_t used;
+    };
+
+    void *allocateBytes(size_t size, size_t alignment)
+    {
+        if (!blocks_.empty()) {
+            Block &block = blocks_.back();
+            size_t offset = (block.used + alignment - 1) & ~(alignment - 1);
+            if (offset + size <= block.size) {
+                block.used = offset + size;
+                return block.bytes.get() + offset;
+            }
+        }
+        // Blocks come from operator new[] and are suitably aligned for any
+        // trivial type, so a fresh block needs no padding
+        Block &block = addBlock(std::max(size, std::max(MLSScratchArenaMinimumBlock, capacity())));
+        block.used = size;
+        return block.bytes.get();
+    }
+
+    Block &addBlock(size_t size)
+    {
+        blocks_.push_back({std::unique_ptr<uint8_t[]>(new uint8_t[size]), size, 0});
+        return blocks_.back();
+    }
+
+    size_t retainLimit_;
+    std::vector<Block> blocks_;
+};
+
+// Key for the arena attached to a lane queue
+inline char MLSScratchArenaKey = 0;
+
+inline MLSScratchArena &MLSScratchArenaForQueue(dispatch_queue_t queue)
+{
+    void *arena = dispatch_queue_get_specific(queue, &MLSScratchArenaKey);
+    if (arena == nullptr) {
+        arena = new MLSScratchArena();
+        dispatch_queue_set_specific(queue, &MLSScratchArenaKey, arena, [](void *context) {
+            delete static_cast<MLSScratchArena *>(context);
+        });
+    }
+    return *static_cast<MLSScratchArena *>(arena);
+}
+
+/**
+ * The lane's arena for the duration of one operation. Must be created on
+ * the lane queue it names, so no other block uses the arena meanwhile.
+ */
+class MLSScratchScope {
+public:
+    explicit MLSScratchScope(dispatch_queue_t queue) : arena_(MLSScratchArenaForQueue(queue)) {}
+    ~MLSScratchScope() { arena_.reset(); }
+
+    MLSScratchScope(const MLSScratchScope &) = delete;
+    MLSScratchScope &operator=(const MLSScratchScope &) = delete;
+
+    MLSScratchArena &arena() { return arena_; }
+
+private:
+    MLSScratchArena &arena_;
+};
+
+/**
+ * Byte strings packed back to back into one arena buffer. Entry i spans
+ * bytes [offsets[i], offsets[i + 1]).
+ */
+struct MLSPackedBytes {
+    uint8_t *bytes = nullptr;
+    size_t *offsets = nullptr;
+    size_t count = 0;
+
+    const uint8_t *entry(size_t index) const { return bytes + offsets[index]; }
+    int length(size_t index) const { return (int)(offsets[index + 1] - offsets[index]); }
+
+    // Pointer and length arrays in the shape the FFI takes
+    void table(MLSScratchArena &arena, const uint8_t **&pointers, int *&lengths) const
+    {
+        pointers = arena.allocate<const uint8_t *>(count);
+        lengths = arena.allocate<int>(count);
+        for (size_t i = 0; i < count; i++) {
+            pointers[i] = entry(i);
+            lengths[i] = length(i);
+        }
+    }
+};
+
+inline int MLSBase64Value(uint8_t c)
+{
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A';
+    }
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a' + 26;
+    }
+    if (c >= '0' && c <= '9') {
+        return c - '0' + 52;
+    }
+    if (c == '+') {
+        return 62;
+    }
+    if (c == '/') {
+        return 63;
+    }
+    return -1;
+}
+
+/**
+ * Decode padded base64 in place. The output never overtakes the input, so
+ * the decoded bytes start at `text`. Returns the decoded length, or -1 on
+ * input NSData's initWithBase64EncodedString:options:0 would also reject.
+ */
+inline ptrdiff_t MLSBase64DecodeInPlace(uint8_t *text, size_t length)
+{
+    if (length % 4 != 0) {
+        return -1;
+    }
+    size_t written = 0;
+    for (size_t i = 0; i < length; i += 4) {
+        bool last = i + 4 == length;
+        int padding = 0;
+        if (last && text[i + 3] == '=') {
+            padding = text[i + 2] == '=' ? 2 : 1;
+        }
+
+        uint32_t quantum = 0;
+        for (int j = 0; j < 4; j++) {
+            int value = j < 4 - padding ? MLSBase64Value(text[i + j]) : 0;
+            if (value < 0) {
+                return -1;
+            }
+            quantum = (quantum << 6) | (uint32_t)value;
+        }
+
+        text[written++] = (uint8_t)(quantum >> 16);
+        if (padding < 2) {
+            text[written++] = (uint8_t)(quantum >> 8);
+        }
+        if (padding < 1) {
+            text[written++] = (uint8_t)quantum;
+        }
+    }
+    return (ptrdiff_t)written;
+}
+
+/**
+ * Decode base64 strings into one contiguous arena buffer. Each string is
+ * copied as ASCII to where its bytes belong and decoded there, so no
+ * per-entry NSData is created. Returns NO if an entry is not valid base64.
+ */
+inline BOOL MLSPackBase64Strings(MLSScratchArena &arena, NSArray *strings, MLSPackedBytes &packed)
+{
+    size_t capacity = 0;
+    for (id string in strings) {
+        if (![string isKindOfClass:[NSString class]]) {
+            return NO;
+        }
+        capacity += [(NSString *)string length];
+    }
+
+    packed.count = strings.count;
+    packed.bytes = arena.allocate<uint8_t>(capacity);
+    packed.offsets = arena.allocate<size_t>(packed.count + 1);
+
+    size_t offset = 0;
+    for (size_t i = 0; i < packed.count; i++) {
+        NSString *string = strings[i];
+        NSUInteger length = string.length;
+        packed.offsets[i] = offset;
+        if (length == 0) {
+            continue;
+        }
+
+        NSUInteger used = 0;
+        BOOL copied = [string getBytes:packed.bytes + offset
+                             maxLength:capacity - offset
+                            usedLength:&used
+                              encoding:NSASCIIStringEncoding
+                               options:0
+                                 range:NSMakeRange(0, length)
+                        remainingRange:NULL];
+        ptrdiff_t decoded = copied && used == length ? MLSBase64DecodeInPlace(packed.bytes + offset, used) : -1;
+        if (decoded < 0) {
+            return NO;
+        }
+        offset += (size_t)decoded;
+    }
+    packed.offsets[packed.count] = offset;
+    return YES;
+}
+
+/**
+ * Copy strings as NUL-terminated UTF-8 into one contiguous arena buffer and
+ * return a pointer table into it. Returns NULL if an entry is not a string.
+ */
+inline const char **MLSPackUTF8Strings(MLSScratchArena &arena, NSArray *strings)
+{
+    size_t capacity = 0;
+    for (id string in strings) {
+        if (![string isKindOfClass:[NSString class]]) {
+            return NULL;
+        }
+        capacity += [(NSString *)string lengthOfBytesUsingEncoding:NSUTF8StringEncoding] + 1;
+    }
+
+    char *bytes = arena.allocate<char>(capacity);
+    const char **pointers = arena.allocate<const char *>(strings.count);
+
+    size_t offset = 0;
+    for (NSUInteger i = 0; i < strings.count; i++) {
+        NSString *string = strings[i];
+        NSUInteger used = 0;
+        [string getBytes:bytes + offset
+               maxLength:capacity - offset - 1
+              usedLength:&used
+                encoding:NSUTF8StringEncoding
+                 options:0
+                   range:NSMakeRange(0, string.length)
+          remainingRange:NULL];
+        bytes[offset + used] = '\0';
+        pointers[i] = bytes + offset;
+        offset += used + 1;
+    }
+    return pointers;
+}
+
+#endif
@@ -0,0 +1,86 @@
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSInteger, MLSStorageSynchronous) {
+    MLSStorageSynchronousOff = 0,
+    MLSStorageSynchronousNormal = 1,
+    MLSStorageSynchronousFull = 2,
+};
+
+/**
+ * SQLite settings for the Rust storage provider, and batches that let a run
+ * of processMessage calls share one durable transaction per identity.
+ *
+ * The storage entry points are optional in the Rust library and resolved at
+ * runtime (see MLSFFI.h). Against a build that does not export them the
+ * settings are only recorded, batches still nest and report their depth, and
+ * every state change is persisted on its own as before; `supported` tells
+ * which case applies.
+ *
+ * Batches nest per identity. Only the outermost begin and end reach the
+ * storage layer, so the transaction commits when the last scope closes.
+ *
+ * Thread-safe; group lanes on the scheduler use it concurrently.
+ */
+@interface MLSStorageTuning : NSObject
+
+// Whether the linked Rust library exports the storage entry points
+@property (nonatomic, readonly) BOOL supported;
+
+@property (atomic, assign) BOOL journalModeWAL;
+@property (atomic, assign) MLSStorageSynchronous synchronous;
+
+// Page cache per connection, in KiB
+@property (atomic, assign) NSUInteger cacheSizeKiB;
+
+// Longest writes outside a batch wait to be made durable together. Zero
+// syncs every write.
+@property (atomic, assign) NSUInteger groupCommitIntervalMs;
+
+/**
+ * Hand the current settings to the storage layer. Connections opened
+ * afterwards use them. Returns NO if unsupported or Rust rejects them.
+ */
+- (BOOL)apply;
+
+/**
+ * Open a batch scope for an identity, starting its transaction if this is
+ * the outermost scope.
+ * @param generation Set to the id of the outermost batch, for expireBatchForIdentity:generation:
+ * @return The nesting depth after opening
+ */
+- (NSUInteger)beginBatchForIdentity:(NSString *)identity generation:(uint64_t *)generation;
+
+/**
+ * Close the innermost batch scope, committing the transaction when it was
+ * the outermost one.
+ * @return The remaining depth, or -1 if no batch was open
+ */
+- (NSInteger)endBatchForIdentity:(NSString *)identity;
+
+/**
+ * endBatchForIdentity:, but only while the batch `generation` is still open,
+ * for a scope that other work may have committed meanwhile
+ * @return The remaining depth, or -1 if that batch already ended
+ */
+- (NSInteger)endBatchForIdentity:(NSString *)identity generation:(uint64_t)generation;
+
+/**
+ * Close every scope of the batch `generation` if it is still open, e.g.
+ * after JS forgot to call endBatch. Returns NO if it already ended.
+ */
+- (BOOL)expireBatchForIdentity:(NSString *)identity generation:(uint64_t)generation;
+
+// Commit the identity's open batch, e.g. before its client is replaced
+- (void)endBatchesForIdentity:(NSString *)identity;
+
+// Commit every open batch
+- (void)endAllBatches;
+
+// {supported, journalMode, synchronous, cacheSizeKiB, groupCommitIntervalMs, openBatches: {identity: depth}, committedBatches, expiredBatches}
+- (NSDictionary *)statistics;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,237 @@
+#import "MLSWarmStart.h"
+#import <os/lock.h>
+
+// Kept in the storage directory, beside the per-identity databases
+static NSString *const MLSRecentGroupsFileName = @"recent-groups.plist";
+
+// Uses within this window are written back together
+static const int64_t MLSRecentGroupsWriteDelay = 2 * NSEC_PER_SEC;
+
+// Same layout as MLSGroupHandleKey: the group ID, a NUL, then the user ID
+static NSString *MLSRecentGroupKey(NSString *groupId, NSString *userId)
+{
+    return [NSString stringWithFormat:@"%@%C%@", groupId, (unichar)0, userId];
+}
+
+static NSNumber *MLSElapsedMs(NSTimeInterval since, NSTimeInterval until)
+{
+    return since > 0 && until > 0 ? @((until - since) * 1000.0) : nil;
+}
+
+@implementation MLSWarmStart
+{
+    NSUInteger _limit;
+    NSMutableOrderedSet<NSString *> *_keys;
+    NSMutableDictionary<NSString *, NSDictionary<NSString *, NSString *> *> *_entries;
+    NSString *_path;
+    BOOL _dirty;
+    BOOL _writeScheduled;
+    dispatch_queue_t _ioQueue;
+
+    BOOL _async;
+    NSTimeInterval _startedAt;
+    NSTimeInterval _clientReadyAt;
+    NSTimeInterval _warmedAt;
+    NSTimeInterval _firstDecryptAt;
+    NSUInteger _warmedGroups;
+
+    os_unfair_lock _lock;
+}
+
+- (instancetype)initWithLimit:(NSUInteger)limit
+{
+    if (self = [super init]) {
+        _limit = limit > 0 ? limit : 1;
+        _keys = [NSMutableOrderedSet orderedSet];
+        _entries = [NSMutableDictionary dictionary];
+        _ioQueue = dispatch_queue_create("com.reactnativemls.MLSQueue.recentGroups",
+                                         dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+        _lock = OS_UNFAIR_LOCK_INIT;
+    }
+    return self;
+}
+
+- (void)loadFromDirectory:(NSString *)directory
+{
+    [self flush];
+
+    NSString *path = [directory stringByAppendingPathComponent:MLSRecentGroupsFileName];
+    NSArray *stored = nil;
+    NSData *data = [NSData dataWithContentsOfFile:path];
+    if (data != nil) {
+        id list = [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:NULL error:NULL];
+        stored = [list isKindOfClass:[NSArray class]] ? list : nil;
+    }
+
+    NSMutableOrderedSet<NSString *> *keys = [NSMutableOrderedSet orderedSet];
+    NSMutableDictionary<NSString *, NSDictionary<NSString *, NSString *> *> *entries = [NSMutableDictionary dictionary];
+    for (id item in stored) {
+        NSDictionary *entry = [item isKindOfClass:[NSDictionary class]] ? item : nil;
+        NSString *groupId = [entry[@"groupId"] isKindOfClass:[NSString class]] ? entry[@"groupId"] : nil;
+        NSString *userId = [entry[@"userId"] isKindOfClass:[NSString class]] ? entry[@"userId"] : nil;
+        if (groupId == nil || userId == nil || keys.count == _limit) {
+            continue;
+        }
+        NSString *key = MLSRecentGroupKey(groupId, userId);
+        if (![keys containsObject:key]) {
+            [keys addObject:key];
+            entries[key] = @{ @"groupId": groupId, @"userId": userId };
+        }
+    }
+
+    os_unfair_lock_lock(&_lock);
+    _path = path;
+    _keys = keys;
+    _entries = entries;
+    _dirty = NO;
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)groupWasUsed:(NSString *)groupId userId:(NSString *)userId
+{
+    NSString *key = MLSRecentGroupKey(groupId, userId);
+
+    os_unfair_lock_lock(&_lock);
+    // The common case: the same group again
+    if ([_keys.firstObject isEqualToString:key]) {
+        os_unfair_lock_unlock(&_lock);
+        return;
+    }
+    if ([_keys containsObject:key]) {
+        [_keys removeObject:key];
+    } else {
+        _entries[key] = @{ @"groupId": groupId, @"userId": userId };
+    }
+    [_keys insertObject:key atIndex:0];
+    while (_keys.count > _limit) {
+        [_entries removeObjectForKey:_keys.lastObject];
+        [_keys removeObjectAtIndex:_keys.count - 1];
+    }
+    [self scheduleWrite];
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)forgetGroup:(NSString *)groupId userId:(NSString *)userId
+{
+    NSString *key = MLSRecentGroupKey(groupId, userId);
+
+    os_unfair_lock_lock(&_lock);
+    if ([_keys containsObject:key]) {
+        [_keys removeObject:key];
+        [_entries removeObjectForKey:key];
+        [self scheduleWrite];
+    }
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (NSArray<NSDictionary<NSString *, NSString *> *> *)recentGroups
+{
+    os_unfair_lock_lock(&_lock);
+    NSMutableArray<NSDictionary<NSString *, NSString *> *> *groups = [NSMutableArray arrayWithCapacity:_keys.count];
+    for (NSString *key in _keys) {
+        [groups addObject:_entries[key]];
+    }
+    os_unfair_lock_unlock(&_lock);
+    return groups;
+}
+
+- (void)flush
+{
+    dispatch_sync(_ioQueue, ^{
+        [self writeIfDirty];
+    });
+}
+
+// Caller holds _lock
+- (void)scheduleWrite
+{
+    _dirty = YES;
+    if (_writeScheduled) {
+        return;
+    }
+    _writeScheduled = YES;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, MLSRecentGroupsWriteDelay), _ioQueue, ^{
+        os_unfair_lock_lock(&self->_lock);
+        self->_writeScheduled = NO;
+        os_unfair_lock_unlock(&self->_lock);
+        [self writeIfDirty];
+    });
+}
+
+// Runs on _ioQueue, so writes land in order
+- (void)writeIfDirty
+{
+    os_unfair_lock_lock(&_lock);
+    NSString *path = _path;
+    if (!_dirty || path == nil) {
+        os_unfair_lock_unlock(&_lock);
+        return;
+    }
+    NSMutableArray *list = [NSMutableArray arrayWithCapacity:_keys.count];
+    for (NSString *key in _keys) {
+        [list addObject:_entries[key]];
+    }
+    _dirty = NO;
+    os_unfair_lock_unlock(&_lock);
+
+    NSData *data = [NSPropertyListSerialization dataWithPropertyList:list
+                                                              format:NSPropertyListBinaryFormat_v1_0
+                                                             options:0
+                                                               error:NULL];
+    [data writeToFile:path atomically:YES];
+}
+
+- (void)beginStartup:(BOOL)async
+{
+    os_unfair_lock_lock(&_lock);
+    _async = async;
+    _startedAt = NSProcessInfo.processInfo.systemUptime;
+    _clientReadyAt = 0;
+    _warmedAt = 0;
+    _firstDecryptAt = 0;
+    _warmedGroups = 0;
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)clientDidStart
+{
+    NSTimeInterval now = NSProcessInfo.processInfo.systemUptime;
+    os_unfair_lock_lock(&_lock);
+    _clientReadyAt = now;
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)warmingDidFinish:(NSUInteger)warmedGroups
+{
+    NSTimeInterval now = NSProcessInfo.processInfo.systemUptime;
+    os_unfair_lock_lock(&_lock);
+    _warmedAt = now;
+    _warmedGroups = warmedGroups;
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (void)messageWasDecrypted
+{
+    os_unfair_lock_lock(&_lock);
+    if (_firstDecryptAt == 0 && _startedAt > 0) {
+        _firstDecryptAt = NSProcessInfo.processInfo.systemUptime;
+    }
+    os_unfair_lock_unlock(&_lock);
+}
+
+- (NSDictionary *)statistics
+{
+    os_unfair_lock_lock(&_lock);
+    NSDictionary *statistics = @{
+        @"mode": _startedAt == 0 ? @"none" : (_async ? @"async" : @"sync"),
+        @"clientReadyMs": MLSElapsedMs(_startedAt, _clientReadyAt) ?: [NSNull null],
+        @"warmedGroups": @(_warmedGroups),
+        @"warmMs": MLSElapsedMs(_startedAt, _warmedAt) ?: [NSNull null],
+        @"firstDecryptMs": MLSElapsedMs(_startedAt, _firstDecryptAt) ?: [NSNull null],
+        @"recentGroups": @(_keys.count),
+    };
+    os_unfair_lock_unlock(&_lock);
+    return statistics;
+}
+
+@end
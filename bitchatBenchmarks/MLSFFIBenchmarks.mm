@@ -0,0 +1,611 @@
+//
+// MLSFFIBenchmarks.mm
+// bitchatBenchmarks
+//
+// This is free and unencumbered software released into the public domain.
+// For more information, see <https://unlicense.org>
+//
+
+#import <XCTest/XCTest.h>
+
+#include <mach/mach_time.h>
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "MLSFFI.h"
+#include "MLSPlatform.h"
+
+// Benchmarks for the mls_* entry points of libreact_native_mls_rust across
+// group and message sizes. Every operation is measured twice: "ffi" times
+// the raw call, "bridge" adds the same UTF-8 / NSData / base64 marshalling
+// MLSModule performs around it. Results are logged as a table and attached
+// to the test run as JSON so runs against different XCFramework builds can
+// be compared.
+//
+// Group sizes default to 2, 10, 100 and 1000 members; set
+// MLS_BENCH_GROUP_SIZES (e.g. "2,10") to run a quicker subset.
+
+namespace {
+
+struct BenchmarkStats {
+    size_t iterations;
+    double meanMicros;
+    double p50Micros;
+    double p95Micros;
+    double minMicros;
+};
+
+double microsSince(uint64_t start)
+{
+    static mach_timebase_info_data_t timebase = {0, 0};
+    if (timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+    uint64_t elapsed = mach_absolute_time() - start;
+    return (double)elapsed * timebase.numer / timebase.denom / 1000.0;
+}
+
+// Runs `setup` untimed before each timed `body`, after one warm-up round
+BenchmarkStats runBenchmark(size_t iterations, const std::function<void()> &setup, const std::function<void()> &body)
+{
+    setup();
+    body();
+
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    for (size_t i = 0; i < iterations; i++) {
+        setup();
+        uint64_t start = mach_absolute_time();
+        body();
+        samples.push_back(microsSince(start));
+    }
+
+    std::sort(samples.begin(), samples.end());
+    double total = 0;
+    for (double sample : samples) {
+        total += sample;
+    }
+    return {
+        iterations,
+        total / samples.size(),
+        samples[samples.size() / 2],
+        samples[std::min(samples.size() - 1, (size_t)(samples.size() * 0.95))],
+        samples.front(),
+    };
+}
+
+// Fewer rounds for large groups, where a single commit can take seconds
+size_t iterationsForGroupSize(NSUInteger groupSize)
+{
+    if (groupSize >= 500) {
+        return 3;
+    }
+    if (groupSize >= 100) {
+        return 10;
+    }
+    return 50;
+}
+
+NSString *base64FromRust(uint8_t *bytes, int length)
+{
+    NSData *data = [[NSData alloc] initWithBytesNoCopy:bytes length:(NSUInteger)length deallocator:^(void *rustBytes, NSUInteger rustLength) {
+        mls_free_bytes((uint8_t *)rustBytes);
+    }];
+    return [data base64EncodedStringWithOptions:0];
+}
+
+} // namespace
+
+@interface MLSFFIBenchmarks : XCTestCase
+@end
+
+@implementation MLSFFIBenchmarks
+{
+    void *_client;
+    NSString *_storagePath;
+    std::vector<void *> _groupHandles;
+    NSUInteger _groupCounter;
+}
+
+static NSMutableArray<NSDictionary *> *MLSBenchmarkResults;
+
++ (void)setUp
+{
+    [super setUp];
+    MLSBenchmarkResults = [NSMutableArray array];
+}
+
++ (void)tearDown
+{
+    NSMutableString *table = [NSMutableString stringWithString:@"\noperation                       layer    members  msgBytes  iters      mean µs       p50 µs       p95 µs\n"];
+    for (NSDictionary *result in MLSBenchmarkResults) {
+        [table appendFormat:@"%-31s %-8s %7lu %9lu %6lu %12.1f %12.1f %12.1f\n",
+         [result[@"operation"] UTF8String], [result[@"layer"] UTF8String],
+         [result[@"groupSize"] unsignedLongValue], [result[@"messageSize"] unsignedLongValue],
+         [result[@"iterations"] unsignedLongValue], [result[@"meanMicros"] doubleValue],
+         [result[@"p50Micros"] doubleValue], [result[@"p95Micros"] doubleValue]];
+    }
+    NSLog(@"MLS FFI benchmarks:%@", table);
+    [super tearDown];
+}
+
++ (NSArray<NSNumber *> *)groupSizes
+{
+    NSString *override = NSProcessInfo.processInfo.environment[@"MLS_BENCH_GROUP_SIZES"];
+    if (override.length == 0) {
+        return @[@2, @10, @100, @1000];
+    }
+
+    NSMutableArray<NSNumber *> *sizes = [NSMutableArray array];
+    for (NSString *part in [override componentsSeparatedByString:@","]) {
+        NSInteger size = part.integerValue;
+        if (size >= 2) {
+            [sizes addObject:@(size)];
+        }
+    }
+    return sizes;
+}
+
++ (NSArray<NSNumber *> *)messageSizes
+{
+    return @[@32, @1024, @16384];
+}
+
+- (void)setUp
+{
+    [super setUp];
+    _storagePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    [[NSFileManager defaultManager] createDirectoryAtPath:_storagePath withIntermediateDirectories:YES attributes:nil error:nil];
+    mls_set_storage_path(_storagePath.UTF8String);
+    _client = mls_client_create();
+    XCTAssertNotEqual(_client, (void *)NULL, @"mls_client_create failed");
+}
+
+- (void)tearDown
+{
+    for (void *handle : _groupHandles) {
+        mls_free_group(handle);
+    }
+    _groupHandles.clear();
+    if (_client) {
+        mls_free_client(_client);
+        _client = NULL;
+    }
+    [[NSFileManager defaultManager] removeItemAtPath:_storagePath error:nil];
+    [super tearDown];
+}
+
+#pragma mark - Fixtures
+
+- (void)recordOperation:(NSString *)operation
+                  layer:(NSString *)layer
+              groupSize:(NSUInteger)groupSize
+            messageSize:(NSUInteger)messageSize
+                  stats:(BenchmarkStats)stats
+{
+    NSDictionary *result = @{
+        @"operation": operation,
+        @"layer": layer,
+        @"groupSize": @(groupSize),
+        @"messageSize": @(messageSize),
+        @"iterations": @(stats.iterations),
+        @"meanMicros": @(stats.meanMicros),
+        @"p50Micros": @(stats.p50Micros),
+        @"p95Micros": @(stats.p95Micros),
+        @"minMicros": @(stats.minMicros),
+    };
+    [MLSBenchmarkResults addObject:result];
+
+    NSData *json = [NSJSONSerialization dataWithJSONObject:result options:NSJSONWritingSortedKeys error:nil];
+    XCTAttachment *attachment = [XCTAttachment attachmentWithUniformTypeIdentifier:@"public.json"
+                                                                              name:[NSString stringWithFormat:@"%@-%@-%lu-%lu", operation, layer, (unsigned long)groupSize, (unsigned long)messageSize]
+                                                                           payload:json
+                                                                          userInfo:nil];
+    attachment.lifetime = XCTAttachmentLifetimeKeepAlways;
+    [self addAttachment:attachment];
+}
+
+- (NSString *)memberIdentity:(NSUInteger)index
+{
+    return [NSString stringWithFormat:@"bench-member-%lu", (unsigned long)index];
+}
+
+- (std::vector<std::string>)keyPackagesForMembers:(NSRange)members
+{
+    std::vector<std::string> keyPackages;
+    keyPackages.reserve(members.length);
+    for (NSUInteger i = members.location; i < NSMaxRange(members); i++) {
+        char *keyPackage = mls_generate_key_package(_client, [self memberIdentity:i].UTF8String);
+        XCTAssertNotEqual(keyPackage, (char *)NULL, @"mls_generate_key_package failed");
+        if (keyPackage) {
+            keyPackages.emplace_back(keyPackage);
+            mls_free_string(keyPackage);
+        }
+    }
+    return keyPackages;
+}
+
+- (NSString *)createEmptyGroup
+{
+    NSString *groupId = [NSString stringWithFormat:@"bench-group-%lu", (unsigned long)++_groupCounter];
+    void *handle = mls_create_group(_client, groupId.UTF8String, [self memberIdentity:0].UTF8String);
+    XCTAssertNotEqual(handle, (void *)NULL, @"mls_create_group failed");
+    if (handle) {
+        _groupHandles.push_back(handle);
+    }
+    return groupId;
+}
+
+// Add members 1..count to a group in one commit; returns the welcome as base64
+- (NSString *)addMembers:(const std::vector<std::string> &)keyPackages toGroup:(NSString *)groupId
+{
+    std::vector<const char *> receivers;
+    receivers.reserve(keyPackages.size());
+    for (const std::string &keyPackage : keyPackages) {
+        receivers.push_back(keyPackage.c_str());
+    }
+
+    int *outLens = NULL;
+    int outCount = 0;
+    uint8_t *result = mls_add_members(_client, groupId.UTF8String, [self memberIdentity:0].UTF8String,
+                                      receivers.data(), (int)receivers.size(), &outLens, &outCount);
+    NSString *welcome = nil;
+    MLSAddMembersOutput output;
+    if (MLSUnpackAddMembersResult(result, outLens, outCount, &output)) {
+        mls_free_bytes(output.commit);
+        if (output.welcome != NULL) {
+            welcome = base64FromRust(output.welcome, output.welcomeLength);
+        }
+    }
+    return welcome;
+}
+
+// Group with `size` members in which member 0 sends and member 1 receives
+- (NSString *)bootstrapGroupOfSize:(NSUInteger)size
+{
+    NSString *groupId = [self createEmptyGroup];
+    NSString *welcome = [self addMembers:[self keyPackagesForMembers:NSMakeRange(1, size - 1)] toGroup:groupId];
+    XCTAssertNotNil(welcome, @"mls_add_members failed for %lu members", (unsigned long)size);
+
+    void *handle = mls_join_group(_client, groupId.UTF8String, [self memberIdentity:1].UTF8String, welcome.UTF8String);
+    XCTAssertNotEqual(handle, (void *)NULL, @"mls_join_group failed");
+    if (handle) {
+        _groupHandles.push_back(handle);
+    }
+    return groupId;
+}
+
+- (std::string)plaintextOfSize:(NSUInteger)size
+{
+    std::string plaintext(size, 'a');
+    for (NSUInteger i = 0; i < size; i++) {
+        plaintext[i] = (char)('a' + (i % 26));
+    }
+    return plaintext;
+}
+
+#pragma mark - Benchmarks
+
+- (void)testCreateApplicationMessage
+{
+    for (NSNumber *groupSize in [[self class] groupSizes]) {
+        NSString *groupId = [self bootstrapGroupOfSize:groupSize.unsignedIntegerValue];
+        const char *groupIdStr = groupId.UTF8String;
+        const char *senderStr = [self memberIdentity:0].UTF8String;
+        size_t iterations = iterationsForGroupSize(groupSize.unsignedIntegerValue) * 4;
+
+        for (NSNumber *messageSize in [[self class] messageSizes]) {
+            std::string plaintext = [self plaintextOfSize:messageSize.unsignedIntegerValue];
+            NSString *plaintextString = @(plaintext.c_str());
+
+            BenchmarkStats raw = runBenchmark(iterations, [] {}, [&] {
+                int outLen = 0;
+                uint8_t *ciphertext = mls_create_application_message(_client, groupIdStr, senderStr,
+                                                                     (const uint8_t *)plaintext.data(), (int)plaintext.size(), &outLen);
+                mls_free_bytes(ciphertext);
+            });
+            [self recordOperation:@"createApplicationMessage" layer:@"ffi"
+                        groupSize:groupSize.unsignedIntegerValue messageSize:messageSize.unsignedIntegerValue stats:raw];
+
+            BenchmarkStats bridged = runBenchmark(iterations, [] {}, [&] {
+                @autoreleasepool {
+                    const char *messageBytes = [plaintextString UTF8String];
+                    int outLen = 0;
+                    uint8_t *ciphertext = mls_create_application_message(_client, groupIdStr, senderStr,
+                                                                         (const uint8_t *)messageBytes, (int)strlen(messageBytes), &outLen);
+                    if (ciphertext) {
+                        (void)base64FromRust(ciphertext, outLen);
+                    }
+                }
+            });
+            [self recordOperation:@"createApplicationMessage" layer:@"bridge"
+                        groupSize:groupSize.unsignedIntegerValue messageSize:messageSize.unsignedIntegerValue stats:bridged];
+        }
+    }
+}
+
+- (void)testProcessMessage
+{
+    for (NSNumber *groupSize in [[self class] groupSizes]) {
+        NSString *groupId = [self bootstrapGroupOfSize:groupSize.unsignedIntegerValue];
+        const char *groupIdStr = groupId.UTF8String;
+        const char *senderStr = [self memberIdentity:0].UTF8String;
+        const char *receiverStr = [self memberIdentity:1].UTF8String;
+        size_t iterations = iterationsForGroupSize(groupSize.unsignedIntegerValue) * 4;
+
+        for (NSNumber *messageSize in [[self class] messageSizes]) {
+            std::string plaintext = [self plaintextOfSize:messageSize.unsignedIntegerValue];
+
+            // Each ciphertext can only be processed once, so encrypt a fresh one per round
+            NSData *ciphertext = nil;
+            auto encrypt = [&] {
+                int outLen = 0;
+                uint8_t *bytes = mls_create_application_message(_client, groupIdStr, senderStr,
+                                                                (const uint8_t *)plaintext.data(), (int)plaintext.size(), &outLen);
+                ciphertext = bytes ? [NSData dataWithBytes:bytes length:(NSUInteger)outLen] : nil;
+                mls_free_bytes(bytes);
+            };
+
+            BenchmarkStats raw = runBenchmark(iterations, encrypt, [&] {
+                int type = 0, contentLen = 0, senderLen = 0, validated = 0;
+                uint8_t *content = NULL, *sender = NULL;
+                mls_process_message(_client, groupIdStr, receiverStr, (const uint8_t *)ciphertext.bytes, (int)ciphertext.length,
+                                    &type, &content, &contentLen, &sender, &senderLen, &validated);
+                mls_free_bytes(content);
+                mls_free_bytes(sender);
+            });
+            [self recordOperation:@"processMessage" layer:@"ffi"
+                        groupSize:groupSize.unsignedIntegerValue messageSize:messageSize.unsignedIntegerValue stats:raw];
+
+            NSString *ciphertextBase64 = nil;
+            BenchmarkStats bridged = runBenchmark(iterations, [&] {
+                encrypt();
+                ciphertextBase64 = [ciphertext base64EncodedStringWithOptions:0];
+            }, [&] {
+                @autoreleasepool {
+                    NSData *decoded = [[NSData alloc] initWithBase64EncodedString:ciphertextBase64 options:0];
+                    int type = 0, contentLen = 0, senderLen = 0, validated = 0;
+                    uint8_t *content = NULL, *sender = NULL;
+                    mls_process_message(_client, groupIdStr, receiverStr, (const uint8_t *)decoded.bytes, (int)decoded.length,
+                                        &type, &content, &contentLen, &sender, &senderLen, &validated);
+                    NSMutableDictionary *result = [NSMutableDictionary dictionary];
+                    if (content && contentLen > 0) {
+                        NSData *contentData = [[NSData alloc] initWithBytesNoCopy:content length:(NSUInteger)contentLen deallocator:^(void *bytes, NSUInteger length) {
+                            mls_free_bytes((uint8_t *)bytes);
+                        }];
+                        result[@"content"] = [[NSString alloc] initWithData:contentData encoding:NSUTF8StringEncoding] ?: [contentData base64EncodedStringWithOptions:0];
+                    } else {
+                        mls_free_bytes(content);
+                    }
+                    if (sender && senderLen > 0) {
+                        result[@"sender"] = base64FromRust(sender, senderLen);
+                    } else {
+                        mls_free_bytes(sender);
+                    }
+                    result[@"validated"] = @(validated == 1);
+                }
+            });
+            [self recordOperation:@"processMessage" layer:@"bridge"
+                        groupSize:groupSize.unsignedIntegerValue messageSize:messageSize.unsignedIntegerValue stats:bridged];
+        }
+    }
+}
+
+- (void)testAddMembers
+{
+    for (NSNumber *groupSize in [[self class] groupSizes]) {
+        NSUInteger size = groupSize.unsignedIntegerValue;
+        size_t iterations = std::max<size_t>(iterationsForGroupSize(size) / 5, 2);
+
+        // Fresh group and key packages per round; only the commit is timed
+        NSString *groupId = nil;
+        std::vector<std::string> keyPackages;
+        auto prepare = [&] {
+            groupId = [self createEmptyGroup];
+            keyPackages = [self keyPackagesForMembers:NSMakeRange(1, size - 1)];
+        };
+
+        BenchmarkStats raw = runBenchmark(iterations, prepare, [&] {
+            std::vector<const char *> receivers;
+            for (const std::string &keyPackage : keyPackages) {
+                receivers.push_back(keyPackage.c_str());
+            }
+            int *outLens = NULL;
+            int outCount = 0;
+            uint8_t *result = mls_add_members(_client, groupId.UTF8String, [self memberIdentity:0].UTF8String,
+                                              receivers.data(), (int)receivers.size(), &outLens, &outCount);
+            MLSAddMembersOutput output;
+            if (MLSUnpackAddMembersResult(result, outLens, outCount, &output)) {
+                mls_free_bytes(output.commit);
+                if (output.welcome != NULL) {
+                    mls_free_bytes(output.welcome);
+                }
+            }
+        });
+        [self recordOperation:@"addMembers" layer:@"ffi" groupSize:size messageSize:0 stats:raw];
+
+        BenchmarkStats bridged = runBenchmark(iterations, prepare, [&] {
+            @autoreleasepool {
+                NSMutableArray<NSString *> *keyPackageStrings = [NSMutableArray arrayWithCapacity:keyPackages.size()];
+                for (const std::string &keyPackage : keyPackages) {
+                    [keyPackageStrings addObject:@(keyPackage.c_str())];
+                }
+                (void)[self addMembersThroughBridge:keyPackageStrings toGroup:groupId];
+            }
+        });
+        [self recordOperation:@"addMembers" layer:@"bridge" groupSize:size messageSize:0 stats:bridged];
+    }
+}
+
+// Same marshalling as -[MLSModule addMembers:creatorId:receiverKeyPackages:]
+- (NSDictionary *)addMembersThroughBridge:(NSArray<NSString *> *)keyPackages toGroup:(NSString *)groupId
+{
+    const char **receivers = (const char **)malloc(keyPackages.count * sizeof(char *));
+    for (NSUInteger i = 0; i < keyPackages.count; i++) {
+        receivers[i] = [keyPackages[i] UTF8String];
+    }
+
+    int *outLens = NULL;
+    int outCount = 0;
+    uint8_t *result = mls_add_members(_client, groupId.UTF8String, [self memberIdentity:0].UTF8String,
+                                      receivers, (int)keyPackages.count, &outLens, &outCount);
+    free(receivers);
+
+    NSMutableDictionary *resultDict = nil;
+    MLSAddMembersOutput output;
+    if (MLSUnpackAddMembersResult(result, outLens, outCount, &output)) {
+        resultDict = [NSMutableDictionary dictionaryWithObject:base64FromRust(output.commit, output.commitLength) forKey:@"commit"];
+        if (output.welcome != NULL) {
+            resultDict[@"welcome"] = base64FromRust(output.welcome, output.welcomeLength);
+        }
+    }
+    return resultDict;
+}
+
+- (void)benchmarkCommitOperation:(NSString *)operation
+                            call:(uint8_t *(*)(const void *, const char *, const char *, int *, uint8_t **, int *))call
+{
+    for (NSNumber *groupSize in [[self class] groupSizes]) {
+        NSUInteger size = groupSize.unsignedIntegerValue;
+        NSString *groupId = [self bootstrapGroupOfSize:size];
+        const char *groupIdStr = groupId.UTF8String;
+        const char *creatorStr = [self memberIdentity:0].UTF8String;
+        size_t iterations = iterationsForGroupSize(size);
+
+        BenchmarkStats raw = runBenchmark(iterations, [] {}, [&] {
+            int commitLen = 0, welcomeLen = 0;
+            uint8_t *welcome = NULL;
+            uint8_t *commit = call(_client, groupIdStr, creatorStr, &commitLen, &welcome, &welcomeLen);
+            mls_free_bytes(commit);
+            mls_free_bytes(welcome);
+        });
+        [self recordOperation:operation layer:@"ffi" groupSize:size messageSize:0 stats:raw];
+
+        BenchmarkStats bridged = runBenchmark(iterations, [] {}, [&] {
+            @autoreleasepool {
+                int commitLen = 0, welcomeLen = 0;
+                uint8_t *welcome = NULL;
+                uint8_t *commit = call(_client, groupIdStr, creatorStr, &commitLen, &welcome, &welcomeLen);
+                NSMutableDictionary *result = [NSMutableDictionary dictionary];
+                if (commit) {
+                    result[@"commit"] = base64FromRust(commit, commitLen);
+                }
+                if (welcome) {
+                    result[@"welcome"] = base64FromRust(welcome, welcomeLen);
+                }
+            }
+        });
+        [self recordOperation:operation layer:@"bridge" groupSize:size messageSize:0 stats:bridged];
+    }
+}
+
+- (void)testCommitPendingProposals
+{
+    [self benchmarkCommitOperation:@"commitPendingProposals" call:mls_commit_pending_proposals];
+}
+
+- (void)testSelfUpdate
+{
+    [self benchmarkCommitOperation:@"selfUpdate" call:mls_self_update];
+}
+
+- (void)testExportRatchetTree
+{
+    for (NSNumber *groupSize in [[self class] groupSizes]) {
+        NSUInteger size = groupSize.unsignedIntegerValue;
+        NSString *groupId = [self bootstrapGroupOfSize:size];
+        const char *groupIdStr = groupId.UTF8String;
+        const char *userStr = [self memberIdentity:0].UTF8String;
+        size_t iterations = iterationsForGroupSize(size) * 2;
+
+        int treeLen = 0;
+        mls_free_bytes(mls_export_ratchet_tree(_client, groupIdStr, userStr, &treeLen));
+
+        BenchmarkStats raw = runBenchmark(iterations, [] {}, [&] {
+            int outLen = 0;
+            mls_free_bytes(mls_export_ratchet_tree(_client, groupIdStr, userStr, &outLen));
+        });
+        [self recordOperation:@"exportRatchetTree" layer:@"ffi" groupSize:size messageSize:(NSUInteger)treeLen stats:raw];
+
+        BenchmarkStats bridged = runBenchmark(iterations, [] {}, [&] {
+            @autoreleasepool {
+                int outLen = 0;
+                uint8_t *tree = mls_export_ratchet_tree(_client, groupIdStr, userStr, &outLen);
+                if (tree) {
+                    (void)base64FromRust(tree, outLen);
+                }
+            }
+        });
+        [self recordOperation:@"exportRatchetTree" layer:@"bridge" groupSize:size messageSize:(NSUInteger)treeLen stats:bridged];
+    }
+}
+
+- (void)testJoinGroupWithRatchetTree
+{
+    for (NSNumber *groupSize in [[self class] groupSizes]) {
+        NSUInteger size = groupSize.unsignedIntegerValue;
+        NSString *groupId = [self bootstrapGroupOfSize:size];
+        const char *groupIdStr = groupId.UTF8String;
+        const char *creatorStr = [self memberIdentity:0].UTF8String;
+        size_t iterations = std::max<size_t>(iterationsForGroupSize(size) / 2, 2);
+
+        // Each round adds one new member; only its join is timed
+        NSUInteger nextMember = size;
+        NSString *joiner = nil;
+        NSString *welcome = nil;
+        NSString *tree = nil;
+        NSData *welcomeBytes = nil;
+        NSData *treeBytes = nil;
+        auto prepare = [&] {
+            joiner = [self memberIdentity:nextMember];
+            std::vector<std::string> keyPackage = [self keyPackagesForMembers:NSMakeRange(nextMember, 1)];
+            nextMember++;
+
+            int commitLen = 0, welcomeLen = 0, treeLen = 0;
+            uint8_t *welcomeOut = NULL;
+            uint8_t *commit = mls_add_member(_client, groupIdStr, creatorStr, joiner.UTF8String,
+                                             keyPackage.empty() ? "" : keyPackage[0].c_str(), &commitLen, &welcomeOut, &welcomeLen);
+            mls_free_bytes(commit);
+            welcomeBytes = welcomeOut ? [NSData dataWithBytes:welcomeOut length:(NSUInteger)welcomeLen] : [NSData data];
+            mls_free_bytes(welcomeOut);
+
+            uint8_t *treeOut = mls_export_ratchet_tree(_client, groupIdStr, creatorStr, &treeLen);
+            treeBytes = treeOut ? [NSData dataWithBytes:treeOut length:(NSUInteger)treeLen] : [NSData data];
+            mls_free_bytes(treeOut);
+
+            welcome = [welcomeBytes base64EncodedStringWithOptions:0];
+            tree = [treeBytes base64EncodedStringWithOptions:0];
+        };
+
+        // The FFI takes base64 text, so the raw layer starts from ready C strings
+        std::string welcomeStr;
+        std::string treeStr;
+        BenchmarkStats raw = runBenchmark(iterations, [&] {
+            prepare();
+            welcomeStr = welcome.UTF8String;
+            treeStr = tree.UTF8String;
+        }, [&] {
+            void *handle = mls_join_group_with_ratchet_tree(_client, groupIdStr, joiner.UTF8String, welcomeStr.c_str(), treeStr.c_str());
+            if (handle) {
+                _groupHandles.push_back(handle);
+            }
+        });
+        [self recordOperation:@"joinGroupWithRatchetTree" layer:@"ffi" groupSize:size messageSize:treeBytes.length stats:raw];
+
+        BenchmarkStats bridged = runBenchmark(iterations, prepare, [&] {
+            @autoreleasepool {
+                void *handle = mls_join_group_with_ratchet_tree(_client, groupIdStr, [joiner UTF8String],
+                                                                [welcome UTF8String], [tree UTF8String]);
+                if (handle) {
+                    _groupHandles.push_back(handle);
+                }
+            }
+        });
+        [self recordOperation:@"joinGroupWithRatchetTree" layer:@"bridge" groupSize:size messageSize:treeBytes.length stats:bridged];
+    }
+}
+
+@end
@@ -0,0 +1,212 @@
+//
+// MLSCiphertextFilterTests.mm
+// bitchatMLSTests
+//
+// This is free and unencumbered software released into the public domain.
+// For more information, see <https://unlicense.org>
+//
+
+#import <XCTest/XCTest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MLSCiphertextFilter.h"
+#include "MLSEpochReorderBuffer.h"
+
+namespace {
+
+MLSCiphertextDigest digest(const char *groupId, const char *userId, uint32_t message)
+{
+    std::string bytes = "ciphertext " + std::to_string(message);
+    return MLSDigestCiphertext(groupId, userId, (const uint8_t *)bytes.data(), bytes.size());
+}
+
+MLSCiphertextDigest digest(uint32_t message)
+{
+    return digest("group", "alice", message);
+}
+
+bool operator==(const MLSCiphertextDigest &a, const MLSCiphertextDigest &b)
+{
+    return a.high == b.high && a.low == b.low;
+}
+
+}
+
+@interface MLSCiphertextFilterTests : XCTestCase
+@end
+
+@implementation MLSCiphertextFilterTests
+
+- (void)testDigestCoversGroupMemberAndCiphertext
+{
+    XCTAssertTrue(digest(1) == digest(1));
+    XCTAssertFalse(digest(1) == digest(2));
+    XCTAssertFalse(digest("group", "alice", 1) == digest("group", "bob", 1));
+    XCTAssertFalse(digest("group", "alice", 1) == digest("other", "alice", 1));
+    // The field separators keep "ab" + "c" apart from "a" + "bc"
+    XCTAssertFalse(digest("ab", "c", 1) == digest("a", "bc", 1));
+}
+
+- (void)testRecordedCiphertextsAreDuplicates
+{
+    MLSCiphertextFilter filter(16);
+    XCTAssertFalse(filter.contains(digest(1)));
+    filter.insert(digest(1));
+    XCTAssertTrue(filter.contains(digest(1)));
+    XCTAssertFalse(filter.contains(digest(2)));
+
+    MLSCiphertextFilter::Statistics statistics = filter.statistics();
+    XCTAssertEqual(statistics.checked, 3u);
+    XCTAssertEqual(statistics.duplicates, 1u);
+    XCTAssertEqual(statistics.remembered, 1u);
+}
+
+- (void)testRecordingTwiceKeepsOneEntry
+{
+    MLSCiphertextFilter filter(16);
+    filter.insert(digest(1));
+    filter.insert(digest(1));
+    XCTAssertEqual(filter.statistics().remembered, 1u);
+}
+
+- (void)testOtherLocalMembersStillProcessTheirCopy
+{
+    MLSCiphertextFilter filter(16);
+    filter.insert(digest("group", "alice", 1));
+    XCTAssertFalse(filter.contains(digest("group", "bob", 1)));
+}
+
+- (void)testPreviousGenerationIsRememberedUntilReplaced
+{
+    MLSCiphertextFilter filter(4);
+    for (uint32_t message = 1; message <= 5; message++) {
+        filter.insert(digest(message));
+    }
+    // 1 to 4 moved to the previous generation when 5 started a new one
+    XCTAssertTrue(filter.contains(digest(1)));
+    XCTAssertEqual(filter.statistics().remembered, 5u);
+
+    for (uint32_t message = 6; message <= 9; message++) {
+        filter.insert(digest(message));
+    }
+    // 5 to 8 replaced them when 9 came in
+    XCTAssertFalse(filter.contains(digest(1)));
+    XCTAssertFalse(filter.contains(digest(4)));
+    XCTAssertTrue(filter.contains(digest(5)));
+    XCTAssertTrue(filter.contains(digest(9)));
+    XCTAssertEqual(filter.statistics().remembered, 5u);
+}
+
+- (void)testNoFalseDuplicatesAtCapacity
+{
+    MLSCiphertextFilter filter(1000);
+    for (uint32_t message = 0; message < 1000; message++) {
+        filter.insert(digest(message));
+    }
+    for (uint32_t message = 1000; message < 3000; message++) {
+        XCTAssertFalse(filter.contains(digest(message)));
+    }
+    MLSCiphertextFilter::Statistics statistics = filter.statistics();
+    XCTAssertEqual(statistics.duplicates, 0u);
+    // About 1% of the new messages get past the Bloom filter to the fingerprints
+    XCTAssertLessThan(statistics.falsePositives, 100u);
+}
+
+- (void)testRemovedCiphertextsAreProcessedAgain
+{
+    MLSCiphertextFilter filter(16);
+    filter.insert(digest(1));
+    filter.insert(digest(2));
+    filter.remove(digest(1));
+    filter.remove(digest(3));
+
+    XCTAssertFalse(filter.contains(digest(1)));
+    XCTAssertTrue(filter.contains(digest(2)));
+    XCTAssertEqual(filter.statistics().remembered, 1u);
+}
+
+- (void)testRemovingKeepsTheRestFindable
+{
+    // Full enough for long probe runs, each removal moving entries back
+    MLSCiphertextFilter filter(512);
+    for (uint32_t message = 0; message < 512; message++) {
+        filter.insert(digest(message));
+    }
+    for (uint32_t message = 0; message < 512; message += 2) {
+        filter.remove(digest(message));
+    }
+    for (uint32_t message = 0; message < 512; message++) {
+        XCTAssertEqual(filter.contains(digest(message)), message % 2 == 1, @"message %u", message);
+    }
+    XCTAssertEqual(filter.statistics().remembered, 256u);
+}
+
+- (void)testRemovesFromThePreviousGeneration
+{
+    MLSCiphertextFilter filter(4);
+    for (uint32_t message = 1; message <= 5; message++) {
+        filter.insert(digest(message));
+    }
+    filter.remove(digest(1));
+    XCTAssertFalse(filter.contains(digest(1)));
+    XCTAssertTrue(filter.contains(digest(2)));
+}
+
+- (void)testParkedMessageDroppedFromTheReorderBufferCanBeResent
+{
+    // How the module records a parked message and forgets it once dropped
+    MLSEpochReorderBuffer buffer({1, 1024, 4, std::chrono::minutes(5)});
+    MLSCiphertextFilter filter(16);
+    auto park = [&](const std::string &ciphertext, std::vector<MLSDeferredMessage> &dropped) {
+        MLSMessageHeader header;
+        header.epoch = 3;
+        header.contentType = MLSContentType::Application;
+        const uint8_t *bytes = (const uint8_t *)ciphertext.data();
+        XCTAssertNotEqual(buffer.park("group", "alice", header, 2, bytes, ciphertext.size(), dropped), 0u);
+        filter.insert(MLSDigestCiphertext("group", "alice", bytes, ciphertext.size()));
+    };
+
+    std::vector<MLSDeferredMessage> dropped;
+    park("first", dropped);
+    std::string first = "first";
+    MLSCiphertextDigest firstDigest = MLSDigestCiphertext("group", "alice", (const uint8_t *)first.data(), first.size());
+    XCTAssertTrue(filter.contains(firstDigest), @"A copy arriving while it is parked is a duplicate");
+
+    // The group's limit of one pushes the first message out
+    park("second", dropped);
+    XCTAssertEqual(dropped.size(), 1u);
+    for (const MLSDeferredMessage &message : dropped) {
+        filter.remove(MLSDigestCiphertext(message.groupId.c_str(), message.userId.c_str(),
+                                          message.bytes.data(), message.bytes.size()));
+    }
+    XCTAssertFalse(filter.contains(firstDigest), @"The resend of a dropped message must be processed");
+}
+
+- (void)testClearForgetsEverything
+{
+    MLSCiphertextFilter filter(4);
+    for (uint32_t message = 1; message <= 5; message++) {
+        filter.insert(digest(message));
+    }
+    size_t memoryBytes = filter.statistics().memoryBytes;
+    filter.clear();
+
+    XCTAssertFalse(filter.contains(digest(1)));
+    XCTAssertFalse(filter.contains(digest(5)));
+    XCTAssertEqual(filter.statistics().remembered, 0u);
+    XCTAssertEqual(filter.statistics().memoryBytes, memoryBytes);
+}
+
+- (void)testZeroCapacityRemembersOne
+{
+    MLSCiphertextFilter filter(0);
+    XCTAssertEqual(filter.statistics().capacity, 1u);
+    filter.insert(digest(1));
+    XCTAssertTrue(filter.contains(digest(1)));
+}
+
+@end
@@ -0,0 +1,264 @@
+//
+// MLSEpochReorderBufferTests.mm
+// bitchatMLSTests
+//
+// This is free and unencumbered software released into the public domain.
+// For more information, see <https://unlicense.org>
+//
+
+#import <XCTest/XCTest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MLSEpochReorderBuffer.h"
+
+namespace {
+
+void appendUInt(std::vector<uint8_t> &bytes, uint64_t value, size_t width)
+{
+    for (size_t i = width; i > 0; i--) {
+        bytes.push_back((uint8_t)(value >> (8 * (i - 1))));
+    }
+}
+
+// MLSMessage framing up to the content type, with a one-byte group_id length
+std::vector<uint8_t> messagePrefix(uint16_t wireFormat, uint64_t epoch)
+{
+    std::vector<uint8_t> bytes;
+    appendUInt(bytes, 1, 2);
+    appendUInt(bytes, wireFormat, 2);
+    std::string groupId = "group";
+    bytes.push_back((uint8_t)groupId.size());
+    bytes.insert(bytes.end(), groupId.begin(), groupId.end());
+    appendUInt(bytes, epoch, 8);
+    return bytes;
+}
+
+std::vector<uint8_t> privateMessage(uint64_t epoch, MLSContentType contentType)
+{
+    std::vector<uint8_t> bytes = messagePrefix(2, epoch);
+    bytes.push_back((uint8_t)contentType);
+    bytes.insert(bytes.end(), 16, 0xEE);
+    return bytes;
+}
+
+std::vector<uint8_t> publicMessage(uint64_t epoch, MLSContentType contentType)
+{
+    std::vector<uint8_t> bytes = messagePrefix(1, epoch);
+    // A member sender with its leaf index, then empty authenticated_data
+    bytes.push_back(1);
+    appendUInt(bytes, 3, 4);
+    bytes.push_back(0);
+    bytes.push_back((uint8_t)contentType);
+    return bytes;
+}
+
+MLSMessageHeader header(uint64_t epoch, MLSContentType contentType = MLSContentType::Application)
+{
+    MLSMessageHeader header;
+    header.epoch = epoch;
+    header.contentType = contentType;
+    return header;
+}
+
+MLSEpochReorderBuffer::Limits limits(size_t messagesPerGroup = 8, size_t bytes = 1024)
+{
+    return {messagesPerGroup, bytes, 4, std::chrono::minutes(5)};
+}
+
+const uint8_t payload[64] = {};
+
+}
+
+@interface MLSEpochReorderBufferTests : XCTestCase
+@end
+
+@implementation MLSEpochReorderBufferTests
+
+#pragma mark - Headers
+
+- (void)testReadsPrivateMessageHeaders
+{
+    std::vector<uint8_t> bytes = privateMessage(7, MLSContentType::Application);
+    MLSMessageHeader parsed;
+    XCTAssertTrue(MLSReadMessageHeader(bytes.data(), bytes.size(), parsed));
+    XCTAssertEqual(parsed.epoch, 7u);
+    XCTAssertTrue(parsed.contentType == MLSContentType::Application);
+}
+
+- (void)testReadsPublicMessageHeaders
+{
+    std::vector<uint8_t> bytes = publicMessage(9, MLSContentType::Commit);
+    MLSMessageHeader parsed;
+    XCTAssertTrue(MLSReadMessageHeader(bytes.data(), bytes.size(), parsed));
+    XCTAssertEqual(parsed.epoch, 9u);
+    XCTAssertTrue(parsed.contentType == MLSContentType::Commit);
+}
+
+- (void)testContentTypeIsUnknownWhenCutShortAfterTheEpoch
+{
+    std::vector<uint8_t> bytes = messagePrefix(2, 3);
+    MLSMessageHeader parsed;
+    XCTAssertTrue(MLSReadMessageHeader(bytes.data(), bytes.size(), parsed));
+    XCTAssertEqual(parsed.epoch, 3u);
+    XCTAssertTrue(parsed.contentType == MLSContentType::Unknown);
+}
+
+- (void)testRejectsOtherWireFormatsAndTruncatedMessages
+{
+    MLSMessageHeader parsed;
+    std::vector<uint8_t> welcome = messagePrefix(3, 1);
+    XCTAssertFalse(MLSReadMessageHeader(welcome.data(), welcome.size(), parsed));
+
+    std::vector<uint8_t> truncated = privateMessage(1, MLSContentType::Application);
+    truncated.resize(10);
+    XCTAssertFalse(MLSReadMessageHeader(truncated.data(), truncated.size(), parsed));
+
+    std::vector<uint8_t> wrongVersion = privateMessage(1, MLSContentType::Application);
+    wrongVersion[1] = 2;
+    XCTAssertFalse(MLSReadMessageHeader(wrongVersion.data(), wrongVersion.size(), parsed));
+    XCTAssertFalse(MLSReadMessageHeader(nullptr, 0, parsed));
+}
+
+#pragma mark - Parking
+
+- (void)testParksOnlyMessagesFromALaterEpochWithinReach
+{
+    MLSEpochReorderBuffer buffer(limits());
+    std::vector<MLSDeferredMessage> dropped;
+
+    XCTAssertEqual(buffer.park("group", "alice", header(2), 2, payload, 8, dropped), 0u);
+    XCTAssertEqual(buffer.park("group", "alice", header(1), 2, payload, 8, dropped), 0u);
+    XCTAssertEqual(buffer.park("group", "alice", header(7), 2, payload, 8, dropped), 0u, @"More than epochsAhead past the group");
+    XCTAssertEqual(buffer.park("group", "alice", header(3), 2, payload, 2048, dropped), 0u, @"Larger than the byte limit");
+    XCTAssertTrue(buffer.empty());
+
+    XCTAssertEqual(buffer.park("group", "alice", header(3), 2, payload, 8, dropped), 1u);
+    XCTAssertEqual(buffer.park("group", "alice", header(6), 2, payload, 8, dropped), 2u);
+    XCTAssertTrue(dropped.empty());
+    XCTAssertEqual(buffer.statistics().messages, 2u);
+    XCTAssertEqual(buffer.statistics().bytes, 16u);
+}
+
+- (void)testZeroMessagesPerGroupTurnsBufferingOff
+{
+    MLSEpochReorderBuffer buffer(limits(0));
+    std::vector<MLSDeferredMessage> dropped;
+    XCTAssertEqual(buffer.park("group", "alice", header(3), 2, payload, 8, dropped), 0u);
+}
+
+- (void)testTakeReadyOrdersByEpochWithCommitsLast
+{
+    MLSEpochReorderBuffer buffer(limits());
+    std::vector<MLSDeferredMessage> dropped;
+    uint64_t commit4 = buffer.park("group", "alice", header(4, MLSContentType::Commit), 2, payload, 8, dropped);
+    uint64_t message4 = buffer.park("group", "alice", header(4), 2, payload, 8, dropped);
+    uint64_t commit3 = buffer.park("group", "alice", header(3, MLSContentType::Commit), 2, payload, 8, dropped);
+    uint64_t message3 = buffer.park("group", "alice", header(3), 2, payload, 8, dropped);
+    uint64_t proposal3 = buffer.park("group", "alice", header(3, MLSContentType::Proposal), 2, payload, 8, dropped);
+    uint64_t message5 = buffer.park("group", "alice", header(5), 2, payload, 8, dropped);
+
+    std::vector<MLSDeferredMessage> ready = buffer.takeReady("group", "alice", 4, dropped);
+    std::vector<uint64_t> tickets;
+    for (const MLSDeferredMessage &message : ready) {
+        tickets.push_back(message.ticket);
+    }
+    XCTAssertTrue((tickets == std::vector<uint64_t>{message3, proposal3, commit3, message4, commit4}));
+
+    // The epoch 5 message waits for its own commit
+    XCTAssertEqual(buffer.statistics().messages, 1u);
+    ready = buffer.takeReady("group", "alice", 5, dropped);
+    XCTAssertEqual(ready.size(), 1u);
+    XCTAssertEqual(ready.front().ticket, message5);
+    XCTAssertEqual(buffer.statistics().replayed, 6u);
+}
+
+- (void)testTakeReadyStaysWithinTheGroupAndMember
+{
+    MLSEpochReorderBuffer buffer(limits());
+    std::vector<MLSDeferredMessage> dropped;
+    buffer.park("group", "alice", header(3), 2, payload, 8, dropped);
+    buffer.park("group", "bob", header(3), 2, payload, 8, dropped);
+    buffer.park("other", "alice", header(3), 2, payload, 8, dropped);
+
+    std::vector<MLSDeferredMessage> ready = buffer.takeReady("group", "alice", 3, dropped);
+    XCTAssertEqual(ready.size(), 1u);
+    XCTAssertEqual(ready.front().groupId, "group");
+    XCTAssertEqual(ready.front().userId, "alice");
+    XCTAssertEqual(buffer.statistics().messages, 2u);
+}
+
+#pragma mark - Limits
+
+- (void)testGroupLimitPushesOutThatGroupsOldestMessage
+{
+    MLSEpochReorderBuffer buffer(limits(2));
+    std::vector<MLSDeferredMessage> dropped;
+    uint64_t oldest = buffer.park("group", "alice", header(3), 2, payload, 8, dropped);
+    buffer.park("other", "alice", header(3), 2, payload, 8, dropped);
+    buffer.park("group", "alice", header(3), 2, payload, 8, dropped);
+    buffer.park("group", "alice", header(3), 2, payload, 8, dropped);
+
+    XCTAssertEqual(dropped.size(), 1u);
+    XCTAssertEqual(dropped.front().ticket, oldest);
+    XCTAssertFalse(dropped.front().expired);
+    XCTAssertEqual(buffer.statistics().evicted, 1u);
+    XCTAssertEqual(buffer.statistics().messages, 3u);
+}
+
+- (void)testByteLimitPushesOutTheOldestMessages
+{
+    MLSEpochReorderBuffer buffer(limits(8, 100));
+    std::vector<MLSDeferredMessage> dropped;
+    uint64_t first = buffer.park("group", "alice", header(3), 2, payload, 40, dropped);
+    uint64_t second = buffer.park("other", "bob", header(3), 2, payload, 40, dropped);
+    buffer.park("group", "alice", header(3), 2, payload, 60, dropped);
+
+    XCTAssertEqual(dropped.size(), 2u);
+    XCTAssertEqual(dropped[0].ticket, first);
+    XCTAssertEqual(dropped[1].ticket, second);
+    XCTAssertEqual(buffer.statistics().bytes, 60u);
+}
+
+- (void)testMessagesExpireAfterTheTimeToLive
+{
+    MLSEpochReorderBuffer::Limits expiring = limits();
+    expiring.timeToLive = MLSEpochReorderBuffer::Clock::duration::zero();
+    MLSEpochReorderBuffer buffer(expiring);
+
+    std::vector<MLSDeferredMessage> dropped;
+    uint64_t ticket = buffer.park("group", "alice", header(3), 2, payload, 8, dropped);
+    XCTAssertNotEqual(ticket, 0u);
+
+    std::vector<MLSDeferredMessage> ready = buffer.takeReady("group", "alice", 3, dropped);
+    XCTAssertTrue(ready.empty());
+    XCTAssertEqual(dropped.size(), 1u);
+    XCTAssertEqual(dropped.front().ticket, ticket);
+    XCTAssertTrue(dropped.front().expired);
+    XCTAssertEqual(buffer.statistics().expired, 1u);
+}
+
+- (void)testRemoveUserDiscardsOnlyThatMembersMessages
+{
+    MLSEpochReorderBuffer buffer(limits());
+    std::vector<MLSDeferredMessage> dropped;
+    buffer.park("group", "alice", header(3), 2, payload, 8, dropped);
+    buffer.park("other", "alice", header(3), 2, payload, 8, dropped);
+    buffer.park("group", "bob", header(3), 2, payload, 8, dropped);
+
+    std::vector<MLSDeferredMessage> removed;
+    buffer.removeUser("alice", removed);
+    XCTAssertEqual(removed.size(), 2u);
+    XCTAssertEqual(removed.front().userId, "alice");
+    XCTAssertEqual(buffer.statistics().messages, 1u);
+    XCTAssertEqual(buffer.statistics().bytes, 8u);
+
+    buffer.clear();
+    XCTAssertTrue(buffer.empty());
+    XCTAssertEqual(buffer.statistics().bytes, 0u);
+}
+
+@end
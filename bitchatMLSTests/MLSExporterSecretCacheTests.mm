@@ -0,0 +1,133 @@
+//
+// MLSExporterSecretCacheTests.mm
+// bitchatMLSTests
+//
+// This is free and unencumbered software released into the public domain.
+// For more information, see <https://unlicense.org>
+//
+
+#import <XCTest/XCTest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MLSExporterSecretCache.h"
+
+namespace {
+
+MLSExporterSecretKey secretKey(const std::string &groupId, const std::string &userId, uint64_t epoch,
+                               const std::string &label = "label", uint32_t length = 32)
+{
+    return {groupId, userId, epoch, label, "digest", length};
+}
+
+std::vector<uint8_t> secretBytes(uint8_t seed)
+{
+    return std::vector<uint8_t>(32, seed);
+}
+
+}
+
+@interface MLSExporterSecretCacheTests : XCTestCase
+@end
+
+@implementation MLSExporterSecretCacheTests
+
+- (void)testServesStoredSecretsAndCountsLookups
+{
+    MLSExporterSecretCache cache(8);
+    std::vector<uint8_t> secret;
+    XCTAssertFalse(cache.get(secretKey("group", "alice", 1), secret));
+
+    cache.put(secretKey("group", "alice", 1), secretBytes(7));
+    XCTAssertTrue(cache.get(secretKey("group", "alice", 1), secret));
+    XCTAssertTrue(secret == secretBytes(7));
+    XCTAssertEqual(cache.hits(), 1u);
+    XCTAssertEqual(cache.misses(), 1u);
+    XCTAssertEqual(cache.bytes(), 32u);
+}
+
+- (void)testEveryFieldOfTheKeyMatters
+{
+    MLSExporterSecretCache cache(8);
+    cache.put(secretKey("group", "alice", 1), secretBytes(1));
+
+    std::vector<uint8_t> secret;
+    XCTAssertFalse(cache.get(secretKey("group", "bob", 1), secret));
+    XCTAssertFalse(cache.get(secretKey("other", "alice", 1), secret));
+    XCTAssertFalse(cache.get(secretKey("group", "alice", 1, "other label"), secret));
+    XCTAssertFalse(cache.get(secretKey("group", "alice", 1, "label", 16), secret));
+
+    MLSExporterSecretKey otherContext = secretKey("group", "alice", 1);
+    otherContext.contextDigest = "other digest";
+    XCTAssertFalse(cache.get(otherContext, secret));
+}
+
+- (void)testSecretsOfAnotherEpochAreNeverServed
+{
+    MLSExporterSecretCache cache(8);
+    cache.put(secretKey("group", "alice", 1), secretBytes(1));
+
+    // The caller keys lookups with Rust's current epoch, invalidated or not
+    std::vector<uint8_t> secret;
+    XCTAssertFalse(cache.get(secretKey("group", "alice", 2), secret));
+
+    // Storing the new epoch's secret drops the old one
+    cache.put(secretKey("group", "alice", 2), secretBytes(2));
+    XCTAssertFalse(cache.get(secretKey("group", "alice", 1), secret));
+    XCTAssertEqual(cache.size(), 1u);
+}
+
+- (void)testInvalidateDropsOnlyThatGroupAndMember
+{
+    MLSExporterSecretCache cache(8);
+    cache.put(secretKey("group", "alice", 1), secretBytes(1));
+    cache.put(secretKey("group", "alice", 1, "other label"), secretBytes(2));
+    cache.put(secretKey("group", "bob", 1), secretBytes(3));
+
+    cache.invalidate("group", "alice");
+    std::vector<uint8_t> secret;
+    XCTAssertFalse(cache.get(secretKey("group", "alice", 1), secret));
+    XCTAssertTrue(cache.get(secretKey("group", "bob", 1), secret));
+    XCTAssertEqual(cache.size(), 1u);
+}
+
+- (void)testEvictsLeastRecentlyUsedBeyondCapacity
+{
+    MLSExporterSecretCache cache(2);
+    cache.put(secretKey("g1", "alice", 1), secretBytes(1));
+    cache.put(secretKey("g2", "alice", 1), secretBytes(2));
+
+    std::vector<uint8_t> secret;
+    cache.get(secretKey("g1", "alice", 1), secret);
+    cache.put(secretKey("g3", "alice", 1), secretBytes(3));
+
+    XCTAssertTrue(cache.get(secretKey("g1", "alice", 1), secret));
+    XCTAssertFalse(cache.get(secretKey("g2", "alice", 1), secret));
+
+    cache.setCapacity(1);
+    XCTAssertEqual(cache.size(), 1u);
+    XCTAssertTrue(cache.get(secretKey("g1", "alice", 1), secret));
+}
+
+- (void)testClearEmptiesTheCache
+{
+    MLSExporterSecretCache cache(8);
+    cache.put(secretKey("group", "alice", 1), secretBytes(1));
+    cache.clear();
+
+    std::vector<uint8_t> secret;
+    XCTAssertEqual(cache.size(), 0u);
+    XCTAssertEqual(cache.bytes(), 0u);
+    XCTAssertFalse(cache.get(secretKey("group", "alice", 1), secret));
+}
+
+- (void)testZeroizeOverwritesEveryByte
+{
+    std::vector<uint8_t> bytes = secretBytes(0xAB);
+    MLSZeroize(bytes);
+    XCTAssertTrue(bytes == std::vector<uint8_t>(32, 0));
+}
+
+@end
@@ -0,0 +1,183 @@
+//
+// MLSGroupHandleCacheTests.mm
+// bitchatMLSTests
+//
+// This is free and unencumbered software released into the public domain.
+// For more information, see <https://unlicense.org>
+//
+
+#import <XCTest/XCTest.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "MLSGroupHandleCache.h"
+
+namespace {
+
+// Stand-ins for Rust group handles; the cache never looks behind them
+int handleStorage[8];
+
+void *handle(size_t index)
+{
+    return &handleStorage[index];
+}
+
+std::vector<void *> released;
+
+void recordRelease(void *handle)
+{
+    released.push_back(handle);
+}
+
+bool wasReleased(void *handle)
+{
+    return std::find(released.begin(), released.end(), handle) != released.end();
+}
+
+}
+
+@interface MLSGroupHandleCacheTests : XCTestCase
+@end
+
+@implementation MLSGroupHandleCacheTests
+
+- (void)setUp
+{
+    [super setUp];
+    released.clear();
+}
+
+- (void)testReleasesLeastRecentlyUsedBeyondCapacity
+{
+    MLSGroupHandleCache cache(2, recordRelease);
+    cache.put("a", handle(0));
+    cache.put("b", handle(1));
+    cache.get("a");
+    cache.put("c", handle(2));
+
+    XCTAssertEqual(cache.size(), 2u);
+    XCTAssertTrue(cache.contains("a"));
+    XCTAssertFalse(cache.contains("b"));
+    XCTAssertTrue(wasReleased(handle(1)));
+    XCTAssertEqual(released.size(), 1u);
+}
+
+- (void)testReplacingAHandleReleasesTheOldOne
+{
+    MLSGroupHandleCache cache(4, recordRelease);
+    cache.put("a", handle(0));
+    cache.put("a", handle(0));
+    XCTAssertTrue(released.empty(), @"Putting the same handle again must keep it");
+
+    cache.put("a", handle(1));
+    XCTAssertTrue(wasReleased(handle(0)));
+    XCTAssertEqual(cache.get("a").get(), handle(1));
+}
+
+- (void)testNullHandlesAreNotCached
+{
+    MLSGroupHandleCache cache(4, recordRelease);
+    cache.put("a", nullptr);
+    XCTAssertFalse(cache.contains("a"));
+    XCTAssertTrue(cache.get("a") == nullptr);
+}
+
+- (void)testHandleInUseOutlivesEviction
+{
+    MLSGroupHandleCache cache(4, recordRelease);
+    cache.put("a", handle(0));
+
+    MLSGroupHandleCache::Handle inUse = cache.get("a");
+    XCTAssertTrue(cache.evict("a"));
+    XCTAssertFalse(cache.contains("a"));
+    XCTAssertTrue(released.empty(), @"A lane still calling into the handle keeps it alive");
+
+    inUse.reset();
+    XCTAssertTrue(wasReleased(handle(0)));
+}
+
+- (void)testEvictIfReleasesMatchingKeys
+{
+    MLSGroupHandleCache cache(4, recordRelease);
+    cache.put(MLSGroupHandleKey("group", "alice"), handle(0));
+    cache.put(MLSGroupHandleKey("group", "bob"), handle(1));
+    cache.put(MLSGroupHandleKey("other", "alice"), handle(2));
+
+    size_t evicted = cache.evictIf([](const std::string &key) { return MLSGroupHandleKeyHasUser(key, "alice"); });
+    XCTAssertEqual(evicted, 2u);
+    XCTAssertTrue(cache.keys() == std::vector<std::string>{MLSGroupHandleKey("group", "bob")});
+}
+
+- (void)testSetCapacityTakesEffectOnTheNextPut
+{
+    MLSGroupHandleCache cache(4, recordRelease);
+    cache.put("a", handle(0));
+    cache.put("b", handle(1));
+    cache.put("c", handle(2));
+
+    cache.setCapacity(1);
+    XCTAssertEqual(cache.size(), 3u);
+    XCTAssertTrue(released.empty());
+
+    cache.put("d", handle(3));
+    XCTAssertTrue(cache.keys() == std::vector<std::string>{"d"});
+    XCTAssertEqual(released.size(), 3u);
+}
+
+- (void)testTrimKeepsMostRecentlyUsed
+{
+    MLSGroupHandleCache cache(4, recordRelease);
+    cache.put("a", handle(0));
+    cache.put("b", handle(1));
+    cache.put("c", handle(2));
+
+    XCTAssertEqual(cache.trim(1), 2u);
+    XCTAssertTrue(cache.keys() == std::vector<std::string>{"c"});
+    XCTAssertEqual(cache.capacity(), 4u);
+}
+
+- (void)testTrimIfReleasesOnlyMatchingKeysButCountsTheRest
+{
+    MLSGroupHandleCache cache(8, recordRelease);
+    cache.put(MLSGroupHandleKey("g1", "alice"), handle(0));
+    cache.put(MLSGroupHandleKey("g2", "bob"), handle(1));
+    cache.put(MLSGroupHandleKey("g3", "alice"), handle(2));
+    cache.put(MLSGroupHandleKey("g4", "alice"), handle(3));
+
+    // Down to two: alice's oldest handles go first, bob's stays
+    auto isAlice = [](const std::string &key) { return MLSGroupHandleKeyHasUser(key, "alice"); };
+    XCTAssertEqual(cache.trimIf(2, isAlice), 2u);
+    XCTAssertTrue(wasReleased(handle(0)));
+    XCTAssertTrue(wasReleased(handle(2)));
+    XCTAssertTrue(cache.contains(MLSGroupHandleKey("g2", "bob")));
+    XCTAssertTrue(cache.contains(MLSGroupHandleKey("g4", "alice")));
+
+    // Down to none: alice's last handle goes, bob's still stays
+    XCTAssertEqual(cache.trimIf(0, isAlice), 1u);
+    XCTAssertEqual(cache.size(), 1u);
+}
+
+- (void)testClearReleasesEverything
+{
+    MLSGroupHandleCache cache(4, recordRelease);
+    cache.put("a", handle(0));
+    cache.put("b", handle(1));
+    cache.clear();
+
+    XCTAssertEqual(cache.size(), 0u);
+    XCTAssertEqual(released.size(), 2u);
+}
+
+- (void)testKeysSeparateGroupAndMember
+{
+    std::string key = MLSGroupHandleKey("group", "alice");
+    XCTAssertTrue(MLSGroupHandleKeyHasGroup(key, "group"));
+    XCTAssertTrue(MLSGroupHandleKeyHasUser(key, "alice"));
+    XCTAssertFalse(MLSGroupHandleKeyHasGroup(key, "grou"));
+    XCTAssertFalse(MLSGroupHandleKeyHasUser(key, "alic"));
+    XCTAssertFalse(MLSGroupHandleKeyHasUser(MLSGroupHandleKey("groupalice", ""), "alice"));
+}
+
+@end
@@ -0,0 +1,80 @@
+//
+// MLSGroupStateTrackerTests.m
+// bitchatMLSTests
+//
+// This is free and unencumbered software released into the public domain.
+// For more information, see <https://unlicense.org>
+//
+
+#import <XCTest/XCTest.h>
+
+#import "MLSGroupStateTracker.h"
+
+@interface MLSGroupStateTrackerTests : XCTestCase
+@end
+
+@implementation MLSGroupStateTrackerTests
+{
+    MLSGroupStateTracker *_tracker;
+}
+
+- (void)setUp
+{
+    [super setUp];
+    _tracker = [[MLSGroupStateTracker alloc] init];
+}
+
+- (void)testFirstEpochIsAChangeWithoutAPreviousOne
+{
+    NSNumber *previous = @42;
+    XCTAssertTrue([_tracker updateEpoch:1 forGroup:@"group" userId:@"alice" previousEpoch:&previous]);
+    XCTAssertNil(previous);
+}
+
+- (void)testEpochChangesReportThePreviousEpoch
+{
+    NSNumber *previous = nil;
+    [_tracker updateEpoch:1 forGroup:@"group" userId:@"alice" previousEpoch:&previous];
+
+    XCTAssertFalse([_tracker updateEpoch:1 forGroup:@"group" userId:@"alice" previousEpoch:&previous]);
+    XCTAssertEqualObjects(previous, @1);
+
+    XCTAssertTrue([_tracker updateEpoch:2 forGroup:@"group" userId:@"alice" previousEpoch:&previous]);
+    XCTAssertEqualObjects(previous, @1);
+}
+
+- (void)testLocalMembersAreTrackedSeparately
+{
+    NSNumber *previous = nil;
+    [_tracker updateEpoch:3 forGroup:@"group" userId:@"alice" previousEpoch:&previous];
+    XCTAssertTrue([_tracker updateEpoch:3 forGroup:@"group" userId:@"bob" previousEpoch:&previous]);
+    XCTAssertNil(previous);
+
+    [_tracker addPendingProposalForGroup:@"group" userId:@"alice"];
+    XCTAssertFalse([_tracker clearPendingProposalsForGroup:@"group" userId:@"bob"]);
+    XCTAssertTrue([_tracker clearPendingProposalsForGroup:@"group" userId:@"alice"]);
+}
+
+- (void)testPendingProposalsCountUntilCleared
+{
+    XCTAssertEqual([_tracker addPendingProposalForGroup:@"group" userId:@"alice"], 1u);
+    XCTAssertEqual([_tracker addPendingProposalForGroup:@"group" userId:@"alice"], 2u);
+
+    XCTAssertTrue([_tracker clearPendingProposalsForGroup:@"group" userId:@"alice"]);
+    XCTAssertFalse([_tracker clearPendingProposalsForGroup:@"group" userId:@"alice"]);
+    XCTAssertEqual([_tracker addPendingProposalForGroup:@"group" userId:@"alice"], 1u);
+}
+
+- (void)testRemoveAllStatesForgetsEpochsAndProposals
+{
+    NSNumber *previous = nil;
+    [_tracker updateEpoch:5 forGroup:@"group" userId:@"alice" previousEpoch:&previous];
+    [_tracker addPendingProposalForGroup:@"group" userId:@"alice"];
+
+    [_tracker removeAllStates];
+    XCTAssertFalse([_tracker clearPendingProposalsForGroup:@"group" userId:@"alice"]);
+    XCTAssertTrue([_tracker updateEpoch:5 forGroup:@"group" userId:@"alice" previousEpoch:&previous]);
+    XCTAssertNil(previous);
+}
+
+@end
@@ -0,0 +1,118 @@
+//
+// MLSMemberRosterTests.m
+// bitchatMLSTests
+//
+// This is free and unencumbered software released into the public domain.
+// For more information, see <https://unlicense.org>
+//
+
+#import <XCTest/XCTest.h>
+
+#import "MLSMemberRoster.h"
+
+@interface MLSMemberRosterTests : XCTestCase
+@end
+
+@implementation MLSMemberRosterTests
+{
+    MLSMemberRoster *_roster;
+}
+
+- (void)setUp
+{
+    [super setUp];
+    _roster = [[MLSMemberRoster alloc] initWithChangeLogLimit:2];
+}
+
+- (void)testFirstLoadStartsTrackingWithoutADelta
+{
+    XCTAssertFalse([_roster isTrackingGroup:@"group" userId:@"alice"]);
+    XCTAssertNil([_roster membersOfGroup:@"group" userId:@"alice"]);
+
+    XCTAssertNil([_roster updateMembers:@[@"alice", @"bob"] ofGroup:@"group" userId:@"alice"]);
+    XCTAssertTrue([_roster isTrackingGroup:@"group" userId:@"alice"]);
+    XCTAssertEqualObjects([_roster membersOfGroup:@"group" userId:@"alice"], (@[@"alice", @"bob"]));
+    XCTAssertTrue([_roster group:@"group" userId:@"alice" containsMember:@"bob"]);
+    XCTAssertFalse([_roster group:@"group" userId:@"alice" containsMember:@"carol"]);
+}
+
+- (void)testUpdateReportsAddedAndRemoved
+{
+    [_roster updateMembers:@[@"alice", @"bob"] ofGroup:@"group" userId:@"alice"];
+    NSDictionary *change = [_roster updateMembers:@[@"alice", @"carol"] ofGroup:@"group" userId:@"alice"];
+
+    XCTAssertEqualObjects(change[@"version"], @2);
+    XCTAssertEqualObjects(change[@"added"], @[@"carol"]);
+    XCTAssertEqualObjects(change[@"removed"], @[@"bob"]);
+}
+
+- (void)testReorderingIsNotAChange
+{
+    [_roster updateMembers:@[@"alice", @"bob"] ofGroup:@"group" userId:@"alice"];
+    XCTAssertNil([_roster updateMembers:@[@"bob", @"alice"] ofGroup:@"group" userId:@"alice"]);
+    XCTAssertEqualObjects([_roster membersOfGroup:@"group" userId:@"alice"], (@[@"bob", @"alice"]));
+    XCTAssertEqualObjects([_roster changesForGroup:@"group" userId:@"alice" sinceVersion:1][@"version"], @1);
+}
+
+- (void)testLocalMembersKeepSeparateRosters
+{
+    [_roster updateMembers:@[@"alice", @"bob"] ofGroup:@"group" userId:@"alice"];
+    XCTAssertFalse([_roster isTrackingGroup:@"group" userId:@"bob"]);
+    XCTAssertNil([_roster updateMembers:@[@"alice"] ofGroup:@"group" userId:@"bob"]);
+    XCTAssertEqualObjects([_roster membersOfGroup:@"group" userId:@"alice"], (@[@"alice", @"bob"]));
+}
+
+- (void)testChangesFoldAndCancelOut
+{
+    [_roster updateMembers:@[@"alice"] ofGroup:@"group" userId:@"alice"];
+    [_roster updateMembers:@[@"alice", @"bob", @"carol"] ofGroup:@"group" userId:@"alice"];
+    [_roster updateMembers:@[@"alice", @"carol"] ofGroup:@"group" userId:@"alice"];
+
+    // bob came and went after version 1
+    NSDictionary *changes = [_roster changesForGroup:@"group" userId:@"alice" sinceVersion:1];
+    XCTAssertEqualObjects(changes[@"version"], @3);
+    XCTAssertEqualObjects(changes[@"added"], @[@"carol"]);
+    XCTAssertEqualObjects(changes[@"removed"], @[]);
+
+    changes = [_roster changesForGroup:@"group" userId:@"alice" sinceVersion:2];
+    XCTAssertEqualObjects(changes[@"added"], @[]);
+    XCTAssertEqualObjects(changes[@"removed"], @[@"bob"]);
+
+    changes = [_roster changesForGroup:@"group" userId:@"alice" sinceVersion:3];
+    XCTAssertEqualObjects(changes[@"added"], @[]);
+    XCTAssertEqualObjects(changes[@"removed"], @[]);
+}
+
+- (void)testVersionsOlderThanTheChangeLogGetAReset
+{
+    [_roster updateMembers:@[@"alice"] ofGroup:@"group" userId:@"alice"];
+    [_roster updateMembers:@[@"alice", @"bob"] ofGroup:@"group" userId:@"alice"];
+    [_roster updateMembers:@[@"alice", @"bob", @"carol"] ofGroup:@"group" userId:@"alice"];
+    [_roster updateMembers:@[@"alice", @"carol"] ofGroup:@"group" userId:@"alice"];
+
+    // Only the deltas to versions 3 and 4 are kept
+    NSDictionary *reset = [_roster changesForGroup:@"group" userId:@"alice" sinceVersion:1];
+    XCTAssertEqualObjects(reset[@"reset"], @YES);
+    XCTAssertEqualObjects(reset[@"version"], @4);
+    XCTAssertEqualObjects(reset[@"members"], (@[@"alice", @"carol"]));
+
+    NSDictionary *changes = [_roster changesForGroup:@"group" userId:@"alice" sinceVersion:2];
+    XCTAssertNil(changes[@"reset"]);
+    XCTAssertEqualObjects(changes[@"added"], @[@"carol"]);
+    XCTAssertEqualObjects(changes[@"removed"], @[@"bob"]);
+
+    // A version from the future, e.g. from before the client was replaced
+    XCTAssertEqualObjects([_roster changesForGroup:@"group" userId:@"alice" sinceVersion:9][@"reset"], @YES);
+}
+
+- (void)testUntrackedRostersHaveNoChanges
+{
+    XCTAssertNil([_roster changesForGroup:@"group" userId:@"alice" sinceVersion:0]);
+
+    [_roster updateMembers:@[@"alice"] ofGroup:@"group" userId:@"alice"];
+    [_roster removeAllRosters];
+    XCTAssertFalse([_roster isTrackingGroup:@"group" userId:@"alice"]);
+    XCTAssertNil([_roster changesForGroup:@"group" userId:@"alice" sinceVersion:1]);
+}
+
+@end
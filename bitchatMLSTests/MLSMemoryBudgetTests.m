@@ -0,0 +1,121 @@
+//
+// MLSMemoryBudgetTests.m
+// bitchatMLSTests
+//
+// This is free and unencumbered software released into the public domain.
+// For more information, see <https://unlicense.org>
+//
+
+#import <XCTest/XCTest.h>
+
+#import "MLSMemoryBudget.h"
+
+@interface MLSMemoryBudgetTests : XCTestCase
+@end
+
+@implementation MLSMemoryBudgetTests
+{
+    NSMutableArray<NSArray *> *_trims;
+    XCTestExpectation *_trimExpectation;
+}
+
+- (void)setUp
+{
+    [super setUp];
+    _trims = [NSMutableArray array];
+}
+
+- (MLSMemoryBudget *)budgetWithBytes:(uint64_t)bytes
+{
+    MLSMemoryBudget *budget = [[MLSMemoryBudget alloc] initWithBudget:bytes];
+    __weak MLSMemoryBudgetTests *weakSelf = self;
+    budget.trimHandler = ^(MLSMemoryTrimLevel level, NSString *reason) {
+        MLSMemoryBudgetTests *strongSelf = weakSelf;
+        @synchronized (strongSelf) {
+            [strongSelf->_trims addObject:@[MLSMemoryTrimLevelName(level), reason]];
+            [strongSelf->_trimExpectation fulfill];
+        }
+    };
+    return budget;
+}
+
+- (void)expectTrim:(BOOL)expected
+{
+    @synchronized (self) {
+        _trimExpectation = [self expectationWithDescription:@"trim"];
+        _trimExpectation.inverted = !expected;
+    }
+}
+
+- (void)testLevelNamesRoundTrip
+{
+    for (MLSMemoryTrimLevel level = MLSMemoryTrimLevelLow; level <= MLSMemoryTrimLevelCritical; level++) {
+        MLSMemoryTrimLevel parsed;
+        XCTAssertTrue(MLSMemoryTrimLevelFromName(MLSMemoryTrimLevelName(level), &parsed));
+        XCTAssertEqual(parsed, level);
+    }
+    XCTAssertEqualObjects(MLSMemoryTrimLevelName(MLSMemoryTrimLevelModerate), @"moderate");
+
+    MLSMemoryTrimLevel parsed = MLSMemoryTrimLevelLow;
+    XCTAssertFalse(MLSMemoryTrimLevelFromName(@"severe", &parsed));
+    XCTAssertEqual(parsed, MLSMemoryTrimLevelLow);
+}
+
+- (void)testZeroBudgetNeverTrims
+{
+    MLSMemoryBudget *budget = [self budgetWithBytes:0];
+    [self expectTrim:NO];
+    [budget checkFootprint];
+    [self waitForExpectationsWithTimeout:0.3 handler:nil];
+    XCTAssertEqualObjects(budget.statistics[@"budgetTrims"], @0);
+}
+
+- (void)testFootprintUnderTheBudgetDoesNotTrim
+{
+    MLSMemoryBudget *budget = [self budgetWithBytes:UINT64_MAX];
+    [self expectTrim:NO];
+    [budget checkFootprint];
+    [self waitForExpectationsWithTimeout:0.3 handler:nil];
+}
+
+- (void)testOverTheBudgetTrimsThenEscalates
+{
+    // Any process is over a one-byte budget
+    MLSMemoryBudget *budget = [self budgetWithBytes:1];
+    [self expectTrim:YES];
+    [budget checkFootprint];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    XCTAssertEqualObjects(_trims, (@[@[@"moderate", @"budget"]]));
+
+    // Sampled at most every couple of seconds
+    [self expectTrim:NO];
+    [budget checkFootprint];
+    [self waitForExpectationsWithTimeout:0.3 handler:nil];
+
+    // Still over after the trim, so the next one is critical
+    [NSThread sleepForTimeInterval:2];
+    [self expectTrim:YES];
+    [budget checkFootprint];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    XCTAssertEqualObjects(_trims.lastObject, (@[@"critical", @"budget"]));
+    XCTAssertEqualObjects(budget.statistics[@"budgetTrims"], @2);
+}
+
+- (void)testTrimDidFinishIsCounted
+{
+    MLSMemoryBudget *budget = [self budgetWithBytes:0];
+    XCTAssertEqualObjects(budget.statistics[@"lastTrimLevel"], [NSNull null]);
+
+    [budget trimDidFinish:MLSMemoryTrimLevelLow released:3];
+    [budget trimDidFinish:MLSMemoryTrimLevelCritical released:5];
+    [budget trimDidFinish:MLSMemoryTrimLevelLow released:0];
+
+    NSDictionary *statistics = budget.statistics;
+    XCTAssertEqualObjects(statistics[@"trims"], (@{@"low": @2, @"moderate": @0, @"critical": @1}));
+    XCTAssertEqualObjects(statistics[@"released"], @8);
+    XCTAssertEqualObjects(statistics[@"lastTrimLevel"], @"low");
+    XCTAssertEqualObjects(statistics[@"budgetBytes"], @0);
+    XCTAssertGreaterThan([statistics[@"footprintBytes"] unsignedLongLongValue], 0u);
+}
+
+@end
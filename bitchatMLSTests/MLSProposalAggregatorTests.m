@@ -0,0 +1,184 @@
+//
+// MLSProposalAggregatorTests.m
+// bitchatMLSTests
+//
+// This is free and unencumbered software released into the public domain.
+// For more information, see <https://unlicense.org>
+//
+
+#import <XCTest/XCTest.h>
+
+#import "MLSProposalAggregator.h"
+
+// Longer than any test waits, so only the trigger under test can fire
+static const NSTimeInterval MLSNever = 60;
+
+@interface MLSProposalAggregatorTests : XCTestCase
+@end
+
+@implementation MLSProposalAggregatorTests
+{
+    MLSProposalAggregator *_aggregator;
+    NSMutableArray<NSArray *> *_commits;
+    XCTestExpectation *_commitExpectation;
+}
+
+- (void)setUp
+{
+    [super setUp];
+    _aggregator = [[MLSProposalAggregator alloc] initWithMaxProposals:3 maxDelay:MLSNever idleDelay:MLSNever];
+    _commits = [NSMutableArray array];
+
+    __weak MLSProposalAggregatorTests *weakSelf = self;
+    _aggregator.commitHandler = ^(NSString *groupId, NSString *userId, MLSProposalCommitReason reason) {
+        MLSProposalAggregatorTests *strongSelf = weakSelf;
+        @synchronized (strongSelf) {
+            [strongSelf->_commits addObject:@[groupId, userId, @(reason)]];
+            [strongSelf->_commitExpectation fulfill];
+        }
+    };
+    [_aggregator addGroup:@"group" userId:@"alice"];
+}
+
+- (void)expectCommits:(NSUInteger)count
+{
+    @synchronized (self) {
+        _commitExpectation = [self expectationWithDescription:@"commit"];
+        _commitExpectation.expectedFulfillmentCount = count;
+        _commitExpectation.assertForOverFulfill = YES;
+    }
+}
+
+- (void)expectNoCommit
+{
+    [self expectCommits:1];
+    _commitExpectation.inverted = YES;
+}
+
+- (void)propose:(NSUInteger)count
+{
+    for (NSUInteger i = 0; i < count; i++) {
+        [_aggregator proposalAddedToGroup:@"group" userId:@"alice"];
+    }
+}
+
+- (void)testCommitsOnceMaxProposalsArePending
+{
+    [self expectNoCommit];
+    [self propose:2];
+    [self waitForExpectationsWithTimeout:0.3 handler:nil];
+
+    [self expectCommits:1];
+    [self propose:1];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    XCTAssertEqualObjects(_commits.firstObject, (@[@"group", @"alice", @(MLSProposalCommitReasonCount)]));
+}
+
+- (void)testCommitsWhenTheOldestProposalWaitedMaxDelay
+{
+    [_aggregator setMaxProposals:100 maxDelay:0.1 idleDelay:MLSNever];
+    [self expectCommits:1];
+    [self propose:1];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    XCTAssertEqualObjects(_commits.firstObject[2], @(MLSProposalCommitReasonTime));
+}
+
+- (void)testCommitsWhenTheGroupGoesIdle
+{
+    [_aggregator setMaxProposals:100 maxDelay:MLSNever idleDelay:0.1];
+    [self expectCommits:1];
+    [self propose:1];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    XCTAssertEqualObjects(_commits.firstObject[2], @(MLSProposalCommitReasonIdle));
+}
+
+- (void)testFlushCommitsOnlyGroupsWithProposals
+{
+    [_aggregator addGroup:@"quiet" userId:@"alice"];
+    [self propose:1];
+
+    [self expectCommits:1];
+    [_aggregator flush];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    XCTAssertEqualObjects(_commits, (@[@[@"group", @"alice", @(MLSProposalCommitReasonFlush)]]));
+}
+
+- (void)testIgnoresGroupsThatAreNotEnrolled
+{
+    [self expectNoCommit];
+    for (NSUInteger i = 0; i < 3; i++) {
+        [_aggregator proposalAddedToGroup:@"group" userId:@"bob"];
+        [_aggregator proposalAddedToGroup:@"other" userId:@"alice"];
+    }
+    [self waitForExpectationsWithTimeout:0.3 handler:nil];
+    XCTAssertEqualObjects(_aggregator.statistics[@"pendingProposals"], @0);
+}
+
+- (void)testOneCommitIsOutstandingUntilReported
+{
+    [self expectCommits:1];
+    [self propose:3];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+
+    [self expectNoCommit];
+    [self propose:3];
+    [_aggregator flush];
+    [self waitForExpectationsWithTimeout:0.3 handler:nil];
+
+    [_aggregator groupDidCommit:@"group" userId:@"alice"];
+    NSDictionary *statistics = _aggregator.statistics;
+    XCTAssertEqualObjects(statistics[@"commits"], @1);
+    XCTAssertEqualObjects(statistics[@"proposalsCommitted"], @6);
+    XCTAssertEqualObjects(statistics[@"pendingProposals"], @0);
+}
+
+- (void)testAnotherMembersCommitConsumesPendingProposals
+{
+    [self propose:2];
+    [_aggregator groupDidCommit:@"group" userId:@"alice"];
+
+    [self expectNoCommit];
+    [self propose:2];
+    [self waitForExpectationsWithTimeout:0.3 handler:nil];
+    XCTAssertEqualObjects(_aggregator.statistics[@"commits"], @0, @"The aggregator did not ask for that commit");
+}
+
+- (void)testFailedCommitCanBeAskedForAgain
+{
+    [self expectCommits:1];
+    [self propose:3];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    [_aggregator commitDidFail:@"group" userId:@"alice"];
+    XCTAssertEqualObjects(_aggregator.statistics[@"failed"], @1);
+
+    [self expectCommits:1];
+    [self propose:1];
+    [self waitForExpectationsWithTimeout:2 handler:nil];
+    XCTAssertEqual(_commits.count, 2u);
+}
+
+- (void)testRemoveUserDropsItsGroups
+{
+    [_aggregator addGroup:@"other" userId:@"alice"];
+    [_aggregator addGroup:@"group" userId:@"bob"];
+    [_aggregator removeUser:@"alice"];
+    XCTAssertEqualObjects(_aggregator.statistics[@"groups"], @1);
+
+    [self expectNoCommit];
+    [self propose:3];
+    [self waitForExpectationsWithTimeout:0.3 handler:nil];
+
+    [_aggregator removeAllGroups];
+    XCTAssertEqualObjects(_aggregator.statistics[@"groups"], @0);
+}
+
+- (void)testSettingsAreClampedAndReported
+{
+    [_aggregator setMaxProposals:0 maxDelay:-1 idleDelay:0.25];
+    NSDictionary *statistics = _aggregator.statistics;
+    XCTAssertEqualObjects(statistics[@"maxProposals"], @1);
+    XCTAssertEqualObjects(statistics[@"maxDelayMs"], @0);
+    XCTAssertEqualObjects(statistics[@"idleMs"], @250);
+}
+
+@end